@@ -17,21 +17,32 @@
 #include "CinderTango.h"
 #include "cinder/app/App.h"
 #include "cinder/Log.h"
+#include "fast_log.h"
+#include "profiler.h"
 
 CinderTango::CinderTango() : tango_position(glm::vec3(0.0f, 0.0f, 0.0f)),
       tango_rotation(glm::quat(1.0f, 0.0f, 0.0f, 0.0f)),
-      config_(nullptr) {}
+      sensor_sync(SensorSynchronizer::Options()),
+      config_(nullptr),
+      timestamp(0.0) {}
 
 // This is called when new pose updates become available. Pair was set to start-
 // of-service with respect to ADF frame, which will be available only once
 // localized against an ADF. Use this function to check localization status, and
 // use GetPoseAtTime to get the current pose.
 static void onPoseAvailable(void*, const TangoPoseData* pose) {
+  PROFILE_SCOPE("onPoseAvailable");
+  // Device poses registered by ConnectSensorSync go to the synchronizer.
+  if (pose->frame.base == TANGO_COORDINATE_FRAME_START_OF_SERVICE &&
+      pose->frame.target == TANGO_COORDINATE_FRAME_DEVICE) {
+    CinderTango::GetInstance().sensor_sync.PushPose(*pose);
+    return;
+  }
   pthread_mutex_lock(&CinderTango::GetInstance().pose_mutex);
   // Update Tango localization status.
   if (pose->status_code == TANGO_POSE_VALID) {
     CinderTango::GetInstance().is_localized = true;
-    CI_LOG_I("valid pose onPoseAvailable");
+    FAST_LOG(FastLog::kInfo, 1000, "valid pose onPoseAvailable");
   } else {
     CinderTango::GetInstance().is_localized = false;
   }
@@ -40,6 +51,7 @@ static void onPoseAvailable(void*, const TangoPoseData* pose) {
 
 // Tango event callback.
 static void onTangoEvent(void*, const TangoEvent* event) {
+  PROFILE_SCOPE("onTangoEvent");
   pthread_mutex_lock(&CinderTango::GetInstance().event_mutex);
   // Update the status string for debug display.
   std::stringstream string_stream;
@@ -48,6 +60,23 @@ static void onTangoEvent(void*, const TangoEvent* event) {
   pthread_mutex_unlock(&CinderTango::GetInstance().event_mutex);
 }
 
+// Color camera frame callback. Copies the image into a pooled buffer and
+// passes it on to the registered consumers.
+static void onFrameAvailable(void* context, TangoCameraId,
+                             const TangoImageBuffer* buffer) {
+  PROFILE_SCOPE("onFrameAvailable");
+  static_cast<CameraFramePool*>(context)->OnFrameAvailable(buffer);
+}
+
+// Depth callback. The service buffer is only valid during the call, so the
+// points are copied before they are queued.
+static void onXYZijAvailable(void*, const TangoXYZij* xyz_ij) {
+  PROFILE_SCOPE("onXYZijAvailable");
+  std::shared_ptr<PointCloudData> cloud(new PointCloudData());
+  PointCloudFromTango(*xyz_ij, cloud.get());
+  CinderTango::GetInstance().sensor_sync.PushCloud(cloud);
+}
+
 // Get status string based on the pose status code.
 const char* CinderTango::getStatusStringFromStatusCode(
     TangoPoseStatusType status) {
@@ -190,6 +219,43 @@ void CinderTango::ConnectTexture(GLuint texture_id) {
   }
 }
 
+bool CinderTango::ConnectCameraFrames() {
+  if (TangoService_connectOnFrameAvailable(TANGO_CAMERA_COLOR, &camera_frames,
+                                           onFrameAvailable) != TANGO_SUCCESS) {
+    CI_LOG_E("TangoService_connectOnFrameAvailable(): Failed");
+    return false;
+  }
+  return true;
+}
+
+bool CinderTango::ConnectSensorSync() {
+  if (TangoConfig_setBool(config_, "config_enable_depth", true) !=
+      TANGO_SUCCESS) {
+    CI_LOG_E("config_enable_depth(): Failed");
+    return false;
+  }
+
+  TangoCoordinateFramePair pair;
+  pair.base = TANGO_COORDINATE_FRAME_START_OF_SERVICE;
+  pair.target = TANGO_COORDINATE_FRAME_DEVICE;
+  if (TangoService_connectOnPoseAvailable(1, &pair, onPoseAvailable) !=
+      TANGO_SUCCESS) {
+    CI_LOG_E("TangoService_connectOnPoseAvailable(): Failed");
+    return false;
+  }
+
+  if (TangoService_connectOnXYZijAvailable(onXYZijAvailable) !=
+      TANGO_SUCCESS) {
+    CI_LOG_E("TangoService_connectOnXYZijAvailable(): Failed");
+    return false;
+  }
+
+  camera_frames.AddListener([this](const CameraFrameRef& frame) {
+    sensor_sync.PushFrame(frame);
+  });
+  return true;
+}
+
 /// Connect to the Tango Service.
 /// Note: connecting Tango service will start the motion
 /// tracking automatically.
@@ -202,15 +268,20 @@ bool CinderTango::Connect() {
 }
 
 void CinderTango::UpdateColorTexture() {
+  PROFILE_SCOPE("UpdateColorTexture");
   // TangoService_updateTexture() updates target camera's
   // texture and timestamp.
-  if (TangoService_updateTexture(TANGO_CAMERA_COLOR, &timestamp) !=
+  double texture_timestamp;
+  if (TangoService_updateTexture(TANGO_CAMERA_COLOR, &texture_timestamp) !=
       TANGO_SUCCESS) {
-      ci::app::console()<<"TangoService_updateTexture(): Failed"<<std::endl;
+      FAST_LOG(FastLog::kError, 1000, "TangoService_updateTexture(): Failed");
+      return;
   }
+  timestamp.store(texture_timestamp);
 }
 
-bool CinderTango::GetPoseAtTime() {
+bool CinderTango::GetPoseAtTime(double color_timestamp) {
+  PROFILE_SCOPE("GetPoseAtTime");
   // Set the reference frame pair after connect to service.
   // Currently the API will set this set below as default.
 
@@ -224,7 +295,7 @@ bool CinderTango::GetPoseAtTime() {
       TangoService_getPoseAtTime(0., frame_pair, &pose_latest);
   TangoPoseData pose_texture;
   TangoErrorType result_texture =
-      TangoService_getPoseAtTime(timestamp, frame_pair, &pose_texture);
+      TangoService_getPoseAtTime(color_timestamp, frame_pair, &pose_texture);
   bool ok_latest = (result_latest == TANGO_SUCCESS &&
                     pose_latest.status_code == TANGO_POSE_VALID);
   bool ok_texture = (result_texture == TANGO_SUCCESS &&
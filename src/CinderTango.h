@@ -20,8 +20,11 @@
 
 #include <sys/time.h>
 #include <tango_client_api.h>
+#include <atomic>
 
 #include "cinder/gl/gl.h"
+#include "camera_frame_pool.h"
+#include "sensor_synchronizer.h"
 const int kVersionStringLength = 27;
 
 class CinderTango {
@@ -37,11 +40,25 @@ class CinderTango {
   bool SetConfig(bool is_auto_recovery);
   bool Connect();
   void Disconnect();
-  bool GetPoseAtTime();
+  // Updates tango_position and tango_rotation to the pose at
+  // color_timestamp, normally a GetColorTimestamp() the caller keeps with
+  // the result. May run on another thread than UpdateColorTexture; only
+  // that thread may read the two members.
+  bool GetPoseAtTime(double color_timestamp);
+  // Of the last color texture, written by UpdateColorTexture.
+  double GetColorTimestamp() const { return timestamp.load(); }
   bool GetIntrinsics();
   bool GetExtrinsics();
 
   void ConnectTexture(GLuint texture_id);
+  // Delivers color frames to camera_frames for CPU access. The service
+  // supports either this or ConnectTexture, not both.
+  bool ConnectCameraFrames();
+  // Feeds sensor_sync with color frames, depth clouds and device poses.
+  // Enables depth, so call it between SetConfig and Connect. Frames only
+  // arrive if ConnectCameraFrames is used as well.
+  bool ConnectSensorSync();
+  // Call on the GL thread.
   void UpdateColorTexture();
   void ResetMotionTracking();
 
@@ -80,10 +97,17 @@ class CinderTango {
   bool is_localized;
   std::string cur_uuid;
 
+  // CPU copies of the color camera image, fed by ConnectCameraFrames.
+  CameraFramePool camera_frames;
+
+  // Timestamp matched frames, clouds and poses, fed by ConnectSensorSync.
+  SensorSynchronizer sensor_sync;
+
 
  private:
   TangoConfig config_;
-  double timestamp;
+  // Of the color texture, written by UpdateColorTexture.
+  std::atomic<double> timestamp;
 };
 
 #endif  // VIDEO_OVERLAY_JNI_EXAMPLE_EXPERIMENTAL_TANGO_DATA_H_
@@ -9,13 +9,19 @@
 #include "cinder/gl/Batch.h"
 #include "cinder/gl/GlslProg.h"
 #include "cinder/gl/Shader.h"
+#include "cinder/Text.h"
 #include "tango_client_api.h"
 #include "cinder/android/JniHelper.h"
 #include <glm/gtc/quaternion.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include "CinderTango.h"
+#include "fast_log.h"
+#include "profiler.h"
+#include "trace_exporter.h"
+#include "simulation_thread.h"
 
 #include "tango-gl/conversions.h"
+#include "tango-gl/gl_debug.h"
 #include "tango-gl/util.h"
 #include "cinder/Log.h"
 
@@ -23,6 +29,33 @@ using namespace ci;
 using namespace ci::app;
 using namespace std;
 
+// What the simulation thread hands the render thread each step.
+struct FrameState {
+	FrameState() : sequence( 0 ), sim_time( 0.0 ), color_timestamp( 0.0 ) {}
+
+	// 0 until the first step; counts steps after that.
+	uint64_t sequence;
+	// Monotonic time the step finished, in seconds.
+	double sim_time;
+	// Timestamp of the color texture the pose was matched to.
+	double color_timestamp;
+	// Opengl camera with respect to opengl world, and the matrices from it.
+	glm::mat4 ow_T_oc;
+	glm::vec3 ow_p_oc;
+	glm::quat ow_q_oc;
+	glm::mat4 view_mat;
+	glm::mat4 projection_mat;
+	// Pose for mCam.
+	vec3 eye_point;
+	quat orientation;
+};
+
+static double NowSeconds() {
+	timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return now.tv_sec + now.tv_nsec / 1.0e9;
+}
+
 // We'll create a new Cinder Application by deriving from the App class
 class CinderTangoApp : public App {
   public:
@@ -36,8 +69,43 @@ class CinderTangoApp : public App {
 	void keyDown( KeyEvent event );
 	void update();
 	void draw();
+	void cleanup() override;
 	void SetupExtrinsics();
 	void SetupIntrinsics();
+	// Runs on the simulation thread: queries Tango and computes the frame.
+	void Simulate( FrameState *state );
+	// Runs on the render thread: takes the latest simulated frame.
+	void ApplyFrameState();
+#if CINDER_TANGO_PROFILE
+	// Stage timings over the scene; 'p' toggles them. The text is rendered
+	// into mProfileTexture twice a second.
+	void DrawProfileOverlay();
+	bool mShowProfile = true;
+	gl::TextureRef mProfileTexture;
+	// Records a trace from setup on; 't' stops it, or starts a new one
+	// over the old file. Pull it with
+	// adb shell run-as net.jameshurlbut.cindertangoapp cat files/trace.json
+	void StartTrace();
+	// trace.json in the app's files directory, Context.getFilesDir().
+	static const std::string& getTracePath();
+#endif
+
+	// Pose queries and transforms run here at kSimulationRate, so a slow
+	// Tango call costs a stale pose instead of a dropped frame. Simulate
+	// only reads the extrinsics, intrinsics and conversion matrices below,
+	// which are fixed before the thread starts; everything else it touches
+	// lives in the FrameState it writes. The render thread only reads
+	// snapshots.
+	std::unique_ptr<SimulationThread<FrameState> > mSimulation;
+	const double kSimulationRate = 60.0;
+	// Owned by the simulation thread.
+	uint64_t mSimulationSteps = 0;
+	// Render thread timing: update plus draw, how old the snapshot drawn
+	// was, and frames that had no new snapshot.
+	TimingStats mRenderStats;
+	TimingStats mSnapshotAgeStats;
+	uint64_t mStaleFrames = 0;
+	double mFrameStart = 0.0;
 
 	gl::TextureCubeMapRef	mCubeMap;
 	gl::BatchRef			mTeapotBatch, mGround;
@@ -147,7 +215,8 @@ class CinderTangoApp : public App {
 const int SKY_BOX_SIZE = 40;
 
 static void onPoseAvailable(void*, const TangoPoseData* pose) {
-  ci::app::console()<<"Position:"<<pose->translation[0]<<" " <<pose->translation[1]<< std::endl;
+  FAST_LOG(FastLog::kInfo, 1000, "Position: %f %f", pose->translation[0],
+           pose->translation[1]);
 }
 
 
@@ -181,7 +250,12 @@ void CinderTangoApp::resize()
 }
 void CinderTangoApp::setup()
 {
-	
+	// Before Tango connects, so its callbacks can log.
+	FastLog::GetInstance().Start( FastLog::Options() );
+#if CINDER_TANGO_PROFILE
+	StartTrace();
+#endif
+	tango_gl::gl_debug::Initialize();
 	mGround = gl::Batch::create(geom::Cube().size(1,10,10), ci::gl::getStockShader(ci::gl::ShaderDef().color()));
 
     ow_T_ss = tango_gl::conversions::opengl_world_T_tango_world();
@@ -218,51 +292,98 @@ void CinderTangoApp::setup()
         	texFmt.wrap( GL_CLAMP_TO_EDGE );
 			mPassThru = gl::Texture2d::create( getWindowWidth(), getWindowHeight(), texFmt );
 			CinderTango::GetInstance().ConnectTexture(mPassThru->getId());
+			mSimulation.reset( new SimulationThread<FrameState>( kSimulationRate,
+			    [this]( FrameState *state ) { Simulate( state ); } ) );
+			mSimulation->Start();
 	  }
 
 
 }
-void CinderTangoApp::update()
+void CinderTangoApp::Simulate( FrameState *state )
 {
+	PROFILE_SCOPE( "Simulate" );
+	// One read, so the pose and the timestamp in the snapshot match.
+	const double colorTimestamp = CinderTango::GetInstance().GetColorTimestamp();
+	CinderTango::GetInstance().GetPoseAtTime( colorTimestamp );
+
+	glm::vec3 ss_p_device = CinderTango::GetInstance().tango_position;
+	glm::quat ss_q_device = CinderTango::GetInstance().tango_rotation;
+	glm::mat4 ss_T_device = glm::translate(glm::mat4(1.0f), ss_p_device) *
+	                        glm::mat4_cast(ss_q_device);
+	state->ow_T_oc =
+	    ow_T_ss * ss_T_device * glm::inverse(imu_T_device) * imu_T_cc * cc_T_oc;
+	glm::vec3 scale;
+	tango_gl::util::DecomposeMatrix(state->ow_T_oc, state->ow_p_oc, state->ow_q_oc, scale);
+	state->projection_mat = projection_mat_ar;
+	state->view_mat = glm::inverse(state->ow_T_oc);
+
+	// Define what motion is requested.
+	TangoCoordinateFramePair frames_of_reference;
+	frames_of_reference.base = TANGO_COORDINATE_FRAME_START_OF_SERVICE;
+	frames_of_reference.target = TANGO_COORDINATE_FRAME_DEVICE;
+	TangoPoseData pose;
+	TangoService_getPoseAtTime(0.0, frames_of_reference, &pose);
+	quat tangoPose = quat(pose.orientation[3], pose.orientation[0], pose.orientation[1], pose.orientation[2]);
+	const float M_SQRT_2_OVER_2 = sqrt(2) / 2.0f;
+	glm::quat conversionQuaternion = glm::quat(M_SQRT_2_OVER_2, -M_SQRT_2_OVER_2,
+	                                           0.0f, 0.0f);
+	state->orientation = conversionQuaternion * tangoPose;
+	state->eye_point = vec3(pose.translation[0], pose.translation[1], pose.translation[2]);
+	FAST_LOG( FastLog::kInfo, 1000, "trans %f %f %f", pose.translation[0], pose.translation[1], pose.translation[2] );
+
+	state->color_timestamp = colorTimestamp;
+	state->sequence = ++mSimulationSteps;
+	state->sim_time = NowSeconds();
+}
 
+void CinderTangoApp::ApplyFrameState()
+{
+	if( ! mSimulation->Acquire() ) {
+		++mStaleFrames;
+	}
+	const FrameState &state = mSimulation->GetState();
+	if( state.sequence == 0 ) {
+		return;
+	}
+	mSnapshotAgeStats.Add( ( NowSeconds() - state.sim_time ) * 1000.0 );
+	PROFILE_COUNTER( "snapshot_age_ms", mSnapshotAgeStats.last_ms );
+	ow_T_oc = state.ow_T_oc;
+	ow_p_oc = state.ow_p_oc;
+	ow_q_oc = state.ow_q_oc;
+	projection_mat = state.projection_mat;
+	view_mat = state.view_mat;
+	mCam.setOrientation( state.orientation );
+	mCam.setEyePoint( state.eye_point );
+}
+
+void CinderTangoApp::update()
+{
+	// The previous frame ends as this one begins.
+	PROFILE_END_FRAME();
+	PROFILE_SCOPE( "update" );
+	mFrameStart = NowSeconds();
     if(tangoConnected){
+    	// Must run with the GL context current; the pose for the new image
+    	// is looked up by the simulation thread.
     	CinderTango::GetInstance().UpdateColorTexture();
-    	CinderTango::GetInstance().GetPoseAtTime();
-
-  		glm::vec3 ss_p_device = CinderTango::GetInstance().tango_position;
-	  glm::quat ss_q_device = CinderTango::GetInstance().tango_rotation;
-	  glm::mat4 ss_T_device = glm::translate(glm::mat4(1.0f), ss_p_device) *
-	                          glm::mat4_cast(ss_q_device);
-	  ow_T_oc =
-	      ow_T_ss * ss_T_device * glm::inverse(imu_T_device) * imu_T_cc * cc_T_oc;
-	  glm::vec3 scale;
-	  tango_gl::util::DecomposeMatrix(ow_T_oc, ow_p_oc, ow_q_oc, scale);
-		projection_mat = projection_mat_ar;
-    	view_mat = glm::inverse(ow_T_oc);
-    	// Define what motion is requested.
-            
-
-
-            TangoCoordinateFramePair frames_of_reference;
-            frames_of_reference.base = TANGO_COORDINATE_FRAME_START_OF_SERVICE;
-            frames_of_reference.target = TANGO_COORDINATE_FRAME_DEVICE;
-            TangoPoseData pose;
-    		TangoService_getPoseAtTime(0.0, frames_of_reference, &pose);
-    		quat tangoPose = quat(pose.orientation[3], pose.orientation[0], pose.orientation[1], pose.orientation[2]);
-    		const float M_SQRT_2_OVER_2 = sqrt(2) / 2.0f;
-              glm::quat conversionQuaternion = glm::quat(M_SQRT_2_OVER_2, -M_SQRT_2_OVER_2,
-                                                         0.0f, 0.0f);
-             tangoPose = conversionQuaternion * tangoPose;
-    		mCam.setOrientation(tangoPose);
-			mCam.setEyePoint(vec3(pose.translation[0], pose.translation[1], pose.translation[2]));
-			ci::app::console()<<"trans " << pose.translation[0] << " " << pose.translation[1] << " " << pose.translation[2] << std::endl;
-
+    	ApplyFrameState();
     }
     //
 	//mCam.setPerspective(60, getWindowAspectRatio(), 1, 1000);
 
 
 }
+
+void CinderTangoApp::cleanup()
+{
+	// Simulate uses this app, so the thread must end first.
+	mSimulation.reset();
+#if CINDER_TANGO_PROFILE
+	TraceExporter::GetInstance().Stop();
+#endif
+	FastLog::GetInstance().Stop();
+}
+
 void CinderTangoApp::mouseDrag( MouseEvent event )
 {
 	mPoints.push_back( event.getPos() );
@@ -287,11 +408,33 @@ void CinderTangoApp::keyDown( KeyEvent event )
 {
 	if( event.getChar() == 'f' )
 		setFullScreen( ! isFullScreen() );
+#if CINDER_TANGO_PROFILE
+	else if( event.getChar() == 'p' )
+		mShowProfile = ! mShowProfile;
+	else if( event.getChar() == 't' ) {
+		if( TraceExporter::GetInstance().IsRecording() )
+			TraceExporter::GetInstance().Stop();
+		else
+			StartTrace();
+	}
+#endif
+	else if( event.getChar() == 's' && mSimulation ) {
+		const SimulationThread<FrameState>::Stats sim = mSimulation->GetStats();
+		CI_LOG_I( "simulation: " << sim.step.count << " steps, " << sim.step.GetAverageMs()
+		          << " ms avg, " << sim.step.max_ms << " ms max, " << sim.overruns << " overruns" );
+		CI_LOG_I( "render: " << mRenderStats.count << " frames, " << mRenderStats.GetAverageMs()
+		          << " ms avg, " << mRenderStats.max_ms << " ms max, snapshot age "
+		          << mSnapshotAgeStats.GetAverageMs() << " ms avg, " << mStaleFrames << " stale frames" );
+		const FastLog::Stats log = FastLog::GetInstance().GetStats();
+		CI_LOG_I( "fast log: " << log.written << " written, " << log.dropped << " dropped, "
+		          << log.suppressed << " suppressed, " << log.threads << " threads" );
+	}
 }
 
 
 void CinderTangoApp::draw()
 {
+	PROFILE_SCOPE( "draw" );
 	gl::clear( Color( 0, 0, 0 ) );
 	gl::setMatricesWindow(getWindowSize(),false);
 		gl::pushMatrices();
@@ -300,8 +443,6 @@ void CinderTangoApp::draw()
     	gl::popMatrices();
 	gl::setMatrices( mCam );
 	gl::enableDepthWrite();
-	projection_mat = projection_mat_ar;
-    view_mat = glm::inverse(ow_T_oc);
 
     gl::pushMatrices();
     //gl::setProjectionMatrix(projection_mat);
@@ -311,6 +452,13 @@ void CinderTangoApp::draw()
 	gl::translate(0,-3,.5);
 	//mGround->draw();
 	gl::popMatrices();
+
+	mRenderStats.Add( ( NowSeconds() - mFrameStart ) * 1000.0 );
+	TANGO_GL_CHECK_FRAME( "CinderTangoApp::draw" );
+#if CINDER_TANGO_PROFILE
+	if( mShowProfile )
+		DrawProfileOverlay();
+#endif
 	
 	// draw sky box
 	//gl::pushMatrices();
@@ -320,6 +468,73 @@ void CinderTangoApp::draw()
 
 }
 
+#if CINDER_TANGO_PROFILE
+const std::string& CinderTangoApp::getTracePath()
+{
+	static const std::string path = [] {
+		JNIEnv *env = cinder::android::JniHelper::Get()->AttachCurrentThread();
+		jobject activity = cinder::android::app::CinderNativeActivity::getJavaObject();
+		jclass contextClass = env->GetObjectClass( activity );
+		jobject dir = env->CallObjectMethod( activity, env->GetMethodID( contextClass, "getFilesDir", "()Ljava/io/File;" ) );
+		std::string filesDir;
+		if( dir ) {
+			jclass fileClass = env->GetObjectClass( dir );
+			jstring dirPath = static_cast<jstring>( env->CallObjectMethod( dir, env->GetMethodID( fileClass, "getAbsolutePath", "()Ljava/lang/String;" ) ) );
+			const char *chars = env->GetStringUTFChars( dirPath, nullptr );
+			filesDir = chars;
+			env->ReleaseStringUTFChars( dirPath, chars );
+			env->DeleteLocalRef( dirPath );
+			env->DeleteLocalRef( fileClass );
+			env->DeleteLocalRef( dir );
+		}
+		env->DeleteLocalRef( contextClass );
+		// Without a files directory TraceExporter::Start fails and logs why.
+		return filesDir + "/trace.json";
+	}();
+	return path;
+}
+
+void CinderTangoApp::StartTrace()
+{
+	TraceExporter::Options options;
+	options.path = getTracePath();
+	TraceExporter::GetInstance().Start( options );
+}
+
+void CinderTangoApp::DrawProfileOverlay()
+{
+	if( ! mProfileTexture || getElapsedFrames() % 30 == 0 ) {
+		const Profiler::Stats stats = Profiler::GetInstance().GetStats();
+		TextLayout layout;
+		layout.clear( ColorA( 0, 0, 0, 0.6f ) );
+		layout.setColor( Color::white() );
+		layout.setBorder( 8, 8 );
+		char line[128];
+		snprintf( line, sizeof( line ), "frame %.2f ms avg, %.2f ms max, %llu spans dropped",
+		          stats.frame_average_ms, stats.frame_max_ms, static_cast<unsigned long long>( stats.dropped ) );
+		layout.addLine( line );
+		if( TraceExporter::GetInstance().IsRecording() ) {
+			const TraceExporter::Stats trace = TraceExporter::GetInstance().GetStats();
+			snprintf( line, sizeof( line ), "tracing: %llu events, %llu dropped, %.1f MB",
+			          static_cast<unsigned long long>( trace.written ), static_cast<unsigned long long>( trace.dropped ),
+			          trace.bytes / ( 1024.0 * 1024.0 ) );
+			layout.addLine( line );
+		}
+		for( const Profiler::StageStats &stage : stats.stages ) {
+			snprintf( line, sizeof( line ), "%s: %.1f/frame, %.2f ms avg, %.2f ms max",
+			          stage.name.c_str(), stage.calls, stage.average_ms, stage.max_ms );
+			layout.addLine( line );
+		}
+		mProfileTexture = gl::Texture2d::create( layout.render( true ) );
+	}
+	gl::ScopedMatrices matrices;
+	gl::setMatricesWindow( getWindowSize() );
+	gl::ScopedDepth depth( false );
+	gl::ScopedBlendAlpha blend;
+	gl::ScopedColor color( Color::white() );
+	gl::draw( mProfileTexture, vec2( 10, 10 ) );
+}
+#endif
 
 // This line tells Cinder to actually create the application
 CINDER_APP( CinderTangoApp, RendererGl )
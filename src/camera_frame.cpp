@@ -0,0 +1,82 @@
+#include "camera_frame.h"
+
+namespace {
+// Android YV12 aligns the chroma stride to 16 bytes.
+uint32_t Yv12ChromaStride(uint32_t stride) { return ((stride / 2) + 15) & ~15u; }
+}  // namespace
+
+size_t ImageByteSize(TangoImageFormatType format, uint32_t stride,
+                     uint32_t height) {
+  const size_t luma = static_cast<size_t>(stride) * height;
+  switch (format) {
+    case TANGO_HAL_PIXEL_FORMAT_RGBA_8888:
+      return luma * 4;
+    case TANGO_HAL_PIXEL_FORMAT_YCrCb_420_SP:
+      return luma + static_cast<size_t>(stride) * ((height + 1) / 2);
+    case TANGO_HAL_PIXEL_FORMAT_YV12:
+      return luma +
+             2 * static_cast<size_t>(Yv12ChromaStride(stride)) *
+                 ((height + 1) / 2);
+    default:
+      return 0;
+  }
+}
+
+bool GetImagePlanes(TangoImageFormatType format, const uint8_t* data,
+                    uint32_t width, uint32_t height, uint32_t stride,
+                    ImagePlanes* planes) {
+  const uint8_t* chroma = data + static_cast<size_t>(stride) * height;
+  planes->y = data;
+  planes->y_stride = static_cast<int>(stride);
+  planes->width = static_cast<int>(width);
+  planes->height = static_cast<int>(height);
+  switch (format) {
+    case TANGO_HAL_PIXEL_FORMAT_YCrCb_420_SP:
+      // Interleaved V, U.
+      planes->v = chroma;
+      planes->u = chroma + 1;
+      planes->chroma_stride = static_cast<int>(stride);
+      planes->chroma_step = 2;
+      return true;
+    case TANGO_HAL_PIXEL_FORMAT_YV12: {
+      // Full V plane followed by the full U plane.
+      const uint32_t chroma_stride = Yv12ChromaStride(stride);
+      planes->v = chroma;
+      planes->u = chroma + static_cast<size_t>(chroma_stride) *
+                               ((height + 1) / 2);
+      planes->chroma_stride = static_cast<int>(chroma_stride);
+      planes->chroma_step = 1;
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+CameraFrame::CameraFrame()
+    : width(0),
+      height(0),
+      stride(0),
+      timestamp(0.0),
+      frame_number(0),
+      format(TANGO_HAL_PIXEL_FORMAT_YCrCb_420_SP),
+      byte_size_(0),
+      ref_count_(0) {}
+
+bool CameraFrame::GetPlanes(ImagePlanes* planes) const {
+  if (data_.empty()) {
+    return false;
+  }
+  return GetImagePlanes(format, &data_[0], width, height, stride, planes);
+}
+
+bool CameraFrame::TryAddRef() {
+  int count = ref_count_.load(std::memory_order_acquire);
+  while (count > 0) {
+    if (ref_count_.compare_exchange_weak(count, count + 1,
+                                         std::memory_order_acq_rel)) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,114 @@
+#ifndef CINDER_TANGO_CAMERA_FRAME_H_
+#define CINDER_TANGO_CAMERA_FRAME_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+#include <tango_client_api.h>
+
+// Plane pointers of a YUV 4:2:0 image. Chroma samples of one row are
+// chroma_step bytes apart: 2 for the interleaved VU plane of NV21, 1 for the
+// separate planes of YV12.
+struct ImagePlanes {
+  const uint8_t* y;
+  const uint8_t* u;
+  const uint8_t* v;
+  int y_stride;
+  int chroma_stride;
+  int chroma_step;
+  int width;
+  int height;
+};
+
+// Bytes occupied by an image of the given format as laid out by the service.
+// stride is in pixels, as in TangoImageBuffer.
+size_t ImageByteSize(TangoImageFormatType format, uint32_t stride,
+                     uint32_t height);
+
+// Fills planes for a YUV buffer. Returns false for formats that are not
+// YUV 4:2:0.
+bool GetImagePlanes(TangoImageFormatType format, const uint8_t* data,
+                    uint32_t width, uint32_t height, uint32_t stride,
+                    ImagePlanes* planes);
+
+// One color camera image owned by a CameraFramePool slot. The pixel data
+// keeps the service layout (planes and stride), with the metadata scanline
+// replaced by a copy of the first image row.
+class CameraFrame {
+ public:
+  CameraFrame();
+  CameraFrame(const CameraFrame& other) = delete;
+  CameraFrame& operator=(const CameraFrame&) = delete;
+
+  uint32_t width;
+  uint32_t height;
+  uint32_t stride;
+  double timestamp;
+  int64_t frame_number;
+  TangoImageFormatType format;
+
+  const uint8_t* GetData() const { return data_.empty() ? nullptr : &data_[0]; }
+  size_t GetByteSize() const { return byte_size_; }
+  // Returns false if the frame is not YUV 4:2:0.
+  bool GetPlanes(ImagePlanes* planes) const;
+
+ private:
+  friend class CameraFramePool;
+  friend class CameraFrameRef;
+
+  void AddRef() { ref_count_.fetch_add(1, std::memory_order_relaxed); }
+  void Release() { ref_count_.fetch_sub(1, std::memory_order_acq_rel); }
+  // Takes a reference only if somebody else still holds one.
+  bool TryAddRef();
+
+  std::vector<uint8_t> data_;
+  size_t byte_size_;
+  std::atomic<int> ref_count_;
+};
+
+// Counted reference to a pooled CameraFrame. The slot returns to the pool
+// when the last reference goes away, so consumers must not hold on to frames
+// longer than they need; every held reference is one buffer fewer for the
+// camera callback.
+class CameraFrameRef {
+ public:
+  CameraFrameRef() : frame_(nullptr) {}
+  CameraFrameRef(const CameraFrameRef& other) : frame_(other.frame_) {
+    if (frame_ != nullptr) {
+      frame_->AddRef();
+    }
+  }
+  CameraFrameRef(CameraFrameRef&& other) : frame_(other.frame_) {
+    other.frame_ = nullptr;
+  }
+  CameraFrameRef& operator=(CameraFrameRef other) {
+    CameraFrame* frame = frame_;
+    frame_ = other.frame_;
+    other.frame_ = frame;
+    return *this;
+  }
+  ~CameraFrameRef() { Reset(); }
+
+  void Reset() {
+    if (frame_ != nullptr) {
+      frame_->Release();
+      frame_ = nullptr;
+    }
+  }
+
+  const CameraFrame* get() const { return frame_; }
+  const CameraFrame* operator->() const { return frame_; }
+  const CameraFrame& operator*() const { return *frame_; }
+  explicit operator bool() const { return frame_ != nullptr; }
+
+ private:
+  friend class CameraFramePool;
+  // Adopts a reference the caller already took.
+  explicit CameraFrameRef(CameraFrame* frame) : frame_(frame) {}
+
+  CameraFrame* frame_;
+};
+
+#endif  // CINDER_TANGO_CAMERA_FRAME_H_
@@ -0,0 +1,130 @@
+#include "camera_frame_pool.h"
+
+#include <string.h>
+
+CameraFramePool::CameraFramePool(int num_buffers)
+    : latest_(nullptr),
+      next_listener_id_(1),
+      received_frames_(0),
+      dropped_frames_(0) {
+  pthread_mutex_init(&listener_mutex_, nullptr);
+  // One slot for the latest frame, one being written, the rest for consumers.
+  if (num_buffers < 2) {
+    num_buffers = 2;
+  }
+  for (int i = 0; i < num_buffers; ++i) {
+    slots_.push_back(new CameraFrame());
+  }
+}
+
+CameraFramePool::~CameraFramePool() {
+  // Outstanding references must be gone by now; the slots are freed here.
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    delete slots_[i];
+  }
+  pthread_mutex_destroy(&listener_mutex_);
+}
+
+int CameraFramePool::AddListener(const Listener& listener) {
+  pthread_mutex_lock(&listener_mutex_);
+  int id = next_listener_id_++;
+  listeners_.push_back(std::make_pair(id, listener));
+  pthread_mutex_unlock(&listener_mutex_);
+  return id;
+}
+
+void CameraFramePool::RemoveListener(int id) {
+  pthread_mutex_lock(&listener_mutex_);
+  for (size_t i = 0; i < listeners_.size(); ++i) {
+    if (listeners_[i].first == id) {
+      listeners_.erase(listeners_.begin() + i);
+      break;
+    }
+  }
+  pthread_mutex_unlock(&listener_mutex_);
+}
+
+CameraFrame* CameraFramePool::ClaimFreeSlot() {
+  for (size_t i = 0; i < slots_.size(); ++i) {
+    int expected = 0;
+    if (slots_[i]->ref_count_.compare_exchange_strong(
+            expected, 1, std::memory_order_acq_rel)) {
+      return slots_[i];
+    }
+  }
+  return nullptr;
+}
+
+void CameraFramePool::OnFrameAvailable(const TangoImageBuffer* buffer) {
+  ++received_frames_;
+  const size_t byte_size =
+      ImageByteSize(buffer->format, buffer->stride, buffer->height);
+  if (byte_size == 0 || buffer->height < 2) {
+    ++dropped_frames_;
+    return;
+  }
+
+  CameraFrame* frame = ClaimFreeSlot();
+  if (frame == nullptr) {
+    ++dropped_frames_;
+    return;
+  }
+
+  // Storage only grows, so after the first frames this never allocates.
+  if (frame->data_.size() < byte_size) {
+    frame->data_.resize(byte_size);
+  }
+  frame->byte_size_ = byte_size;
+  frame->width = buffer->width;
+  frame->height = buffer->height;
+  frame->stride = buffer->stride;
+  frame->timestamp = buffer->timestamp;
+  frame->frame_number = buffer->frame_number;
+  frame->format = buffer->format;
+
+  // The first scanline carries metadata rather than pixels. Everything after
+  // it is copied in one pass and the first row is filled from the second,
+  // which keeps the image size and the camera intrinsics valid.
+  const size_t row_bytes =
+      buffer->format == TANGO_HAL_PIXEL_FORMAT_RGBA_8888
+          ? static_cast<size_t>(buffer->stride) * 4
+          : static_cast<size_t>(buffer->stride);
+  uint8_t* data = &frame->data_[0];
+  memcpy(data + row_bytes, buffer->data + row_bytes, byte_size - row_bytes);
+  memcpy(data, data + row_bytes, row_bytes);
+
+  // Publish: the pool's reference moves from the previous latest frame to
+  // this one.
+  CameraFrame* previous = latest_.exchange(frame, std::memory_order_acq_rel);
+  if (previous != nullptr) {
+    previous->Release();
+  }
+
+  pthread_mutex_lock(&listener_mutex_);
+  if (!listeners_.empty()) {
+    frame->AddRef();
+    CameraFrameRef ref(frame);
+    for (size_t i = 0; i < listeners_.size(); ++i) {
+      listeners_[i].second(ref);
+    }
+  }
+  pthread_mutex_unlock(&listener_mutex_);
+}
+
+CameraFrameRef CameraFramePool::AcquireLatest() const {
+  while (true) {
+    CameraFrame* frame = latest_.load(std::memory_order_acquire);
+    if (frame == nullptr) {
+      return CameraFrameRef();
+    }
+    // The slot may be recycled between the load and the increment. A
+    // reference only counts if the slot is still the published one
+    // afterwards; otherwise give it back and retry.
+    if (frame->TryAddRef()) {
+      if (latest_.load(std::memory_order_acquire) == frame) {
+        return CameraFrameRef(frame);
+      }
+      frame->Release();
+    }
+  }
+}
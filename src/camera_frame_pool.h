@@ -0,0 +1,64 @@
+#ifndef CINDER_TANGO_CAMERA_FRAME_POOL_H_
+#define CINDER_TANGO_CAMERA_FRAME_POOL_H_
+
+#include <pthread.h>
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include <tango_client_api.h>
+
+#include "camera_frame.h"
+
+// Hands color camera frames from TangoService_connectOnFrameAvailable to CPU
+// consumers.
+//
+// The pool owns a fixed number of frame buffers allocated on the first
+// callback. Each callback copies the service buffer once into a free slot;
+// from there consumers share the slot through CameraFrameRef without further
+// copies. When every slot is still referenced the incoming frame is dropped
+// and counted, so a slow consumer never blocks the camera thread.
+//
+// Consumers either register a listener, which runs on the camera callback
+// thread and should only take a reference and hand it off, or poll with
+// AcquireLatest() from any thread.
+class CameraFramePool {
+ public:
+  typedef std::function<void(const CameraFrameRef& frame)> Listener;
+
+  explicit CameraFramePool(int num_buffers = 6);
+  CameraFramePool(const CameraFramePool& other) = delete;
+  CameraFramePool& operator=(const CameraFramePool&) = delete;
+  ~CameraFramePool();
+
+  // Called from the onFrameAvailable callback.
+  void OnFrameAvailable(const TangoImageBuffer* buffer);
+
+  // Returns an id for RemoveListener.
+  int AddListener(const Listener& listener);
+  void RemoveListener(int id);
+
+  // Most recent complete frame, or an empty reference before the first one.
+  CameraFrameRef AcquireLatest() const;
+
+  uint64_t GetReceivedFrameCount() const { return received_frames_.load(); }
+  uint64_t GetDroppedFrameCount() const { return dropped_frames_.load(); }
+  int GetBufferCount() const { return static_cast<int>(slots_.size()); }
+
+ private:
+  CameraFrame* ClaimFreeSlot();
+
+  std::vector<CameraFrame*> slots_;
+  // Slot holding the latest frame. The pool keeps one reference on it.
+  std::atomic<CameraFrame*> latest_;
+
+  pthread_mutex_t listener_mutex_;
+  std::vector<std::pair<int, Listener> > listeners_;
+  int next_listener_id_;
+
+  std::atomic<uint64_t> received_frames_;
+  std::atomic<uint64_t> dropped_frames_;
+};
+
+#endif  // CINDER_TANGO_CAMERA_FRAME_POOL_H_
@@ -0,0 +1,221 @@
+#include "capture_format.h"
+
+#include <string.h>
+#include <zlib.h>
+#include <algorithm>
+
+#include "camera_frame.h"
+#include "cinder/Log.h"
+
+static_assert(sizeof(CaptureRecordHeader) == 128,
+              "CaptureRecordHeader must match the on-disk layout");
+static_assert(sizeof(CaptureIndexEntry) == 32,
+              "CaptureIndexEntry must match the on-disk layout");
+
+namespace {
+const size_t kFileHeaderSize = 8;
+
+// A run of equally sized rows sharing one delta step.
+struct RowSegment {
+  size_t offset;
+  size_t rows;
+  size_t row_bytes;
+  size_t step;
+};
+
+// Splits an image buffer into luma and chroma rows. Returns the number of
+// segments, 0 if size does not match the format.
+int GetRowSegments(TangoImageFormatType format, uint32_t height,
+                   uint32_t stride, size_t size, RowSegment segments[2]) {
+  if (size != ImageByteSize(format, stride, height) || height == 0) {
+    return 0;
+  }
+  if (format == TANGO_HAL_PIXEL_FORMAT_RGBA_8888) {
+    RowSegment rgba = {0, height, static_cast<size_t>(stride) * 4, 4};
+    segments[0] = rgba;
+    return 1;
+  }
+  const size_t luma = static_cast<size_t>(stride) * height;
+  const size_t chroma_rows = (height + 1) / 2;
+  RowSegment y = {0, height, stride, 1};
+  segments[0] = y;
+  if (format == TANGO_HAL_PIXEL_FORMAT_YCrCb_420_SP) {
+    RowSegment vu = {luma, chroma_rows, stride, 2};
+    segments[1] = vu;
+  } else {
+    // V plane followed by U plane, both with the same padded stride.
+    RowSegment vu = {luma, 2 * chroma_rows, (size - luma) / (2 * chroma_rows),
+                     1};
+    segments[1] = vu;
+  }
+  return 2;
+}
+
+void DeltaEncode(const RowSegment& segment, const uint8_t* src, uint8_t* dst) {
+  for (size_t row = 0; row < segment.rows; ++row) {
+    const uint8_t* in = src + segment.offset + row * segment.row_bytes;
+    uint8_t* out = dst + segment.offset + row * segment.row_bytes;
+    const size_t step = std::min(segment.step, segment.row_bytes);
+    memcpy(out, in, step);
+    for (size_t x = step; x < segment.row_bytes; ++x) {
+      out[x] = static_cast<uint8_t>(in[x] - in[x - step]);
+    }
+  }
+}
+
+void DeltaDecode(const RowSegment& segment, uint8_t* data) {
+  for (size_t row = 0; row < segment.rows; ++row) {
+    uint8_t* bytes = data + segment.offset + row * segment.row_bytes;
+    for (size_t x = segment.step; x < segment.row_bytes; ++x) {
+      bytes[x] = static_cast<uint8_t>(bytes[x] + bytes[x - segment.step]);
+    }
+  }
+}
+}  // namespace
+
+std::string CaptureChunkPath(const std::string& directory, uint32_t chunk) {
+  char name[32];
+  snprintf(name, sizeof(name), "/chunk_%05u.ctv", chunk);
+  return directory + name;
+}
+
+std::string CaptureIndexPath(const std::string& directory) {
+  return directory + "/index.ctv";
+}
+
+bool EncodeCaptureFrame(CaptureCodec codec, int level,
+                        TangoImageFormatType format, uint32_t height,
+                        uint32_t stride, const uint8_t* data, size_t size,
+                        std::vector<uint8_t>* scratch,
+                        std::vector<uint8_t>* payload) {
+  if (codec == kCaptureCodecRaw) {
+    payload->assign(data, data + size);
+    return true;
+  }
+
+  RowSegment segments[2];
+  const int segment_count =
+      GetRowSegments(format, height, stride, size, segments);
+  if (segment_count == 0) {
+    return false;
+  }
+  scratch->resize(size);
+  for (int i = 0; i < segment_count; ++i) {
+    DeltaEncode(segments[i], data, &(*scratch)[0]);
+  }
+
+  uLongf compressed_size = compressBound(size);
+  payload->resize(compressed_size);
+  if (compress2(&(*payload)[0], &compressed_size, &(*scratch)[0], size,
+                level) != Z_OK) {
+    return false;
+  }
+  payload->resize(compressed_size);
+  return true;
+}
+
+bool DecodeCaptureFrame(const CaptureRecordHeader& header,
+                        const std::vector<uint8_t>& payload,
+                        std::vector<uint8_t>* data) {
+  if (header.codec == kCaptureCodecRaw) {
+    if (payload.size() != header.raw_size) {
+      return false;
+    }
+    *data = payload;
+    return true;
+  }
+  if (header.codec != kCaptureCodecDeflate || payload.empty()) {
+    return false;
+  }
+
+  const TangoImageFormatType format =
+      static_cast<TangoImageFormatType>(header.format);
+  RowSegment segments[2];
+  const int segment_count = GetRowSegments(format, header.height,
+                                           header.stride, header.raw_size,
+                                           segments);
+  if (segment_count == 0) {
+    return false;
+  }
+  data->resize(header.raw_size);
+  uLongf size = header.raw_size;
+  if (uncompress(&(*data)[0], &size, &payload[0], payload.size()) != Z_OK ||
+      size != header.raw_size) {
+    return false;
+  }
+  for (int i = 0; i < segment_count; ++i) {
+    DeltaDecode(segments[i], &(*data)[0]);
+  }
+  return true;
+}
+
+CaptureReader::CaptureReader() : chunk_file_(nullptr), chunk_(0) {}
+
+CaptureReader::~CaptureReader() { Close(); }
+
+bool CaptureReader::Open(const std::string& directory) {
+  Close();
+  FILE* file = fopen(CaptureIndexPath(directory).c_str(), "rb");
+  if (file == nullptr) {
+    CI_LOG_E("CaptureReader: cannot open index in " << directory);
+    return false;
+  }
+  char magic[4];
+  uint32_t version = 0;
+  bool ok = fread(magic, 1, 4, file) == 4 &&
+            memcmp(magic, kCaptureIndexMagic, 4) == 0 &&
+            fread(&version, sizeof(version), 1, file) == 1 &&
+            version == kCaptureFormatVersion;
+  CaptureIndexEntry entry;
+  while (ok && fread(&entry, sizeof(entry), 1, file) == 1) {
+    index_.push_back(entry);
+  }
+  fclose(file);
+  if (!ok) {
+    CI_LOG_E("CaptureReader: bad index in " << directory);
+    index_.clear();
+    return false;
+  }
+  directory_ = directory;
+  return true;
+}
+
+void CaptureReader::Close() {
+  if (chunk_file_ != nullptr) {
+    fclose(chunk_file_);
+    chunk_file_ = nullptr;
+  }
+  index_.clear();
+  directory_.clear();
+}
+
+bool CaptureReader::ReadFrame(size_t i, CaptureRecordHeader* header,
+                              std::vector<uint8_t>* data) {
+  if (i >= index_.size()) {
+    return false;
+  }
+  const CaptureIndexEntry& entry = index_[i];
+  if (chunk_file_ == nullptr || chunk_ != entry.chunk) {
+    if (chunk_file_ != nullptr) {
+      fclose(chunk_file_);
+    }
+    chunk_ = entry.chunk;
+    chunk_file_ = fopen(CaptureChunkPath(directory_, chunk_).c_str(), "rb");
+    if (chunk_file_ == nullptr) {
+      return false;
+    }
+  }
+  if (entry.offset < kFileHeaderSize ||
+      fseeko(chunk_file_, static_cast<off_t>(entry.offset), SEEK_SET) != 0 ||
+      fread(header, sizeof(*header), 1, chunk_file_) != 1 ||
+      memcmp(header->magic, kCaptureRecordMagic, 4) != 0) {
+    return false;
+  }
+  payload_.resize(header->payload_size);
+  if (header->payload_size > 0 &&
+      fread(&payload_[0], 1, payload_.size(), chunk_file_) !=
+          payload_.size()) {
+    return false;
+  }
+  return DecodeCaptureFrame(*header, payload_, data);
+}
@@ -0,0 +1,109 @@
+#ifndef CINDER_TANGO_CAPTURE_FORMAT_H_
+#define CINDER_TANGO_CAPTURE_FORMAT_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#include <tango_client_api.h>
+
+// On-disk layout of a camera capture, written by CaptureRecorder.
+//
+// A capture is a directory holding numbered chunk files and one index:
+//
+//  chunk_00000.ctv  "CTVC" + uint32 version, then records back to back.
+//                   A record is a CaptureRecordHeader followed by
+//                   payload_size bytes of image data.
+//  chunk_00001.ctv  Started once the previous chunk reaches its size limit.
+//  index.ctv        "CTVI" + uint32 version, then one CaptureIndexEntry per
+//                   record in recording order.
+//
+// All values are little endian. Chunks are self-describing, so a capture
+// whose index was lost can be rebuilt by walking the records.
+//
+// Image data keeps the service layout (the full stride, all planes) with the
+// metadata scanline replaced as in CameraFrame. With kCaptureCodecDeflate
+// every row is first delta coded against the sample step bytes to its left
+// (1 for luma and YV12 chroma, 2 for NV21 chroma, 4 for RGBA) and the
+// result is compressed with zlib.
+
+enum CaptureCodec { kCaptureCodecRaw = 0, kCaptureCodecDeflate = 1 };
+
+const uint32_t kCaptureFormatVersion = 1;
+const char kCaptureChunkMagic[4] = {'C', 'T', 'V', 'C'};
+const char kCaptureIndexMagic[4] = {'C', 'T', 'V', 'I'};
+const char kCaptureRecordMagic[4] = {'C', 'T', 'V', 'F'};
+
+struct CaptureRecordHeader {
+  char magic[4];  // "CTVF"
+  uint32_t header_size;
+  uint32_t width;
+  uint32_t height;
+  uint32_t stride;
+  uint32_t format;  // TangoImageFormatType.
+  uint32_t codec;   // CaptureCodec.
+  // TangoPoseStatusType of the device pose, TANGO_POSE_UNKNOWN if no pose
+  // could be matched to the frame.
+  uint32_t pose_status;
+  int64_t frame_number;
+  double timestamp;
+  // start_of_service_T_device at (or nearest to) timestamp.
+  double pose_timestamp;
+  double translation[3];
+  double orientation[4];  // x, y, z, w as in TangoPoseData.
+  uint64_t payload_size;
+  uint64_t raw_size;
+};
+
+struct CaptureIndexEntry {
+  uint32_t chunk;
+  uint32_t reserved;
+  uint64_t offset;  // Of the record header within the chunk.
+  double timestamp;
+  int64_t frame_number;
+};
+
+std::string CaptureChunkPath(const std::string& directory, uint32_t chunk);
+std::string CaptureIndexPath(const std::string& directory);
+
+// Encodes size bytes of image data for a record. scratch holds the delta
+// coded rows between calls so steady-state encoding does not allocate.
+bool EncodeCaptureFrame(CaptureCodec codec, int level,
+                        TangoImageFormatType format, uint32_t height,
+                        uint32_t stride, const uint8_t* data, size_t size,
+                        std::vector<uint8_t>* scratch,
+                        std::vector<uint8_t>* payload);
+
+// Restores the image data of a record from its payload.
+bool DecodeCaptureFrame(const CaptureRecordHeader& header,
+                        const std::vector<uint8_t>& payload,
+                        std::vector<uint8_t>* data);
+
+// Random access to the frames of a capture through its index.
+class CaptureReader {
+ public:
+  CaptureReader();
+  CaptureReader(const CaptureReader& other) = delete;
+  CaptureReader& operator=(const CaptureReader&) = delete;
+  ~CaptureReader();
+
+  bool Open(const std::string& directory);
+  void Close();
+
+  size_t GetFrameCount() const { return index_.size(); }
+  const CaptureIndexEntry& GetEntry(size_t i) const { return index_[i]; }
+
+  // Reads and decodes frame i. data receives the image in service layout.
+  bool ReadFrame(size_t i, CaptureRecordHeader* header,
+                 std::vector<uint8_t>* data);
+
+ private:
+  std::string directory_;
+  std::vector<CaptureIndexEntry> index_;
+  FILE* chunk_file_;
+  uint32_t chunk_;
+  std::vector<uint8_t> payload_;
+};
+
+#endif  // CINDER_TANGO_CAPTURE_FORMAT_H_
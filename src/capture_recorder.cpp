@@ -0,0 +1,334 @@
+#include "capture_recorder.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "cinder/Log.h"
+
+namespace {
+bool QueryServicePose(double timestamp, TangoPoseData* pose) {
+  TangoCoordinateFramePair pair;
+  pair.base = TANGO_COORDINATE_FRAME_START_OF_SERVICE;
+  pair.target = TANGO_COORDINATE_FRAME_DEVICE;
+  return TangoService_getPoseAtTime(timestamp, pair, pose) == TANGO_SUCCESS;
+}
+}  // namespace
+
+CaptureRecorder::Options::Options()
+    : codec(kCaptureCodecDeflate),
+      compression_level(1),
+      queue_size(4),
+      max_in_flight(4),
+      chunk_size(256u << 20) {}
+
+CaptureRecorder::CaptureRecorder(WorkerPool* pool, const Options& options)
+    : pool_(pool),
+      options_(options),
+      queue_(options.queue_size),
+      thread_running_(false),
+      recording_(false),
+      stopping_(false),
+      producers_(0),
+      chunk_file_(nullptr),
+      index_file_(nullptr),
+      chunk_(0),
+      chunk_bytes_(0),
+      write_ok_(true),
+      received_(0),
+      recorded_(0),
+      dropped_(0),
+      failed_(0),
+      bytes_written_(0) {
+  sem_init(&queued_, 0, 0);
+  pthread_mutex_init(&jobs_mutex_, nullptr);
+  pthread_cond_init(&jobs_cond_, nullptr);
+}
+
+CaptureRecorder::~CaptureRecorder() {
+  Stop();
+  pthread_cond_destroy(&jobs_cond_);
+  pthread_mutex_destroy(&jobs_mutex_);
+  sem_destroy(&queued_);
+}
+
+bool CaptureRecorder::Start(const std::string& directory,
+                            const PoseProvider& pose_provider) {
+  if (thread_running_) {
+    return false;
+  }
+  if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) {
+    CI_LOG_E("CaptureRecorder: cannot create " << directory << ": "
+                                               << strerror(errno));
+    return false;
+  }
+  index_file_ = fopen(CaptureIndexPath(directory).c_str(), "wb");
+  if (index_file_ == nullptr) {
+    CI_LOG_E("CaptureRecorder: cannot create index: " << strerror(errno));
+    return false;
+  }
+  fwrite(kCaptureIndexMagic, 1, 4, index_file_);
+  fwrite(&kCaptureFormatVersion, sizeof(kCaptureFormatVersion), 1,
+         index_file_);
+
+  directory_ = directory;
+  pose_provider_ = pose_provider ? pose_provider : QueryServicePose;
+  chunk_ = 0;
+  chunk_bytes_ = 0;
+  write_ok_ = true;
+  received_ = 0;
+  recorded_ = 0;
+  dropped_ = 0;
+  failed_ = 0;
+  bytes_written_ = 0;
+  stopping_ = false;
+
+  if (pthread_create(&thread_, nullptr, ThreadMain, this) != 0) {
+    CI_LOG_E("CaptureRecorder: cannot start writer thread");
+    CloseFiles();
+    return false;
+  }
+  thread_running_ = true;
+  recording_ = true;
+  return true;
+}
+
+void CaptureRecorder::Stop() {
+  if (!thread_running_) {
+    return;
+  }
+  recording_ = false;
+  // A callback that saw recording_ set may still be pushing. Once it is out,
+  // nothing else reaches the queue and the writer can drain it for good.
+  while (producers_.load() != 0) {
+    sched_yield();
+  }
+  stopping_ = true;
+  sem_post(&queued_);
+  pthread_join(thread_, nullptr);
+  thread_running_ = false;
+  CloseFiles();
+}
+
+void CaptureRecorder::OnFrame(const CameraFrameRef& frame) {
+  ++producers_;
+  if (recording_.load()) {
+    ++received_;
+    if (queue_.TryPush(frame)) {
+      sem_post(&queued_);
+    } else {
+      ++dropped_;
+    }
+  }
+  --producers_;
+}
+
+CaptureRecorder::Stats CaptureRecorder::GetStats() const {
+  Stats stats;
+  stats.received = received_.load();
+  stats.recorded = recorded_.load();
+  stats.dropped = dropped_.load();
+  stats.failed = failed_.load();
+  stats.bytes_written = bytes_written_.load();
+  return stats;
+}
+
+void* CaptureRecorder::ThreadMain(void* arg) {
+  static_cast<CaptureRecorder*>(arg)->Run();
+  return nullptr;
+}
+
+void CaptureRecorder::Run() {
+  std::deque<Job*> pending;
+  std::vector<Job*> free_jobs;
+  while (true) {
+    sem_wait(&queued_);
+    CameraFrameRef frame;
+    if (!queue_.TryPop(&frame)) {
+      // Every post but the final one from Stop() comes with a frame.
+      if (stopping_.load()) {
+        break;
+      }
+      continue;
+    }
+
+    Job* job;
+    if (free_jobs.empty()) {
+      job = new Job();
+    } else {
+      job = free_jobs.back();
+      free_jobs.pop_back();
+    }
+    job->frame = std::move(frame);
+    FillHeader(job);
+    job->ok = true;
+    job->done = options_.codec == kCaptureCodecRaw;
+    pending.push_back(job);
+    if (!job->done && !pool_->Enqueue([this, job]() { Compress(job); })) {
+      // Nothing will finish the job, so the writer must not wait for it.
+      // No task holds it yet, so no lock is needed.
+      job->ok = false;
+      job->done = true;
+    }
+    WriteFinished(options_.max_in_flight, &pending, &free_jobs);
+  }
+  WriteFinished(0, &pending, &free_jobs);
+
+  for (size_t i = 0; i < free_jobs.size(); ++i) {
+    delete free_jobs[i];
+  }
+}
+
+void CaptureRecorder::FillHeader(Job* job) {
+  const CameraFrame& frame = *job->frame;
+  CaptureRecordHeader& header = job->header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kCaptureRecordMagic, 4);
+  header.header_size = sizeof(header);
+  header.width = frame.width;
+  header.height = frame.height;
+  header.stride = frame.stride;
+  header.format = frame.format;
+  header.codec = options_.codec;
+  header.frame_number = frame.frame_number;
+  header.timestamp = frame.timestamp;
+  header.raw_size = frame.GetByteSize();
+
+  // The writer runs a few frames behind the camera, so the pose at the frame
+  // timestamp has usually arrived by now.
+  TangoPoseData pose;
+  memset(&pose, 0, sizeof(pose));
+  if (pose_provider_(frame.timestamp, &pose)) {
+    header.pose_status = pose.status_code;
+    header.pose_timestamp = pose.timestamp;
+    for (int i = 0; i < 3; ++i) {
+      header.translation[i] = pose.translation[i];
+    }
+    for (int i = 0; i < 4; ++i) {
+      header.orientation[i] = pose.orientation[i];
+    }
+  } else {
+    header.pose_status = TANGO_POSE_UNKNOWN;
+  }
+}
+
+void CaptureRecorder::Compress(Job* job) {
+  const CameraFrame& frame = *job->frame;
+  const bool ok = EncodeCaptureFrame(
+      options_.codec, options_.compression_level, frame.format, frame.height,
+      frame.stride, frame.GetData(), frame.GetByteSize(), &job->scratch,
+      &job->payload);
+  // The encoded copy is all the writer needs; give the buffer back to the
+  // camera right away.
+  job->frame.Reset();
+  pthread_mutex_lock(&jobs_mutex_);
+  job->ok = ok;
+  job->done = true;
+  pthread_cond_broadcast(&jobs_cond_);
+  pthread_mutex_unlock(&jobs_mutex_);
+}
+
+void CaptureRecorder::WriteFinished(size_t max_pending,
+                                    std::deque<Job*>* pending,
+                                    std::vector<Job*>* free_jobs) {
+  while (!pending->empty()) {
+    Job* job = pending->front();
+    pthread_mutex_lock(&jobs_mutex_);
+    while (!job->done && pending->size() > max_pending) {
+      pthread_cond_wait(&jobs_cond_, &jobs_mutex_);
+    }
+    const bool done = job->done;
+    pthread_mutex_unlock(&jobs_mutex_);
+    if (!done) {
+      return;
+    }
+    pending->pop_front();
+    WriteJob(job);
+    free_jobs->push_back(job);
+  }
+}
+
+void CaptureRecorder::WriteJob(Job* job) {
+  const bool raw = options_.codec == kCaptureCodecRaw;
+  const uint8_t* payload =
+      raw ? job->frame->GetData()
+          : (job->payload.empty() ? nullptr : &job->payload[0]);
+  const size_t payload_size = raw ? job->header.raw_size : job->payload.size();
+  if (!job->ok || !write_ok_) {
+    ++failed_;
+    job->frame.Reset();
+    return;
+  }
+
+  CaptureRecordHeader& header = job->header;
+  header.payload_size = payload_size;
+  const uint64_t record_size = sizeof(header) + payload_size;
+  if (chunk_file_ == nullptr ||
+      (chunk_bytes_ + record_size > options_.chunk_size &&
+       chunk_bytes_ > sizeof(kCaptureChunkMagic) + 4)) {
+    if (!OpenChunk(chunk_file_ == nullptr ? chunk_ : chunk_ + 1)) {
+      write_ok_ = false;
+      ++failed_;
+      job->frame.Reset();
+      return;
+    }
+  }
+
+  CaptureIndexEntry entry;
+  entry.chunk = chunk_;
+  entry.reserved = 0;
+  entry.offset = chunk_bytes_;
+  entry.timestamp = header.timestamp;
+  entry.frame_number = header.frame_number;
+
+  bool ok = fwrite(&header, sizeof(header), 1, chunk_file_) == 1 &&
+            fwrite(payload, 1, payload_size, chunk_file_) == payload_size &&
+            fwrite(&entry, sizeof(entry), 1, index_file_) == 1;
+  job->frame.Reset();
+  if (!ok) {
+    CI_LOG_E("CaptureRecorder: write failed: " << strerror(errno));
+    write_ok_ = false;
+    ++failed_;
+    return;
+  }
+  chunk_bytes_ += record_size;
+  bytes_written_ += record_size + sizeof(entry);
+  ++recorded_;
+}
+
+bool CaptureRecorder::OpenChunk(uint32_t chunk) {
+  if (chunk_file_ != nullptr) {
+    fclose(chunk_file_);
+  }
+  chunk_ = chunk;
+  chunk_bytes_ = 0;
+  const std::string path = CaptureChunkPath(directory_, chunk);
+  chunk_file_ = fopen(path.c_str(), "wb");
+  if (chunk_file_ == nullptr) {
+    CI_LOG_E("CaptureRecorder: cannot create " << path << ": "
+                                               << strerror(errno));
+    return false;
+  }
+  // Records are large; a bigger stdio buffer turns each into a few writes.
+  setvbuf(chunk_file_, nullptr, _IOFBF, 1 << 20);
+  if (fwrite(kCaptureChunkMagic, 1, 4, chunk_file_) != 4 ||
+      fwrite(&kCaptureFormatVersion, sizeof(kCaptureFormatVersion), 1,
+             chunk_file_) != 1) {
+    return false;
+  }
+  chunk_bytes_ = sizeof(kCaptureChunkMagic) + sizeof(kCaptureFormatVersion);
+  bytes_written_ += chunk_bytes_;
+  return true;
+}
+
+void CaptureRecorder::CloseFiles() {
+  if (chunk_file_ != nullptr) {
+    fclose(chunk_file_);
+    chunk_file_ = nullptr;
+  }
+  if (index_file_ != nullptr) {
+    fclose(index_file_);
+    index_file_ = nullptr;
+  }
+}
@@ -0,0 +1,151 @@
+#ifndef CINDER_TANGO_CAPTURE_RECORDER_H_
+#define CINDER_TANGO_CAPTURE_RECORDER_H_
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <tango_client_api.h>
+
+#include "camera_frame.h"
+#include "capture_format.h"
+#include "spsc_ring.h"
+#include "worker_pool.h"
+
+// Records color camera frames with the matching device pose to a chunked
+// capture directory (see capture_format.h).
+//
+// The camera callback only pushes a frame reference into a bounded ring and
+// posts a semaphore; it never locks, allocates or waits. A writer thread
+// takes frames off the ring, stamps them with a pose, compresses them on the
+// WorkerPool and appends the finished records in frame order. When the ring
+// is full the newest frame is dropped and counted, so under backpressure the
+// capture loses whole frames at a predictable point instead of stalling the
+// camera.
+//
+// Every queued or compressing frame pins one CameraFramePool buffer, up to
+// queue_size + max_in_flight of them. Size the pool with two buffers more
+// than that, or the pool starts dropping frames for every consumer.
+//
+//  CaptureRecorder recorder(&pool, CaptureRecorder::Options());
+//  tango.camera_frames.AddListener([&](const CameraFrameRef& frame) {
+//    recorder.OnFrame(frame);
+//  });
+//  recorder.Start(directory);
+//  ...
+//  recorder.Stop();
+class CaptureRecorder {
+ public:
+  struct Options {
+    Options();
+    CaptureCodec codec;
+    // zlib level for kCaptureCodecDeflate, 1 (fastest) to 9.
+    int compression_level;
+    // Frames waiting for the writer thread.
+    size_t queue_size;
+    // Frames being compressed or waiting to be written in order.
+    size_t max_in_flight;
+    // A new chunk file is started once a chunk would grow past this size.
+    uint64_t chunk_size;
+  };
+
+  // Fills pose with start_of_service_T_device at timestamp. Returns false if
+  // there is none.
+  typedef std::function<bool(double timestamp, TangoPoseData* pose)>
+      PoseProvider;
+
+  struct Stats {
+    uint64_t received;
+    uint64_t recorded;
+    // Frames rejected because the queue was full.
+    uint64_t dropped;
+    // Frames lost to encoding or write errors.
+    uint64_t failed;
+    uint64_t bytes_written;
+  };
+
+  CaptureRecorder(WorkerPool* pool, const Options& options);
+  CaptureRecorder(const CaptureRecorder& other) = delete;
+  CaptureRecorder& operator=(const CaptureRecorder&) = delete;
+  // Stops a running capture. The pool must outlive the recorder.
+  ~CaptureRecorder();
+
+  // Creates directory if needed and starts recording into it. Without a
+  // pose_provider the pose is queried with TangoService_getPoseAtTime.
+  // Returns false if a capture is already running or the index cannot be
+  // created.
+  bool Start(const std::string& directory,
+             const PoseProvider& pose_provider = PoseProvider());
+
+  // Stops accepting frames, writes everything already queued and closes the
+  // files.
+  void Stop();
+
+  bool IsRecording() const { return recording_.load(); }
+
+  // Camera callback thread, typically from a CameraFramePool listener.
+  void OnFrame(const CameraFrameRef& frame);
+
+  Stats GetStats() const;
+
+ private:
+  struct Job {
+    CameraFrameRef frame;
+    CaptureRecordHeader header;
+    std::vector<uint8_t> scratch;
+    std::vector<uint8_t> payload;
+    bool ok;
+    // Guarded by jobs_mutex_.
+    bool done;
+  };
+
+  static void* ThreadMain(void* arg);
+  void Run();
+  void FillHeader(Job* job);
+  void Compress(Job* job);
+  // Writes finished jobs from the front of pending, waiting for the front
+  // one while more than max_pending are outstanding.
+  void WriteFinished(size_t max_pending, std::deque<Job*>* pending,
+                     std::vector<Job*>* free_jobs);
+  void WriteJob(Job* job);
+  bool OpenChunk(uint32_t chunk);
+  void CloseFiles();
+
+  WorkerPool* pool_;
+  const Options options_;
+  PoseProvider pose_provider_;
+  std::string directory_;
+
+  SpscRing<CameraFrameRef> queue_;
+  sem_t queued_;
+  pthread_t thread_;
+  bool thread_running_;
+  std::atomic<bool> recording_;
+  std::atomic<bool> stopping_;
+  // Camera callbacks currently inside OnFrame.
+  std::atomic<int> producers_;
+
+  pthread_mutex_t jobs_mutex_;
+  pthread_cond_t jobs_cond_;
+
+  // Writer thread state.
+  FILE* chunk_file_;
+  FILE* index_file_;
+  uint32_t chunk_;
+  uint64_t chunk_bytes_;
+  bool write_ok_;
+
+  std::atomic<uint64_t> received_;
+  std::atomic<uint64_t> recorded_;
+  std::atomic<uint64_t> dropped_;
+  std::atomic<uint64_t> failed_;
+  std::atomic<uint64_t> bytes_written_;
+};
+
+#endif  // CINDER_TANGO_CAPTURE_RECORDER_H_
@@ -0,0 +1,288 @@
+#include "exposure_estimator.h"
+
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <vector>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define EXPOSURE_ESTIMATOR_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define EXPOSURE_ESTIMATOR_SSE2 1
+#endif
+
+namespace {
+double NowMs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000.0 + now.tv_nsec / 1.0e6;
+}
+
+// Copies every step-th byte of row into samples and returns how many.
+int GatherSamples(const uint8_t* row, int width, int step, uint8_t* samples) {
+  int x = 0;
+  int count = 0;
+#if defined(EXPOSURE_ESTIMATOR_NEON)
+  if (step == 2) {
+    for (; x + 32 <= width; x += 32, count += 16) {
+      vst1q_u8(samples + count, vld2q_u8(row + x).val[0]);
+    }
+  } else if (step == 4) {
+    for (; x + 64 <= width; x += 64, count += 16) {
+      vst1q_u8(samples + count, vld4q_u8(row + x).val[0]);
+    }
+  }
+#elif defined(EXPOSURE_ESTIMATOR_SSE2)
+  if (step == 2) {
+    const __m128i mask = _mm_set1_epi16(0x00ff);
+    for (; x + 32 <= width; x += 32, count += 16) {
+      const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x));
+      const __m128i b =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + 16));
+      _mm_storeu_si128(
+          reinterpret_cast<__m128i*>(samples + count),
+          _mm_packus_epi16(_mm_and_si128(a, mask), _mm_and_si128(b, mask)));
+    }
+  } else if (step == 4) {
+    const __m128i mask = _mm_set1_epi32(0x000000ff);
+    for (; x + 64 <= width; x += 64, count += 16) {
+      __m128i v[4];
+      for (int i = 0; i < 4; ++i) {
+        v[i] = _mm_and_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + 16 * i)),
+            mask);
+      }
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(samples + count),
+                       _mm_packus_epi16(_mm_packs_epi32(v[0], v[1]),
+                                        _mm_packs_epi32(v[2], v[3])));
+    }
+  }
+#endif
+  for (; x < width; x += step) {
+    samples[count++] = row[x];
+  }
+  return count;
+}
+
+// Sums size bytes that are step bytes apart (1 or 2), starting at data.
+uint64_t SumBytes(const uint8_t* data, int size, int step) {
+  uint64_t sum = 0;
+  int i = 0;
+#if defined(EXPOSURE_ESTIMATOR_NEON)
+  // 16-bit lanes take at most 255 * 2 per iteration; flush well before they
+  // could overflow.
+  while (i + 16 * step <= size * step) {
+    uint16x8_t lanes = vdupq_n_u16(0);
+    for (int n = 0; n < 64 && i + 16 * step <= size * step; ++n) {
+      const uint8x16_t values =
+          step == 2 ? vld2q_u8(data + i).val[0] : vld1q_u8(data + i);
+      lanes = vpadalq_u8(lanes, values);
+      i += 16 * step;
+    }
+    const uint64x2_t wide = vpaddlq_u32(vpaddlq_u16(lanes));
+    sum += vgetq_lane_u64(wide, 0) + vgetq_lane_u64(wide, 1);
+  }
+#elif defined(EXPOSURE_ESTIMATOR_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i mask = _mm_set1_epi16(0x00ff);
+  __m128i total = zero;
+  for (; i + 16 <= size * step; i += 16) {
+    __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    if (step == 2) {
+      values = _mm_and_si128(values, mask);
+    }
+    total = _mm_add_epi64(total, _mm_sad_epu8(values, zero));
+  }
+  uint64_t halves[2];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(halves), total);
+  sum = halves[0] + halves[1];
+#endif
+  for (; i < size * step; i += step) {
+    sum += data[i];
+  }
+  return sum;
+}
+
+float Lerp(float from, float to, float weight) {
+  return from + (to - from) * weight;
+}
+}  // namespace
+
+void ComputeLumaHistogram(const ImagePlanes& planes, int step,
+                          LumaHistogram* histogram) {
+  if (step != 1 && step != 2 && step != 4 && step != 8) {
+    step = 4;
+  }
+  memset(histogram, 0, sizeof(*histogram));
+
+  // Four sub-histograms so back-to-back samples with the same value do not
+  // wait on each other's increments.
+  uint32_t bins[4][256];
+  memset(bins, 0, sizeof(bins));
+  std::vector<uint8_t> gathered(planes.width / step + 1);
+  for (int y = 0; y < planes.height; y += step) {
+    const uint8_t* row = planes.y + static_cast<size_t>(y) * planes.y_stride;
+    const uint8_t* samples = row;
+    int count = planes.width;
+    if (step > 1) {
+      count = GatherSamples(row, planes.width, step, &gathered[0]);
+      samples = &gathered[0];
+    }
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+      ++bins[0][samples[i]];
+      ++bins[1][samples[i + 1]];
+      ++bins[2][samples[i + 2]];
+      ++bins[3][samples[i + 3]];
+    }
+    for (; i < count; ++i) {
+      ++bins[0][samples[i]];
+    }
+    histogram->sample_count += count;
+  }
+  for (int v = 0; v < 256; ++v) {
+    histogram->bins[v] = bins[0][v] + bins[1][v] + bins[2][v] + bins[3][v];
+  }
+
+  // Chroma is subsampled by rows only; whole rows are cheap to sum.
+  const int chroma_width = planes.width / 2;
+  const int chroma_rows = planes.height / 2;
+  const int row_step = std::max(1, step / 2);
+  uint64_t sum_u = 0;
+  uint64_t sum_v = 0;
+  uint64_t chroma_count = 0;
+  for (int y = 0; y < chroma_rows; y += row_step) {
+    const size_t offset = static_cast<size_t>(y) * planes.chroma_stride;
+    sum_u += SumBytes(planes.u + offset, chroma_width, planes.chroma_step);
+    sum_v += SumBytes(planes.v + offset, chroma_width, planes.chroma_step);
+    chroma_count += chroma_width;
+  }
+  histogram->mean_u = chroma_count > 0
+                          ? static_cast<float>(sum_u) / chroma_count
+                          : 128.0f;
+  histogram->mean_v = chroma_count > 0
+                          ? static_cast<float>(sum_v) / chroma_count
+                          : 128.0f;
+}
+
+ExposureEstimator::Options::Options()
+    : sample_step(4),
+      target_luma(118.0f),
+      min_gain(0.25f),
+      max_gain(1.5f),
+      white_balance_strength(1.0f),
+      smoothing(0.15f) {}
+
+ExposureEstimator::ExposureEstimator(const Options& options)
+    : options_(options), has_estimate_(false), last_update_ms_(0.0) {
+  pthread_mutex_init(&mutex_, nullptr);
+}
+
+ExposureEstimator::~ExposureEstimator() { pthread_mutex_destroy(&mutex_); }
+
+void ExposureEstimator::OnFrame(const CameraFrameRef& frame) {
+  ImagePlanes planes;
+  if (frame && frame->GetPlanes(&planes)) {
+    Update(planes, frame->timestamp);
+  }
+}
+
+void ExposureEstimator::Update(const ImagePlanes& planes, double timestamp) {
+  const double start = NowMs();
+  ComputeLumaHistogram(planes, options_.sample_step, &histogram_);
+  const uint32_t count = histogram_.sample_count;
+  if (count == 0) {
+    return;
+  }
+
+  ToneEstimate frame;
+  frame.timestamp = timestamp;
+  uint64_t sum = 0;
+  uint32_t below = 0;
+  uint32_t cumulative = 0;
+  int median = -1;
+  for (int v = 0; v < 256; ++v) {
+    const uint32_t bin = histogram_.bins[v];
+    sum += static_cast<uint64_t>(bin) * v;
+    cumulative += bin;
+    if (median < 0 && cumulative * 2 >= count) {
+      median = v;
+    }
+    if (v <= 16) {
+      below += bin;
+    }
+  }
+  uint32_t above = 0;
+  for (int v = 235; v < 256; ++v) {
+    above += histogram_.bins[v];
+  }
+  frame.mean_luma = static_cast<float>(sum) / count;
+  frame.median_luma = static_cast<float>(median);
+  frame.underexposed = static_cast<float>(below) / count;
+  frame.overexposed = static_cast<float>(above) / count;
+  const float relative =
+      std::max(frame.mean_luma, 1.0f) / options_.target_luma;
+  frame.exposure_offset = log2f(relative);
+  frame.gain = std::min(std::max(relative, options_.min_gain),
+                        options_.max_gain);
+
+  // Gray world: the mean color of the scene is taken to be neutral, so any
+  // cast in it comes from the camera's white balance.
+  const float c = frame.mean_luma - 16.0f;
+  const float d = histogram_.mean_u - 128.0f;
+  const float e = histogram_.mean_v - 128.0f;
+  const glm::vec3 mean_rgb(1.164f * c + 1.596f * e,
+                           1.164f * c - 0.392f * d - 0.813f * e,
+                           1.164f * c + 2.017f * d);
+  const float luminance =
+      0.299f * mean_rgb.x + 0.587f * mean_rgb.y + 0.114f * mean_rgb.z;
+  if (luminance > 1.0f) {
+    for (int i = 0; i < 3; ++i) {
+      const float cast = std::min(std::max(mean_rgb[i] / luminance, 0.5f),
+                                  1.5f);
+      frame.white_balance[i] =
+          Lerp(1.0f, cast, options_.white_balance_strength);
+    }
+  }
+
+  pthread_mutex_lock(&mutex_);
+  if (!has_estimate_) {
+    estimate_ = frame;
+    has_estimate_ = true;
+  } else {
+    const float w = options_.smoothing;
+    estimate_.timestamp = frame.timestamp;
+    estimate_.mean_luma = Lerp(estimate_.mean_luma, frame.mean_luma, w);
+    estimate_.median_luma = Lerp(estimate_.median_luma, frame.median_luma, w);
+    estimate_.underexposed =
+        Lerp(estimate_.underexposed, frame.underexposed, w);
+    estimate_.overexposed = Lerp(estimate_.overexposed, frame.overexposed, w);
+    estimate_.exposure_offset =
+        Lerp(estimate_.exposure_offset, frame.exposure_offset, w);
+    estimate_.gain = Lerp(estimate_.gain, frame.gain, w);
+    for (int i = 0; i < 3; ++i) {
+      estimate_.white_balance[i] =
+          Lerp(estimate_.white_balance[i], frame.white_balance[i], w);
+    }
+  }
+  estimate_.tint = estimate_.white_balance * estimate_.gain;
+  last_update_ms_ = NowMs() - start;
+  pthread_mutex_unlock(&mutex_);
+}
+
+ToneEstimate ExposureEstimator::GetEstimate() const {
+  pthread_mutex_lock(&mutex_);
+  ToneEstimate estimate = estimate_;
+  pthread_mutex_unlock(&mutex_);
+  return estimate;
+}
+
+double ExposureEstimator::GetLastUpdateMs() const {
+  pthread_mutex_lock(&mutex_);
+  double ms = last_update_ms_;
+  pthread_mutex_unlock(&mutex_);
+  return ms;
+}
@@ -0,0 +1,104 @@
+#ifndef CINDER_TANGO_EXPOSURE_ESTIMATOR_H_
+#define CINDER_TANGO_EXPOSURE_ESTIMATOR_H_
+
+#define GLM_FORCE_RADIANS
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "glm/glm.hpp"
+
+#include "camera_frame.h"
+
+// Luma histogram and mean chroma of a subsampled camera image.
+struct LumaHistogram {
+  uint32_t bins[256];
+  uint32_t sample_count;
+  // Mean U and V over the sampled chroma rows.
+  float mean_u;
+  float mean_v;
+};
+
+// Samples every step-th pixel of every step-th row. step is 1, 2, 4 or 8.
+// Luma samples are gathered 16 bytes at a time with NEON or SSE2 and chroma
+// sums use SIMD horizontal adds; the histogram itself is built from four
+// interleaved sub-histograms so consecutive samples do not serialize on the
+// same counter.
+void ComputeLumaHistogram(const ImagePlanes& planes, int step,
+                          LumaHistogram* histogram);
+
+// What the camera image looks like, for rendering virtual content to match.
+struct ToneEstimate {
+  ToneEstimate()
+      : timestamp(0.0),
+        mean_luma(0.0f),
+        median_luma(0.0f),
+        underexposed(0.0f),
+        overexposed(0.0f),
+        exposure_offset(0.0f),
+        gain(1.0f),
+        white_balance(1.0f, 1.0f, 1.0f),
+        tint(1.0f, 1.0f, 1.0f) {}
+
+  double timestamp;
+  float mean_luma;
+  float median_luma;
+  // Fraction of samples at or below 16 and at or above 235.
+  float underexposed;
+  float overexposed;
+  // log2 of the mean luma over the target, in stops.
+  float exposure_offset;
+  // Brightness factor for virtual content.
+  float gain;
+  // Per-channel cast of the image under a gray world assumption,
+  // normalized to unit luminance.
+  glm::vec3 white_balance;
+  // gain * white_balance: multiply virtual content colors by this.
+  glm::vec3 tint;
+};
+
+// Turns per-frame histograms into a smoothed ToneEstimate. Update() runs on
+// the camera callback thread in a few tens of microseconds; GetEstimate()
+// can be called from the render thread at any time.
+//
+// It needs CPU camera frames (CinderTango::ConnectCameraFrames), which the
+// app does not connect while it uses the texture path, so the app does not
+// use it yet.
+class ExposureEstimator {
+ public:
+  struct Options {
+    Options();
+    int sample_step;
+    // Luma that renders virtual content unchanged.
+    float target_luma;
+    float min_gain;
+    float max_gain;
+    // 0 ignores the color cast, 1 applies it fully.
+    float white_balance_strength;
+    // Weight of each new frame in the running estimate, in (0, 1].
+    float smoothing;
+  };
+
+  explicit ExposureEstimator(const Options& options);
+  ExposureEstimator(const ExposureEstimator& other) = delete;
+  ExposureEstimator& operator=(const ExposureEstimator&) = delete;
+  ~ExposureEstimator();
+
+  void Update(const ImagePlanes& planes, double timestamp);
+  // For use as a CameraFramePool listener.
+  void OnFrame(const CameraFrameRef& frame);
+
+  ToneEstimate GetEstimate() const;
+  // Cost of the last Update call.
+  double GetLastUpdateMs() const;
+
+ private:
+  const Options options_;
+  mutable pthread_mutex_t mutex_;
+  ToneEstimate estimate_;
+  bool has_estimate_;
+  double last_update_ms_;
+  LumaHistogram histogram_;
+};
+
+#endif  // CINDER_TANGO_EXPOSURE_ESTIMATOR_H_
@@ -0,0 +1,396 @@
+#include "fast_detector.h"
+
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <functional>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FAST_DETECTOR_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define FAST_DETECTOR_SSE2 1
+#endif
+
+namespace {
+const int kBorder = 3;
+
+// Bresenham circle of radius 3, clockwise from the top. Entries 0, 4, 8 and
+// 12 are the cardinal pixels used by the pre-test.
+const int kCircle[16][2] = {{0, -3}, {1, -3},  {2, -2},  {3, -1},
+                            {3, 0},  {3, 1},   {2, 2},   {1, 3},
+                            {0, 3},  {-1, 3},  {-2, 2},  {-3, 1},
+                            {-3, 0}, {-3, -1}, {-2, -2}, {-1, -3}};
+
+double NowMs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000.0 + now.tv_nsec / 1.0e6;
+}
+
+// True if the 16-bit circular mask has 9 consecutive bits set.
+bool HasArc9(uint32_t mask) {
+  const uint32_t m = mask | (mask << 16);
+  const uint32_t runs2 = m & (m >> 1);
+  const uint32_t runs4 = runs2 & (runs2 >> 2);
+  const uint32_t runs8 = runs4 & (runs4 >> 4);
+  return (runs8 & (m >> 8) & 0xffff) != 0;
+}
+
+// Every 9-pixel arc contains two neighboring cardinal pixels, so a corner
+// needs such a pair that is brighter (or darker) than the center.
+bool PassesCardinalTest(const uint8_t* center, const int offsets[16],
+                        int threshold) {
+  const int high = center[0] + threshold;
+  const int low = center[0] - threshold;
+  bool bright[4];
+  bool dark[4];
+  for (int i = 0; i < 4; ++i) {
+    const int value = center[offsets[4 * i]];
+    bright[i] = value > high;
+    dark[i] = value < low;
+  }
+  for (int i = 0; i < 4; ++i) {
+    const int j = (i + 1) & 3;
+    if ((bright[i] && bright[j]) || (dark[i] && dark[j])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Largest value v such that some 9-arc of the circular values is entirely
+// above v - 1, i.e. the maximum over arcs of the arc minimum. values holds
+// the 16 entries followed by the first 9 again. Minimums of 2, 4 and 8
+// neighbors are built up by doubling instead of scanning every arc.
+int MaxArcMinimum(const int values[25]) {
+  int min2[24];
+  for (int k = 0; k < 24; ++k) {
+    min2[k] = std::min(values[k], values[k + 1]);
+  }
+  int min4[22];
+  for (int k = 0; k < 22; ++k) {
+    min4[k] = std::min(min2[k], min2[k + 2]);
+  }
+  int best = INT_MIN;
+  for (int k = 0; k < 16; ++k) {
+    const int min8 = std::min(min4[k], min4[k + 4]);
+    best = std::max(best, std::min(min8, values[k + 8]));
+  }
+  return best;
+}
+
+// Full segment test. Returns the largest threshold at which the pixel is a
+// corner, or 0 if it is not one at threshold.
+int CornerScore(const uint8_t* center, const int offsets[16], int threshold) {
+  int diff[25];
+  uint32_t bright = 0;
+  uint32_t dark = 0;
+  for (int k = 0; k < 16; ++k) {
+    diff[k] = center[0] - center[offsets[k]];
+    if (diff[k] < -threshold) {
+      bright |= 1u << k;
+    } else if (diff[k] > threshold) {
+      dark |= 1u << k;
+    }
+  }
+  // Two 9-arcs cannot both fit on 16 pixels, so at most one side passes.
+  const bool is_dark = HasArc9(dark);
+  if (!is_dark && !HasArc9(bright)) {
+    return 0;
+  }
+  // The point stays a corner as long as some arc has every difference
+  // beyond the threshold on the passing side.
+  if (!is_dark) {
+    for (int k = 0; k < 16; ++k) {
+      diff[k] = -diff[k];
+    }
+  }
+  for (int k = 0; k < 9; ++k) {
+    diff[16 + k] = diff[k];
+  }
+  return MaxArcMinimum(diff) - 1;
+}
+
+// Bit i set if pixel begin + i may be a corner, for 16 pixels.
+#if defined(FAST_DETECTOR_NEON)
+uint32_t CardinalMask16(const uint8_t* center, const int offsets[16],
+                        int threshold) {
+  const uint8x16_t t = vdupq_n_u8(static_cast<uint8_t>(threshold));
+  const uint8x16_t value = vld1q_u8(center);
+  const uint8x16_t high = vqaddq_u8(value, t);
+  const uint8x16_t low = vqsubq_u8(value, t);
+  uint8x16_t bright[4];
+  uint8x16_t dark[4];
+  for (int i = 0; i < 4; ++i) {
+    const uint8x16_t c = vld1q_u8(center + offsets[4 * i]);
+    bright[i] = vcgtq_u8(c, high);
+    dark[i] = vcltq_u8(c, low);
+  }
+  uint8x16_t candidates = vdupq_n_u8(0);
+  for (int i = 0; i < 4; ++i) {
+    const int j = (i + 1) & 3;
+    candidates = vorrq_u8(candidates, vandq_u8(bright[i], bright[j]));
+    candidates = vorrq_u8(candidates, vandq_u8(dark[i], dark[j]));
+  }
+  const uint64x2_t wide = vreinterpretq_u64_u8(candidates);
+  if ((vgetq_lane_u64(wide, 0) | vgetq_lane_u64(wide, 1)) == 0) {
+    return 0;
+  }
+  uint8_t lanes[16];
+  vst1q_u8(lanes, candidates);
+  uint32_t mask = 0;
+  for (int i = 0; i < 16; ++i) {
+    mask |= static_cast<uint32_t>(lanes[i] & 1) << i;
+  }
+  return mask;
+}
+#elif defined(FAST_DETECTOR_SSE2)
+uint32_t CardinalMask16(const uint8_t* center, const int offsets[16],
+                        int threshold) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i t = _mm_set1_epi8(static_cast<char>(threshold));
+  const __m128i value =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(center));
+  const __m128i high = _mm_adds_epu8(value, t);
+  const __m128i low = _mm_subs_epu8(value, t);
+  // Lanes are all ones where the cardinal pixel is *not* brighter (darker).
+  __m128i not_bright[4];
+  __m128i not_dark[4];
+  for (int i = 0; i < 4; ++i) {
+    const __m128i c = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(center + offsets[4 * i]));
+    not_bright[i] = _mm_cmpeq_epi8(_mm_subs_epu8(c, high), zero);
+    not_dark[i] = _mm_cmpeq_epi8(_mm_subs_epu8(low, c), zero);
+  }
+  __m128i rejected = _mm_cmpeq_epi8(zero, zero);
+  for (int i = 0; i < 4; ++i) {
+    const int j = (i + 1) & 3;
+    rejected = _mm_and_si128(rejected,
+                             _mm_or_si128(not_bright[i], not_bright[j]));
+    rejected =
+        _mm_and_si128(rejected, _mm_or_si128(not_dark[i], not_dark[j]));
+  }
+  return ~static_cast<uint32_t>(_mm_movemask_epi8(rejected)) & 0xffff;
+}
+#endif
+
+void RunTasks(WorkerPool* pool,
+              const std::vector<std::function<void()> >& tasks) {
+  if (pool != nullptr) {
+    pool->RunBatch(tasks);
+    return;
+  }
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    tasks[i]();
+  }
+}
+}  // namespace
+
+FastDetector::Options::Options()
+    : threshold(20),
+      nonmax_suppression(true),
+      cell_size(32),
+      max_per_cell(4),
+      band_rows(32) {}
+
+FastDetector::FastDetector(WorkerPool* pool, const Options& options)
+    : pool_(pool), options_(options) {
+  timing_.score_ms = 0.0;
+  timing_.suppress_ms = 0.0;
+  timing_.bucket_ms = 0.0;
+}
+
+void FastDetector::ScoreRows(const ImagePyramid::Level& level, int begin,
+                             int end, uint8_t* scores) const {
+  const int threshold = std::max(1, std::min(options_.threshold, 254));
+  int offsets[16];
+  for (int k = 0; k < 16; ++k) {
+    offsets[k] = kCircle[k][1] * level.stride + kCircle[k][0];
+  }
+  const int end_x = level.width - kBorder;
+
+  for (int y = begin; y < end; ++y) {
+    uint8_t* score_row = scores + static_cast<size_t>(y) * level.width;
+    memset(score_row, 0, level.width);
+    if (y < kBorder || y >= level.height - kBorder) {
+      continue;
+    }
+    const uint8_t* row = level.data + static_cast<size_t>(y) * level.stride;
+    int x = kBorder;
+#if defined(FAST_DETECTOR_NEON) || defined(FAST_DETECTOR_SSE2)
+    for (; x + 16 <= end_x; x += 16) {
+      uint32_t mask = CardinalMask16(row + x, offsets, threshold);
+      while (mask != 0) {
+        const int i = __builtin_ctz(mask);
+        mask &= mask - 1;
+        const int score = CornerScore(row + x + i, offsets, threshold);
+        score_row[x + i] = static_cast<uint8_t>(std::min(score, 255));
+      }
+    }
+#endif
+    for (; x < end_x; ++x) {
+      if (PassesCardinalTest(row + x, offsets, threshold)) {
+        const int score = CornerScore(row + x, offsets, threshold);
+        score_row[x] = static_cast<uint8_t>(std::min(score, 255));
+      }
+    }
+  }
+}
+
+void FastDetector::SuppressRows(const ImagePyramid::Level& level,
+                                int level_index, int begin, int end,
+                                const uint8_t* scores,
+                                std::vector<Keypoint>* keypoints) const {
+  const int width = level.width;
+  const int end_x = width - kBorder;
+  const float scale = static_cast<float>(level.scale);
+  begin = std::max(begin, kBorder);
+  end = std::min(end, level.height - kBorder);
+
+  for (int y = begin; y < end; ++y) {
+    const uint8_t* row = scores + static_cast<size_t>(y) * width;
+    const uint8_t* above = row - width;
+    const uint8_t* below = row + width;
+    for (int x = kBorder; x < end_x; ++x) {
+      // Most of the map is empty; skip it eight bytes at a time.
+      if (x + 8 <= end_x) {
+        uint64_t word;
+        memcpy(&word, row + x, sizeof(word));
+        if (word == 0) {
+          x += 7;
+          continue;
+        }
+      }
+      const int score = row[x];
+      if (score == 0) {
+        continue;
+      }
+      // Ties go to the first pixel in raster order.
+      if (options_.nonmax_suppression &&
+          (score < above[x - 1] || score < above[x] || score < above[x + 1] ||
+           score < row[x - 1] || score <= row[x + 1] ||
+           score <= below[x - 1] || score <= below[x] ||
+           score <= below[x + 1])) {
+        continue;
+      }
+      Keypoint keypoint;
+      keypoint.x = (x + 0.5f) * scale - 0.5f;
+      keypoint.y = (y + 0.5f) * scale - 0.5f;
+      keypoint.level = level_index;
+      keypoint.score = score;
+      keypoints->push_back(keypoint);
+    }
+  }
+}
+
+void FastDetector::Bucket(int width, int height,
+                          std::vector<Keypoint>* keypoints) {
+  const int cell_size =
+      options_.cell_size > 0 ? options_.cell_size : std::max(width, height);
+  const int columns = (width + cell_size - 1) / cell_size;
+  const int rows = (height + cell_size - 1) / cell_size;
+  const size_t cell_count = static_cast<size_t>(columns) * rows;
+
+  // Counting sort by cell, then order each cell by score.
+  cell_starts_.assign(cell_count + 1, 0);
+  cells_.resize(keypoints->size());
+  for (size_t i = 0; i < keypoints->size(); ++i) {
+    const Keypoint& keypoint = (*keypoints)[i];
+    const int column =
+        std::min(std::max(0, static_cast<int>(keypoint.x)) / cell_size,
+                 columns - 1);
+    const int row = std::min(
+        std::max(0, static_cast<int>(keypoint.y)) / cell_size, rows - 1);
+    cells_[i] = row * columns + column;
+    ++cell_starts_[cells_[i] + 1];
+  }
+  for (size_t c = 0; c < cell_count; ++c) {
+    cell_starts_[c + 1] += cell_starts_[c];
+  }
+  sorted_.resize(keypoints->size());
+  std::vector<int> next(cell_starts_.begin(), cell_starts_.end() - 1);
+  for (size_t i = 0; i < keypoints->size(); ++i) {
+    sorted_[next[cells_[i]]++] = (*keypoints)[i];
+  }
+
+  auto stronger = [](const Keypoint& a, const Keypoint& b) {
+    if (a.score != b.score) return a.score > b.score;
+    if (a.level != b.level) return a.level < b.level;
+    if (a.y != b.y) return a.y < b.y;
+    return a.x < b.x;
+  };
+  keypoints->clear();
+  for (size_t c = 0; c < cell_count; ++c) {
+    std::vector<Keypoint>::iterator begin =
+        sorted_.begin() + cell_starts_[c];
+    std::vector<Keypoint>::iterator end = sorted_.begin() + cell_starts_[c + 1];
+    if (options_.max_per_cell > 0 && end - begin > options_.max_per_cell) {
+      std::partial_sort(begin, begin + options_.max_per_cell, end, stronger);
+      end = begin + options_.max_per_cell;
+    } else {
+      std::sort(begin, end, stronger);
+    }
+    keypoints->insert(keypoints->end(), begin, end);
+  }
+}
+
+void FastDetector::Detect(const ImagePyramid& pyramid,
+                          std::vector<Keypoint>* keypoints) {
+  keypoints->clear();
+  const int level_count = pyramid.GetLevelCount();
+  if (level_count == 0) {
+    return;
+  }
+  const int band_rows = std::max(options_.band_rows, 1);
+  const double start = NowMs();
+
+  scores_.resize(level_count);
+  std::vector<std::function<void()> > tasks;
+  for (int l = 0; l < level_count; ++l) {
+    const ImagePyramid::Level& level = pyramid.GetLevel(l);
+    scores_[l].resize(static_cast<size_t>(level.width) * level.height);
+    uint8_t* scores = &scores_[l][0];
+    for (int y = 0; y < level.height; y += band_rows) {
+      const int end = std::min(y + band_rows, level.height);
+      tasks.push_back([this, &level, y, end, scores]() {
+        ScoreRows(level, y, end, scores);
+      });
+    }
+  }
+  RunTasks(pool_, tasks);
+  const double scored = NowMs();
+
+  // Suppression reads the scores of neighboring bands, so it starts only
+  // once every band is scored.
+  band_keypoints_.resize(tasks.size());
+  tasks.clear();
+  size_t band = 0;
+  for (int l = 0; l < level_count; ++l) {
+    const ImagePyramid::Level& level = pyramid.GetLevel(l);
+    const uint8_t* scores = &scores_[l][0];
+    for (int y = 0; y < level.height; y += band_rows, ++band) {
+      const int end = std::min(y + band_rows, level.height);
+      std::vector<Keypoint>* output = &band_keypoints_[band];
+      output->clear();
+      tasks.push_back([this, &level, l, y, end, scores, output]() {
+        SuppressRows(level, l, y, end, scores, output);
+      });
+    }
+  }
+  RunTasks(pool_, tasks);
+  const double suppressed = NowMs();
+
+  for (size_t i = 0; i < band_keypoints_.size(); ++i) {
+    keypoints->insert(keypoints->end(), band_keypoints_[i].begin(),
+                      band_keypoints_[i].end());
+  }
+  const ImagePyramid::Level& base = pyramid.GetLevel(0);
+  Bucket(base.width, base.height, keypoints);
+
+  timing_.score_ms = scored - start;
+  timing_.suppress_ms = suppressed - scored;
+  timing_.bucket_ms = NowMs() - suppressed;
+}
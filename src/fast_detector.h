@@ -0,0 +1,85 @@
+#ifndef CINDER_TANGO_FAST_DETECTOR_H_
+#define CINDER_TANGO_FAST_DETECTOR_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "image_pyramid.h"
+#include "worker_pool.h"
+
+struct Keypoint {
+  // Position in level 0 pixels.
+  float x;
+  float y;
+  int level;
+  // Largest threshold at which the point is still a corner.
+  int score;
+};
+
+// FAST-9 corner detector over an ImagePyramid.
+//
+// Each level is split into bands of rows that run on the WorkerPool, first
+// to score candidates and then for 3x3 non-max suppression. The cardinal
+// pixel pre-test runs on 16 pixels at a time with NEON or SSE2; survivors
+// get the exact segment test and score, so the result does not depend on the
+// instruction set or the number of threads.
+//
+// With max_per_cell set, the output is bucketed on a grid of cell_size level
+// 0 pixels and only the strongest corners of each cell are kept, which
+// spreads keypoints over the image instead of clustering them on texture.
+class FastDetector {
+ public:
+  struct Options {
+    Options();
+    // Intensity difference for a circle pixel to count as brighter or
+    // darker than the center.
+    int threshold;
+    bool nonmax_suppression;
+    // Grid cell size in level 0 pixels and corners kept per cell. A
+    // cell_size of 0 makes the whole image one cell; a max_per_cell of 0
+    // keeps every corner.
+    int cell_size;
+    int max_per_cell;
+    // Rows per task.
+    int band_rows;
+  };
+
+  struct Timing {
+    double score_ms;
+    double suppress_ms;
+    double bucket_ms;
+  };
+
+  // pool may be null to detect on the calling thread.
+  FastDetector(WorkerPool* pool, const Options& options);
+  FastDetector(const FastDetector& other) = delete;
+  FastDetector& operator=(const FastDetector&) = delete;
+
+  // Replaces keypoints with the corners of all pyramid levels, sorted by grid
+  // cell and then by decreasing score.
+  void Detect(const ImagePyramid& pyramid, std::vector<Keypoint>* keypoints);
+
+  // Wall time of the stages of the last Detect call.
+  const Timing& GetLastTiming() const { return timing_; }
+
+ private:
+  void ScoreRows(const ImagePyramid::Level& level, int begin, int end,
+                 uint8_t* scores) const;
+  void SuppressRows(const ImagePyramid::Level& level, int level_index,
+                    int begin, int end, const uint8_t* scores,
+                    std::vector<Keypoint>* keypoints) const;
+  void Bucket(int width, int height, std::vector<Keypoint>* keypoints);
+
+  WorkerPool* pool_;
+  const Options options_;
+  // One score map per level, reused between calls.
+  std::vector<std::vector<uint8_t> > scores_;
+  std::vector<std::vector<Keypoint> > band_keypoints_;
+  // Bucketing scratch.
+  std::vector<int> cells_;
+  std::vector<int> cell_starts_;
+  std::vector<Keypoint> sorted_;
+  Timing timing_;
+};
+
+#endif  // CINDER_TANGO_FAST_DETECTOR_H_
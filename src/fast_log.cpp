@@ -0,0 +1,339 @@
+#include "fast_log.h"
+
+#include <android/log.h>
+#include <errno.h>
+#include <stdarg.h>
+#include <algorithm>
+
+namespace {
+int ToAndroidPriority(FastLog::Level level) {
+  switch (level) {
+    case FastLog::kWarning:
+      return ANDROID_LOG_WARN;
+    case FastLog::kError:
+      return ANDROID_LOG_ERROR;
+    default:
+      return ANDROID_LOG_INFO;
+  }
+}
+
+char ToLevelChar(FastLog::Level level) {
+  switch (level) {
+    case FastLog::kWarning:
+      return 'W';
+    case FastLog::kError:
+      return 'E';
+    default:
+      return 'I';
+  }
+}
+
+const char* GetBaseName(const char* path) {
+  const char* slash = strrchr(path, '/');
+  return slash == nullptr ? path : slash + 1;
+}
+
+void Append(std::string* line, const char* spec, ...)
+    __attribute__((format(printf, 2, 3)));
+
+void Append(std::string* line, const char* spec, ...) {
+  char buffer[128];
+  va_list args;
+  va_start(args, spec);
+  const int size = vsnprintf(buffer, sizeof(buffer), spec, args);
+  va_end(args);
+  if (size > 0) {
+    line->append(buffer, std::min(static_cast<size_t>(size),
+                                  sizeof(buffer) - 1));
+  }
+}
+}  // namespace
+
+FastLog::Options::Options()
+    : tag("CinderTango"), ring_size(512), flush_interval_ms(50) {}
+
+FastLog::FastLog()
+    : rings_(options_.ring_size),
+      running_(false),
+      flush_requested_(0),
+      flush_done_(0),
+      stopping_(false),
+      file_(nullptr),
+      written_(0),
+      suppressed_(0) {
+  pthread_mutex_init(&mutex_, nullptr);
+  pthread_cond_init(&wake_cond_, nullptr);
+  pthread_cond_init(&flushed_cond_, nullptr);
+}
+
+FastLog::~FastLog() {
+  Stop();
+  // Threads may still log while the process exits, so the mutex is left
+  // alone.
+}
+
+void FastLog::CheckFormat(const char*, ...) {}
+
+bool FastLog::Start(const Options& options) {
+  if (running_.load()) {
+    return false;
+  }
+  options_ = options;
+  rings_.SetRingSize(options_.ring_size);
+  if (!options_.file_path.empty()) {
+    file_ = fopen(options_.file_path.c_str(), "a");
+    if (file_ == nullptr) {
+      __android_log_print(ANDROID_LOG_ERROR, options_.tag.c_str(),
+                          "FastLog: cannot open %s: %s",
+                          options_.file_path.c_str(), strerror(errno));
+    }
+  }
+  stopping_ = false;
+  if (pthread_create(&thread_, nullptr, ThreadMain, this) != 0) {
+    __android_log_print(ANDROID_LOG_ERROR, options_.tag.c_str(),
+                        "FastLog: cannot start writer thread");
+    if (file_ != nullptr) {
+      fclose(file_);
+      file_ = nullptr;
+    }
+    return false;
+  }
+  running_.store(true);
+  return true;
+}
+
+void FastLog::Stop() {
+  if (!running_.exchange(false)) {
+    return;
+  }
+  pthread_mutex_lock(&mutex_);
+  stopping_ = true;
+  pthread_cond_signal(&wake_cond_);
+  pthread_mutex_unlock(&mutex_);
+  pthread_join(thread_, nullptr);
+  if (file_ != nullptr) {
+    fclose(file_);
+    file_ = nullptr;
+  }
+}
+
+void FastLog::Flush() {
+  if (!running_.load()) {
+    return;
+  }
+  pthread_mutex_lock(&mutex_);
+  const uint64_t request = ++flush_requested_;
+  pthread_cond_signal(&wake_cond_);
+  while (flush_done_ < request && !stopping_) {
+    pthread_cond_wait(&flushed_cond_, &mutex_);
+  }
+  pthread_mutex_unlock(&mutex_);
+}
+
+FastLog::Stats FastLog::GetStats() const {
+  Stats stats;
+  stats.threads = rings_.GetThreadCount();
+  stats.dropped = rings_.GetDropped();
+  stats.written = written_.load();
+  stats.suppressed = suppressed_.load();
+  return stats;
+}
+
+void FastLog::PutText(Record* record, const char* value, size_t size) {
+  const int index = record->arg_count++;
+  record->types[index] = kText;
+  const size_t offset = std::min<size_t>(record->text_used, kTextSize - 1);
+  size = std::min<size_t>(size, kTextSize - 1 - offset);
+  if (size > 0) {
+    memcpy(record->text + offset, value, size);
+  }
+  record->text[offset + size] = '\0';
+  record->args[index].u = offset;
+  record->text_used = static_cast<uint8_t>(offset + size + 1);
+}
+
+void* FastLog::ThreadMain(void* arg) {
+  static_cast<FastLog*>(arg)->Run();
+  return nullptr;
+}
+
+void FastLog::Run() {
+  std::string line;
+  pthread_mutex_lock(&mutex_);
+  while (true) {
+    const bool stopping = stopping_;
+    const uint64_t flush_request = flush_requested_;
+    pthread_mutex_unlock(&mutex_);
+
+    Drain();
+    // Each thread's records are in order; merge them into one timeline.
+    std::stable_sort(pending_.begin(), pending_.end(),
+                     [](const Record& a, const Record& b) {
+                       return a.time_ns < b.time_ns;
+                     });
+    for (const Record& record : pending_) {
+      FormatRecord(record, &line);
+      Output(record.site->level, record.time_ns, record.site, line);
+      suppressed_.fetch_add(record.suppressed);
+    }
+    written_.fetch_add(pending_.size());
+    pending_.clear();
+    if (file_ != nullptr) {
+      fflush(file_);
+    }
+
+    pthread_mutex_lock(&mutex_);
+    flush_done_ = flush_request;
+    pthread_cond_broadcast(&flushed_cond_);
+    if (stopping) {
+      break;
+    }
+    if (flush_requested_ == flush_request && !stopping_) {
+      timespec deadline;
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_nsec += options_.flush_interval_ms * 1000000L;
+      deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+      deadline.tv_nsec %= 1000000000L;
+      pthread_cond_timedwait(&wake_cond_, &mutex_, &deadline);
+    }
+  }
+  pthread_mutex_unlock(&mutex_);
+}
+
+void FastLog::Drain() {
+  const uint64_t dropped =
+      rings_.Drain([this](int, const Record& record) {
+        pending_.push_back(record);
+      });
+  if (dropped > 0) {
+    char message[96];
+    snprintf(message, sizeof(message),
+             "FastLog: %llu records dropped, ring full",
+             static_cast<unsigned long long>(dropped));
+    Output(kWarning, NowNs(), nullptr, message);
+  }
+}
+
+bool FastLog::TakeInt(const Record& record, int* arg, int64_t* value) {
+  if (*arg >= record.arg_count) {
+    return false;
+  }
+  const uint8_t type = record.types[*arg];
+  const auto& recorded = record.args[(*arg)++];
+  *value = type == kDouble ? static_cast<int64_t>(recorded.d) : recorded.i;
+  return true;
+}
+
+void FastLog::FormatRecord(const Record& record, std::string* line) {
+  line->clear();
+  int arg = 0;
+  for (const char* p = record.site->format; *p != '\0'; ++p) {
+    if (*p != '%') {
+      line->push_back(*p);
+      continue;
+    }
+    if (p[1] == '%') {
+      line->push_back('%');
+      ++p;
+      continue;
+    }
+    // %[flags][width][.precision][length]conversion; the length is
+    // replaced to match the recorded type, and a * width or precision by
+    // the argument it takes.
+    const char* start = p++;
+    while (*p != '\0' && strchr("-+ #0", *p) != nullptr) {
+      ++p;
+    }
+    std::string spec(start, p);
+    int64_t star = 0;
+    if (*p == '*') {
+      ++p;
+      if (!TakeInt(record, &arg, &star)) {
+        line->append("<missing>");
+        continue;
+      }
+      Append(&spec, "%lld", static_cast<long long>(star));
+    }
+    while (*p >= '0' && *p <= '9') {
+      spec.push_back(*p++);
+    }
+    if (*p == '.') {
+      ++p;
+      if (*p == '*') {
+        ++p;
+        if (!TakeInt(record, &arg, &star)) {
+          line->append("<missing>");
+          continue;
+        }
+        // A negative precision counts as none.
+        if (star >= 0) {
+          Append(&spec, ".%lld", static_cast<long long>(star));
+        }
+      } else {
+        spec.push_back('.');
+        while (*p >= '0' && *p <= '9') {
+          spec.push_back(*p++);
+        }
+      }
+    }
+    while (*p != '\0' && strchr("hlLqjzt", *p) != nullptr) {
+      ++p;
+    }
+    const char conversion = *p;
+    if (conversion == '\0') {
+      line->append(start);
+      break;
+    }
+    if (arg >= record.arg_count) {
+      line->append("<missing>");
+      continue;
+    }
+    const uint8_t type = record.types[arg];
+    const auto& value = record.args[arg];
+    ++arg;
+    if (type == kText) {
+      spec += 's';
+      Append(line, spec.c_str(), record.text + value.u);
+    } else if (conversion == 'p' || type == kPointer) {
+      Append(line, "%p", reinterpret_cast<void*>(value.u));
+    } else if (strchr("fFeEgGaA", conversion) != nullptr || type == kDouble) {
+      const double number = type == kDouble
+                                ? value.d
+                                : (type == kInt ? static_cast<double>(value.i)
+                                                : static_cast<double>(value.u));
+      spec += strchr("fFeEgGaA", conversion) != nullptr ? conversion : 'g';
+      Append(line, spec.c_str(), number);
+    } else if (conversion == 'c') {
+      spec += 'c';
+      Append(line, spec.c_str(), static_cast<int>(value.i));
+    } else if (strchr("uoxX", conversion) != nullptr) {
+      spec += "ll";
+      spec += conversion;
+      Append(line, spec.c_str(), static_cast<unsigned long long>(value.u));
+    } else if (type == kUnsigned) {
+      spec += "llu";
+      Append(line, spec.c_str(), static_cast<unsigned long long>(value.u));
+    } else {
+      spec += "lld";
+      Append(line, spec.c_str(), static_cast<long long>(value.i));
+    }
+  }
+  if (record.suppressed > 0) {
+    Append(line, " (+%u suppressed)", record.suppressed);
+  }
+}
+
+void FastLog::Output(Level level, int64_t time_ns, const Site* site,
+                     const std::string& line) {
+  __android_log_write(ToAndroidPriority(level), options_.tag.c_str(),
+                      line.c_str());
+  if (file_ != nullptr) {
+    // Monotonic seconds, the clock the records were stamped with.
+    fprintf(file_, "%lld.%06lld %c %s:%d %s\n",
+            static_cast<long long>(time_ns / 1000000000),
+            static_cast<long long>(time_ns % 1000000000 / 1000),
+            ToLevelChar(level),
+            site != nullptr ? GetBaseName(site->file) : "FastLog",
+            site != nullptr ? site->line : 0, line.c_str());
+  }
+}
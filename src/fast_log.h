@@ -0,0 +1,266 @@
+#ifndef CINDER_TANGO_FAST_LOG_H_
+#define CINDER_TANGO_FAST_LOG_H_
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "thread_rings.h"
+
+// Logging for the render, simulation and Tango callback threads. A call
+// only copies the raw arguments and a pointer to its call site (format,
+// level, file and line) into a ring owned by the calling thread; a
+// background thread formats the records and writes them to the Android log
+// and, optionally, a file. Nothing on the calling side locks, allocates or
+// formats, so logging can stay on in production builds.
+//
+//  FAST_LOG_I("pose %f %f %f", x, y, z);
+//  // At most once a second from this line; the next record that gets
+//  // through says how many were suppressed in between.
+//  FAST_LOG(FastLog::kWarning, 1000, "getPoseAtTime failed: %d", error);
+//
+// Formats are printf's. Arguments are integers, floating point numbers,
+// pointers and strings; strings are copied, up to kTextSize bytes per
+// record in all. The types recorded, not the length modifiers of the
+// format, decide how a value is printed, so "%d" prints an int64_t right.
+//
+// A full ring drops the record and counts it. Until Start is called every
+// call returns right away.
+#define FAST_LOG(level, interval_ms, format, ...)                          \
+  do {                                                                     \
+    static FastLog::Site fast_log_site((level), (interval_ms), (format),   \
+                                       __FILE__, __LINE__);                \
+    if (false) {                                                           \
+      FastLog::CheckFormat(format, ##__VA_ARGS__);                         \
+    }                                                                      \
+    FastLog::GetInstance().Write(&fast_log_site, ##__VA_ARGS__);           \
+  } while (0)
+
+#define FAST_LOG_I(format, ...) \
+  FAST_LOG(FastLog::kInfo, 0, format, ##__VA_ARGS__)
+#define FAST_LOG_W(format, ...) \
+  FAST_LOG(FastLog::kWarning, 0, format, ##__VA_ARGS__)
+#define FAST_LOG_E(format, ...) \
+  FAST_LOG(FastLog::kError, 0, format, ##__VA_ARGS__)
+
+class FastLog {
+ public:
+  enum Level { kInfo, kWarning, kError };
+
+  static const int kMaxArgs = 8;
+  static const int kTextSize = 48;
+
+  struct Options {
+    Options();
+    // Android log tag.
+    std::string tag;
+    // Lines are appended to this file too, unless it is empty (the
+    // default).
+    std::string file_path;
+    // Records each thread can queue before the writer catches up.
+    size_t ring_size;
+    // How often the writer drains the rings.
+    int flush_interval_ms;
+  };
+
+  struct Stats {
+    uint64_t written;
+    // Records lost to full rings, and not logged because of rate limits.
+    uint64_t dropped;
+    uint64_t suppressed;
+    int threads;
+  };
+
+  // One logging statement. FAST_LOG keeps one in a static, so the address
+  // identifies the statement for the lifetime of the process.
+  struct Site {
+    constexpr Site(Level level, int interval_ms, const char* format,
+                   const char* file, int line)
+        : level(level),
+          interval_ns(static_cast<int64_t>(interval_ms) * 1000000),
+          format(format),
+          file(file),
+          line(line),
+          next_ns(0),
+          suppressed(0) {}
+    const Level level;
+    const int64_t interval_ns;
+    const char* const format;
+    const char* const file;
+    const int line;
+    // Earliest time the next record may go out, and records held back
+    // since the last one.
+    std::atomic<int64_t> next_ns;
+    std::atomic<uint32_t> suppressed;
+  };
+
+  static FastLog& GetInstance() {
+    static FastLog instance;
+    return instance;
+  }
+
+  FastLog(const FastLog& other) = delete;
+  FastLog& operator=(const FastLog&) = delete;
+  ~FastLog();
+
+  // Starts the writer thread. Returns false if it is running already or
+  // cannot be started.
+  bool Start(const Options& options);
+  // Writes everything queued and ends the writer thread.
+  void Stop();
+  // Blocks until everything queued before the call has been written.
+  void Flush();
+
+  Stats GetStats() const;
+
+  template <typename... Args>
+  void Write(Site* site, const Args&... args) {
+    static_assert(sizeof...(Args) <= kMaxArgs, "too many log arguments");
+    if (!running_.load(std::memory_order_acquire)) {
+      return;
+    }
+    const int64_t now = NowNs();
+    uint32_t suppressed = 0;
+    if (site->interval_ns > 0 && !Admit(site, now, &suppressed)) {
+      return;
+    }
+    Record record;
+    record.time_ns = now;
+    record.site = site;
+    record.suppressed = suppressed;
+    record.arg_count = 0;
+    record.text_used = 0;
+    Encode(&record, args...);
+    rings_.Push(record);
+  }
+
+  // Never called; FAST_LOG uses it so the compiler checks the arguments
+  // against the format.
+  static void CheckFormat(const char* format, ...)
+      __attribute__((format(printf, 1, 2)));
+
+ private:
+  enum ArgType { kInt, kUnsigned, kDouble, kText, kPointer };
+
+  struct Record {
+    int64_t time_ns;
+    const Site* site;
+    uint32_t suppressed;
+    uint8_t arg_count;
+    uint8_t text_used;
+    uint8_t types[kMaxArgs];
+    union {
+      int64_t i;
+      uint64_t u;
+      double d;
+    } args[kMaxArgs];
+    // Strings, each copied with its terminator; a kText argument holds its
+    // offset in u.
+    char text[kTextSize];
+  };
+
+  FastLog();
+
+  static int64_t NowNs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+  }
+
+  // Returns whether site may log at now, and how many records it held back
+  // since it last did.
+  static bool Admit(Site* site, int64_t now, uint32_t* suppressed) {
+    int64_t next = site->next_ns.load(std::memory_order_relaxed);
+    if (now < next ||
+        !site->next_ns.compare_exchange_strong(next,
+                                               now + site->interval_ns)) {
+      site->suppressed.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    *suppressed = site->suppressed.exchange(0, std::memory_order_relaxed);
+    return true;
+  }
+
+  static void Encode(Record*) {}
+  template <typename T, typename... Rest>
+  static void Encode(Record* record, const T& value, const Rest&... rest) {
+    Put(record, value);
+    Encode(record, rest...);
+  }
+
+  template <typename T>
+  static typename std::enable_if<std::is_integral<T>::value ||
+                                 std::is_enum<T>::value>::type
+  Put(Record* record, T value) {
+    const int index = record->arg_count++;
+    if (std::is_unsigned<T>::value) {
+      record->types[index] = kUnsigned;
+      record->args[index].u = static_cast<uint64_t>(value);
+    } else {
+      record->types[index] = kInt;
+      record->args[index].i = static_cast<int64_t>(value);
+    }
+  }
+  template <typename T>
+  static typename std::enable_if<std::is_floating_point<T>::value>::type
+  Put(Record* record, T value) {
+    const int index = record->arg_count++;
+    record->types[index] = kDouble;
+    record->args[index].d = value;
+  }
+  static void Put(Record* record, const char* value) {
+    PutText(record, value, value == nullptr ? 0 : strlen(value));
+  }
+  static void Put(Record* record, char* value) {
+    Put(record, static_cast<const char*>(value));
+  }
+  static void Put(Record* record, const std::string& value) {
+    PutText(record, value.data(), value.size());
+  }
+  template <typename T>
+  static void Put(Record* record, const T* value) {
+    const int index = record->arg_count++;
+    record->types[index] = kPointer;
+    record->args[index].u = reinterpret_cast<uintptr_t>(value);
+  }
+  static void PutText(Record* record, const char* value, size_t size);
+
+  // Takes the argument at *arg as the value of a * width or precision.
+  // Returns false if the record has no argument left.
+  static bool TakeInt(const Record& record, int* arg, int64_t* value);
+  static void FormatRecord(const Record& record, std::string* line);
+  static void* ThreadMain(void* arg);
+
+  void Run();
+  // Moves every queued record to pending_ and reports what the rings
+  // dropped. Writer thread only.
+  void Drain();
+  // site is null for the logger's own messages.
+  void Output(Level level, int64_t time_ns, const Site* site,
+              const std::string& line);
+
+  Options options_;
+  ThreadRings<Record> rings_;
+  pthread_t thread_;
+  std::atomic<bool> running_;
+  // Guards the flush counters and stopping_.
+  mutable pthread_mutex_t mutex_;
+  pthread_cond_t wake_cond_;
+  pthread_cond_t flushed_cond_;
+  uint64_t flush_requested_;
+  uint64_t flush_done_;
+  bool stopping_;
+  // Writer thread only.
+  std::vector<Record> pending_;
+  FILE* file_;
+  std::atomic<uint64_t> written_;
+  std::atomic<uint64_t> suppressed_;
+};
+
+#endif  // CINDER_TANGO_FAST_LOG_H_
@@ -0,0 +1,330 @@
+#include "geometry_exporter.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+
+#include "cinder/Log.h"
+
+namespace {
+const char kNativeMagic[4] = {'C', 'T', 'G', 'M'};
+const uint32_t kNativeVersion = 1;
+const uint32_t kNativeHasNormals = 1u << 0;
+const uint32_t kNativeHasColors = 1u << 1;
+const uint32_t kNativeShortIndices = 1u << 2;
+const size_t kNativeHeaderSize = 4 + 4 * 4;
+
+struct Layout {
+  uint64_t vertex_count;
+  uint64_t face_count;
+  bool has_normals;
+  bool has_colors;
+};
+
+Layout ComputeLayout(const GeometrySnapshot& snapshot) {
+  Layout layout = {0, 0, !snapshot.meshes.empty() && snapshot.clouds.empty(),
+                   !snapshot.meshes.empty() && snapshot.clouds.empty()};
+  for (size_t i = 0; i < snapshot.meshes.size(); ++i) {
+    const MeshData& mesh = *snapshot.meshes[i];
+    layout.vertex_count += mesh.GetVertexCount();
+    layout.face_count += mesh.GetFaceCount();
+    layout.has_normals = layout.has_normals && mesh.HasNormals();
+    layout.has_colors = layout.has_colors && mesh.HasColors();
+  }
+  for (size_t i = 0; i < snapshot.clouds.size(); ++i) {
+    layout.vertex_count += snapshot.clouds[i]->GetPointCount();
+  }
+  return layout;
+}
+
+std::string PlyHeader(const Layout& layout) {
+  std::stringstream header;
+  header << "ply\n"
+         << "format binary_little_endian 1.0\n"
+         << "comment CinderTango export\n"
+         << "element vertex " << layout.vertex_count << "\n"
+         << "property float x\n"
+         << "property float y\n"
+         << "property float z\n";
+  if (layout.has_normals) {
+    header << "property float nx\n"
+           << "property float ny\n"
+           << "property float nz\n";
+  }
+  if (layout.has_colors) {
+    header << "property uchar red\n"
+           << "property uchar green\n"
+           << "property uchar blue\n"
+           << "property uchar alpha\n";
+  }
+  if (layout.face_count > 0) {
+    header << "element face " << layout.face_count << "\n"
+           << "property list uchar int vertex_indices\n";
+  }
+  header << "end_header\n";
+  return header.str();
+}
+
+bool UseShortIndices(const Layout& layout) {
+  return layout.vertex_count <= 0xffff;
+}
+}  // namespace
+
+// Accumulates writes into a fixed buffer and hands full buffers to fwrite.
+class GeometryExporter::BufferedWriter {
+ public:
+  BufferedWriter(FILE* file, size_t size, GeometryExporter* owner,
+                 const ProgressCallback& progress)
+      : file_(file),
+        buffer_(size),
+        used_(0),
+        owner_(owner),
+        progress_(progress),
+        ok_(true) {}
+
+  bool Write(const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    while (size > 0 && ok_) {
+      size_t chunk = std::min(size, buffer_.size() - used_);
+      memcpy(&buffer_[used_], bytes, chunk);
+      used_ += chunk;
+      bytes += chunk;
+      size -= chunk;
+      if (used_ == buffer_.size()) {
+        Flush();
+      }
+    }
+    return ok_;
+  }
+
+  bool Flush() {
+    if (used_ > 0 && ok_) {
+      if (fwrite(&buffer_[0], 1, used_, file_) != used_) {
+        CI_LOG_E("GeometryExporter: write failed: " << strerror(errno));
+        ok_ = false;
+      }
+      owner_->bytes_written_ += used_;
+      used_ = 0;
+      if (progress_) {
+        progress_(owner_->bytes_written_.load(), owner_->total_bytes_.load());
+      }
+    }
+    if (owner_->cancel_.load()) {
+      ok_ = false;
+    }
+    return ok_;
+  }
+
+  bool ok() const { return ok_; }
+
+ private:
+  FILE* file_;
+  std::vector<uint8_t> buffer_;
+  size_t used_;
+  GeometryExporter* owner_;
+  ProgressCallback progress_;
+  bool ok_;
+};
+
+GeometryExporter::GeometryExporter(WorkerPool* pool, size_t buffer_size)
+    : pool_(pool),
+      buffer_size_(buffer_size > 0 ? buffer_size : 1),
+      state_(kStateIdle),
+      cancel_(false),
+      bytes_written_(0),
+      total_bytes_(0) {
+  pthread_mutex_init(&done_mutex_, nullptr);
+  pthread_cond_init(&done_cond_, nullptr);
+}
+
+GeometryExporter::~GeometryExporter() {
+  Cancel();
+  Wait();
+  pthread_cond_destroy(&done_cond_);
+  pthread_mutex_destroy(&done_mutex_);
+}
+
+uint64_t GeometryExporter::ComputeFileSize(Format format,
+                                           const GeometrySnapshot& snapshot) {
+  Layout layout = ComputeLayout(snapshot);
+  uint64_t per_vertex = 3 * sizeof(float) +
+                        (layout.has_normals ? 3 * sizeof(float) : 0) +
+                        (layout.has_colors ? 4 : 0);
+  if (format == kFormatPly) {
+    return PlyHeader(layout).size() + layout.vertex_count * per_vertex +
+           layout.face_count * (1 + 3 * sizeof(int32_t));
+  }
+  uint64_t index_size = UseShortIndices(layout) ? 2 : 4;
+  return kNativeHeaderSize + layout.vertex_count * per_vertex +
+         layout.face_count * 3 * index_size;
+}
+
+bool GeometryExporter::Start(const std::string& path, Format format,
+                             const GeometrySnapshot& snapshot,
+                             const ProgressCallback& progress) {
+  pthread_mutex_lock(&done_mutex_);
+  if (state_.load() == kStateRunning) {
+    pthread_mutex_unlock(&done_mutex_);
+    return false;
+  }
+  state_ = kStateRunning;
+  cancel_ = false;
+  bytes_written_ = 0;
+  total_bytes_ = ComputeFileSize(format, snapshot);
+  pthread_mutex_unlock(&done_mutex_);
+
+  if (!pool_->Enqueue([this, path, format, snapshot, progress]() {
+        Run(path, format, snapshot, progress);
+      })) {
+    // Nothing will finish the export, so Wait must not wait for it.
+    pthread_mutex_lock(&done_mutex_);
+    state_ = kStateFailed;
+    pthread_cond_broadcast(&done_cond_);
+    pthread_mutex_unlock(&done_mutex_);
+    return false;
+  }
+  return true;
+}
+
+void GeometryExporter::Cancel() { cancel_ = true; }
+
+void GeometryExporter::Wait() {
+  pthread_mutex_lock(&done_mutex_);
+  while (state_.load() == kStateRunning) {
+    pthread_cond_wait(&done_cond_, &done_mutex_);
+  }
+  pthread_mutex_unlock(&done_mutex_);
+}
+
+float GeometryExporter::GetProgress() const {
+  uint64_t total = total_bytes_.load();
+  if (total == 0) {
+    return state_.load() == kStateDone ? 1.0f : 0.0f;
+  }
+  return static_cast<float>(bytes_written_.load()) / total;
+}
+
+void GeometryExporter::Run(const std::string& path, Format format,
+                           const GeometrySnapshot& snapshot,
+                           const ProgressCallback& progress) {
+  const std::string part_path = path + ".part";
+  State result = kStateFailed;
+  FILE* file = fopen(part_path.c_str(), "wb");
+  if (file == nullptr) {
+    CI_LOG_E("GeometryExporter: cannot open " << part_path << ": "
+             << strerror(errno));
+  } else {
+    BufferedWriter writer(file, buffer_size_, this, progress);
+    bool ok = format == kFormatPly ? WritePly(snapshot, &writer)
+                                   : WriteNative(snapshot, &writer);
+    ok = writer.Flush() && ok;
+    ok = fclose(file) == 0 && ok;
+    if (ok && rename(part_path.c_str(), path.c_str()) == 0) {
+      result = kStateDone;
+    } else {
+      remove(part_path.c_str());
+      result = cancel_.load() ? kStateCancelled : kStateFailed;
+    }
+  }
+
+  pthread_mutex_lock(&done_mutex_);
+  state_ = result;
+  pthread_cond_broadcast(&done_cond_);
+  pthread_mutex_unlock(&done_mutex_);
+}
+
+bool GeometryExporter::WritePly(const GeometrySnapshot& snapshot,
+                                BufferedWriter* writer) {
+  Layout layout = ComputeLayout(snapshot);
+  std::string header = PlyHeader(layout);
+  writer->Write(header.data(), header.size());
+
+  for (size_t m = 0; m < snapshot.meshes.size() && writer->ok(); ++m) {
+    const MeshData& mesh = *snapshot.meshes[m];
+    for (size_t v = 0; v < mesh.GetVertexCount(); ++v) {
+      writer->Write(&mesh.vertices[v * 3], 3 * sizeof(float));
+      if (layout.has_normals) {
+        writer->Write(&mesh.normals[v * 3], 3 * sizeof(float));
+      }
+      if (layout.has_colors) {
+        writer->Write(&mesh.colors[v * 4], 4);
+      }
+    }
+  }
+  for (size_t c = 0; c < snapshot.clouds.size() && writer->ok(); ++c) {
+    const PointCloudData& cloud = *snapshot.clouds[c];
+    writer->Write(cloud.points.data(), cloud.points.size() * sizeof(float));
+  }
+
+  uint32_t base = 0;
+  for (size_t m = 0; m < snapshot.meshes.size() && writer->ok(); ++m) {
+    const MeshData& mesh = *snapshot.meshes[m];
+    for (size_t f = 0; f < mesh.faces.size(); f += 3) {
+      uint8_t record[1 + 3 * sizeof(int32_t)];
+      record[0] = 3;
+      int32_t indices[3] = {static_cast<int32_t>(mesh.faces[f] + base),
+                            static_cast<int32_t>(mesh.faces[f + 1] + base),
+                            static_cast<int32_t>(mesh.faces[f + 2] + base)};
+      memcpy(record + 1, indices, sizeof(indices));
+      writer->Write(record, sizeof(record));
+    }
+    base += static_cast<uint32_t>(mesh.GetVertexCount());
+  }
+  return writer->ok();
+}
+
+bool GeometryExporter::WriteNative(const GeometrySnapshot& snapshot,
+                                   BufferedWriter* writer) {
+  Layout layout = ComputeLayout(snapshot);
+  const bool short_indices = UseShortIndices(layout);
+  uint32_t header[4];
+  header[0] = kNativeVersion;
+  header[1] = (layout.has_normals ? kNativeHasNormals : 0) |
+              (layout.has_colors ? kNativeHasColors : 0) |
+              (short_indices ? kNativeShortIndices : 0);
+  header[2] = static_cast<uint32_t>(layout.vertex_count);
+  header[3] = static_cast<uint32_t>(layout.face_count);
+  writer->Write(kNativeMagic, sizeof(kNativeMagic));
+  writer->Write(header, sizeof(header));
+
+  // Planar layout: each attribute array is contiguous, so a loader can read
+  // it straight into a vertex buffer.
+  for (size_t m = 0; m < snapshot.meshes.size() && writer->ok(); ++m) {
+    const MeshData& mesh = *snapshot.meshes[m];
+    writer->Write(mesh.vertices.data(), mesh.vertices.size() * sizeof(float));
+  }
+  for (size_t c = 0; c < snapshot.clouds.size() && writer->ok(); ++c) {
+    const PointCloudData& cloud = *snapshot.clouds[c];
+    writer->Write(cloud.points.data(), cloud.points.size() * sizeof(float));
+  }
+  if (layout.has_normals) {
+    for (size_t m = 0; m < snapshot.meshes.size() && writer->ok(); ++m) {
+      const MeshData& mesh = *snapshot.meshes[m];
+      writer->Write(mesh.normals.data(), mesh.normals.size() * sizeof(float));
+    }
+  }
+  if (layout.has_colors) {
+    for (size_t m = 0; m < snapshot.meshes.size() && writer->ok(); ++m) {
+      const MeshData& mesh = *snapshot.meshes[m];
+      writer->Write(mesh.colors.data(), mesh.colors.size());
+    }
+  }
+
+  uint32_t base = 0;
+  for (size_t m = 0; m < snapshot.meshes.size() && writer->ok(); ++m) {
+    const MeshData& mesh = *snapshot.meshes[m];
+    for (size_t i = 0; i < mesh.faces.size(); ++i) {
+      uint32_t index = mesh.faces[i] + base;
+      if (short_indices) {
+        uint16_t short_index = static_cast<uint16_t>(index);
+        writer->Write(&short_index, sizeof(short_index));
+      } else {
+        writer->Write(&index, sizeof(index));
+      }
+    }
+    base += static_cast<uint32_t>(mesh.GetVertexCount());
+  }
+  return writer->ok();
+}
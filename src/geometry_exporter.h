@@ -0,0 +1,97 @@
+#ifndef CINDER_TANGO_GEOMETRY_EXPORTER_H_
+#define CINDER_TANGO_GEOMETRY_EXPORTER_H_
+
+#include <pthread.h>
+#include <stdint.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mesh_data.h"
+#include "point_cloud.h"
+#include "worker_pool.h"
+
+// The geometry captured at one instant. Holding shared_ptrs to immutable
+// data makes taking a snapshot O(number of pieces): producers replace
+// pointers instead of mutating, so the exporter reads a stable copy without
+// ever duplicating vertex data.
+struct GeometrySnapshot {
+  std::vector<std::shared_ptr<const MeshData> > meshes;
+  std::vector<std::shared_ptr<const PointCloudData> > clouds;
+};
+
+// Streams a GeometrySnapshot to disk on a WorkerPool thread.
+//
+// Output goes through a fixed-size buffer, so memory use does not depend on
+// the scan size. The file is written under "<path>.part" and renamed when
+// complete, so readers never see a truncated export.
+//
+// Formats:
+//  kFormatPly     binary little-endian PLY. All pieces are merged into one
+//                 vertex and one face element. Normals and colors are written
+//                 only when every mesh has them and there are no clouds.
+//  kFormatNative  "CTGM" header followed by the raw arrays. Indices are
+//                 stored as uint16 when the vertex count allows it.
+//
+// Only one export runs at a time per exporter.
+//
+// Besides the pool it needs cinder/Log.h and, through MeshData and
+// PointCloudData, tango_client_api.h. test/ builds it on Linux with stubs
+// for those.
+class GeometryExporter {
+ public:
+  enum Format { kFormatPly, kFormatNative };
+
+  enum State { kStateIdle, kStateRunning, kStateDone, kStateFailed,
+               kStateCancelled };
+
+  // Called on the worker thread after each buffer flush and once at the end.
+  typedef std::function<void(uint64_t bytes_written, uint64_t total_bytes)>
+      ProgressCallback;
+
+  GeometryExporter(WorkerPool* pool, size_t buffer_size = 256 * 1024);
+  GeometryExporter(const GeometryExporter& other) = delete;
+  GeometryExporter& operator=(const GeometryExporter&) = delete;
+  // Cancels and waits for a running export. The pool must outlive the
+  // exporter.
+  ~GeometryExporter();
+
+  // Returns false if an export is already running, or if the pool drops the
+  // task because it is shutting down; the state is then kStateFailed.
+  bool Start(const std::string& path, Format format,
+             const GeometrySnapshot& snapshot,
+             const ProgressCallback& progress = ProgressCallback());
+
+  void Cancel();
+
+  // Blocks until the current export has finished.
+  void Wait();
+
+  State GetState() const { return static_cast<State>(state_.load()); }
+  float GetProgress() const;
+
+  // Size in bytes of the file Start() would write for this snapshot.
+  static uint64_t ComputeFileSize(Format format,
+                                  const GeometrySnapshot& snapshot);
+
+ private:
+  class BufferedWriter;
+
+  void Run(const std::string& path, Format format,
+           const GeometrySnapshot& snapshot, const ProgressCallback& progress);
+  bool WritePly(const GeometrySnapshot& snapshot, BufferedWriter* writer);
+  bool WriteNative(const GeometrySnapshot& snapshot, BufferedWriter* writer);
+
+  WorkerPool* pool_;
+  size_t buffer_size_;
+  std::atomic<int> state_;
+  std::atomic<bool> cancel_;
+  std::atomic<uint64_t> bytes_written_;
+  std::atomic<uint64_t> total_bytes_;
+  pthread_mutex_t done_mutex_;
+  pthread_cond_t done_cond_;
+};
+
+#endif  // CINDER_TANGO_GEOMETRY_EXPORTER_H_
@@ -0,0 +1,32 @@
+#include "image_pyramid.h"
+
+#include "yuv_convert.h"
+
+void ImagePyramid::Build(const uint8_t* data, int width, int height,
+                         int stride, int num_levels, int min_size) {
+  levels_.clear();
+  if (data == nullptr || width <= 0 || height <= 0 || num_levels < 1) {
+    return;
+  }
+  Level base = {data, width, height, stride, 1};
+  levels_.push_back(base);
+  if (buffers_.size() < static_cast<size_t>(num_levels - 1)) {
+    buffers_.resize(num_levels - 1);
+  }
+
+  for (int i = 1; i < num_levels; ++i) {
+    const Level& previous = levels_.back();
+    const int level_width = previous.width / 2;
+    const int level_height = previous.height / 2;
+    if (level_width < min_size || level_height < min_size) {
+      break;
+    }
+    std::vector<uint8_t>& buffer = buffers_[i - 1];
+    buffer.resize(static_cast<size_t>(level_width) * level_height);
+    yuv_convert::DownscalePlane(previous.data, previous.width, previous.height,
+                                previous.stride, 2, &buffer[0], level_width);
+    Level level = {&buffer[0], level_width, level_height, level_width,
+                   previous.scale * 2};
+    levels_.push_back(level);
+  }
+}
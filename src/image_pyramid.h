@@ -0,0 +1,48 @@
+#ifndef CINDER_TANGO_IMAGE_PYRAMID_H_
+#define CINDER_TANGO_IMAGE_PYRAMID_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "camera_frame.h"
+
+// Successive 2x box-downscaled copies of an 8-bit plane, usually the luma
+// plane of a camera frame. Level 0 points at the caller's pixels without
+// copying, so the source must stay valid while the pyramid is in use. The
+// other levels live in buffers that are reused across Build() calls.
+//
+// When building from a raw TangoImageBuffer rather than a CameraFrame, skip
+// the metadata scanline: Build(data + stride, width, height - 1, stride, n).
+class ImagePyramid {
+ public:
+  struct Level {
+    const uint8_t* data;
+    int width;
+    int height;
+    int stride;
+    // Level 0 pixels per pixel of this level.
+    int scale;
+  };
+
+  ImagePyramid() {}
+  ImagePyramid(const ImagePyramid& other) = delete;
+  ImagePyramid& operator=(const ImagePyramid&) = delete;
+
+  // Builds up to num_levels levels, stopping early once a level would be
+  // smaller than min_size pixels on either side.
+  void Build(const uint8_t* data, int width, int height, int stride,
+             int num_levels, int min_size = 32);
+  void Build(const ImagePlanes& planes, int num_levels, int min_size = 32) {
+    Build(planes.y, planes.width, planes.height, planes.y_stride, num_levels,
+          min_size);
+  }
+
+  int GetLevelCount() const { return static_cast<int>(levels_.size()); }
+  const Level& GetLevel(int level) const { return levels_[level]; }
+
+ private:
+  std::vector<Level> levels_;
+  std::vector<std::vector<uint8_t> > buffers_;
+};
+
+#endif  // CINDER_TANGO_IMAGE_PYRAMID_H_
@@ -0,0 +1,33 @@
+#include "mesh_data.h"
+
+void MeshDataFromTango(const TangoMesh_Experimental& segment, MeshData* mesh) {
+  const size_t num_vertices = segment.num_vertices;
+  const size_t num_faces = segment.num_faces;
+
+  const float* vertices = reinterpret_cast<const float*>(segment.vertices);
+  mesh->vertices.assign(vertices, vertices + num_vertices * 3);
+
+  const uint32_t* faces = reinterpret_cast<const uint32_t*>(segment.faces);
+  mesh->faces.assign(faces, faces + num_faces * 3);
+
+  if (segment.has_normals) {
+    const float* normals = reinterpret_cast<const float*>(segment.normals);
+    mesh->normals.assign(normals, normals + num_vertices * 3);
+  } else {
+    mesh->normals.clear();
+  }
+
+  if (segment.has_colors) {
+    const uint8_t* colors = reinterpret_cast<const uint8_t*>(segment.colors);
+    mesh->colors.assign(colors, colors + num_vertices * 4);
+  } else {
+    mesh->colors.clear();
+  }
+}
+
+uint64_t MeshCellKey(const int32_t index[3]) {
+  const uint64_t kMask = (1u << 21) - 1;
+  return ((static_cast<uint64_t>(index[0]) & kMask) << 42) |
+         ((static_cast<uint64_t>(index[1]) & kMask) << 21) |
+         (static_cast<uint64_t>(index[2]) & kMask);
+}
@@ -0,0 +1,33 @@
+#ifndef CINDER_TANGO_MESH_DATA_H_
+#define CINDER_TANGO_MESH_DATA_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include <tango_client_api.h>
+
+// CPU-side triangle mesh in the packed layout used by the Tango service.
+// Vertices and normals are {x, y, z} triplets, colors are {r, g, b, a}
+// bytes and faces are index triplets into the vertex array. Normals and
+// colors are either empty or hold one entry per vertex.
+struct MeshData {
+  std::vector<float> vertices;
+  std::vector<float> normals;
+  std::vector<uint8_t> colors;
+  std::vector<uint32_t> faces;
+
+  size_t GetVertexCount() const { return vertices.size() / 3; }
+  size_t GetFaceCount() const { return faces.size() / 3; }
+  bool HasNormals() const { return !normals.empty(); }
+  bool HasColors() const { return !colors.empty(); }
+};
+
+// Copies one reconstruction segment out of the service-owned buffers. The
+// segment pointers are only valid for the duration of the mesh callback.
+void MeshDataFromTango(const TangoMesh_Experimental& segment, MeshData* mesh);
+
+// Packs a grid cell index into a single key. Each component keeps 21 bits,
+// which covers +/-1M cells.
+uint64_t MeshCellKey(const int32_t index[3]);
+
+#endif  // CINDER_TANGO_MESH_DATA_H_
@@ -0,0 +1,456 @@
+#include "mesh_decimator.h"
+
+#include <math.h>
+#include <algorithm>
+#include <utility>
+
+namespace {
+// Faces whose normal turns by more than ~78 degrees reject a collapse.
+const double kMinNormalDot = 0.2;
+
+void AddPlane(double a, double b, double c, double d, double weight,
+              double* m) {
+  m[0] += weight * a * a;
+  m[1] += weight * a * b;
+  m[2] += weight * a * c;
+  m[3] += weight * a * d;
+  m[4] += weight * b * b;
+  m[5] += weight * b * c;
+  m[6] += weight * b * d;
+  m[7] += weight * c * c;
+  m[8] += weight * c * d;
+  m[9] += weight * d * d;
+}
+
+double Evaluate(const double* m, double x, double y, double z) {
+  return m[0] * x * x + 2.0 * m[1] * x * y + 2.0 * m[2] * x * z +
+         2.0 * m[3] * x + m[4] * y * y + 2.0 * m[5] * y * z + 2.0 * m[6] * y +
+         m[7] * z * z + 2.0 * m[8] * z + m[9];
+}
+
+// Solves for the point minimizing the quadric. Returns false when the system
+// is ill-conditioned (flat or linear neighbourhoods).
+bool Minimize(const double* m, double* out) {
+  double a00 = m[0], a01 = m[1], a02 = m[2];
+  double a11 = m[4], a12 = m[5], a22 = m[7];
+  double c00 = a11 * a22 - a12 * a12;
+  double c01 = a02 * a12 - a01 * a22;
+  double c02 = a01 * a12 - a02 * a11;
+  double det = a00 * c00 + a01 * c01 + a02 * c02;
+  if (fabs(det) < 1e-12) {
+    return false;
+  }
+  double c11 = a00 * a22 - a02 * a02;
+  double c12 = a01 * a02 - a00 * a12;
+  double c22 = a00 * a11 - a01 * a01;
+  double bx = -m[3], by = -m[6], bz = -m[8];
+  double inv = 1.0 / det;
+  out[0] = (c00 * bx + c01 * by + c02 * bz) * inv;
+  out[1] = (c01 * bx + c11 * by + c12 * bz) * inv;
+  out[2] = (c02 * bx + c12 * by + c22 * bz) * inv;
+  return true;
+}
+
+void FaceNormal(const float* p0, const float* p1, const float* p2,
+                double* n) {
+  double ux = p1[0] - p0[0], uy = p1[1] - p0[1], uz = p1[2] - p0[2];
+  double vx = p2[0] - p0[0], vy = p2[1] - p0[1], vz = p2[2] - p0[2];
+  n[0] = uy * vz - uz * vy;
+  n[1] = uz * vx - ux * vz;
+  n[2] = ux * vy - uy * vx;
+}
+}  // namespace
+
+MeshDecimator::MeshDecimator(const MeshData& mesh)
+    : positions_(mesh.vertices),
+      colors_(mesh.colors),
+      faces_(mesh.faces),
+      face_alive_(mesh.GetFaceCount(), true),
+      vertex_alive_(mesh.GetVertexCount(), false),
+      vertex_locked_(mesh.GetVertexCount(), false),
+      vertex_version_(mesh.GetVertexCount(), 0),
+      vertex_faces_(mesh.GetVertexCount()),
+      face_count_(mesh.GetFaceCount()),
+      vertex_count_(0),
+      max_error_(0.0) {
+  const size_t num_vertices = mesh.GetVertexCount();
+  for (size_t f = 0; f < face_count_; ++f) {
+    const uint32_t* face = &faces_[f * 3];
+    if (face[0] >= num_vertices || face[1] >= num_vertices ||
+        face[2] >= num_vertices || face[0] == face[1] ||
+        face[1] == face[2] || face[0] == face[2]) {
+      face_alive_[f] = false;
+      continue;
+    }
+    for (int k = 0; k < 3; ++k) {
+      vertex_faces_[face[k]].push_back(static_cast<uint32_t>(f));
+      vertex_alive_[face[k]] = true;
+    }
+  }
+  face_count_ = std::count(face_alive_.begin(), face_alive_.end(), true);
+  vertex_count_ = std::count(vertex_alive_.begin(), vertex_alive_.end(), true);
+
+  ComputeQuadrics();
+  LockBorders();
+
+  std::vector<std::pair<uint32_t, uint32_t> > edges;
+  edges.reserve(face_count_ * 3);
+  for (size_t f = 0; f < face_alive_.size(); ++f) {
+    if (!face_alive_[f]) {
+      continue;
+    }
+    const uint32_t* face = &faces_[f * 3];
+    for (int k = 0; k < 3; ++k) {
+      uint32_t a = face[k], b = face[(k + 1) % 3];
+      edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+  for (size_t i = 0; i < edges.size(); ++i) {
+    PushCollapse(edges[i].first, edges[i].second);
+  }
+}
+
+void MeshDecimator::ComputeQuadrics() {
+  Quadric zero = {};
+  quadrics_.assign(vertex_alive_.size(), zero);
+  for (size_t f = 0; f < face_alive_.size(); ++f) {
+    if (!face_alive_[f]) {
+      continue;
+    }
+    const uint32_t* face = &faces_[f * 3];
+    const float* p0 = &positions_[face[0] * 3];
+    double n[3];
+    FaceNormal(p0, &positions_[face[1] * 3], &positions_[face[2] * 3], n);
+    double length = sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+    if (length <= 0.0) {
+      continue;
+    }
+    // Area weighting keeps large flat regions from being dominated by slivers.
+    double area = 0.5 * length;
+    n[0] /= length;
+    n[1] /= length;
+    n[2] /= length;
+    double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+    for (int k = 0; k < 3; ++k) {
+      AddPlane(n[0], n[1], n[2], d, area, quadrics_[face[k]].m);
+      quadrics_[face[k]].weight += area;
+    }
+  }
+}
+
+void MeshDecimator::LockBorders() {
+  // An edge used by exactly one face is a border; more than two is
+  // non-manifold. Either way its vertices stay where they are.
+  std::vector<std::pair<uint32_t, uint32_t> > edges;
+  edges.reserve(face_count_ * 3);
+  for (size_t f = 0; f < face_alive_.size(); ++f) {
+    if (!face_alive_[f]) {
+      continue;
+    }
+    const uint32_t* face = &faces_[f * 3];
+    for (int k = 0; k < 3; ++k) {
+      uint32_t a = face[k], b = face[(k + 1) % 3];
+      edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+  size_t i = 0;
+  while (i < edges.size()) {
+    size_t j = i + 1;
+    while (j < edges.size() && edges[j] == edges[i]) {
+      ++j;
+    }
+    if (j - i != 2) {
+      vertex_locked_[edges[i].first] = true;
+      vertex_locked_[edges[i].second] = true;
+    }
+    i = j;
+  }
+}
+
+void MeshDecimator::PushCollapse(uint32_t a, uint32_t b) {
+  if (vertex_locked_[a] && vertex_locked_[b]) {
+    return;
+  }
+  if (vertex_locked_[a]) {
+    std::swap(a, b);
+  }
+  // From here on b is the vertex that survives. If it is locked, a collapses
+  // onto it without moving it.
+  const double weight = quadrics_[a].weight + quadrics_[b].weight;
+  const double scale = weight > 0.0 ? 1.0 / weight : 0.0;
+  double q[10];
+  for (int i = 0; i < 10; ++i) {
+    q[i] = (quadrics_[a].m[i] + quadrics_[b].m[i]) * scale;
+  }
+  const float* pa = &positions_[a * 3];
+  const float* pb = &positions_[b * 3];
+
+  double best[3] = {pb[0], pb[1], pb[2]};
+  double best_cost = Evaluate(q, best[0], best[1], best[2]);
+  if (!vertex_locked_[b]) {
+    double candidates[3][3] = {
+        {pa[0], pa[1], pa[2]},
+        {0.5 * (pa[0] + pb[0]), 0.5 * (pa[1] + pb[1]), 0.5 * (pa[2] + pb[2])},
+        {0.0, 0.0, 0.0}};
+    int num_candidates = 2;
+    double optimal[3];
+    if (Minimize(q, optimal)) {
+      // Reject optima that drift far from the edge; they come from nearly
+      // singular systems and produce spikes.
+      double ex = pb[0] - pa[0], ey = pb[1] - pa[1], ez = pb[2] - pa[2];
+      double mx = optimal[0] - candidates[1][0];
+      double my = optimal[1] - candidates[1][1];
+      double mz = optimal[2] - candidates[1][2];
+      if (mx * mx + my * my + mz * mz <= ex * ex + ey * ey + ez * ez) {
+        candidates[2][0] = optimal[0];
+        candidates[2][1] = optimal[1];
+        candidates[2][2] = optimal[2];
+        num_candidates = 3;
+      }
+    }
+    for (int i = 0; i < num_candidates; ++i) {
+      double cost = Evaluate(q, candidates[i][0], candidates[i][1],
+                             candidates[i][2]);
+      if (cost < best_cost) {
+        best_cost = cost;
+        best[0] = candidates[i][0];
+        best[1] = candidates[i][1];
+        best[2] = candidates[i][2];
+      }
+    }
+  }
+
+  Collapse collapse;
+  collapse.cost = best_cost < 0.0 ? 0.0 : best_cost;
+  collapse.keep = b;
+  collapse.remove = a;
+  collapse.keep_version = vertex_version_[b];
+  collapse.remove_version = vertex_version_[a];
+  collapse.position[0] = static_cast<float>(best[0]);
+  collapse.position[1] = static_cast<float>(best[1]);
+  collapse.position[2] = static_cast<float>(best[2]);
+  heap_.push(collapse);
+}
+
+void MeshDecimator::GatherNeighbors(uint32_t v,
+                                    std::vector<uint32_t>* neighbors) const {
+  neighbors->clear();
+  const std::vector<uint32_t>& faces = vertex_faces_[v];
+  for (size_t i = 0; i < faces.size(); ++i) {
+    if (!face_alive_[faces[i]]) {
+      continue;
+    }
+    const uint32_t* face = &faces_[faces[i] * 3];
+    for (int k = 0; k < 3; ++k) {
+      if (face[k] != v) {
+        neighbors->push_back(face[k]);
+      }
+    }
+  }
+  std::sort(neighbors->begin(), neighbors->end());
+  neighbors->erase(std::unique(neighbors->begin(), neighbors->end()),
+                   neighbors->end());
+}
+
+bool MeshDecimator::IsLegal(const Collapse& collapse) {
+  const uint32_t keep = collapse.keep;
+  const uint32_t remove = collapse.remove;
+
+  // Link condition: the two one-rings may only share the two vertices
+  // opposite the collapsed edge, otherwise the result is non-manifold.
+  GatherNeighbors(keep, &scratch_a_);
+  GatherNeighbors(remove, &scratch_b_);
+  if (!std::binary_search(scratch_a_.begin(), scratch_a_.end(), remove)) {
+    return false;
+  }
+  size_t shared = 0;
+  for (size_t i = 0; i < scratch_b_.size(); ++i) {
+    if (std::binary_search(scratch_a_.begin(), scratch_a_.end(),
+                           scratch_b_[i])) {
+      ++shared;
+    }
+  }
+  if (shared > 2) {
+    return false;
+  }
+
+  // Reject collapses that fold a surviving face over.
+  const uint32_t ends[2] = {keep, remove};
+  for (int e = 0; e < 2; ++e) {
+    const std::vector<uint32_t>& faces = vertex_faces_[ends[e]];
+    for (size_t i = 0; i < faces.size(); ++i) {
+      if (!face_alive_[faces[i]]) {
+        continue;
+      }
+      const uint32_t* face = &faces_[faces[i] * 3];
+      if ((face[0] == keep || face[1] == keep || face[2] == keep) &&
+          (face[0] == remove || face[1] == remove || face[2] == remove)) {
+        continue;
+      }
+      const float* p[3];
+      const float* q[3];
+      for (int k = 0; k < 3; ++k) {
+        p[k] = &positions_[face[k] * 3];
+        q[k] = face[k] == ends[e] ? collapse.position : p[k];
+      }
+      double before[3], after[3];
+      FaceNormal(p[0], p[1], p[2], before);
+      FaceNormal(q[0], q[1], q[2], after);
+      double dot = before[0] * after[0] + before[1] * after[1] +
+                   before[2] * after[2];
+      double lengths =
+          sqrt((before[0] * before[0] + before[1] * before[1] +
+                before[2] * before[2]) *
+               (after[0] * after[0] + after[1] * after[1] +
+                after[2] * after[2]));
+      if (lengths <= 0.0 || dot < kMinNormalDot * lengths) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void MeshDecimator::Apply(const Collapse& collapse) {
+  const uint32_t keep = collapse.keep;
+  const uint32_t remove = collapse.remove;
+
+  positions_[keep * 3 + 0] = collapse.position[0];
+  positions_[keep * 3 + 1] = collapse.position[1];
+  positions_[keep * 3 + 2] = collapse.position[2];
+  for (int i = 0; i < 10; ++i) {
+    quadrics_[keep].m[i] += quadrics_[remove].m[i];
+  }
+  quadrics_[keep].weight += quadrics_[remove].weight;
+
+  std::vector<uint32_t>& keep_faces = vertex_faces_[keep];
+  std::vector<uint32_t>& remove_faces = vertex_faces_[remove];
+  for (size_t i = 0; i < remove_faces.size(); ++i) {
+    uint32_t f = remove_faces[i];
+    if (!face_alive_[f]) {
+      continue;
+    }
+    uint32_t* face = &faces_[f * 3];
+    if (face[0] == keep || face[1] == keep || face[2] == keep) {
+      face_alive_[f] = false;
+      --face_count_;
+      continue;
+    }
+    for (int k = 0; k < 3; ++k) {
+      if (face[k] == remove) {
+        face[k] = keep;
+      }
+    }
+    keep_faces.push_back(f);
+  }
+  std::vector<uint32_t>().swap(remove_faces);
+
+  // Drop faces killed by this collapse from the surviving vertex's list.
+  size_t live = 0;
+  for (size_t i = 0; i < keep_faces.size(); ++i) {
+    if (face_alive_[keep_faces[i]]) {
+      keep_faces[live++] = keep_faces[i];
+    }
+  }
+  keep_faces.resize(live);
+
+  vertex_alive_[remove] = false;
+  --vertex_count_;
+  ++vertex_version_[keep];
+  ++vertex_version_[remove];
+  if (collapse.cost > max_error_) {
+    max_error_ = collapse.cost;
+  }
+
+  // Every edge around the surviving vertex changed cost. Bumping its version
+  // above already invalidated the old heap entries, so re-queue them all.
+  GatherNeighbors(keep, &scratch_a_);
+  for (size_t i = 0; i < scratch_a_.size(); ++i) {
+    PushCollapse(keep, scratch_a_[i]);
+  }
+}
+
+bool MeshDecimator::Simplify(size_t target_faces, size_t max_vertices,
+                             double max_error) {
+  while ((face_count_ > target_faces || vertex_count_ > max_vertices) &&
+         !heap_.empty()) {
+    Collapse collapse = heap_.top();
+    if (collapse.cost > max_error) {
+      break;
+    }
+    heap_.pop();
+    if (!vertex_alive_[collapse.keep] || !vertex_alive_[collapse.remove] ||
+        vertex_version_[collapse.keep] != collapse.keep_version ||
+        vertex_version_[collapse.remove] != collapse.remove_version) {
+      continue;
+    }
+    if (!IsLegal(collapse)) {
+      continue;
+    }
+    Apply(collapse);
+  }
+  return face_count_ <= target_faces && vertex_count_ <= max_vertices;
+}
+
+void MeshDecimator::Extract(MeshData* mesh) const {
+  const uint32_t kUnused = 0xffffffffu;
+  std::vector<uint32_t> remap(vertex_alive_.size(), kUnused);
+
+  mesh->vertices.clear();
+  mesh->colors.clear();
+  mesh->faces.clear();
+  mesh->vertices.reserve(vertex_count_ * 3);
+  mesh->faces.reserve(face_count_ * 3);
+  if (!colors_.empty()) {
+    mesh->colors.reserve(vertex_count_ * 4);
+  }
+
+  uint32_t next = 0;
+  for (size_t f = 0; f < face_alive_.size(); ++f) {
+    if (!face_alive_[f]) {
+      continue;
+    }
+    for (int k = 0; k < 3; ++k) {
+      uint32_t v = faces_[f * 3 + k];
+      if (remap[v] == kUnused) {
+        remap[v] = next++;
+        mesh->vertices.insert(mesh->vertices.end(), &positions_[v * 3],
+                              &positions_[v * 3] + 3);
+        if (!colors_.empty()) {
+          mesh->colors.insert(mesh->colors.end(), &colors_[v * 4],
+                              &colors_[v * 4] + 4);
+        }
+      }
+      mesh->faces.push_back(remap[v]);
+    }
+  }
+
+  // Area-weighted vertex normals; the input normals no longer describe the
+  // simplified surface.
+  mesh->normals.assign(mesh->vertices.size(), 0.0f);
+  for (size_t i = 0; i < mesh->faces.size(); i += 3) {
+    const uint32_t* face = &mesh->faces[i];
+    double n[3];
+    FaceNormal(&mesh->vertices[face[0] * 3], &mesh->vertices[face[1] * 3],
+               &mesh->vertices[face[2] * 3], n);
+    for (int k = 0; k < 3; ++k) {
+      float* normal = &mesh->normals[face[k] * 3];
+      normal[0] += static_cast<float>(n[0]);
+      normal[1] += static_cast<float>(n[1]);
+      normal[2] += static_cast<float>(n[2]);
+    }
+  }
+  for (size_t i = 0; i < mesh->normals.size(); i += 3) {
+    float* normal = &mesh->normals[i];
+    float length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] +
+                         normal[2] * normal[2]);
+    if (length > 0.0f) {
+      normal[0] /= length;
+      normal[1] /= length;
+      normal[2] /= length;
+    }
+  }
+}
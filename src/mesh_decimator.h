@@ -0,0 +1,87 @@
+#ifndef CINDER_TANGO_MESH_DECIMATOR_H_
+#define CINDER_TANGO_MESH_DECIMATOR_H_
+
+#include <stdint.h>
+#include <queue>
+#include <vector>
+
+#include "mesh_data.h"
+
+// Edge-collapse simplification driven by quadric error metrics (Garland and
+// Heckbert, "Surface Simplification Using Quadric Error Metrics").
+//
+// The decimator is progressive: Simplify() can be called repeatedly with
+// decreasing targets and Extract() snapshots the current state in between,
+// so a chain of LOD levels costs about as much as producing the coarsest one.
+//
+// Boundary and non-manifold edges are never collapsed, so the open borders of
+// neighbouring reconstruction cells keep matching at every level.
+class MeshDecimator {
+ public:
+  explicit MeshDecimator(const MeshData& mesh);
+  MeshDecimator(const MeshDecimator& other) = delete;
+  MeshDecimator& operator=(const MeshDecimator&) = delete;
+
+  // Collapses edges until at most target_faces faces and max_vertices
+  // vertices remain, or until no legal collapse costs less than max_error.
+  // Returns true if both limits were reached.
+  bool Simplify(size_t target_faces, size_t max_vertices, double max_error);
+
+  // Writes the current mesh with compacted vertices and recomputed normals.
+  void Extract(MeshData* mesh) const;
+
+  size_t GetFaceCount() const { return face_count_; }
+  size_t GetVertexCount() const { return vertex_count_; }
+
+  // Largest quadric error accepted so far, in squared meters.
+  double GetMaxError() const { return max_error_; }
+
+ private:
+  // Area-weighted sum of the planes of the faces around a vertex, and the
+  // total area. Dividing by weight turns the sum into the mean squared
+  // distance to those planes, which keeps costs in squared meters however
+  // large the faces are.
+  struct Quadric {
+    double m[10];
+    double weight;
+  };
+
+  struct Collapse {
+    double cost;
+    uint32_t keep;
+    uint32_t remove;
+    uint32_t keep_version;
+    uint32_t remove_version;
+    float position[3];
+
+    bool operator<(const Collapse& other) const { return cost > other.cost; }
+  };
+
+  void ComputeQuadrics();
+  void LockBorders();
+  void PushCollapse(uint32_t a, uint32_t b);
+  bool IsLegal(const Collapse& collapse);
+  void Apply(const Collapse& collapse);
+  void GatherNeighbors(uint32_t v, std::vector<uint32_t>* neighbors) const;
+
+  std::vector<float> positions_;
+  std::vector<uint8_t> colors_;
+  std::vector<uint32_t> faces_;
+  std::vector<bool> face_alive_;
+  std::vector<bool> vertex_alive_;
+  std::vector<bool> vertex_locked_;
+  std::vector<uint32_t> vertex_version_;
+  std::vector<std::vector<uint32_t> > vertex_faces_;
+  std::vector<Quadric> quadrics_;
+  std::priority_queue<Collapse> heap_;
+
+  size_t face_count_;
+  size_t vertex_count_;
+  double max_error_;
+
+  // Scratch storage reused across collapses.
+  std::vector<uint32_t> scratch_a_;
+  std::vector<uint32_t> scratch_b_;
+};
+
+#endif  // CINDER_TANGO_MESH_DECIMATOR_H_
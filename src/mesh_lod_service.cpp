@@ -0,0 +1,266 @@
+#include "mesh_lod_service.h"
+
+#include <math.h>
+#include <algorithm>
+
+#include "cinder/Log.h"
+#include "mesh_decimator.h"
+
+namespace {
+// GLushort indices address at most this many vertices.
+const size_t kMaxLevelVertices = 65535;
+
+void ToLodLevel(const MeshData& mesh, double error, MeshLodLevel* level) {
+  level->vertices.assign(mesh.vertices.begin(), mesh.vertices.end());
+  level->normals.assign(mesh.normals.begin(), mesh.normals.end());
+  level->indices.resize(mesh.faces.size());
+  for (size_t i = 0; i < mesh.faces.size(); ++i) {
+    level->indices[i] = static_cast<GLushort>(mesh.faces[i]);
+  }
+  level->error = error;
+}
+}  // namespace
+
+MeshLodService::Options::Options()
+    : hysteresis(0.1f), max_error(0.05 * 0.05) {
+  level_ratios.push_back(1.0f);
+  level_ratios.push_back(0.25f);
+  level_ratios.push_back(0.08f);
+  level_ratios.push_back(0.02f);
+  level_distances.push_back(2.0f);
+  level_distances.push_back(5.0f);
+  level_distances.push_back(12.0f);
+}
+
+MeshLodService::MeshLodService(WorkerPool* pool, const Options& options)
+    : pool_(pool),
+      options_(options),
+      next_generation_(1),
+      pending_jobs_(0),
+      shutting_down_(false) {
+  pthread_mutex_init(&mutex_, nullptr);
+  pthread_cond_init(&done_cond_, nullptr);
+}
+
+MeshLodService::~MeshLodService() {
+  pthread_mutex_lock(&mutex_);
+  shutting_down_ = true;
+  while (pending_jobs_ > 0) {
+    pthread_cond_wait(&done_cond_, &mutex_);
+  }
+  pthread_mutex_unlock(&mutex_);
+  pthread_cond_destroy(&done_cond_);
+  pthread_mutex_destroy(&mutex_);
+}
+
+void MeshLodService::OnMeshSegments(int num_meshes,
+                                    const TangoMesh_Experimental* segments) {
+  for (int i = 0; i < num_meshes; ++i) {
+    std::shared_ptr<MeshData> mesh(new MeshData());
+    MeshDataFromTango(segments[i], mesh.get());
+    Submit(segments[i].index, mesh);
+  }
+}
+
+void MeshLodService::Submit(const int32_t index[3],
+                            std::shared_ptr<const MeshData> mesh) {
+  const uint64_t key = MeshCellKey(index);
+  pthread_mutex_lock(&mutex_);
+  if (shutting_down_) {
+    pthread_mutex_unlock(&mutex_);
+    return;
+  }
+  const uint64_t generation = next_generation_++;
+  latest_generation_[key] = generation;
+  sources_[key] = mesh;
+  ++pending_jobs_;
+  pthread_mutex_unlock(&mutex_);
+
+  int32_t cell[3] = {index[0], index[1], index[2]};
+  const bool queued = pool_->Enqueue([this, key, generation, cell, mesh]() {
+    Build(key, generation, cell, mesh);
+    pthread_mutex_lock(&mutex_);
+    --pending_jobs_;
+    pthread_cond_broadcast(&done_cond_);
+    pthread_mutex_unlock(&mutex_);
+  });
+  if (!queued) {
+    pthread_mutex_lock(&mutex_);
+    --pending_jobs_;
+    pthread_cond_broadcast(&done_cond_);
+    pthread_mutex_unlock(&mutex_);
+  }
+}
+
+bool MeshLodService::IsCurrent(uint64_t key, uint64_t generation) const {
+  pthread_mutex_lock(&mutex_);
+  std::map<uint64_t, uint64_t>::const_iterator it =
+      latest_generation_.find(key);
+  bool current = !shutting_down_ && it != latest_generation_.end() &&
+                 it->second == generation;
+  pthread_mutex_unlock(&mutex_);
+  return current;
+}
+
+void MeshLodService::Build(uint64_t key, uint64_t generation,
+                           const int32_t index[3],
+                           std::shared_ptr<const MeshData> mesh) {
+  if (!IsCurrent(key, generation)) {
+    return;
+  }
+  if (mesh->GetFaceCount() == 0) {
+    // The cell was emptied; its old chain must not stay on screen.
+    Publish(key, generation, nullptr);
+    return;
+  }
+
+  std::shared_ptr<MeshLodChain> chain(new MeshLodChain());
+  chain->index[0] = index[0];
+  chain->index[1] = index[1];
+  chain->index[2] = index[2];
+  chain->generation = generation;
+
+  glm::vec3 lower(mesh->vertices[0], mesh->vertices[1], mesh->vertices[2]);
+  glm::vec3 upper = lower;
+  for (size_t i = 3; i < mesh->vertices.size(); i += 3) {
+    glm::vec3 p(mesh->vertices[i], mesh->vertices[i + 1],
+                mesh->vertices[i + 2]);
+    lower = glm::min(lower, p);
+    upper = glm::max(upper, p);
+  }
+  chain->center = (lower + upper) * 0.5f;
+  chain->radius = glm::length(upper - lower) * 0.5f;
+
+  MeshDecimator decimator(*mesh);
+  const size_t source_faces = mesh->GetFaceCount();
+  MeshData simplified;
+  for (size_t i = 0; i < options_.level_ratios.size(); ++i) {
+    size_t target = static_cast<size_t>(source_faces *
+                                        options_.level_ratios[i]);
+    decimator.Simplify(std::max<size_t>(target, 1), kMaxLevelVertices,
+                       options_.max_error);
+    if (decimator.GetVertexCount() > kMaxLevelVertices) {
+      // Too dense to index with GLushort even after the allowed error; try
+      // the next, coarser ratio.
+      continue;
+    }
+    if (!chain->levels.empty() &&
+        chain->levels.back().indices.size() / 3 == decimator.GetFaceCount()) {
+      // The error budget stopped simplification; another level would be a
+      // duplicate.
+      break;
+    }
+    decimator.Extract(&simplified);
+    chain->levels.push_back(MeshLodLevel());
+    ToLodLevel(simplified, decimator.GetMaxError(), &chain->levels.back());
+
+    if (!IsCurrent(key, generation)) {
+      return;
+    }
+  }
+
+  if (chain->levels.empty()) {
+    CI_LOG_E("MeshLodService: cell " << index[0] << "," << index[1] << ","
+             << index[2] << " has too many vertices for 16-bit indices");
+    // The previous chain belongs to geometry that has been replaced.
+    Publish(key, generation, nullptr);
+    return;
+  }
+  Publish(key, generation, chain);
+}
+
+void MeshLodService::Publish(uint64_t key, uint64_t generation,
+                             std::shared_ptr<const MeshLodChain> chain) {
+  pthread_mutex_lock(&mutex_);
+  std::map<uint64_t, uint64_t>::const_iterator it =
+      latest_generation_.find(key);
+  if (it != latest_generation_.end() && it->second == generation) {
+    if (chain) {
+      chains_[key] = chain;
+    } else {
+      chains_.erase(key);
+    }
+  }
+  pthread_mutex_unlock(&mutex_);
+}
+
+int MeshLodService::ChooseLevel(int current, int num_levels,
+                                float distance) const {
+  const std::vector<float>& distances = options_.level_distances;
+  const int num_thresholds = static_cast<int>(distances.size());
+  int level = std::min(std::max(current, 0), num_levels - 1);
+  while (level + 1 < num_levels && level < num_thresholds &&
+         distance > distances[level] * (1.0f + options_.hysteresis)) {
+    ++level;
+  }
+  while (level > 0 && level - 1 < num_thresholds &&
+         distance < distances[level - 1] * (1.0f - options_.hysteresis)) {
+    --level;
+  }
+  return level;
+}
+
+void MeshLodService::SelectLevels(const glm::vec3& camera_position,
+                                  std::vector<Selection>* selections) {
+  selections->clear();
+  pthread_mutex_lock(&mutex_);
+  selections->reserve(chains_.size());
+  for (std::map<uint64_t, std::shared_ptr<const MeshLodChain> >::const_iterator
+           it = chains_.begin();
+       it != chains_.end(); ++it) {
+    Selection selection;
+    selection.chain = it->second;
+    selections->push_back(selection);
+  }
+  pthread_mutex_unlock(&mutex_);
+
+  std::map<uint64_t, Displayed> displayed;
+  for (size_t i = 0; i < selections->size(); ++i) {
+    Selection& selection = (*selections)[i];
+    const MeshLodChain& chain = *selection.chain;
+    const uint64_t key = MeshCellKey(chain.index);
+    float distance = std::max(
+        glm::length(chain.center - camera_position) - chain.radius, 0.0f);
+
+    std::map<uint64_t, Displayed>::const_iterator previous =
+        displayed_.find(key);
+    int current = previous != displayed_.end() ? previous->second.level : 0;
+    selection.level =
+        ChooseLevel(current, static_cast<int>(chain.levels.size()), distance);
+    selection.changed = previous == displayed_.end() ||
+                        previous->second.generation != chain.generation ||
+                        previous->second.level != selection.level;
+
+    Displayed state = {chain.generation, selection.level};
+    displayed[key] = state;
+  }
+  // Cells that were cleared are forgotten here.
+  displayed_.swap(displayed);
+}
+
+void MeshLodService::GetSourceMeshes(
+    std::vector<std::shared_ptr<const MeshData> >* meshes) const {
+  pthread_mutex_lock(&mutex_);
+  meshes->reserve(meshes->size() + sources_.size());
+  for (std::map<uint64_t, std::shared_ptr<const MeshData> >::const_iterator
+           it = sources_.begin();
+       it != sources_.end(); ++it) {
+    meshes->push_back(it->second);
+  }
+  pthread_mutex_unlock(&mutex_);
+}
+
+void MeshLodService::Clear() {
+  pthread_mutex_lock(&mutex_);
+  chains_.clear();
+  sources_.clear();
+  latest_generation_.clear();
+  pthread_mutex_unlock(&mutex_);
+}
+
+size_t MeshLodService::GetPendingJobCount() const {
+  pthread_mutex_lock(&mutex_);
+  size_t pending = pending_jobs_;
+  pthread_mutex_unlock(&mutex_);
+  return pending;
+}
@@ -0,0 +1,138 @@
+#ifndef CINDER_TANGO_MESH_LOD_SERVICE_H_
+#define CINDER_TANGO_MESH_LOD_SERVICE_H_
+
+#include <pthread.h>
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <tango_client_api.h>
+
+#include "cinder/gl/gl.h"
+#include "mesh_data.h"
+#include "worker_pool.h"
+
+// One simplified version of a reconstruction cell, laid out for
+// DrawableObject::SetVertices(vertices, indices). Every level has at most
+// 65535 vertices so it fits the GLushort index buffer.
+struct MeshLodLevel {
+  std::vector<GLfloat> vertices;
+  std::vector<GLfloat> normals;
+  std::vector<GLushort> indices;
+  // Largest quadric error accepted while producing this level, in m^2.
+  double error;
+};
+
+// All levels of one cell, finest first. Chains are immutable once published;
+// a new submission for the same cell publishes a new chain.
+struct MeshLodChain {
+  int32_t index[3];
+  glm::vec3 center;
+  float radius;
+  uint64_t generation;
+  std::vector<MeshLodLevel> levels;
+};
+
+// Builds LOD chains for reconstruction cells on a WorkerPool and hands them to
+// the render thread.
+//
+// Submissions can come from any thread, typically the
+// TangoService_Experimental_connectOnMeshVectorAvailable callback. Results
+// are swapped in under a short lock that only exchanges shared_ptrs, so a
+// chain being drawn stays alive until the renderer drops its reference.
+//
+//  MeshLodService lods(&pool, MeshLodService::Options());
+//  // Mesh callback thread:
+//  lods.OnMeshSegments(num_meshes, mesh_segments);
+//  // Render thread, camera position in the mesh frame:
+//  lods.SelectLevels(camera_position, &selections);
+//  for (...) {
+//    if (selection.changed) {
+//      const MeshLodLevel& lod = selection.chain->levels[selection.level];
+//      mesh->SetVertices(lod.vertices, lod.indices);
+//    }
+//  }
+class MeshLodService {
+ public:
+  struct Options {
+    Options();
+    // Fraction of the source faces kept at each level, finest first.
+    std::vector<float> level_ratios;
+    // Camera distance in meters beyond which level i + 1 replaces level i.
+    std::vector<float> level_distances;
+    // Fraction of a switch distance the camera has to cross before switching
+    // back, so levels do not flicker at the threshold.
+    float hysteresis;
+    // Collapses above this quadric error are never taken, in m^2.
+    double max_error;
+  };
+
+  struct Selection {
+    std::shared_ptr<const MeshLodChain> chain;
+    int level;
+    // True when level or chain differ from the previous SelectLevels call.
+    bool changed;
+  };
+
+  MeshLodService(WorkerPool* pool, const Options& options);
+  MeshLodService(const MeshLodService& other) = delete;
+  MeshLodService& operator=(const MeshLodService&) = delete;
+  // Waits for in-flight jobs. Jobs that have not started are skipped. The
+  // pool must outlive the service.
+  ~MeshLodService();
+
+  // Copies the segments out of the service buffers and queues them.
+  void OnMeshSegments(int num_meshes, const TangoMesh_Experimental* segments);
+
+  // Queues a cell for simplification. A newer submission for the same cell
+  // supersedes queued or running work for it.
+  void Submit(const int32_t index[3], std::shared_ptr<const MeshData> mesh);
+
+  // Render thread only. Picks a level for every published cell from the
+  // distance between camera_position and the cell's bounding sphere.
+  void SelectLevels(const glm::vec3& camera_position,
+                    std::vector<Selection>* selections);
+
+  // Appends the latest full-resolution mesh of every cell. The meshes are
+  // shared, not copied, so this is cheap enough to call from the render
+  // thread when starting an export.
+  void GetSourceMeshes(
+      std::vector<std::shared_ptr<const MeshData> >* meshes) const;
+
+  // Drops all published chains and invalidates queued work.
+  void Clear();
+
+  size_t GetPendingJobCount() const;
+
+ private:
+  void Build(uint64_t key, uint64_t generation, const int32_t index[3],
+             std::shared_ptr<const MeshData> mesh);
+  bool IsCurrent(uint64_t key, uint64_t generation) const;
+  // Makes chain the one drawn for key if generation is still the latest;
+  // a null chain removes the cell.
+  void Publish(uint64_t key, uint64_t generation,
+               std::shared_ptr<const MeshLodChain> chain);
+  int ChooseLevel(int current, int num_levels, float distance) const;
+
+  WorkerPool* pool_;
+  Options options_;
+
+  mutable pthread_mutex_t mutex_;
+  pthread_cond_t done_cond_;
+  std::map<uint64_t, uint64_t> latest_generation_;
+  std::map<uint64_t, std::shared_ptr<const MeshLodChain> > chains_;
+  std::map<uint64_t, std::shared_ptr<const MeshData> > sources_;
+  uint64_t next_generation_;
+  size_t pending_jobs_;
+  bool shutting_down_;
+
+  // Owned by the render thread.
+  struct Displayed {
+    uint64_t generation;
+    int level;
+  };
+  std::map<uint64_t, Displayed> displayed_;
+};
+
+#endif  // CINDER_TANGO_MESH_LOD_SERVICE_H_
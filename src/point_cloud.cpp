@@ -0,0 +1,25 @@
+#include "point_cloud.h"
+
+void PointCloudFromTango(const TangoXYZij& xyz_ij, PointCloudData* cloud) {
+  const float* points = reinterpret_cast<const float*>(xyz_ij.xyz);
+  cloud->timestamp = xyz_ij.timestamp;
+  cloud->points.assign(points, points + xyz_ij.xyz_count * 3);
+}
+
+void TransformPointCloud(const glm::mat4& transform, PointCloudData* cloud) {
+  // Note glm is column-wise.
+  const float r00 = transform[0][0], r10 = transform[0][1],
+              r20 = transform[0][2];
+  const float r01 = transform[1][0], r11 = transform[1][1],
+              r21 = transform[1][2];
+  const float r02 = transform[2][0], r12 = transform[2][1],
+              r22 = transform[2][2];
+  const float tx = transform[3][0], ty = transform[3][1], tz = transform[3][2];
+  std::vector<float>& points = cloud->points;
+  for (size_t i = 0; i + 2 < points.size(); i += 3) {
+    const float x = points[i], y = points[i + 1], z = points[i + 2];
+    points[i] = r00 * x + r01 * y + r02 * z + tx;
+    points[i + 1] = r10 * x + r11 * y + r12 * z + ty;
+    points[i + 2] = r20 * x + r21 * y + r22 * z + tz;
+  }
+}
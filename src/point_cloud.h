@@ -0,0 +1,32 @@
+#ifndef CINDER_TANGO_POINT_CLOUD_H_
+#define CINDER_TANGO_POINT_CLOUD_H_
+
+#define GLM_FORCE_RADIANS
+
+#include <vector>
+
+#include <tango_client_api.h>
+
+#include "glm/glm.hpp"
+
+// CPU copy of one depth callback. Points are packed {x, y, z} triplets in
+// meters, expressed in whatever frame the producer says (the depth camera
+// frame straight out of TangoXYZij).
+struct PointCloudData {
+  PointCloudData() : timestamp(0.0) {}
+
+  double timestamp;
+  std::vector<float> points;
+
+  size_t GetPointCount() const { return points.size() / 3; }
+};
+
+// Copies the xyz array out of the service buffer. The TangoXYZij pointers
+// are only valid for the duration of the depth callback.
+void PointCloudFromTango(const TangoXYZij& xyz_ij, PointCloudData* cloud);
+
+// Re-expresses every point as transform * point, e.g. with ss_T_depth to move
+// a cloud into the start-of-service frame before merging it with others.
+void TransformPointCloud(const glm::mat4& transform, PointCloudData* cloud);
+
+#endif  // CINDER_TANGO_POINT_CLOUD_H_
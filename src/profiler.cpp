@@ -0,0 +1,167 @@
+#include "profiler.h"
+
+#if CINDER_TANGO_PROFILE
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <algorithm>
+
+#include "trace_exporter.h"
+
+Profiler::Profiler()
+    : rings_(kRingSize, OnNewThread),
+      stage_count_(0),
+      window_frame_(0),
+      window_size_(0),
+      last_frame_end_ns_(0),
+      named_trace_(0) {
+  pthread_mutex_init(&mutex_, nullptr);
+  memset(window_, 0, sizeof(window_));
+  memset(frame_ns_, 0, sizeof(frame_ns_));
+  stats_.frame_average_ms = 0.0;
+  stats_.frame_max_ms = 0.0;
+  stats_.frames = 0;
+  stats_.dropped = 0;
+}
+
+int Profiler::RegisterStage(const char* name) {
+  pthread_mutex_lock(&mutex_);
+  const int count = stage_count_.load();
+  int stage = 0;
+  while (stage < count && strcmp(stage_names_[stage], name) != 0) {
+    ++stage;
+  }
+  if (stage == count) {
+    if (count < kMaxStages) {
+      stage_names_[count] = name;
+      stage_count_.store(count + 1);
+    } else {
+      stage = -1;
+    }
+  }
+  pthread_mutex_unlock(&mutex_);
+  return stage;
+}
+
+void Profiler::OnNewThread(int) {
+  char name[17] = {0};
+  prctl(PR_GET_NAME, name);
+  Event event;
+  event.begin_ns = NowNs();
+  event.end_ns = event.begin_ns;
+  event.stage = kThreadName;
+  event.name = strdup(name);
+  event.value = 0.0;
+  // The ring is new and empty.
+  GetInstance().Push(event);
+}
+
+void Profiler::EndFrame() {
+  const int64_t now = NowNs();
+  FrameTotal* totals = window_[window_frame_];
+  memset(totals, 0, sizeof(window_[0]));
+
+  // Spans go to the frame in which they are drained, callback threads'
+  // included.
+  TraceExporter& trace = TraceExporter::GetInstance();
+  const bool tracing = trace.IsRecording();
+  // A new trace gets the names of the threads already running.
+  if (tracing && trace.GetTraceId() != named_trace_) {
+    for (const auto& thread : thread_names_) {
+      trace.AddThreadName(thread.first, thread.second.name.c_str());
+    }
+    named_trace_ = trace.GetTraceId();
+  }
+  auto consume = [&](int tid, const Event& event) {
+    if (event.stage == kThreadName) {
+      ThreadName& thread = thread_names_[tid];
+      thread.name = event.name;
+      ++thread.threads;
+      if (tracing) {
+        trace.AddThreadName(tid, event.name);
+      }
+      free(const_cast<char*>(event.name));
+      return;
+    }
+    if (event.stage == kCounter) {
+      if (tracing) {
+        trace.AddCounter(event.name, tid, event.begin_ns, event.value);
+      }
+      return;
+    }
+    ++totals[event.stage].calls;
+    totals[event.stage].total_ns += event.end_ns - event.begin_ns;
+    if (tracing) {
+      trace.AddSpan(stage_names_[event.stage], tid, event.begin_ns,
+                    event.end_ns);
+    }
+  };
+  rings_.Drain(consume, [this](int tid) {
+    std::map<int, ThreadName>::iterator thread = thread_names_.find(tid);
+    if (thread != thread_names_.end() && --thread->second.threads == 0) {
+      thread_names_.erase(thread);
+    }
+  });
+  frame_ns_[window_frame_] =
+      last_frame_end_ns_ > 0 ? now - last_frame_end_ns_ : 0;
+  if (tracing) {
+    trace.AddCounter("frame_ms", rings_.GetThreadId(), now,
+                     frame_ns_[window_frame_] / 1.0e6);
+  }
+  last_frame_end_ns_ = now;
+  window_size_ = std::min(window_size_ + 1, static_cast<int>(kWindowFrames));
+
+  const uint64_t dropped = rings_.GetDropped();
+  pthread_mutex_lock(&mutex_);
+  ++stats_.frames;
+  stats_.dropped = dropped;
+  UpdateStats();
+  pthread_mutex_unlock(&mutex_);
+  window_frame_ = (window_frame_ + 1) % kWindowFrames;
+}
+
+void Profiler::UpdateStats() {
+  const int stage_count = stage_count_.load();
+  stats_.stages.resize(stage_count);
+  int64_t frame_total_ns = 0;
+  int64_t frame_max_ns = 0;
+  int frame_count = 0;
+  for (int frame = 0; frame < window_size_; ++frame) {
+    if (frame_ns_[frame] > 0) {
+      frame_total_ns += frame_ns_[frame];
+      frame_max_ns = std::max(frame_max_ns, frame_ns_[frame]);
+      ++frame_count;
+    }
+  }
+  stats_.frame_average_ms =
+      frame_count > 0 ? frame_total_ns / 1.0e6 / frame_count : 0.0;
+  stats_.frame_max_ms = frame_max_ns / 1.0e6;
+
+  for (int stage = 0; stage < stage_count; ++stage) {
+    int64_t calls = 0;
+    int64_t total_ns = 0;
+    int64_t max_ns = 0;
+    for (int frame = 0; frame < window_size_; ++frame) {
+      const FrameTotal& total = window_[frame][stage];
+      calls += total.calls;
+      total_ns += total.total_ns;
+      max_ns = std::max(max_ns, total.total_ns);
+    }
+    StageStats& stats = stats_.stages[stage];
+    stats.name = stage_names_[stage];
+    stats.calls = static_cast<double>(calls) / window_size_;
+    stats.average_ms = total_ns / 1.0e6 / window_size_;
+    stats.max_ms = max_ns / 1.0e6;
+    stats.last_ms = window_[window_frame_][stage].total_ns / 1.0e6;
+  }
+}
+
+Profiler::Stats Profiler::GetStats() const {
+  pthread_mutex_lock(&mutex_);
+  const Stats stats = stats_;
+  pthread_mutex_unlock(&mutex_);
+  return stats;
+}
+
+#endif  // CINDER_TANGO_PROFILE
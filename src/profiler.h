@@ -0,0 +1,202 @@
+#ifndef CINDER_TANGO_PROFILER_H_
+#define CINDER_TANGO_PROFILER_H_
+
+// Scoped timing of the frame's stages. Build with -DCINDER_TANGO_PROFILE=1
+// (the debug build does); otherwise the macros expand to nothing and the
+// profiler is not compiled at all.
+//
+//  void CinderTango::UpdateColorTexture() {
+//    PROFILE_SCOPE("UpdateColorTexture");
+//    ...
+//  }
+//
+// A scope stamps its begin and end and, when it closes, pushes one span
+// into a ring owned by the calling thread: no locks, no allocation after
+// the thread's first span. Once a frame the render thread calls
+// PROFILE_END_FRAME, which drains every thread's ring and adds the spans
+// to the per-stage statistics. Scopes with the same name are one stage.
+//
+// PROFILE_COUNTER records a value against time the same way. Counters and
+// spans also go to the TraceExporter while it records.
+#ifndef CINDER_TANGO_PROFILE
+#define CINDER_TANGO_PROFILE 0
+#endif
+
+#if CINDER_TANGO_PROFILE
+
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "thread_rings.h"
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name)                                         \
+  static const int PROFILE_CONCAT(profile_stage_, __LINE__) =       \
+      Profiler::GetInstance().RegisterStage(name);                  \
+  Profiler::Scope PROFILE_CONCAT(profile_scope_, __LINE__)(         \
+      PROFILE_CONCAT(profile_stage_, __LINE__))
+#define PROFILE_COUNTER(name, value) \
+  Profiler::GetInstance().Count((name), (value))
+#define PROFILE_END_FRAME() Profiler::GetInstance().EndFrame()
+
+class Profiler {
+ public:
+  static const int kMaxStages = 32;
+  // Frames the statistics average over.
+  static const int kWindowFrames = 120;
+  // Spans and counter values a thread can hold between two EndFrame calls.
+  static const size_t kRingSize = 1024;
+
+  // One stage over the last kWindowFrames frames. Times are per frame: a
+  // stage that runs twice a frame adds both spans.
+  struct StageStats {
+    std::string name;
+    double calls;
+    double average_ms;
+    double max_ms;
+    double last_ms;
+  };
+
+  struct Stats {
+    // Frame to frame, EndFrame to EndFrame.
+    double frame_average_ms;
+    double frame_max_ms;
+    uint64_t frames;
+    // Spans and counter values lost to full rings.
+    uint64_t dropped;
+    std::vector<StageStats> stages;
+  };
+
+  class Scope {
+   public:
+    explicit Scope(int stage) : stage_(stage), begin_ns_(NowNs()) {}
+    ~Scope() { GetInstance().Record(stage_, begin_ns_, NowNs()); }
+    Scope(const Scope& other) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    const int stage_;
+    const int64_t begin_ns_;
+  };
+
+  static Profiler& GetInstance() {
+    static Profiler instance;
+    return instance;
+  }
+
+  Profiler(const Profiler& other) = delete;
+  Profiler& operator=(const Profiler&) = delete;
+
+  static int64_t NowNs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000000 + now.tv_nsec;
+  }
+
+  // Returns the index of the stage called name, adding it if needed; -1 once
+  // kMaxStages are in use. name must outlive the profiler.
+  int RegisterStage(const char* name);
+
+  void Record(int stage, int64_t begin_ns, int64_t end_ns) {
+    if (stage < 0) {
+      return;
+    }
+    Event event;
+    event.begin_ns = begin_ns;
+    event.end_ns = end_ns;
+    event.stage = stage;
+    event.name = nullptr;
+    event.value = 0.0;
+    Push(event);
+  }
+
+  // name must outlive the profiler; counters are only traced.
+  void Count(const char* name, double value) {
+    Event event;
+    event.begin_ns = NowNs();
+    event.end_ns = event.begin_ns;
+    event.stage = kCounter;
+    event.name = name;
+    event.value = value;
+    Push(event);
+  }
+
+  // Closes the frame. Must always be called from the same thread.
+  void EndFrame();
+
+  // Statistics as of the last EndFrame; any thread.
+  Stats GetStats() const;
+
+ private:
+  // Stage of a counter Event, and of the Event that OnNewThread queues
+  // first on every thread.
+  static const int kCounter = -1;
+  static const int kThreadName = -2;
+
+  struct Event {
+    int64_t begin_ns;
+    int64_t end_ns;
+    int stage;
+    // A counter's name, or for kThreadName the thread's, allocated by
+    // OnNewThread and freed by EndFrame.
+    const char* name;
+    double value;
+  };
+
+  // Kernel name of the threads with a ring under one tid; more than one
+  // when a tid was reused before the ended thread's ring was freed.
+  struct ThreadName {
+    ThreadName() : threads(0) {}
+    std::string name;
+    int threads;
+  };
+
+  // Per-frame totals of one stage; the window is a ring of these.
+  struct FrameTotal {
+    int calls;
+    int64_t total_ns;
+  };
+
+  Profiler();
+  ~Profiler() {}
+
+  // Queues the calling thread's name ahead of its first span.
+  static void OnNewThread(int tid);
+  void Push(const Event& event) { rings_.Push(event); }
+  // Recomputes stats_ from the window. Caller holds mutex_.
+  void UpdateStats();
+
+  ThreadRings<Event> rings_;
+  // Guards the stage names and stats_.
+  mutable pthread_mutex_t mutex_;
+  const char* stage_names_[kMaxStages];
+  std::atomic<int> stage_count_;
+  Stats stats_;
+
+  // EndFrame's thread only.
+  FrameTotal window_[kWindowFrames][kMaxStages];
+  int64_t frame_ns_[kWindowFrames];
+  int window_frame_;
+  int window_size_;
+  int64_t last_frame_end_ns_;
+  // Threads with a ring, by tid; their names go to each trace.
+  std::map<int, ThreadName> thread_names_;
+  // The trace that thread_names_ was last sent to.
+  uint32_t named_trace_;
+};
+
+#else
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_COUNTER(name, value)
+#define PROFILE_END_FRAME()
+
+#endif  // CINDER_TANGO_PROFILE
+
+#endif  // CINDER_TANGO_PROFILER_H_
@@ -0,0 +1,334 @@
+#include "sensor_synchronizer.h"
+
+#include <math.h>
+#include <algorithm>
+
+namespace {
+
+// Index of the item closest in time to timestamp, or -1 if there is none.
+template <typename T>
+int FindNearest(const std::deque<T>& items, double timestamp,
+                double* offset) {
+  int nearest = -1;
+  for (size_t i = 0; i < items.size(); ++i) {
+    const double distance = fabs(items[i]->timestamp - timestamp);
+    if (nearest < 0 || distance < *offset) {
+      nearest = static_cast<int>(i);
+      *offset = distance;
+    }
+  }
+  return nearest;
+}
+
+// Removes items that can no longer pair with anything at or after timestamp.
+template <typename T>
+void DropOlderThan(double timestamp, std::deque<T>* items) {
+  while (!items->empty() && items->front()->timestamp < timestamp) {
+    items->pop_front();
+  }
+}
+
+}  // namespace
+
+PoseHistory::PoseHistory(size_t capacity) : count_(0), newest_timestamp_(-1.0) {
+  size_t size = 1;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  slots_ = std::vector<Slot>(size);
+  mask_ = size - 1;
+}
+
+void PoseHistory::Push(const PoseSample& pose) {
+  if (pose.timestamp <= newest_timestamp_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  const uint64_t index = count_.load(std::memory_order_relaxed);
+  Slot& slot = slots_[index & mask_];
+  slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slot.timestamp.store(pose.timestamp, std::memory_order_relaxed);
+  const float values[7] = {pose.position.x, pose.position.y, pose.position.z,
+                           pose.rotation.w, pose.rotation.x, pose.rotation.y,
+                           pose.rotation.z};
+  for (int i = 0; i < 7; ++i) {
+    slot.values[i].store(values[i], std::memory_order_relaxed);
+  }
+  slot.sequence.store(2 * index + 2, std::memory_order_release);
+  count_.store(index + 1, std::memory_order_release);
+  newest_timestamp_.store(pose.timestamp, std::memory_order_release);
+}
+
+bool PoseHistory::Read(uint64_t index, PoseSample* pose) const {
+  const Slot& slot = slots_[index & mask_];
+  const uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+  if (sequence != 2 * index + 2) {
+    return false;
+  }
+  float values[7];
+  pose->timestamp = slot.timestamp.load(std::memory_order_relaxed);
+  for (int i = 0; i < 7; ++i) {
+    values[i] = slot.values[i].load(std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+    return false;
+  }
+  pose->position = glm::vec3(values[0], values[1], values[2]);
+  pose->rotation = glm::quat(values[3], values[4], values[5], values[6]);
+  return true;
+}
+
+bool PoseHistory::Lookup(double timestamp, double tolerance, bool interpolate,
+                         PoseSample* pose) const {
+  const uint64_t count = count_.load(std::memory_order_acquire);
+  if (count == 0) {
+    return false;
+  }
+  const uint64_t first = count > slots_.size() ? count - slots_.size() : 0;
+
+  // First pose newer than timestamp. Slots overwritten during the search are
+  // older than anything still readable, so they sort before timestamp.
+  uint64_t low = first;
+  uint64_t high = count;
+  PoseSample probe;
+  while (low < high) {
+    const uint64_t mid = low + (high - low) / 2;
+    if (!Read(mid, &probe) || probe.timestamp <= timestamp) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+
+  PoseSample before;
+  PoseSample after;
+  const bool has_before = low > first && Read(low - 1, &before) &&
+                          timestamp - before.timestamp <= tolerance;
+  const bool has_after = low < count && Read(low, &after) &&
+                         after.timestamp - timestamp <= tolerance;
+
+  if (interpolate && has_before && has_after) {
+    const float alpha = static_cast<float>(
+        (timestamp - before.timestamp) / (after.timestamp - before.timestamp));
+    pose->timestamp = timestamp;
+    pose->position = glm::mix(before.position, after.position, alpha);
+    pose->rotation = glm::slerp(before.rotation, after.rotation, alpha);
+    return true;
+  }
+  if (has_before &&
+      (!has_after ||
+       timestamp - before.timestamp <= after.timestamp - timestamp)) {
+    *pose = before;
+    return true;
+  }
+  if (has_after) {
+    *pose = after;
+    return true;
+  }
+  return false;
+}
+
+double PoseHistory::GetNewestTimestamp() const {
+  return newest_timestamp_.load(std::memory_order_acquire);
+}
+
+SensorSynchronizer::Options::Options()
+    : anchor(kAnchorCloud),
+      max_offset(0.025),
+      require_partner(true),
+      pose_tolerance(0.05),
+      interpolate_poses(true),
+      max_wait(0.25),
+      frame_history(3),
+      cloud_history(4),
+      pose_history(512) {}
+
+SensorSynchronizer::SensorSynchronizer(const Options& options)
+    : options_(options),
+      poses_(options.pose_history),
+      frame_ring_(options.frame_history),
+      cloud_ring_(options.cloud_history),
+      newest_timestamp_(-1.0),
+      emitted_(0),
+      dropped_frames_(0),
+      dropped_clouds_(0),
+      unmatched_(0),
+      missing_pose_(0) {}
+
+void SensorSynchronizer::PushFrame(const CameraFrameRef& frame) {
+  if (!frame_ring_.TryPush(frame)) {
+    ++dropped_frames_;
+  }
+}
+
+void SensorSynchronizer::PushCloud(
+    const std::shared_ptr<const PointCloudData>& cloud) {
+  if (!cloud_ring_.TryPush(cloud)) {
+    ++dropped_clouds_;
+  }
+}
+
+void SensorSynchronizer::PushPose(const TangoPoseData& pose) {
+  if (pose.status_code != TANGO_POSE_VALID) {
+    return;
+  }
+  PoseSample sample;
+  sample.timestamp = pose.timestamp;
+  sample.position = glm::vec3(pose.translation[0], pose.translation[1],
+                              pose.translation[2]);
+  sample.rotation = glm::quat(pose.orientation[3], pose.orientation[0],
+                              pose.orientation[1], pose.orientation[2]);
+  poses_.Push(sample);
+}
+
+bool SensorSynchronizer::LookupPose(double timestamp, PoseSample* pose) const {
+  return poses_.Lookup(timestamp, options_.pose_tolerance,
+                       options_.interpolate_poses, pose);
+}
+
+void SensorSynchronizer::Drain() {
+  CameraFrameRef frame;
+  while (frame_ring_.TryPop(&frame)) {
+    newest_timestamp_ = std::max(newest_timestamp_, frame->timestamp);
+    frames_.push_back(std::move(frame));
+  }
+  std::shared_ptr<const PointCloudData> cloud;
+  while (cloud_ring_.TryPop(&cloud)) {
+    newest_timestamp_ = std::max(newest_timestamp_, cloud->timestamp);
+    clouds_.push_back(std::move(cloud));
+  }
+  newest_timestamp_ = std::max(newest_timestamp_, poses_.GetNewestTimestamp());
+
+  // Histories are bounded. Trimming pending anchors loses samples and is
+  // counted; trimming partners only narrows the choice.
+  while (frames_.size() > options_.frame_history) {
+    frames_.pop_front();
+    if (options_.anchor == kAnchorFrame) {
+      ++dropped_frames_;
+    }
+  }
+  while (clouds_.size() > options_.cloud_history) {
+    clouds_.pop_front();
+    if (options_.anchor == kAnchorCloud) {
+      ++dropped_clouds_;
+    }
+  }
+}
+
+SensorSynchronizer::ResolveResult SensorSynchronizer::ResolveCloud(
+    SyncedSample* sample) {
+  if (clouds_.empty()) {
+    return kResolvePending;
+  }
+  const double timestamp = clouds_.front()->timestamp;
+  const bool stalled = newest_timestamp_ - timestamp > options_.max_wait;
+  // Frames arrive in order, so once one is at or past the cloud no later
+  // frame can be closer.
+  if (!stalled && (frames_.empty() || frames_.back()->timestamp < timestamp)) {
+    return kResolvePending;
+  }
+
+  double offset = 0.0;
+  const int nearest = FindNearest(frames_, timestamp, &offset);
+  const bool paired = nearest >= 0 && offset <= options_.max_offset;
+  if (!paired && options_.require_partner) {
+    clouds_.pop_front();
+    ++unmatched_;
+    return kResolveDropped;
+  }
+
+  const double frame_timestamp = paired ? frames_[nearest]->timestamp : 0.0;
+  if (!stalled && poses_.GetNewestTimestamp() <
+                      std::max(timestamp, frame_timestamp)) {
+    return kResolvePending;
+  }
+
+  SyncedSample result;
+  if (!LookupPose(timestamp, &result.cloud_pose) ||
+      (paired && !LookupPose(frame_timestamp, &result.frame_pose))) {
+    clouds_.pop_front();
+    ++missing_pose_;
+    return kResolveDropped;
+  }
+  result.cloud = clouds_.front();
+  if (paired) {
+    result.frame = frames_[nearest];
+  }
+  clouds_.pop_front();
+  DropOlderThan(timestamp - options_.max_offset, &frames_);
+  *sample = std::move(result);
+  return kResolveEmitted;
+}
+
+SensorSynchronizer::ResolveResult SensorSynchronizer::ResolveFrame(
+    SyncedSample* sample) {
+  if (frames_.empty()) {
+    return kResolvePending;
+  }
+  const double timestamp = frames_.front()->timestamp;
+  const bool stalled = newest_timestamp_ - timestamp > options_.max_wait;
+
+  double offset = 0.0;
+  const int nearest = FindNearest(clouds_, timestamp, &offset);
+  const bool paired = nearest >= 0 && offset <= options_.max_offset;
+  if (!paired && options_.require_partner) {
+    frames_.pop_front();
+    ++unmatched_;
+    return kResolveDropped;
+  }
+
+  const double cloud_timestamp = paired ? clouds_[nearest]->timestamp : 0.0;
+  if (!stalled && poses_.GetNewestTimestamp() <
+                      std::max(timestamp, cloud_timestamp)) {
+    return kResolvePending;
+  }
+
+  SyncedSample result;
+  if (!LookupPose(timestamp, &result.frame_pose) ||
+      (paired && !LookupPose(cloud_timestamp, &result.cloud_pose))) {
+    frames_.pop_front();
+    ++missing_pose_;
+    return kResolveDropped;
+  }
+  result.frame = std::move(frames_.front());
+  if (paired) {
+    result.cloud = clouds_[nearest];
+  }
+  frames_.pop_front();
+  DropOlderThan(timestamp - options_.max_offset, &clouds_);
+  *sample = std::move(result);
+  return kResolveEmitted;
+}
+
+bool SensorSynchronizer::Poll(SyncedSample* sample) {
+  Drain();
+  while (true) {
+    const ResolveResult result = options_.anchor == kAnchorCloud
+                                     ? ResolveCloud(sample)
+                                     : ResolveFrame(sample);
+    if (result == kResolveEmitted) {
+      ++emitted_;
+      return true;
+    }
+    if (result == kResolvePending) {
+      return false;
+    }
+  }
+}
+
+void SensorSynchronizer::Clear() {
+  Drain();
+  frames_.clear();
+  clouds_.clear();
+}
+
+SensorSynchronizer::Stats SensorSynchronizer::GetStats() const {
+  Stats stats;
+  stats.emitted = emitted_.load();
+  stats.dropped_frames = dropped_frames_.load();
+  stats.dropped_clouds = dropped_clouds_.load();
+  stats.unmatched = unmatched_.load();
+  stats.missing_pose = missing_pose_.load();
+  return stats;
+}
@@ -0,0 +1,194 @@
+#ifndef CINDER_TANGO_SENSOR_SYNCHRONIZER_H_
+#define CINDER_TANGO_SENSOR_SYNCHRONIZER_H_
+
+#define GLM_FORCE_RADIANS
+
+#include <stdint.h>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <tango_client_api.h>
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include "camera_frame.h"
+#include "point_cloud.h"
+#include "spsc_ring.h"
+
+// Device pose (start_of_service_T_device) at a service timestamp.
+struct PoseSample {
+  PoseSample() : timestamp(0.0), rotation(1.0f, 0.0f, 0.0f, 0.0f) {}
+
+  double timestamp;
+  glm::vec3 position;
+  glm::quat rotation;
+};
+
+// Fixed-size history of valid poses in timestamp order. One thread pushes
+// (the pose callback); any number of threads may look poses up concurrently
+// without locking. Each slot is a small seqlock, so a reader that races with
+// the writer lapping the ring sees the slot as missing rather than torn.
+class PoseHistory {
+ public:
+  // capacity is rounded up to a power of two.
+  explicit PoseHistory(size_t capacity);
+  PoseHistory(const PoseHistory& other) = delete;
+  PoseHistory& operator=(const PoseHistory&) = delete;
+
+  // Poses older than or equal to the newest one are ignored.
+  void Push(const PoseSample& pose);
+
+  // Pose at timestamp. With interpolate set and a pose on each side no
+  // further than tolerance seconds away, the result is interpolated (lerp for
+  // position, slerp for rotation) and stamped with timestamp. Otherwise the
+  // nearest pose within tolerance is returned unchanged. Returns false when
+  // there is none.
+  bool Lookup(double timestamp, double tolerance, bool interpolate,
+              PoseSample* pose) const;
+
+  // Timestamp of the newest pose, or a negative value before the first.
+  double GetNewestTimestamp() const;
+
+ private:
+  struct Slot {
+    Slot() : sequence(0) {}
+    // 2 * index + 2 once the pose with that logical index is complete, odd
+    // while it is being written.
+    std::atomic<uint64_t> sequence;
+    std::atomic<double> timestamp;
+    std::atomic<float> values[7];
+  };
+
+  bool Read(uint64_t index, PoseSample* pose) const;
+
+  std::vector<Slot> slots_;
+  uint64_t mask_;
+  std::atomic<uint64_t> count_;
+  std::atomic<double> newest_timestamp_;
+};
+
+// Color frame, depth cloud and device poses that belong together.
+struct SyncedSample {
+  // Empty when the anchor is a cloud and no frame was close enough (only
+  // emitted if Options::require_partner is false).
+  CameraFrameRef frame;
+  // Null when the anchor is a frame and no cloud was close enough.
+  std::shared_ptr<const PointCloudData> cloud;
+  // Device poses at frame->timestamp and cloud->timestamp. Only meaningful
+  // for the members that are present.
+  PoseSample frame_pose;
+  PoseSample cloud_pose;
+};
+
+// Pairs color frames, depth clouds and device poses that arrive on different
+// Tango callbacks with different timestamps.
+//
+// Each callback pushes into its own single-producer ring, so producers never
+// lock or wait on each other or on the consumer. A single consumer thread
+// calls Poll(), which drains the rings and emits one SyncedSample per anchor
+// (every cloud or every frame, see Anchor) once its partner and poses are
+// settled. Poses are also available to any thread through LookupPose(),
+// which replaces querying the service at a texture timestamp.
+//
+//  // Callbacks:
+//  sync.PushFrame(frame_ref);
+//  sync.PushCloud(cloud);
+//  sync.PushPose(*pose);
+//  // Worker thread:
+//  SyncedSample sample;
+//  while (sync.Poll(&sample)) {
+//    Colorize(*sample.cloud, sample.cloud_pose, *sample.frame,
+//             sample.frame_pose);
+//  }
+class SensorSynchronizer {
+ public:
+  enum Anchor {
+    // One sample per depth cloud, paired with the nearest color frame. Clouds
+    // wait for the frame stream to pass their timestamp.
+    kAnchorCloud,
+    // One sample per color frame, paired with the nearest cloud already
+    // received. Frames never wait for depth: clouds arrive at a fraction of
+    // the frame rate and a waiting frame pins a pool buffer.
+    kAnchorFrame
+  };
+
+  struct Options {
+    Options();
+    Anchor anchor;
+    // Largest frame to cloud time offset that still counts as a pair, in
+    // seconds.
+    double max_offset;
+    // Drop anchors without a partner instead of emitting them alone.
+    bool require_partner;
+    // Largest distance to the poses used for a sample, in seconds.
+    double pose_tolerance;
+    // Interpolate between the bracketing poses instead of taking the nearest.
+    bool interpolate_poses;
+    // How far the newest timestamp seen on any stream may run ahead of a
+    // pending anchor before it is resolved with whatever has arrived, so a
+    // stalled stream cannot hold samples forever. In seconds.
+    double max_wait;
+    // Frames held for matching. Keep this below the CameraFramePool buffer
+    // count, since every held frame is a buffer the camera cannot reuse.
+    size_t frame_history;
+    size_t cloud_history;
+    size_t pose_history;
+  };
+
+  struct Stats {
+    uint64_t emitted;
+    // Rejected because a ring or history was full.
+    uint64_t dropped_frames;
+    uint64_t dropped_clouds;
+    // Anchors dropped for want of a partner or of poses.
+    uint64_t unmatched;
+    uint64_t missing_pose;
+  };
+
+  explicit SensorSynchronizer(const Options& options);
+  SensorSynchronizer(const SensorSynchronizer& other) = delete;
+  SensorSynchronizer& operator=(const SensorSynchronizer&) = delete;
+
+  // Producers, one thread each.
+  void PushFrame(const CameraFrameRef& frame);
+  void PushCloud(const std::shared_ptr<const PointCloudData>& cloud);
+  // Only valid start_of_service to device poses are kept.
+  void PushPose(const TangoPoseData& pose);
+
+  // Consumer. Returns false when no sample is ready.
+  bool Poll(SyncedSample* sample);
+  // Releases everything queued or held. Consumer thread only.
+  void Clear();
+
+  // Any thread.
+  bool LookupPose(double timestamp, PoseSample* pose) const;
+  Stats GetStats() const;
+
+ private:
+  enum ResolveResult { kResolvePending, kResolveEmitted, kResolveDropped };
+
+  void Drain();
+  ResolveResult ResolveCloud(SyncedSample* sample);
+  ResolveResult ResolveFrame(SyncedSample* sample);
+
+  const Options options_;
+  PoseHistory poses_;
+  SpscRing<CameraFrameRef> frame_ring_;
+  SpscRing<std::shared_ptr<const PointCloudData> > cloud_ring_;
+
+  // Consumer state.
+  std::deque<CameraFrameRef> frames_;
+  std::deque<std::shared_ptr<const PointCloudData> > clouds_;
+  double newest_timestamp_;
+
+  std::atomic<uint64_t> emitted_;
+  std::atomic<uint64_t> dropped_frames_;
+  std::atomic<uint64_t> dropped_clouds_;
+  std::atomic<uint64_t> unmatched_;
+  std::atomic<uint64_t> missing_pose_;
+};
+
+#endif  // CINDER_TANGO_SENSOR_SYNCHRONIZER_H_
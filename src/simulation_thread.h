@@ -0,0 +1,154 @@
+#ifndef CINDER_TANGO_SIMULATION_THREAD_H_
+#define CINDER_TANGO_SIMULATION_THREAD_H_
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <time.h>
+#include <atomic>
+#include <functional>
+
+#include "triple_buffer.h"
+
+// Count, mean and worst case of a repeated piece of work.
+struct TimingStats {
+  TimingStats() : count(0), total_ms(0.0), max_ms(0.0), last_ms(0.0) {}
+
+  void Add(double ms) {
+    ++count;
+    total_ms += ms;
+    last_ms = ms;
+    if (ms > max_ms) {
+      max_ms = ms;
+    }
+  }
+  double GetAverageMs() const { return count > 0 ? total_ms / count : 0.0; }
+
+  uint64_t count;
+  double total_ms;
+  double max_ms;
+  double last_ms;
+};
+
+// Runs a step function at a fixed rate on its own thread, each step writing
+// a complete State snapshot that is published through a TripleBuffer. The
+// render thread picks up the latest snapshot with Acquire and never waits on
+// the step, so a slow step (Tango IPC, say) costs a stale snapshot rather
+// than a dropped frame.
+//
+// Ownership: the step runs on the simulation thread only and owns the State
+// it is handed, which holds an older snapshot to be overwritten. Anything
+// else it reads must be immutable while the thread runs or synchronized by
+// the caller. Acquire and GetState belong to one consumer thread; Start,
+// Stop and GetStats may be called from any thread but not concurrently.
+template <typename State>
+class SimulationThread {
+ public:
+  typedef std::function<void(State* state)> StepFunction;
+
+  struct Stats {
+    Stats() : overruns(0) {}
+    TimingStats step;
+    // Steps that started more than a period late.
+    uint64_t overruns;
+  };
+
+  SimulationThread(double rate_hz, StepFunction step)
+      : step_(step),
+        period_ns_(static_cast<int64_t>(1.0e9 / rate_hz)),
+        running_(false),
+        stopping_(false) {
+    pthread_mutex_init(&mutex_, nullptr);
+  }
+  SimulationThread(const SimulationThread& other) = delete;
+  SimulationThread& operator=(const SimulationThread&) = delete;
+  ~SimulationThread() {
+    Stop();
+    pthread_mutex_destroy(&mutex_);
+  }
+
+  bool Start() {
+    if (running_) {
+      return true;
+    }
+    stopping_.store(false);
+    running_ = pthread_create(&thread_, nullptr, &ThreadMain, this) == 0;
+    return running_;
+  }
+
+  // Returns once the step in progress, if any, has finished.
+  void Stop() {
+    if (!running_) {
+      return;
+    }
+    stopping_.store(true);
+    pthread_join(thread_, nullptr);
+    running_ = false;
+  }
+
+  // Takes the newest snapshot; false if there was none since the last call.
+  // GetState keeps returning the taken snapshot until the next Acquire. It
+  // is default-constructed until the first step has been published.
+  bool Acquire() { return snapshots_.Acquire(); }
+  const State& GetState() const { return snapshots_.GetReadBuffer(); }
+
+  Stats GetStats() const {
+    pthread_mutex_lock(&mutex_);
+    const Stats stats = stats_;
+    pthread_mutex_unlock(&mutex_);
+    return stats;
+  }
+
+ private:
+  static int64_t NowNs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+  }
+
+  static void* ThreadMain(void* arg) {
+    static_cast<SimulationThread*>(arg)->Run();
+    return nullptr;
+  }
+
+  void Run() {
+    int64_t deadline = NowNs();
+    while (!stopping_.load()) {
+      const int64_t start = NowNs();
+      bool overrun = false;
+      if (start - deadline > period_ns_) {
+        // Too far behind to catch up; skip the missed steps.
+        overrun = true;
+        deadline = start;
+      }
+      step_(&snapshots_.GetWriteBuffer());
+      snapshots_.Publish();
+      const int64_t end = NowNs();
+
+      pthread_mutex_lock(&mutex_);
+      stats_.step.Add((end - start) / 1.0e6);
+      stats_.overruns += overrun;
+      pthread_mutex_unlock(&mutex_);
+
+      // Absolute deadlines, so the rate does not drift with step time.
+      deadline += period_ns_;
+      timespec wake;
+      wake.tv_sec = deadline / 1000000000LL;
+      wake.tv_nsec = deadline % 1000000000LL;
+      while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, nullptr) ==
+             EINTR) {
+      }
+    }
+  }
+
+  StepFunction step_;
+  const int64_t period_ns_;
+  TripleBuffer<State> snapshots_;
+  pthread_t thread_;
+  bool running_;
+  std::atomic<bool> stopping_;
+  mutable pthread_mutex_t mutex_;
+  Stats stats_;
+};
+
+#endif  // CINDER_TANGO_SIMULATION_THREAD_H_
@@ -0,0 +1,75 @@
+#ifndef CINDER_TANGO_SPSC_RING_H_
+#define CINDER_TANGO_SPSC_RING_H_
+
+#include <stddef.h>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+// Bounded single-producer, single-consumer queue. TryPush and TryPop never
+// block or allocate; a full ring rejects the item and the producer decides
+// whether to drop or retry.
+//
+// Exactly one thread may push and exactly one (possibly different) thread
+// may pop. Popped slots keep a moved-from T until they are overwritten.
+template <typename T>
+class SpscRing {
+ public:
+  // capacity is rounded up to a power of two.
+  explicit SpscRing(size_t capacity) : head_(0), tail_(0) {
+    size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    items_.resize(size);
+    mask_ = size - 1;
+  }
+  SpscRing(const SpscRing& other) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+
+  bool TryPush(const T& item) {
+    T copy(item);
+    return TryPush(std::move(copy));
+  }
+
+  bool TryPush(T&& item) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) > mask_) {
+      return false;
+    }
+    items_[tail & mask_] = std::move(item);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryPop(T* item) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    *item = std::move(items_[head & mask_]);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t GetCapacity() const { return mask_ + 1; }
+  // Exact only when called from the producer or consumer thread while the
+  // other side is idle.
+  size_t GetSize() const {
+    return tail_.load(std::memory_order_acquire) -
+           head_.load(std::memory_order_acquire);
+  }
+
+ private:
+  std::vector<T> items_;
+  size_t mask_;
+  // The indices live on separate cache lines so producer and consumer do not
+  // invalidate each other on every operation.
+  char pad0_[64];
+  std::atomic<size_t> head_;
+  char pad1_[64];
+  std::atomic<size_t> tail_;
+  char pad2_[64];
+};
+
+#endif  // CINDER_TANGO_SPSC_RING_H_
@@ -0,0 +1,130 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tango-gl/band.h"
+
+#include <string.h>
+
+#include "tango-gl/gl_debug.h"
+#include "tango-gl/gl_state.h"
+
+namespace tango_gl {
+
+static const float kMinDistanceSquared = 0.0025f;
+
+Band::Band(const unsigned int max_length)
+    : band_width_(0.2f), max_length_(max_length), ring_(max_length / 2) {
+  SetShader();
+  SetBufferUsage(kDynamicDraw);
+  // Two vertices per slot, plus the copy of slot 0 past the end.
+  vertices_.assign(6 * (ring_.GetCapacity() + 1), 0.0f);
+}
+
+void Band::SetWidth(const float width) { band_width_ = width; }
+
+void Band::UpdateVertexArray(const glm::mat4 m) {
+  bool need_to_initialize = ring_.IsEmpty();
+  bool sufficient_delta = false;
+  if (!need_to_initialize) {
+    const GLfloat* front = &vertices_[6 * ring_.GetNewest(0)];
+    glm::vec3 band_front = 0.5f * (glm::vec3(front[0], front[1], front[2]) +
+                                   glm::vec3(front[3], front[4], front[5]));
+    sufficient_delta =
+        kMinDistanceSquared <
+        util::DistanceSquared(band_front, util::GetTranslationFromMatrix(m));
+  }
+
+  if (need_to_initialize || sufficient_delta) {
+    glm::vec3 left = glm::vec3(-band_width_ / 2.0f, 0, 0);
+    glm::vec3 right = glm::vec3(band_width_ / 2.0f, 0, 0);
+    left = glm::vec3(m * glm::vec4(left, 1.0f));
+    right = glm::vec3(m * glm::vec4(right, 1.0f));
+    const size_t slot = ring_.Push();
+    WriteSlot(slot, left, right);
+    MarkVerticesDirty(6 * slot, 6);
+    if (slot == 0) {
+      MarkVerticesDirty(6 * ring_.GetCapacity(), 6);
+    }
+  }
+}
+
+void Band::SetVertexArray(const std::vector<glm::vec3>& v,
+                          const glm::vec3& up) {
+  ring_.Clear();
+  if (v.size() < 2) {
+    return;
+  }
+  // Only the newest part of a long path fits; start where it begins.
+  const size_t segments = v.size() - 1;
+  const size_t capacity = ring_.GetCapacity();
+  const size_t first = segments + 1 > capacity ? segments + 1 - capacity : 0;
+  for (size_t i = first; i < segments; ++i) {
+    glm::vec3 gl_p_world_a = v[i];
+    glm::vec3 gl_p_world_b = v[i + 1];
+    glm::vec3 dir = glm::normalize(gl_p_world_b - gl_p_world_a);
+    glm::vec3 left = glm::normalize(glm::cross(up, dir));
+    WriteSlot(ring_.Push(), gl_p_world_a + (band_width_ / 2.0f * left),
+              gl_p_world_a - (band_width_ / 2.0f * left));
+    // Cap the end of the path.
+    if (i == segments - 1) {
+      WriteSlot(ring_.Push(), gl_p_world_b + (band_width_ / 2.0f * left),
+                gl_p_world_b - (band_width_ / 2.0f * left));
+    }
+  }
+  // Everything changed; one upload, and exact bounds.
+  MarkVerticesDirty(0, vertices_.size());
+}
+
+void Band::ClearVertexArray() { ring_.Clear(); }
+
+void Band::WriteSlot(size_t slot, const glm::vec3& left,
+                     const glm::vec3& right) {
+  GLfloat* data = &vertices_[6 * slot];
+  memcpy(data, glm::value_ptr(left), 3 * sizeof(GLfloat));
+  memcpy(data + 3, glm::value_ptr(right), 3 * sizeof(GLfloat));
+  if (slot == 0) {
+    memcpy(&vertices_[6 * ring_.GetCapacity()], data, 6 * sizeof(GLfloat));
+  }
+}
+
+void Band::Render(const glm::mat4& projection_mat,
+                  const glm::mat4& view_mat) const {
+  VertexRing::Range ranges[2];
+  const int range_count = ring_.GetDrawRanges(ranges);
+  if (range_count == 0) {
+    return;
+  }
+  TANGO_GL_LABEL("Band::Render");
+  GlState& state = GlState::GetInstance();
+  state.UseProgram(shader_program_);
+  glm::mat4 model_mat = GetTransformationMatrix();
+  glm::mat4 mv_mat = view_mat * model_mat;
+  glm::mat4 mvp_mat = projection_mat * mv_mat;
+  glUniformMatrix4fv(uniform_mvp_mat_, 1, GL_FALSE, glm::value_ptr(mvp_mat));
+  glUniform4f(uniform_color_, red_, green_, blue_, alpha_);
+
+  if (BindGeometry()) {
+    for (int i = 0; i < range_count; ++i) {
+      TANGO_GL_CHECK(glDrawArrays(GL_TRIANGLE_STRIP,
+                                  static_cast<GLint>(2 * ranges[i].first),
+                                  static_cast<GLsizei>(2 * ranges[i].count)));
+    }
+    UnbindGeometry();
+  }
+}
+
+}  // namespace tango_gl
@@ -0,0 +1,360 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tango-gl/batch_renderer.h"
+
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+
+#include "tango-gl/gl_debug.h"
+#include "tango-gl/gl_state.h"
+#include "tango-gl/program_cache.h"
+#include "tango-gl/shaders.h"
+
+namespace tango_gl {
+
+namespace {
+double NowMs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000.0 + now.tv_nsec / 1.0e6;
+}
+
+bool IsLineMode(GLenum mode) {
+  return mode == GL_LINES || mode == GL_LINE_STRIP || mode == GL_LINE_LOOP;
+}
+}  // namespace
+
+bool BatchRenderer::BatchKey::operator<(const BatchKey& other) const {
+  if (geometry != other.geometry) return geometry < other.geometry;
+  if (mode != other.mode) return mode < other.mode;
+  if (line_width != other.line_width) return line_width < other.line_width;
+  if (lit != other.lit) return lit < other.lit;
+  for (int i = 0; i < 3; ++i) {
+    if (light_position[i] != other.light_position[i]) {
+      return light_position[i] < other.light_position[i];
+    }
+  }
+  return false;
+}
+
+BatchRenderer::BatchRenderer()
+    : batch_count_(0),
+      programs_created_(false),
+      instance_buffer_(0),
+      instance_buffer_capacity_(0),
+      vertex_array_(0),
+      instancing_enabled_(true),
+      culling_enabled_(true) {
+  memset(&unlit_program_, 0, sizeof(unlit_program_));
+  memset(&lit_program_, 0, sizeof(lit_program_));
+  memset(&stats_, 0, sizeof(stats_));
+}
+
+BatchRenderer::~BatchRenderer() {
+  // The programs belong to the ProgramCache.
+  GlState& state = GlState::GetInstance();
+  if (instance_buffer_ != 0) {
+    state.DeleteBuffers(1, &instance_buffer_);
+  }
+  if (vertex_array_ != 0) {
+    state.DeleteVertexArrays(1, &vertex_array_);
+  }
+}
+
+void BatchRenderer::Add(const DrawableObject* object) {
+  queue_.push_back(object);
+}
+
+bool BatchRenderer::LoadProgram(const std::string& vertex_shader,
+                                Program* program) {
+  ProgramCache& programs = ProgramCache::GetInstance();
+  program->id =
+      programs.GetProgram(vertex_shader, shaders::GetBasicFragmentShader());
+  if (!program->id) {
+    LOGE("Could not create program.");
+    return false;
+  }
+  program->uniform_view = programs.GetUniformLocation(program->id, "view");
+  program->uniform_projection =
+      programs.GetUniformLocation(program->id, "projection");
+  program->uniform_light = programs.GetUniformLocation(program->id, "lightVec");
+  program->attrib_vertices = programs.GetAttribLocation(program->id, "vertex");
+  program->attrib_normals = programs.GetAttribLocation(program->id, "normal");
+  // A mat4 attribute takes four consecutive locations, one per column.
+  program->attrib_model =
+      programs.GetAttribLocation(program->id, "instance_model");
+  program->attrib_color =
+      programs.GetAttribLocation(program->id, "instance_color");
+  return program->attrib_vertices >= 0 && program->attrib_model >= 0 &&
+         program->attrib_color >= 0;
+}
+
+void BatchRenderer::Render(const glm::mat4& projection_mat,
+                           const glm::mat4& view_mat) {
+  TANGO_GL_LABEL("BatchRenderer::Render");
+  const double start = NowMs();
+  memset(&stats_, 0, sizeof(stats_));
+  stats_.objects = static_cast<int>(queue_.size());
+
+  if (!programs_created_) {
+    const bool unlit_ok =
+        LoadProgram(shaders::GetInstancedVertexShader(), &unlit_program_);
+    const bool lit_ok =
+        LoadProgram(shaders::GetInstancedShadedVertexShader(), &lit_program_);
+    if (!unlit_ok) {
+      unlit_program_.id = 0;
+    }
+    if (!lit_ok) {
+      lit_program_.id = 0;
+    }
+    programs_created_ = true;
+  }
+
+  visible_.clear();
+  if (culling_enabled_) {
+    culler_.SetViewProjection(projection_mat * view_mat);
+    culler_.Cull(queue_, &visible_);
+  } else {
+    visible_.swap(queue_);
+  }
+  queue_.clear();
+  stats_.culled = stats_.objects - static_cast<int>(visible_.size());
+
+  // Group what is left by geometry and drawing mode.
+  batch_index_.clear();
+  batch_count_ = 0;
+  unbatched_.clear();
+  for (const DrawableObject* object : visible_) {
+    DrawableObject::BatchInfo info;
+    if (!object->GetBatchInfo(&info) ||
+        (info.lit ? lit_program_.id : unlit_program_.id) == 0) {
+      unbatched_.push_back(object);
+      continue;
+    }
+    BatchKey key = {object->GetGeometryKey(), info.mode, info.line_width,
+                    info.lit, info.light_position};
+    std::pair<std::map<BatchKey, size_t>::iterator, bool> inserted =
+        batch_index_.insert(std::make_pair(key, batch_count_));
+    if (inserted.second) {
+      if (batch_count_ == batches_.size()) {
+        batches_.push_back(Batch());
+      }
+      Batch& batch = batches_[batch_count_++];
+      batch.mesh = object;
+      batch.key = key;
+      batch.instances.clear();
+    }
+    Batch& batch = batches_[inserted.first->second];
+    Instance instance;
+    const glm::mat4 model_mat = object->GetTransformationMatrix();
+    memcpy(instance.model, glm::value_ptr(model_mat), sizeof(instance.model));
+    instance.color[0] = object->red_;
+    instance.color[1] = object->green_;
+    instance.color[2] = object->blue_;
+    instance.color[3] = object->alpha_;
+    batch.instances.push_back(instance);
+  }
+  stats_.batches = static_cast<int>(batch_count_);
+
+  if (batch_count_ > 0) {
+    for (size_t i = 0; i < batch_count_; ++i) {
+      batches_[i].mesh->PrepareGeometry();
+    }
+
+    // Leave the bindings as we found them; Cinder caches its own.
+    const bool use_vertex_array = util::HasVertexArrays();
+    const bool instanced = instancing_enabled_ && use_vertex_array;
+    GlState& state = GlState::GetInstance();
+    GLuint previous_vertex_array = 0;
+    GLuint previous_element_buffer = 0;
+    const GLuint previous_array_buffer = state.GetBuffer(GL_ARRAY_BUFFER);
+    if (use_vertex_array) {
+      previous_vertex_array = state.GetVertexArray();
+      if (vertex_array_ == 0) {
+        glGenVertexArrays(1, &vertex_array_);
+      }
+      state.BindVertexArray(vertex_array_);
+    } else {
+      previous_element_buffer = state.GetBuffer(GL_ELEMENT_ARRAY_BUFFER);
+    }
+
+    if (instanced) {
+      UploadInstances();
+    }
+    // Unlit batches first, then lit, so each program is bound once.
+    for (int pass = 0; pass < 2; ++pass) {
+      const Program& program = pass == 0 ? unlit_program_ : lit_program_;
+      bool program_bound = false;
+      for (size_t i = 0; i < batch_count_; ++i) {
+        const Batch& batch = batches_[i];
+        if (batch.key.lit != (pass == 1) || batch.mesh->GetVertexCount() == 0) {
+          continue;
+        }
+        if (!program_bound) {
+          state.UseProgram(program.id);
+          glUniformMatrix4fv(program.uniform_view, 1, GL_FALSE,
+                             glm::value_ptr(view_mat));
+          glUniformMatrix4fv(program.uniform_projection, 1, GL_FALSE,
+                             glm::value_ptr(projection_mat));
+          program_bound = true;
+        }
+        DrawBatch(batch, program, view_mat, instanced);
+      }
+      if (program_bound) {
+        state.SetVertexAttribArray(program.attrib_vertices, false);
+        if (program.attrib_normals >= 0) {
+          state.SetVertexAttribArray(program.attrib_normals, false);
+        }
+        for (int column = 0; column < 4; ++column) {
+          state.SetVertexAttribArray(program.attrib_model + column, false);
+        }
+        state.SetVertexAttribArray(program.attrib_color, false);
+      }
+    }
+
+    if (use_vertex_array) {
+      state.BindVertexArray(previous_vertex_array);
+    } else {
+      state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, previous_element_buffer);
+    }
+    state.BindBuffer(GL_ARRAY_BUFFER, previous_array_buffer);
+  }
+
+  for (const DrawableObject* object : unbatched_) {
+    object->Render(projection_mat, view_mat);
+  }
+  stats_.unbatched = static_cast<int>(unbatched_.size());
+  stats_.draw_calls += stats_.unbatched;
+  stats_.submit_ms = NowMs() - start;
+}
+
+void BatchRenderer::UploadInstances() {
+  size_t total = 0;
+  for (size_t i = 0; i < batch_count_; ++i) {
+    total += batches_[i].instances.size();
+  }
+  instance_data_.resize(total);
+  size_t first = 0;
+  for (size_t i = 0; i < batch_count_; ++i) {
+    Batch& batch = batches_[i];
+    batch.first = first;
+    memcpy(&instance_data_[first], batch.instances.data(),
+           batch.instances.size() * sizeof(Instance));
+    first += batch.instances.size();
+  }
+
+  if (instance_buffer_ == 0) {
+    glGenBuffers(1, &instance_buffer_);
+  }
+  GlState::GetInstance().BindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+  const size_t size = total * sizeof(Instance);
+  if (size > instance_buffer_capacity_) {
+    instance_buffer_capacity_ = std::max(size, 2 * instance_buffer_capacity_);
+  }
+  // Orphan last frame's storage rather than wait for draws still reading it.
+  TANGO_GL_CHECK(glBufferData(GL_ARRAY_BUFFER, instance_buffer_capacity_, NULL,
+                              GL_STREAM_DRAW));
+  TANGO_GL_CHECK(glBufferSubData(GL_ARRAY_BUFFER, 0, size,
+                                 instance_data_.data()));
+}
+
+void BatchRenderer::DrawBatch(const Batch& batch, const Program& program,
+                              const glm::mat4& view_mat, bool instanced) {
+  const DrawableObject* mesh = batch.mesh;
+  GlState& state = GlState::GetInstance();
+  if (batch.key.lit) {
+    glm::vec3 light_position = glm::mat3(view_mat) * batch.key.light_position;
+    glUniform3fv(program.uniform_light, 1, glm::value_ptr(light_position));
+  }
+  if (IsLineMode(batch.key.mode)) {
+    state.LineWidth(batch.key.line_width);
+  }
+
+  state.BindBuffer(GL_ARRAY_BUFFER, mesh->vertex_buffer_.id);
+  state.SetVertexAttribArray(program.attrib_vertices, true);
+  TANGO_GL_CHECK(glVertexAttribPointer(program.attrib_vertices, 3, GL_FLOAT,
+                                       GL_FALSE, 3 * sizeof(GLfloat), 0));
+  if (program.attrib_normals >= 0) {
+    if (mesh->normal_buffer_.size > 0) {
+      state.BindBuffer(GL_ARRAY_BUFFER, mesh->normal_buffer_.id);
+      state.SetVertexAttribArray(program.attrib_normals, true);
+      TANGO_GL_CHECK(glVertexAttribPointer(program.attrib_normals, 3, GL_FLOAT,
+                                           GL_FALSE, 3 * sizeof(GLfloat), 0));
+    } else {
+      state.SetVertexAttribArray(program.attrib_normals, false);
+    }
+  }
+  const GLsizei index_count = mesh->GetIndexCount();
+  const GLsizei vertex_count = mesh->GetVertexCount();
+  state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER,
+                   index_count > 0 ? mesh->index_buffer_.id : 0);
+
+  const GLsizei instance_count = static_cast<GLsizei>(batch.instances.size());
+  if (instanced) {
+    state.BindBuffer(GL_ARRAY_BUFFER, instance_buffer_);
+    const size_t base = batch.first * sizeof(Instance);
+    for (int column = 0; column < 4; ++column) {
+      const GLuint location = program.attrib_model + column;
+      state.SetVertexAttribArray(location, true);
+      TANGO_GL_CHECK(glVertexAttribPointer(
+          location, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+          reinterpret_cast<const void*>(base + column * 4 * sizeof(GLfloat))));
+      TANGO_GL_CHECK(glVertexAttribDivisor(location, 1));
+    }
+    state.SetVertexAttribArray(program.attrib_color, true);
+    TANGO_GL_CHECK(glVertexAttribPointer(
+        program.attrib_color, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+        reinterpret_cast<const void*>(base + offsetof(Instance, color))));
+    TANGO_GL_CHECK(glVertexAttribDivisor(program.attrib_color, 1));
+
+    if (index_count > 0) {
+      TANGO_GL_CHECK(glDrawElementsInstanced(batch.key.mode, index_count,
+                                             mesh->GetIndexType(), 0,
+                                             instance_count));
+    } else {
+      TANGO_GL_CHECK(glDrawArraysInstanced(batch.key.mode, 0, vertex_count,
+                                           instance_count));
+    }
+    ++stats_.draw_calls;
+    return;
+  }
+
+  // No instancing: the per-instance attributes become constant attributes,
+  // set between draws that otherwise share all their state.
+  for (int column = 0; column < 4; ++column) {
+    state.SetVertexAttribArray(program.attrib_model + column, false);
+  }
+  state.SetVertexAttribArray(program.attrib_color, false);
+  for (const Instance& instance : batch.instances) {
+    for (int column = 0; column < 4; ++column) {
+      TANGO_GL_CHECK(glVertexAttrib4fv(program.attrib_model + column,
+                                       instance.model + 4 * column));
+    }
+    TANGO_GL_CHECK(glVertexAttrib4fv(program.attrib_color, instance.color));
+    if (index_count > 0) {
+      TANGO_GL_CHECK(glDrawElements(batch.key.mode, index_count,
+                                    mesh->GetIndexType(), 0));
+    } else {
+      TANGO_GL_CHECK(glDrawArrays(batch.key.mode, 0, vertex_count));
+    }
+    ++stats_.draw_calls;
+  }
+}
+
+}  // namespace tango_gl
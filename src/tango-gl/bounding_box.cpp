@@ -0,0 +1,95 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tango-gl/bounding_box.h"
+
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+
+namespace tango_gl {
+
+BoundingBox::BoundingBox()
+    : min(FLT_MAX, FLT_MAX, FLT_MAX), max(-FLT_MAX, -FLT_MAX, -FLT_MAX) {}
+
+BoundingBox::BoundingBox(const glm::vec3& min, const glm::vec3& max)
+    : min(min), max(max) {}
+
+BoundingBox BoundingBox::FromPoints(const float* points, size_t count) {
+  BoundingBox box;
+  box.Extend(points, count);
+  return box;
+}
+
+bool BoundingBox::IsEmpty() const {
+  return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+glm::vec3 BoundingBox::GetCenter() const { return (min + max) * 0.5f; }
+
+glm::vec3 BoundingBox::GetExtent() const { return (max - min) * 0.5f; }
+
+void BoundingBox::Extend(const glm::vec3& point) {
+  min = glm::min(min, point);
+  max = glm::max(max, point);
+}
+
+void BoundingBox::Extend(const BoundingBox& box) {
+  if (!box.IsEmpty()) {
+    min = glm::min(min, box.min);
+    max = glm::max(max, box.max);
+  }
+}
+
+void BoundingBox::Extend(const float* points, size_t count) {
+  // Plain floats so the loop stays in registers.
+  float min_x = min.x, min_y = min.y, min_z = min.z;
+  float max_x = max.x, max_y = max.y, max_z = max.z;
+  for (const float* point = points; point != points + 3 * count; point += 3) {
+    min_x = std::min(min_x, point[0]);
+    min_y = std::min(min_y, point[1]);
+    min_z = std::min(min_z, point[2]);
+    max_x = std::max(max_x, point[0]);
+    max_y = std::max(max_y, point[1]);
+    max_z = std::max(max_z, point[2]);
+  }
+  min = glm::vec3(min_x, min_y, min_z);
+  max = glm::vec3(max_x, max_y, max_z);
+}
+
+BoundingBox BoundingBox::Transformed(const glm::mat4& matrix) const {
+  if (IsEmpty()) {
+    return BoundingBox();
+  }
+  // Transform the center, and take the extent along each output axis as
+  // the sum of the input extents projected onto it (Arvo's method).
+  const glm::vec3 center = GetCenter();
+  const glm::vec3 extent = GetExtent();
+  glm::vec3 new_center;
+  glm::vec3 new_extent;
+  for (int row = 0; row < 3; ++row) {
+    new_center[row] = matrix[3][row];
+    new_extent[row] = 0.0f;
+    for (int column = 0; column < 3; ++column) {
+      new_center[row] += matrix[column][row] * center[column];
+      new_extent[row] += fabsf(matrix[column][row]) * extent[column];
+    }
+  }
+  return BoundingBox(new_center - new_extent, new_center + new_extent);
+}
+
+}  // namespace tango_gl
@@ -0,0 +1,550 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tango-gl/compressed_texture.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+
+namespace tango_gl {
+namespace compressed_texture {
+
+namespace {
+const uint8_t kKtxIdentifier[12] = {0xAB, 'K',  'T',  'X', ' ',  '1',
+                                    '1',  0xBB, '\r', '\n', 0x1A, '\n'};
+const uint32_t kKtxEndianness = 0x04030201;
+// Anything bigger is a corrupt file, not a texture.
+const uint32_t kMaxKtxSize = 16384;
+
+struct KtxHeader {
+  uint8_t identifier[12];
+  uint32_t endianness;
+  uint32_t gl_type;
+  uint32_t gl_type_size;
+  uint32_t gl_format;
+  uint32_t gl_internal_format;
+  uint32_t gl_base_internal_format;
+  uint32_t pixel_width;
+  uint32_t pixel_height;
+  uint32_t pixel_depth;
+  uint32_t array_elements;
+  uint32_t faces;
+  uint32_t mipmap_levels;
+  uint32_t key_value_bytes;
+};
+
+struct BlockInfo {
+  uint32_t width;
+  uint32_t height;
+  uint32_t bytes;
+};
+
+// ASTC footprints in format order, 4x4 to 12x12.
+const uint8_t kAstcBlocks[14][2] = {{4, 4},   {5, 4},  {5, 5},   {6, 5},
+                                    {6, 6},   {8, 5},  {8, 6},   {8, 8},
+                                    {10, 5},  {10, 6}, {10, 8},  {10, 10},
+                                    {12, 10}, {12, 12}};
+
+bool GetBlockInfo(GLenum format, BlockInfo* info) {
+  info->width = 4;
+  info->height = 4;
+  switch (format) {
+    case GL_ETC1_RGB8_OES:
+    case GL_COMPRESSED_RGB8_ETC2:
+    case GL_COMPRESSED_SRGB8_ETC2:
+    case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+    case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+      info->bytes = 8;
+      return true;
+    case GL_COMPRESSED_RGBA8_ETC2_EAC:
+    case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+      info->bytes = 16;
+      return true;
+  }
+  GLenum astc_index;
+  if (format >= GL_COMPRESSED_RGBA_ASTC_4x4_KHR &&
+      format <= GL_COMPRESSED_RGBA_ASTC_12x12_KHR) {
+    astc_index = format - GL_COMPRESSED_RGBA_ASTC_4x4_KHR;
+  } else if (format >= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR &&
+             format <= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR) {
+    astc_index = format - GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR;
+  } else {
+    return false;
+  }
+  info->width = kAstcBlocks[astc_index][0];
+  info->height = kAstcBlocks[astc_index][1];
+  info->bytes = 16;
+  return true;
+}
+
+uint32_t GetLevelSize(const BlockInfo& info, uint32_t width,
+                      uint32_t height) {
+  return (width + info.width - 1) / info.width *
+         ((height + info.height - 1) / info.height) * info.bytes;
+}
+
+// Levels of a full mipmap chain, down to 1x1.
+uint32_t GetLevelCount(uint32_t width, uint32_t height) {
+  uint32_t levels = 1;
+  for (uint32_t size = std::max(width, height); size > 1; size /= 2) {
+    ++levels;
+  }
+  return levels;
+}
+
+inline int Clamp255(int value) {
+  return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+inline int Square(int value) { return value * value; }
+
+// ETC1 intensity modifiers, also used by ETC2 for its ETC1 compatible
+// blocks. Pixel index values 0 to 3 select +a, +b, -a and -b of a row.
+const int kEtcModifiers[8][2] = {{2, 8},   {5, 17},  {9, 29},  {13, 42},
+                                 {18, 60}, {24, 80}, {33, 106}, {47, 183}};
+
+const int kEacModifiers[16][8] = {
+    {-3, -6, -9, -15, 2, 5, 8, 14}, {-3, -7, -10, -13, 2, 6, 9, 12},
+    {-2, -5, -8, -13, 1, 4, 7, 12}, {-2, -4, -6, -13, 1, 3, 5, 12},
+    {-3, -6, -8, -12, 2, 5, 7, 11}, {-3, -7, -9, -11, 2, 6, 8, 10},
+    {-4, -7, -8, -11, 3, 6, 7, 10}, {-3, -5, -8, -11, 2, 4, 7, 10},
+    {-2, -6, -8, -10, 1, 5, 7, 9},  {-2, -5, -8, -10, 1, 4, 7, 9},
+    {-2, -4, -8, -10, 1, 3, 7, 9},  {-2, -5, -7, -10, 1, 4, 6, 9},
+    {-3, -4, -7, -10, 2, 3, 6, 9},  {-1, -2, -3, -10, 0, 1, 2, 9},
+    {-4, -6, -8, -9, 3, 5, 7, 8},   {-3, -5, -7, -9, 2, 4, 6, 8}};
+// Row of kEacModifiers holding a zero, for blocks of one alpha value.
+const int kEacExactTable = 13;
+const int kEacExactIndex = 4;
+
+// A 4x4 block of pixels, row by row. Pixel indices in the compressed
+// blocks go column by column instead.
+struct PixelBlock {
+  uint8_t rgb[16][3];
+  uint8_t alpha[16];
+};
+
+struct SubblockFit {
+  int table;
+  int error;
+  uint8_t indices[8];
+};
+
+// Picks the modifier table and per pixel indices that best fit the eight
+// pixels of a sub-block around base.
+void FitSubblock(const PixelBlock& block, const int* pixels, const int base[3],
+                 SubblockFit* fit) {
+  fit->error = 0x7fffffff;
+  for (int table = 0; table < 8; ++table) {
+    const int modifiers[4] = {kEtcModifiers[table][0], kEtcModifiers[table][1],
+                              -kEtcModifiers[table][0],
+                              -kEtcModifiers[table][1]};
+    int candidates[4][3];
+    for (int k = 0; k < 4; ++k) {
+      for (int c = 0; c < 3; ++c) {
+        candidates[k][c] = Clamp255(base[c] + modifiers[k]);
+      }
+    }
+    int error = 0;
+    uint8_t indices[8];
+    for (int i = 0; i < 8 && error < fit->error; ++i) {
+      const uint8_t* pixel = block.rgb[pixels[i]];
+      int best = 0x7fffffff;
+      for (int k = 0; k < 4; ++k) {
+        const int distance = Square(candidates[k][0] - pixel[0]) +
+                             Square(candidates[k][1] - pixel[1]) +
+                             Square(candidates[k][2] - pixel[2]);
+        if (distance < best) {
+          best = distance;
+          indices[i] = k;
+        }
+      }
+      error += best;
+    }
+    if (error < fit->error) {
+      fit->table = table;
+      fit->error = error;
+      memcpy(fit->indices, indices, sizeof(indices));
+    }
+  }
+}
+
+// Encodes an ETC1 block, which ETC2 decodes the same way. Both sub-block
+// orientations are tried, each with the sub-block averages as base colors
+// in differential mode (when they are close enough) and individual mode.
+// Differential mode never overflows here, since that would select one of
+// the ETC2-only modes.
+void EncodeColorBlock(const PixelBlock& block, uint8_t* out) {
+  int best_error = 0x7fffffff;
+  uint32_t best_high = 0;
+  uint32_t best_low = 0;
+  for (int flip = 0; flip < 2; ++flip) {
+    int pixels[2][8];
+    int counts[2] = {0, 0};
+    int sums[2][3] = {{0, 0, 0}, {0, 0, 0}};
+    for (int y = 0; y < 4; ++y) {
+      for (int x = 0; x < 4; ++x) {
+        const int subblock = flip ? y / 2 : x / 2;
+        const int pixel = y * 4 + x;
+        pixels[subblock][counts[subblock]++] = pixel;
+        for (int c = 0; c < 3; ++c) {
+          sums[subblock][c] += block.rgb[pixel][c];
+        }
+      }
+    }
+    for (int differential = 1; differential >= 0; --differential) {
+      const int levels = differential ? 31 : 15;
+      int quantized[2][3];
+      int bases[2][3];
+      bool representable = true;
+      for (int s = 0; s < 2; ++s) {
+        for (int c = 0; c < 3; ++c) {
+          // Rounded sums[s][c] / 8 / 255 * levels.
+          quantized[s][c] = (sums[s][c] * levels + 4 * 255) / (8 * 255);
+          const int q = quantized[s][c];
+          bases[s][c] = differential ? (q << 3) | (q >> 2) : q * 17;
+        }
+      }
+      if (differential) {
+        for (int c = 0; c < 3; ++c) {
+          const int delta = quantized[1][c] - quantized[0][c];
+          representable = representable && delta >= -4 && delta <= 3;
+        }
+        if (!representable) {
+          continue;
+        }
+      }
+      SubblockFit fits[2];
+      FitSubblock(block, pixels[0], bases[0], &fits[0]);
+      FitSubblock(block, pixels[1], bases[1], &fits[1]);
+      const int error = fits[0].error + fits[1].error;
+      if (error >= best_error) {
+        continue;
+      }
+      best_error = error;
+      uint32_t high = 0;
+      for (int c = 0; c < 3; ++c) {
+        const int shift = 27 - 8 * c;
+        if (differential) {
+          high |= quantized[0][c] << shift;
+          high |= ((quantized[1][c] - quantized[0][c]) & 7) << (shift - 3);
+        } else {
+          high |= quantized[0][c] << (shift + 1);
+          high |= quantized[1][c] << (shift - 3);
+        }
+      }
+      high |= fits[0].table << 5 | fits[1].table << 2 | differential << 1 |
+              flip;
+      uint32_t low = 0;
+      for (int s = 0; s < 2; ++s) {
+        for (int i = 0; i < 8; ++i) {
+          const int pixel = pixels[s][i];
+          const int bit = (pixel % 4) * 4 + pixel / 4;
+          low |= (fits[s].indices[i] >> 1) << (16 + bit);
+          low |= (fits[s].indices[i] & 1) << bit;
+        }
+      }
+      best_high = high;
+      best_low = low;
+    }
+  }
+  for (int i = 0; i < 4; ++i) {
+    out[i] = best_high >> (24 - 8 * i);
+    out[4 + i] = best_low >> (24 - 8 * i);
+  }
+}
+
+// Encodes an EAC alpha block, searching every modifier table with the
+// multipliers and base values around the ones that span the block.
+void EncodeAlphaBlock(const PixelBlock& block, uint8_t* out) {
+  const uint8_t* alpha = block.alpha;
+  const int low = *std::min_element(alpha, alpha + 16);
+  const int high = *std::max_element(alpha, alpha + 16);
+  int best_error = 0x7fffffff;
+  int best_base = low;
+  int best_multiplier = 1;
+  int best_table = kEacExactTable;
+  uint8_t best_indices[16];
+  memset(best_indices, kEacExactIndex, sizeof(best_indices));
+  if (low != high) {
+    for (int table = 0; table < 16 && best_error > 0; ++table) {
+      const int* modifiers = kEacModifiers[table];
+      const int span = modifiers[7] - modifiers[3];
+      const int center_multiplier = (high - low + span / 2) / span;
+      for (int multiplier = std::max(center_multiplier - 1, 1);
+           multiplier <= std::min(center_multiplier + 1, 15); ++multiplier) {
+        const int center_base =
+            (low + high - (modifiers[7] + modifiers[3]) * multiplier) / 2;
+        for (int base = std::max(center_base - 1, 0);
+             base <= std::min(center_base + 1, 255); ++base) {
+          int values[8];
+          for (int k = 0; k < 8; ++k) {
+            values[k] = Clamp255(base + modifiers[k] * multiplier);
+          }
+          int error = 0;
+          uint8_t indices[16];
+          for (int i = 0; i < 16 && error < best_error; ++i) {
+            int best = 0x7fffffff;
+            for (int k = 0; k < 8; ++k) {
+              const int distance = Square(values[k] - alpha[i]);
+              if (distance < best) {
+                best = distance;
+                indices[i] = k;
+              }
+            }
+            error += best;
+          }
+          if (error < best_error) {
+            best_error = error;
+            best_base = base;
+            best_multiplier = multiplier;
+            best_table = table;
+            memcpy(best_indices, indices, sizeof(indices));
+          }
+        }
+      }
+    }
+  }
+  uint64_t bits = static_cast<uint64_t>(best_base) << 56 |
+                  static_cast<uint64_t>(best_multiplier) << 52 |
+                  static_cast<uint64_t>(best_table) << 48;
+  for (int x = 0; x < 4; ++x) {
+    for (int y = 0; y < 4; ++y) {
+      const int bit = x * 4 + y;
+      bits |= static_cast<uint64_t>(best_indices[y * 4 + x]) << (45 - 3 * bit);
+    }
+  }
+  for (int i = 0; i < 8; ++i) {
+    out[i] = bits >> (56 - 8 * i);
+  }
+}
+
+void EncodeLevel(const uint8_t* pixels, uint32_t width, uint32_t height,
+                 int channels, bool with_alpha, std::vector<uint8_t>* out) {
+  PixelBlock block;
+  memset(block.alpha, 255, sizeof(block.alpha));
+  const size_t block_bytes = with_alpha ? 16 : 8;
+  size_t offset = out->size();
+  out->resize(offset +
+              (width + 3) / 4 * ((height + 3) / 4) * block_bytes);
+  for (uint32_t block_y = 0; block_y < height; block_y += 4) {
+    for (uint32_t block_x = 0; block_x < width; block_x += 4) {
+      // Edge blocks repeat the last row and column.
+      for (int y = 0; y < 4; ++y) {
+        const uint32_t row = std::min(block_y + y, height - 1);
+        for (int x = 0; x < 4; ++x) {
+          const uint32_t column = std::min(block_x + x, width - 1);
+          const uint8_t* pixel = pixels + (row * width + column) * channels;
+          memcpy(block.rgb[y * 4 + x], pixel, 3);
+          if (channels == 4) {
+            block.alpha[y * 4 + x] = pixel[3];
+          }
+        }
+      }
+      if (with_alpha) {
+        EncodeAlphaBlock(block, &(*out)[offset]);
+        offset += 8;
+      }
+      EncodeColorBlock(block, &(*out)[offset]);
+      offset += 8;
+    }
+  }
+}
+
+// Box filters pixels to half size, rounding odd sizes down.
+void Downsample(const std::vector<uint8_t>& pixels, uint32_t width,
+                uint32_t height, int channels, std::vector<uint8_t>* half) {
+  const uint32_t half_width = std::max(width / 2, 1u);
+  const uint32_t half_height = std::max(height / 2, 1u);
+  half->resize(half_width * half_height * channels);
+  for (uint32_t y = 0; y < half_height; ++y) {
+    const uint32_t y0 = std::min(2 * y, height - 1);
+    const uint32_t y1 = std::min(2 * y + 1, height - 1);
+    for (uint32_t x = 0; x < half_width; ++x) {
+      const uint32_t x0 = std::min(2 * x, width - 1);
+      const uint32_t x1 = std::min(2 * x + 1, width - 1);
+      for (int c = 0; c < channels; ++c) {
+        const int sum = pixels[(y0 * width + x0) * channels + c] +
+                        pixels[(y0 * width + x1) * channels + c] +
+                        pixels[(y1 * width + x0) * channels + c] +
+                        pixels[(y1 * width + x1) * channels + c];
+        (*half)[(y * half_width + x) * channels + c] = (sum + 2) / 4;
+      }
+    }
+  }
+}
+}  // namespace
+
+bool EncodeETC2(const Texture::Image& image, Texture::Image* compressed) {
+  const int channels = image.format == GL_RGBA ? 4 : 3;
+  if (image.compressed_format != 0 || image.width == 0 || image.height == 0 ||
+      image.pixels.size() <
+          static_cast<size_t>(image.width) * image.height * channels) {
+    LOGE("EncodeETC2: need an uncompressed image");
+    return false;
+  }
+  bool with_alpha = false;
+  for (size_t i = 3; channels == 4 && i < image.pixels.size() && !with_alpha;
+       i += 4) {
+    with_alpha = image.pixels[i] != 255;
+  }
+  compressed->width = image.width;
+  compressed->height = image.height;
+  compressed->format = with_alpha ? GL_RGBA : GL_RGB;
+  compressed->compressed_format =
+      with_alpha ? GL_COMPRESSED_RGBA8_ETC2_EAC : GL_COMPRESSED_RGB8_ETC2;
+  compressed->pixels.clear();
+  compressed->level_sizes.clear();
+
+  uint32_t width = image.width;
+  uint32_t height = image.height;
+  std::vector<uint8_t> level;
+  std::vector<uint8_t> next_level;
+  const uint8_t* pixels = image.pixels.data();
+  while (true) {
+    const size_t offset = compressed->pixels.size();
+    EncodeLevel(pixels, width, height, channels, with_alpha,
+                &compressed->pixels);
+    compressed->level_sizes.push_back(compressed->pixels.size() - offset);
+    if (width == 1 && height == 1) {
+      break;
+    }
+    Downsample(pixels == image.pixels.data() ? image.pixels : level, width,
+               height, channels, &next_level);
+    level.swap(next_level);
+    pixels = level.data();
+    width = std::max(width / 2, 1u);
+    height = std::max(height / 2, 1u);
+  }
+  return true;
+}
+
+bool ReadKTX(const char* path, Texture::Image* image) {
+  FILE* file = fopen(path, "rb");
+  if (file == NULL) {
+    return false;
+  }
+  KtxHeader header;
+  BlockInfo block;
+  bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+            memcmp(header.identifier, kKtxIdentifier,
+                   sizeof(kKtxIdentifier)) == 0 &&
+            header.endianness == kKtxEndianness && header.gl_type == 0 &&
+            GetBlockInfo(header.gl_internal_format, &block) &&
+            header.pixel_width > 0 && header.pixel_width <= kMaxKtxSize &&
+            header.pixel_height > 0 && header.pixel_height <= kMaxKtxSize &&
+            header.pixel_depth == 0 && header.array_elements == 0 &&
+            header.faces == 1 && header.mipmap_levels > 0 &&
+            header.mipmap_levels <= GetLevelCount(header.pixel_width,
+                                                  header.pixel_height) &&
+            fseek(file, header.key_value_bytes, SEEK_CUR) == 0;
+  image->pixels.clear();
+  image->level_sizes.clear();
+  uint32_t width = header.pixel_width;
+  uint32_t height = header.pixel_height;
+  for (uint32_t level = 0; ok && level < header.mipmap_levels; ++level) {
+    uint32_t size = 0;
+    ok = fread(&size, sizeof(size), 1, file) == 1 &&
+         size == GetLevelSize(block, width, height);
+    if (ok) {
+      const size_t offset = image->pixels.size();
+      image->pixels.resize(offset + size);
+      image->level_sizes.push_back(size);
+      // Levels are padded to 4 bytes; block sizes already are.
+      ok = fread(&image->pixels[offset], 1, size, file) == size &&
+           fseek(file, 3 - (size + 3) % 4, SEEK_CUR) == 0;
+    }
+    width = std::max(width / 2, 1u);
+    height = std::max(height / 2, 1u);
+  }
+  fclose(file);
+  if (!ok) {
+    LOGE("ReadKTX: cannot use %s", path);
+    image->pixels.clear();
+    image->level_sizes.clear();
+    return false;
+  }
+  image->width = header.pixel_width;
+  image->height = header.pixel_height;
+  image->format = header.gl_base_internal_format == GL_RGB ? GL_RGB : GL_RGBA;
+  image->compressed_format = header.gl_internal_format;
+  return true;
+}
+
+bool WriteKTX(const char* path, const Texture::Image& image) {
+  BlockInfo block;
+  if (image.compressed_format == 0 ||
+      !GetBlockInfo(image.compressed_format, &block)) {
+    LOGE("WriteKTX: need a compressed image");
+    return false;
+  }
+  KtxHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.identifier, kKtxIdentifier, sizeof(kKtxIdentifier));
+  header.endianness = kKtxEndianness;
+  header.gl_type_size = 1;
+  header.gl_internal_format = image.compressed_format;
+  header.gl_base_internal_format = image.format;
+  header.pixel_width = image.width;
+  header.pixel_height = image.height;
+  header.faces = 1;
+  header.mipmap_levels = image.level_sizes.size();
+
+  const bool ok = util::WriteFileAtomically(path, [&](FILE* file) {
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    size_t offset = 0;
+    const uint8_t padding[3] = {0, 0, 0};
+    for (size_t level = 0; written && level < image.level_sizes.size();
+         ++level) {
+      const uint32_t size = image.level_sizes[level];
+      const size_t padding_size = 3 - (size + 3) % 4;
+      written = offset + size <= image.pixels.size() &&
+                fwrite(&size, sizeof(size), 1, file) == 1 &&
+                fwrite(&image.pixels[offset], 1, size, file) == size &&
+                fwrite(padding, 1, padding_size, file) == padding_size;
+      offset += size;
+    }
+    return written;
+  });
+  if (!ok) {
+    LOGE("WriteKTX: cannot write %s", path);
+  }
+  return ok;
+}
+
+bool IsFormatSupported(GLenum format) {
+  BlockInfo block;
+  if (!GetBlockInfo(format, &block)) {
+    return false;
+  }
+  // ETC2 and EAC are core in OpenGL ES 3.
+  if (format >= GL_COMPRESSED_RGB8_ETC2 &&
+      format <= GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC) {
+    return util::HasVertexArrays();
+  }
+  if (format == GL_ETC1_RGB8_OES) {
+    return util::HasExtension("GL_OES_compressed_ETC1_RGB8_texture");
+  }
+  if (format >= GL_COMPRESSED_RGBA_ASTC_4x4_KHR) {
+    return util::HasExtension("GL_KHR_texture_compression_astc_ldr");
+  }
+  return false;
+}
+
+}  // namespace compressed_texture
+}  // namespace tango_gl
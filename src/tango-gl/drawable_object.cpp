@@ -0,0 +1,607 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tango-gl/drawable_object.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <utility>
+
+#include "tango-gl/gl_debug.h"
+#include "tango-gl/gl_state.h"
+#include "tango-gl/program_cache.h"
+#include "tango-gl/shaders.h"
+
+namespace tango_gl {
+
+namespace {
+const size_t kWholeBuffer = static_cast<size_t>(-1);
+
+GLenum ToGlUsage(DrawableObject::BufferUsage usage) {
+  switch (usage) {
+    case DrawableObject::kDynamicDraw:
+      return GL_DYNAMIC_DRAW;
+    case DrawableObject::kStreamDraw:
+      return GL_STREAM_DRAW;
+    default:
+      return GL_STATIC_DRAW;
+  }
+}
+
+bool IsValidAttrib(GLuint attrib) { return static_cast<GLint>(attrib) >= 0; }
+}  // namespace
+
+DrawableObject::DrawableObject()
+    : red_(0),
+      green_(0),
+      blue_(0),
+      alpha_(1.0f),
+      shader_program_(0),
+      uniform_color_(-1),
+      uniform_mvp_mat_(-1),
+      attrib_vertices_(-1),
+      attrib_normals_(-1),
+      usage_(kStaticDraw),
+      index_type_(GL_UNSIGNED_SHORT),
+      vertex_array_(0),
+      vertex_array_program_(0),
+      vertex_array_dirty_(true),
+      previous_vertex_array_(0),
+      previous_array_buffer_(0),
+      previous_element_buffer_(0),
+      world_bounds_version_(0),
+      world_bounds_valid_(false),
+      geometry_key_(0),
+      geometry_key_valid_(false) {}
+
+DrawableObject::~DrawableObject() {
+  // shader_program_ belongs to the ProgramCache.
+  const GLuint buffers[] = {vertex_buffer_.id, normal_buffer_.id,
+                            index_buffer_.id};
+  GlState& state = GlState::GetInstance();
+  for (GLuint buffer : buffers) {
+    if (buffer != 0) {
+      state.DeleteBuffers(1, &buffer);
+    }
+  }
+  if (vertex_array_ != 0) {
+    state.DeleteVertexArrays(1, &vertex_array_);
+  }
+}
+
+void DrawableObject::SetShader() {
+  ProgramCache& programs = ProgramCache::GetInstance();
+  shader_program_ = programs.GetProgram(shaders::GetBasicVertexShader(),
+                                        shaders::GetBasicFragmentShader());
+  if (!shader_program_) {
+    LOGE("Could not create program.");
+  }
+  uniform_mvp_mat_ = programs.GetUniformLocation(shader_program_, "mvp");
+  uniform_color_ = programs.GetUniformLocation(shader_program_, "color");
+  attrib_vertices_ = programs.GetAttribLocation(shader_program_, "vertex");
+  attrib_normals_ = programs.GetAttribLocation(shader_program_, "normal");
+}
+
+void DrawableObject::SetColor(const float red, const float green,
+                              const float blue) {
+  red_ = red;
+  green_ = green;
+  blue_ = blue;
+}
+
+void DrawableObject::SetColor(const Color& color) {
+  SetColor(color.r, color.g, color.b);
+}
+
+void DrawableObject::SetAlpha(const float alpha) { alpha_ = alpha; }
+
+void DrawableObject::SetBufferUsage(BufferUsage usage) {
+  if (usage == usage_) {
+    return;
+  }
+  usage_ = usage;
+  vertex_buffer_.reallocate = true;
+  normal_buffer_.reallocate = true;
+  index_buffer_.reallocate = true;
+}
+
+void DrawableObject::SetVertices(const std::vector<GLfloat>& vertices) {
+  vertices_ = vertices;
+  VerticesReplaced();
+}
+
+void DrawableObject::SetVertices(const std::vector<GLfloat>& vertices,
+                                 const std::vector<GLushort>& indices) {
+  SetVertices(vertices);
+  indices_ = indices;
+  IndicesReplaced(GL_UNSIGNED_SHORT);
+}
+
+void DrawableObject::SetVertices(const std::vector<GLfloat>& vertices,
+                                 const std::vector<GLfloat>& normals) {
+  SetVertices(vertices);
+  normals_ = normals;
+  NormalsReplaced();
+}
+
+void DrawableObject::SetVertices(std::vector<GLfloat>&& vertices) {
+  vertices_ = std::move(vertices);
+  vertices.clear();
+  VerticesReplaced();
+}
+
+void DrawableObject::SetVertices(std::vector<GLfloat>&& vertices,
+                                 std::vector<GLushort>&& indices) {
+  SetVertices(std::move(vertices));
+  indices_ = std::move(indices);
+  indices.clear();
+  IndicesReplaced(GL_UNSIGNED_SHORT);
+}
+
+void DrawableObject::SetVertices(std::vector<GLfloat>&& vertices,
+                                 std::vector<GLfloat>&& normals) {
+  SetVertices(std::move(vertices));
+  normals_ = std::move(normals);
+  normals.clear();
+  NormalsReplaced();
+}
+
+void DrawableObject::SetVertices(const GLfloat* vertices, size_t count) {
+  vertices_.assign(vertices, vertices + count);
+  VerticesReplaced();
+}
+
+void DrawableObject::SetVertices(const GLfloat* vertices, size_t vertex_count,
+                                 const GLushort* indices, size_t index_count) {
+  SetVertices(vertices, vertex_count);
+  indices_.assign(indices, indices + index_count);
+  IndicesReplaced(GL_UNSIGNED_SHORT);
+}
+
+void DrawableObject::SetVertices(const GLfloat* vertices, size_t vertex_count,
+                                 const GLfloat* normals, size_t normal_count) {
+  SetVertices(vertices, vertex_count);
+  normals_.assign(normals, normals + normal_count);
+  NormalsReplaced();
+}
+
+void DrawableObject::SetVertices(const std::vector<GLfloat>& vertices,
+                                 const std::vector<GLuint>& indices) {
+  SetVertices(vertices);
+  wide_indices_ = indices;
+  IndicesReplaced(GL_UNSIGNED_INT);
+}
+
+void DrawableObject::SetVertices(std::vector<GLfloat>&& vertices,
+                                 std::vector<GLuint>&& indices) {
+  SetVertices(std::move(vertices));
+  wide_indices_ = std::move(indices);
+  indices.clear();
+  IndicesReplaced(GL_UNSIGNED_INT);
+}
+
+void DrawableObject::SetVertices(const GLfloat* vertices, size_t vertex_count,
+                                 const GLuint* indices, size_t index_count) {
+  SetVertices(vertices, vertex_count);
+  wide_indices_.assign(indices, indices + index_count);
+  IndicesReplaced(GL_UNSIGNED_INT);
+}
+
+GLfloat* DrawableObject::MapVertices(size_t count) {
+  if (vertex_buffer_.released) {
+    // The old contents are only on the GPU.
+    vertices_.assign(count, 0.0f);
+    ReadBack(GL_ARRAY_BUFFER, vertex_buffer_, vertices_.data(),
+             count * sizeof(GLfloat));
+  } else {
+    vertices_.resize(count);
+  }
+  return vertices_.data();
+}
+
+void DrawableObject::UnmapVertices() { VerticesReplaced(); }
+
+void DrawableObject::UpdateVertices(size_t offset, const GLfloat* data,
+                                    size_t count) {
+  if (UpdateRange(GL_ARRAY_BUFFER, offset * sizeof(GLfloat), data,
+                  count * sizeof(GLfloat), vertices_.size() * sizeof(GLfloat),
+                  vertices_.data(), &vertex_buffer_)) {
+    ExtendBounds(offset, data, count);
+  }
+}
+
+void DrawableObject::UpdateNormals(size_t offset, const GLfloat* data,
+                                   size_t count) {
+  UpdateRange(GL_ARRAY_BUFFER, offset * sizeof(GLfloat), data,
+              count * sizeof(GLfloat), normals_.size() * sizeof(GLfloat),
+              normals_.data(), &normal_buffer_);
+}
+
+void DrawableObject::UpdateIndices(size_t offset, const GLushort* data,
+                                   size_t count) {
+  if (index_type_ != GL_UNSIGNED_SHORT) {
+    LOGE("DrawableObject: 16-bit index update of 32-bit indices ignored.");
+    return;
+  }
+  UpdateRange(GL_ELEMENT_ARRAY_BUFFER, offset * sizeof(GLushort), data,
+              count * sizeof(GLushort), indices_.size() * sizeof(GLushort),
+              indices_.data(), &index_buffer_);
+}
+
+void DrawableObject::UpdateIndices(size_t offset, const GLuint* data,
+                                   size_t count) {
+  if (index_type_ != GL_UNSIGNED_INT) {
+    LOGE("DrawableObject: 32-bit index update of 16-bit indices ignored.");
+    return;
+  }
+  UpdateRange(GL_ELEMENT_ARRAY_BUFFER, offset * sizeof(GLuint), data,
+              count * sizeof(GLuint), wide_indices_.size() * sizeof(GLuint),
+              wide_indices_.data(), &index_buffer_);
+}
+
+void DrawableObject::MarkVerticesDirty(size_t offset, size_t count) {
+  vertex_buffer_.released = false;
+  MarkDirty(&vertex_buffer_, offset * sizeof(GLfloat),
+            (offset + count) * sizeof(GLfloat));
+  if (offset == 0 && count >= vertices_.size()) {
+    local_bounds_ = BoundingBox::FromPoints(vertices_.data(),
+                                            vertices_.size() / 3);
+    world_bounds_valid_ = false;
+  } else if (offset < vertices_.size()) {
+    ExtendBounds(offset, vertices_.data() + offset,
+                 std::min(count, vertices_.size() - offset));
+  }
+}
+
+void DrawableObject::VerticesReplaced() {
+  vertex_buffer_.released = false;
+  MarkDirty(&vertex_buffer_, 0, kWholeBuffer);
+  local_bounds_ = BoundingBox::FromPoints(vertices_.data(),
+                                          vertices_.size() / 3);
+  world_bounds_valid_ = false;
+}
+
+void DrawableObject::NormalsReplaced() {
+  normal_buffer_.released = false;
+  MarkDirty(&normal_buffer_, 0, kWholeBuffer);
+}
+
+void DrawableObject::IndicesReplaced(GLenum type) {
+  // Only one of the two index arrays is in use at a time.
+  if (type == GL_UNSIGNED_INT) {
+    std::vector<GLushort>().swap(indices_);
+  } else {
+    std::vector<GLuint>().swap(wide_indices_);
+  }
+  index_type_ = type;
+  index_buffer_.released = false;
+  MarkDirty(&index_buffer_, 0, kWholeBuffer);
+}
+
+const BoundingBox& DrawableObject::GetWorldBounds() const {
+  const uint32_t version = GetWorldVersion();
+  if (!world_bounds_valid_ || version != world_bounds_version_) {
+    world_bounds_ = local_bounds_.Transformed(GetTransformationMatrix());
+    world_bounds_version_ = version;
+    world_bounds_valid_ = true;
+  }
+  return world_bounds_;
+}
+
+void DrawableObject::ReleaseCpuData() {
+  // The key is taken from the CPU copies, so compute it while they exist.
+  GetGeometryKey();
+  SaveBindings();
+  UploadPending();
+  RestoreBindings();
+  // swap() rather than clear() so the memory is actually returned.
+  std::vector<GLfloat>().swap(vertices_);
+  std::vector<GLfloat>().swap(normals_);
+  std::vector<GLushort>().swap(indices_);
+  std::vector<GLuint>().swap(wide_indices_);
+  vertex_buffer_.released = true;
+  normal_buffer_.released = true;
+  index_buffer_.released = true;
+}
+
+bool DrawableObject::HasCpuData() const {
+  return !vertex_buffer_.released || !normal_buffer_.released ||
+         !index_buffer_.released;
+}
+
+bool DrawableObject::BindGeometry() const {
+  SaveBindings();
+  UploadPending();
+  if (GetVertexCount() == 0 || !IsValidAttrib(attrib_vertices_)) {
+    RestoreBindings();
+    return false;
+  }
+  if (vertex_array_ == 0) {
+    SetAttributes();
+  } else if (vertex_array_dirty_ || vertex_array_program_ != shader_program_) {
+    if (vertex_array_program_ != 0 &&
+        vertex_array_program_ != shader_program_) {
+      // Start from a fresh vertex array so nothing enabled for the previous
+      // shader lingers.
+      GlState& state = GlState::GetInstance();
+      state.BindVertexArray(0);
+      state.DeleteVertexArrays(1, &vertex_array_);
+      glGenVertexArrays(1, &vertex_array_);
+      state.BindVertexArray(vertex_array_);
+    }
+    SetAttributes();
+    vertex_array_program_ = shader_program_;
+    vertex_array_dirty_ = false;
+  }
+  return true;
+}
+
+void DrawableObject::UnbindGeometry() const {
+  if (vertex_array_ == 0) {
+    GlState& state = GlState::GetInstance();
+    state.SetVertexAttribArray(attrib_vertices_, false);
+    if (normal_buffer_.size > 0 && IsValidAttrib(attrib_normals_)) {
+      state.SetVertexAttribArray(attrib_normals_, false);
+    }
+  }
+  RestoreBindings();
+}
+
+GLsizei DrawableObject::GetVertexCount() const {
+  return static_cast<GLsizei>(vertex_buffer_.size / (3 * sizeof(GLfloat)));
+}
+
+GLsizei DrawableObject::GetIndexCount() const {
+  const size_t index_size =
+      index_type_ == GL_UNSIGNED_INT ? sizeof(GLuint) : sizeof(GLushort);
+  return static_cast<GLsizei>(index_buffer_.size / index_size);
+}
+
+uint64_t DrawableObject::GetGeometryKey() const {
+  if (!geometry_key_valid_) {
+    const GpuBuffer* buffers[] = {&vertex_buffer_, &normal_buffer_,
+                                  &index_buffer_};
+    bool gpu_only = false;
+    for (const GpuBuffer* buffer : buffers) {
+      gpu_only = gpu_only || (buffer->released && buffer->size > 0);
+    }
+    if (gpu_only) {
+      // Released geometry changed since the CPU copy went away, so its
+      // content cannot be hashed; the object gets a key of its own.
+      geometry_key_ = reinterpret_cast<uintptr_t>(this);
+    } else {
+      const uint64_t sizes[] = {vertices_.size(), normals_.size(),
+                                indices_.size(), wide_indices_.size()};
+      uint64_t hash = util::HashBytes(sizes, sizeof(sizes));
+      hash = util::HashBytes(vertices_.data(),
+                             vertices_.size() * sizeof(GLfloat), hash);
+      hash = util::HashBytes(normals_.data(), normals_.size() * sizeof(GLfloat),
+                             hash);
+      hash = util::HashBytes(indices_.data(),
+                             indices_.size() * sizeof(GLushort), hash);
+      geometry_key_ = util::HashBytes(
+          wide_indices_.data(), wide_indices_.size() * sizeof(GLuint), hash);
+    }
+    geometry_key_valid_ = true;
+  }
+  return geometry_key_;
+}
+
+void DrawableObject::PrepareGeometry() const {
+  const GpuBuffer* buffers[] = {&vertex_buffer_, &normal_buffer_,
+                                &index_buffer_};
+  for (const GpuBuffer* buffer : buffers) {
+    if (buffer->dirty_begin != buffer->dirty_end || buffer->reallocate) {
+      SaveBindings();
+      UploadPending();
+      RestoreBindings();
+      return;
+    }
+  }
+}
+
+void DrawableObject::MarkDirty(GpuBuffer* buffer, size_t begin, size_t end) {
+  geometry_key_valid_ = false;
+  if (buffer->dirty_begin == buffer->dirty_end) {
+    buffer->dirty_begin = begin;
+    buffer->dirty_end = end;
+  } else {
+    buffer->dirty_begin = std::min(buffer->dirty_begin, begin);
+    buffer->dirty_end = std::max(buffer->dirty_end, end);
+  }
+}
+
+void DrawableObject::SaveBindings() const {
+  if (vertex_array_ == 0 && util::HasVertexArrays()) {
+    glGenVertexArrays(1, &vertex_array_);
+    vertex_array_dirty_ = true;
+  }
+  // The shadow answers these without a glGet round trip once known.
+  GlState& state = GlState::GetInstance();
+  previous_array_buffer_ = state.GetBuffer(GL_ARRAY_BUFFER);
+  if (vertex_array_ != 0) {
+    // The element buffer binding belongs to the vertex array, so binding
+    // ours first keeps uploads from touching anyone else's.
+    previous_vertex_array_ = state.GetVertexArray();
+    state.BindVertexArray(vertex_array_);
+  } else {
+    previous_element_buffer_ = state.GetBuffer(GL_ELEMENT_ARRAY_BUFFER);
+  }
+}
+
+void DrawableObject::RestoreBindings() const {
+  GlState& state = GlState::GetInstance();
+  if (vertex_array_ != 0) {
+    state.BindVertexArray(previous_vertex_array_);
+  } else {
+    state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, previous_element_buffer_);
+  }
+  state.BindBuffer(GL_ARRAY_BUFFER, previous_array_buffer_);
+}
+
+void DrawableObject::Upload(GLenum target, const void* data, size_t size,
+                            GpuBuffer* buffer) const {
+  if (buffer->dirty_begin == buffer->dirty_end && !buffer->reallocate) {
+    return;
+  }
+  if (buffer->id == 0) {
+    if (size == 0) {
+      buffer->dirty_begin = buffer->dirty_end = 0;
+      return;
+    }
+    glGenBuffers(1, &buffer->id);
+    vertex_array_dirty_ = true;
+  }
+  if (buffer->size == 0 || size == 0) {
+    // Whether the normals are bound depends on whether there are any.
+    vertex_array_dirty_ = true;
+  }
+  GlState::GetInstance().BindBuffer(target, buffer->id);
+  const size_t begin = std::min(buffer->dirty_begin, size);
+  const size_t end = std::min(buffer->dirty_end, size);
+  const bool whole = begin == 0 && end == size;
+  // Stream buffers are respecified on every full update so the driver can
+  // hand out fresh storage instead of waiting for draws still using the
+  // old contents.
+  if (size > buffer->capacity && usage_ == kDynamicDraw) {
+    // Geometry that grows gets room to grow into, so appending a vertex at a
+    // time does not reallocate every frame.
+    buffer->capacity = std::max(size, buffer->capacity * 2);
+    TANGO_GL_CHECK(glBufferData(target, buffer->capacity, NULL,
+                                ToGlUsage(usage_)));
+    TANGO_GL_CHECK(glBufferSubData(target, 0, size, data));
+  } else if (buffer->reallocate || size > buffer->capacity ||
+             (whole && usage_ == kStreamDraw)) {
+    TANGO_GL_CHECK(glBufferData(target, size, data, ToGlUsage(usage_)));
+    buffer->capacity = size;
+  } else if (end > begin) {
+    TANGO_GL_CHECK(glBufferSubData(target, begin, end - begin,
+                                   static_cast<const uint8_t*>(data) + begin));
+  }
+  buffer->size = size;
+  buffer->dirty_begin = buffer->dirty_end = 0;
+  buffer->reallocate = false;
+}
+
+void DrawableObject::UploadPending() const {
+  if (!vertex_buffer_.released) {
+    Upload(GL_ARRAY_BUFFER, vertices_.data(),
+           vertices_.size() * sizeof(GLfloat), &vertex_buffer_);
+  }
+  if (!normal_buffer_.released) {
+    Upload(GL_ARRAY_BUFFER, normals_.data(), normals_.size() * sizeof(GLfloat),
+           &normal_buffer_);
+  }
+  if (!index_buffer_.released) {
+    if (index_type_ == GL_UNSIGNED_INT) {
+      Upload(GL_ELEMENT_ARRAY_BUFFER, wide_indices_.data(),
+             wide_indices_.size() * sizeof(GLuint), &index_buffer_);
+    } else {
+      Upload(GL_ELEMENT_ARRAY_BUFFER, indices_.data(),
+             indices_.size() * sizeof(GLushort), &index_buffer_);
+    }
+  }
+}
+
+bool DrawableObject::UpdateRange(GLenum target, size_t offset,
+                                 const void* data, size_t size,
+                                 size_t cpu_size, void* cpu_data,
+                                 GpuBuffer* buffer) {
+  if (size == 0) {
+    return false;
+  }
+  if (!buffer->released) {
+    if (offset + size > cpu_size) {
+      return false;
+    }
+    memcpy(static_cast<uint8_t*>(cpu_data) + offset, data, size);
+    MarkDirty(buffer, offset, offset + size);
+    return true;
+  }
+  if (offset + size > buffer->size) {
+    return false;
+  }
+  geometry_key_valid_ = false;
+  SaveBindings();
+  GlState::GetInstance().BindBuffer(target, buffer->id);
+  TANGO_GL_CHECK(glBufferSubData(target, offset, size, data));
+  RestoreBindings();
+  return true;
+}
+
+void DrawableObject::ReadBack(GLenum target, const GpuBuffer& buffer,
+                              void* data, size_t size) const {
+  size = std::min(size, buffer.size);
+  // OpenGL ES 2 cannot read a buffer object back.
+  if (size == 0 || !util::HasVertexArrays()) {
+    return;
+  }
+  SaveBindings();
+  GlState::GetInstance().BindBuffer(target, buffer.id);
+  const void* mapped = glMapBufferRange(target, 0, size, GL_MAP_READ_BIT);
+  if (mapped == NULL) {
+    LOGE("DrawableObject: could not map the buffer to read it back.");
+  } else {
+    memcpy(data, mapped, size);
+    // False means the contents were lost while mapped.
+    if (!glUnmapBuffer(target)) {
+      LOGE("DrawableObject: buffer contents lost while reading them back.");
+      memset(data, 0, size);
+    }
+  }
+  RestoreBindings();
+}
+
+void DrawableObject::ExtendBounds(size_t offset, const GLfloat* data,
+                                  size_t count) {
+  // Each axis of a box is independent, so a range that starts or ends in
+  // the middle of a vertex still extends the axes it covers.
+  size_t i = 0;
+  for (; i < count && (offset + i) % 3 != 0; ++i) {
+    const int axis = (offset + i) % 3;
+    local_bounds_.min[axis] = std::min(local_bounds_.min[axis], data[i]);
+    local_bounds_.max[axis] = std::max(local_bounds_.max[axis], data[i]);
+  }
+  const size_t whole = (count - i) / 3;
+  local_bounds_.Extend(data + i, whole);
+  for (i += 3 * whole; i < count; ++i) {
+    const int axis = (offset + i) % 3;
+    local_bounds_.min[axis] = std::min(local_bounds_.min[axis], data[i]);
+    local_bounds_.max[axis] = std::max(local_bounds_.max[axis], data[i]);
+  }
+  world_bounds_valid_ = false;
+}
+
+void DrawableObject::SetAttributes() const {
+  GlState& state = GlState::GetInstance();
+  state.BindBuffer(GL_ARRAY_BUFFER, vertex_buffer_.id);
+  state.SetVertexAttribArray(attrib_vertices_, true);
+  TANGO_GL_CHECK(glVertexAttribPointer(attrib_vertices_, 3, GL_FLOAT, GL_FALSE,
+                                       3 * sizeof(GLfloat), 0));
+  if (normal_buffer_.size > 0 && IsValidAttrib(attrib_normals_)) {
+    state.BindBuffer(GL_ARRAY_BUFFER, normal_buffer_.id);
+    state.SetVertexAttribArray(attrib_normals_, true);
+    TANGO_GL_CHECK(glVertexAttribPointer(attrib_normals_, 3, GL_FLOAT, GL_FALSE,
+                                         3 * sizeof(GLfloat), 0));
+  } else if (vertex_array_ != 0 && IsValidAttrib(attrib_normals_)) {
+    state.SetVertexAttribArray(attrib_normals_, false);
+  }
+  state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER,
+                   index_buffer_.size > 0 ? index_buffer_.id : 0);
+}
+
+}  // namespace tango_gl
@@ -0,0 +1,208 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tango-gl/frustum_culler.h"
+
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FRUSTUM_CULLER_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define FRUSTUM_CULLER_SSE2 1
+#endif
+
+namespace tango_gl {
+
+namespace {
+double NowMs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000.0 + now.tv_nsec / 1.0e6;
+}
+}  // namespace
+
+FrustumCuller::FrustumCuller() {
+  // Until a frustum is set every plane is 0 >= 0, so everything is kept.
+  memset(planes_, 0, sizeof(planes_));
+  memset(abs_normals_, 0, sizeof(abs_normals_));
+  memset(&stats_, 0, sizeof(stats_));
+}
+
+void FrustumCuller::SetViewProjection(const glm::mat4& view_projection_mat) {
+  // Gribb and Hartmann: a clip space point is inside when -w <= x, y, z <=
+  // w, so each plane is the last row of the matrix plus or minus one of the
+  // others. glm is column major, so row i is m[0][i] .. m[3][i].
+  const glm::mat4& m = view_projection_mat;
+  for (int plane = 0; plane < 6; ++plane) {
+    const int row = plane / 2;
+    const float sign = plane % 2 == 0 ? 1.0f : -1.0f;
+    for (int column = 0; column < 4; ++column) {
+      planes_[plane][column] = m[column][3] + sign * m[column][row];
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+      abs_normals_[plane][axis] = fabsf(planes_[plane][axis]);
+    }
+  }
+  memset(&stats_, 0, sizeof(stats_));
+}
+
+bool FrustumCuller::IsVisible(const BoundingBox& box) const {
+  if (box.IsEmpty()) {
+    return true;
+  }
+  const glm::vec3 center = box.GetCenter();
+  const glm::vec3 extent = box.GetExtent();
+  for (int plane = 0; plane < 6; ++plane) {
+    const float* p = planes_[plane];
+    const float* a = abs_normals_[plane];
+    const float distance =
+        p[0] * center.x + p[1] * center.y + p[2] * center.z + p[3];
+    const float radius = a[0] * extent.x + a[1] * extent.y + a[2] * extent.z;
+    if (distance + radius < 0.0f) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void FrustumCuller::Cull(const BoundingBox* boxes, size_t count,
+                         uint8_t* visible) {
+  const double start = NowMs();
+  const size_t padded = (count + 3) & ~static_cast<size_t>(3);
+  centers_.assign(3 * padded, 0.0f);
+  extents_.assign(3 * padded, 0.0f);
+  for (size_t i = 0; i < count; ++i) {
+    const glm::vec3 center = boxes[i].GetCenter();
+    const glm::vec3 extent = boxes[i].GetExtent();
+    for (int axis = 0; axis < 3; ++axis) {
+      centers_[axis * padded + i] = center[axis];
+      extents_[axis * padded + i] = extent[axis];
+    }
+  }
+  results_.resize(padded);
+  TestPacked(padded, results_.data());
+
+  int kept = 0;
+  for (size_t i = 0; i < count; ++i) {
+    visible[i] = results_[i] || boxes[i].IsEmpty();
+    kept += visible[i];
+  }
+  stats_.tested += static_cast<int>(count);
+  stats_.visible += kept;
+  stats_.culled += static_cast<int>(count) - kept;
+  stats_.cull_ms += NowMs() - start;
+}
+
+void FrustumCuller::Cull(const std::vector<const DrawableObject*>& objects,
+                         std::vector<const DrawableObject*>* visible) {
+  boxes_.resize(objects.size());
+  for (size_t i = 0; i < objects.size(); ++i) {
+    boxes_[i] = objects[i]->GetWorldBounds();
+  }
+  object_visible_.resize(objects.size());
+  Cull(boxes_.data(), boxes_.size(), object_visible_.data());
+  for (size_t i = 0; i < objects.size(); ++i) {
+    if (object_visible_[i]) {
+      visible->push_back(objects[i]);
+    }
+  }
+}
+
+void FrustumCuller::TestPacked(size_t count, uint8_t* visible) const {
+  const float* cx = centers_.data();
+  const float* cy = cx + count;
+  const float* cz = cy + count;
+  const float* ex = extents_.data();
+  const float* ey = ex + count;
+  const float* ez = ey + count;
+  // Every path computes ((a x + b y) + c z) + d and the radius in the same
+  // order, so they agree on boxes that touch a plane.
+#if defined(FRUSTUM_CULLER_NEON)
+  for (size_t i = 0; i < count; i += 4) {
+    const float32x4_t x = vld1q_f32(cx + i);
+    const float32x4_t y = vld1q_f32(cy + i);
+    const float32x4_t z = vld1q_f32(cz + i);
+    const float32x4_t half_x = vld1q_f32(ex + i);
+    const float32x4_t half_y = vld1q_f32(ey + i);
+    const float32x4_t half_z = vld1q_f32(ez + i);
+    uint32x4_t outside = vdupq_n_u32(0);
+    for (int plane = 0; plane < 6; ++plane) {
+      const float* p = planes_[plane];
+      const float* a = abs_normals_[plane];
+      float32x4_t distance = vmulq_n_f32(x, p[0]);
+      distance = vaddq_f32(distance, vmulq_n_f32(y, p[1]));
+      distance = vaddq_f32(distance, vmulq_n_f32(z, p[2]));
+      distance = vaddq_f32(distance, vdupq_n_f32(p[3]));
+      float32x4_t radius = vmulq_n_f32(half_x, a[0]);
+      radius = vaddq_f32(radius, vmulq_n_f32(half_y, a[1]));
+      radius = vaddq_f32(radius, vmulq_n_f32(half_z, a[2]));
+      outside = vorrq_u32(
+          outside, vcltq_f32(vaddq_f32(distance, radius), vdupq_n_f32(0.0f)));
+    }
+    uint32_t lanes[4];
+    vst1q_u32(lanes, outside);
+    for (int lane = 0; lane < 4; ++lane) {
+      visible[i + lane] = lanes[lane] == 0;
+    }
+  }
+#elif defined(FRUSTUM_CULLER_SSE2)
+  for (size_t i = 0; i < count; i += 4) {
+    const __m128 x = _mm_loadu_ps(cx + i);
+    const __m128 y = _mm_loadu_ps(cy + i);
+    const __m128 z = _mm_loadu_ps(cz + i);
+    const __m128 half_x = _mm_loadu_ps(ex + i);
+    const __m128 half_y = _mm_loadu_ps(ey + i);
+    const __m128 half_z = _mm_loadu_ps(ez + i);
+    __m128 outside = _mm_setzero_ps();
+    for (int plane = 0; plane < 6; ++plane) {
+      const float* p = planes_[plane];
+      const float* a = abs_normals_[plane];
+      __m128 distance = _mm_mul_ps(x, _mm_set1_ps(p[0]));
+      distance = _mm_add_ps(distance, _mm_mul_ps(y, _mm_set1_ps(p[1])));
+      distance = _mm_add_ps(distance, _mm_mul_ps(z, _mm_set1_ps(p[2])));
+      distance = _mm_add_ps(distance, _mm_set1_ps(p[3]));
+      __m128 radius = _mm_mul_ps(half_x, _mm_set1_ps(a[0]));
+      radius = _mm_add_ps(radius, _mm_mul_ps(half_y, _mm_set1_ps(a[1])));
+      radius = _mm_add_ps(radius, _mm_mul_ps(half_z, _mm_set1_ps(a[2])));
+      outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius),
+                                                _mm_setzero_ps()));
+    }
+    const int mask = _mm_movemask_ps(outside);
+    for (int lane = 0; lane < 4; ++lane) {
+      visible[i + lane] = (mask >> lane & 1) == 0;
+    }
+  }
+#else
+  for (size_t i = 0; i < count; ++i) {
+    bool outside = false;
+    for (int plane = 0; plane < 6 && !outside; ++plane) {
+      const float* p = planes_[plane];
+      const float* a = abs_normals_[plane];
+      const float distance = p[0] * cx[i] + p[1] * cy[i] + p[2] * cz[i] + p[3];
+      const float radius = a[0] * ex[i] + a[1] * ey[i] + a[2] * ez[i];
+      outside = distance + radius < 0.0f;
+    }
+    visible[i] = !outside;
+  }
+#endif
+}
+
+}  // namespace tango_gl
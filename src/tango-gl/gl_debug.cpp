@@ -0,0 +1,202 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tango-gl/gl_debug.h"
+
+#include <EGL/egl.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+// KHR_debug names; the extension spells them with a KHR suffix.
+#ifndef GL_DEBUG_OUTPUT_KHR
+#define GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR 0x8242
+#define GL_DEBUG_SOURCE_APPLICATION_KHR 0x824A
+#define GL_DEBUG_TYPE_ERROR_KHR 0x824C
+#define GL_DEBUG_SEVERITY_HIGH_KHR 0x9146
+#define GL_DEBUG_SEVERITY_NOTIFICATION_KHR 0x826B
+#define GL_DEBUG_OUTPUT_KHR 0x92E0
+#endif
+#ifndef GL_APIENTRY
+#define GL_APIENTRY
+#endif
+
+namespace tango_gl {
+
+namespace {
+typedef void(GL_APIENTRY* DebugProc)(GLenum source, GLenum type, GLuint id,
+                                     GLenum severity, GLsizei length,
+                                     const GLchar* message,
+                                     const void* user_param);
+typedef void(GL_APIENTRY* DebugMessageCallbackProc)(DebugProc callback,
+                                                    const void* user_param);
+typedef void(GL_APIENTRY* PushDebugGroupProc)(GLenum source, GLuint id,
+                                              GLsizei length,
+                                              const GLchar* message);
+typedef void(GL_APIENTRY* PopDebugGroupProc)();
+
+// Deeper labels are counted but not named.
+const int kMaxLabels = 16;
+const char* labels[kMaxLabels];
+int label_depth = 0;
+// Set once the callback is installed.
+PushDebugGroupProc push_debug_group = NULL;
+PopDebugGroupProc pop_debug_group = NULL;
+// Only a synchronous callback runs on the GL thread, inside the call that
+// failed, so only then do the labels say where it happened.
+bool synchronous = false;
+
+std::string GetLabelPath() {
+  std::string path;
+  for (int i = 0; i < label_depth && i < kMaxLabels; ++i) {
+    path += i == 0 ? " in " : " > ";
+    path += labels[i];
+  }
+  if (label_depth > kMaxLabels) {
+    path += " > ...";
+  }
+  return path;
+}
+
+const char* GetErrorName(GLenum error) {
+  switch (error) {
+    case GL_INVALID_ENUM:
+      return "GL_INVALID_ENUM";
+    case GL_INVALID_VALUE:
+      return "GL_INVALID_VALUE";
+    case GL_INVALID_OPERATION:
+      return "GL_INVALID_OPERATION";
+    case GL_INVALID_FRAMEBUFFER_OPERATION:
+      return "GL_INVALID_FRAMEBUFFER_OPERATION";
+    case GL_OUT_OF_MEMORY:
+      return "GL_OUT_OF_MEMORY";
+    default:
+      return "unknown error";
+  }
+}
+
+const char* GetBaseName(const char* path) {
+  const char* slash = strrchr(path, '/');
+  return slash == NULL ? path : slash + 1;
+}
+
+void GL_APIENTRY OnDebugMessage(GLenum source, GLenum type, GLuint id,
+                                GLenum severity, GLsizei length,
+                                const GLchar* message,
+                                const void* user_param) {
+  (void)source;
+  (void)user_param;
+  // Notifications include our own group pushes and pops.
+  if (severity == GL_DEBUG_SEVERITY_NOTIFICATION_KHR) {
+    return;
+  }
+  const std::string path = synchronous ? GetLabelPath() : std::string();
+  const int size = length < 0 ? static_cast<int>(strlen(message)) : length;
+  if (type == GL_DEBUG_TYPE_ERROR_KHR ||
+      severity == GL_DEBUG_SEVERITY_HIGH_KHR) {
+    LOGE("GL debug 0x%x: %.*s%s", id, size, message, path.c_str());
+  } else {
+    LOGI("GL debug 0x%x: %.*s%s", id, size, message, path.c_str());
+  }
+}
+
+// OpenGL ES 3.2 made KHR_debug core, without the suffix.
+bool IsVersionAtLeast32() {
+  const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+  const char kPrefix[] = "OpenGL ES ";
+  if (version == NULL || strncmp(version, kPrefix, sizeof(kPrefix) - 1) != 0) {
+    return false;
+  }
+  int major = 0;
+  int minor = 0;
+  sscanf(version + sizeof(kPrefix) - 1, "%d.%d", &major, &minor);
+  return major > 3 || (major == 3 && minor >= 2);
+}
+
+template <typename Proc>
+Proc GetProc(const char* name, const char* suffix) {
+  const std::string full_name = std::string(name) + suffix;
+  return reinterpret_cast<Proc>(eglGetProcAddress(full_name.c_str()));
+}
+}  // namespace
+
+bool gl_debug::Initialize() {
+  if (TANGO_GL_DEBUG_LEVEL == TANGO_GL_DEBUG_OFF || push_debug_group != NULL) {
+    return push_debug_group != NULL;
+  }
+  // eglGetProcAddress may hand out pointers for functions the context does
+  // not have, so ask the context first.
+  const char* suffix;
+  if (util::HasExtension("GL_KHR_debug")) {
+    suffix = "KHR";
+  } else if (IsVersionAtLeast32()) {
+    suffix = "";
+  } else {
+    LOGI("GL debug: no KHR_debug, errors are checked with glGetError only.");
+    return false;
+  }
+  DebugMessageCallbackProc debug_message_callback =
+      GetProc<DebugMessageCallbackProc>("glDebugMessageCallback", suffix);
+  PushDebugGroupProc push = GetProc<PushDebugGroupProc>("glPushDebugGroup",
+                                                        suffix);
+  PopDebugGroupProc pop = GetProc<PopDebugGroupProc>("glPopDebugGroup",
+                                                     suffix);
+  if (debug_message_callback == NULL || push == NULL || pop == NULL) {
+    LOGE("GL debug: KHR_debug entry points missing.");
+    return false;
+  }
+  synchronous = TANGO_GL_DEBUG_LEVEL >= TANGO_GL_DEBUG_CALLS;
+  if (synchronous) {
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR);
+  }
+  glEnable(GL_DEBUG_OUTPUT_KHR);
+  debug_message_callback(OnDebugMessage, NULL);
+  push_debug_group = push;
+  pop_debug_group = pop;
+  return true;
+}
+
+bool gl_debug::CheckErrors(const char* operation, const char* file,
+                           int line) {
+  bool found = false;
+  for (GLenum error = glGetError(); error != GL_NO_ERROR;
+       error = glGetError()) {
+    LOGE("%s (0x%x) after %s at %s:%d%s", GetErrorName(error), error,
+         operation, GetBaseName(file), line, GetLabelPath().c_str());
+    found = true;
+  }
+  return found;
+}
+
+gl_debug::ScopedLabel::ScopedLabel(const char* name) {
+  if (label_depth < kMaxLabels) {
+    labels[label_depth] = name;
+  }
+  ++label_depth;
+  if (push_debug_group != NULL) {
+    push_debug_group(GL_DEBUG_SOURCE_APPLICATION_KHR, 0, -1, name);
+  }
+}
+
+gl_debug::ScopedLabel::~ScopedLabel() {
+  --label_depth;
+  if (pop_debug_group != NULL) {
+    pop_debug_group();
+  }
+}
+
+}  // namespace tango_gl
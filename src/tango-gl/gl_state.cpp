@@ -0,0 +1,343 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tango-gl/gl_state.h"
+
+#include <string.h>
+
+#include "tango-gl/gl_debug.h"
+
+namespace tango_gl {
+
+namespace {
+const GLenum kShadowedCapabilities[] = {GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST,
+                                        GL_SCISSOR_TEST, GL_STENCIL_TEST};
+const GLenum kBlendFuncNames[4] = {GL_BLEND_SRC_RGB, GL_BLEND_DST_RGB,
+                                   GL_BLEND_SRC_ALPHA, GL_BLEND_DST_ALPHA};
+}  // namespace
+
+int GlState::Stats::GetTotalChanges() const {
+  int total = 0;
+  for (int kind = 0; kind < kKindCount; ++kind) {
+    total += changes[kind];
+  }
+  return total;
+}
+
+int GlState::Stats::GetTotalSkipped() const {
+  int total = 0;
+  for (int kind = 0; kind < kKindCount; ++kind) {
+    total += skipped[kind];
+  }
+  return total;
+}
+
+GlState::GlState() : in_frame_(false) {
+  memset(&stats_, 0, sizeof(stats_));
+  memset(&last_frame_stats_, 0, sizeof(last_frame_stats_));
+}
+
+void GlState::BeginFrame() {
+  last_frame_stats_ = stats_;
+  memset(&stats_, 0, sizeof(stats_));
+  Invalidate();
+  frame_program_.known = false;
+  frame_vertex_array_.known = false;
+  frame_array_buffer_.known = false;
+  in_frame_ = true;
+}
+
+void GlState::EndFrame() {
+  in_frame_ = false;
+  if (frame_program_.known) {
+    UseProgram(frame_program_.value);
+  }
+  if (frame_vertex_array_.known) {
+    BindVertexArray(frame_vertex_array_.value);
+  }
+  if (frame_array_buffer_.known) {
+    BindBuffer(GL_ARRAY_BUFFER, frame_array_buffer_.value);
+  }
+}
+
+void GlState::Invalidate() {
+  program_.known = false;
+  array_buffer_.known = false;
+  element_buffer_.known = false;
+  vertex_array_.known = false;
+  active_texture_.known = false;
+  for (Shadow<GLuint>& texture : textures_) {
+    texture.known = false;
+  }
+  for (Shadow<bool>& capability : capabilities_) {
+    capability.known = false;
+  }
+  for (Shadow<GLenum>& function : blend_func_) {
+    function.known = false;
+  }
+  depth_mask_.known = false;
+  depth_func_.known = false;
+  line_width_.known = false;
+  for (Shadow<bool>& attribute : attributes_) {
+    attribute.known = false;
+  }
+}
+
+void GlState::UseProgram(GLuint program) {
+  SaveBinding(&program_, GL_CURRENT_PROGRAM, &frame_program_);
+  if (Count(kProgram, program_.Set(program))) {
+    TANGO_GL_CHECK(glUseProgram(program));
+  }
+}
+
+void GlState::BindBuffer(GLenum target, GLuint buffer) {
+  Shadow<GLuint>* shadow = NULL;
+  if (target == GL_ARRAY_BUFFER) {
+    shadow = &array_buffer_;
+  } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+    shadow = &element_buffer_;
+  }
+  if (target == GL_ARRAY_BUFFER) {
+    SaveBinding(&array_buffer_, GL_ARRAY_BUFFER_BINDING, &frame_array_buffer_);
+  }
+  if (Count(kBuffer, shadow == NULL || shadow->Set(buffer))) {
+    TANGO_GL_CHECK(glBindBuffer(target, buffer));
+  }
+}
+
+void GlState::BindVertexArray(GLuint vertex_array) {
+  SaveBinding(&vertex_array_, GL_VERTEX_ARRAY_BINDING, &frame_vertex_array_);
+  if (Count(kVertexArray, vertex_array_.Set(vertex_array))) {
+    TANGO_GL_CHECK(glBindVertexArray(vertex_array));
+    element_buffer_.known = false;
+    for (Shadow<bool>& attribute : attributes_) {
+      attribute.known = false;
+    }
+  }
+}
+
+void GlState::ActiveTexture(GLenum unit) {
+  if (Count(kTexture, active_texture_.Set(unit))) {
+    TANGO_GL_CHECK(glActiveTexture(unit));
+  }
+}
+
+void GlState::BindTexture(GLenum target, GLuint texture) {
+  if (!active_texture_.known) {
+    active_texture_.Set(Query(GL_ACTIVE_TEXTURE));
+  }
+  const GLuint unit = active_texture_.value - GL_TEXTURE0;
+  const bool shadowed = target == GL_TEXTURE_2D && unit < kTextureUnits;
+  if (Count(kTexture, !shadowed || textures_[unit].Set(texture))) {
+    TANGO_GL_CHECK(glBindTexture(target, texture));
+  }
+}
+
+void GlState::SetEnabled(GLenum capability, bool enabled) {
+  const int index = GetCapabilityIndex(capability);
+  if (Count(kCapability, index < 0 || capabilities_[index].Set(enabled))) {
+    if (enabled) {
+      TANGO_GL_CHECK(glEnable(capability));
+    } else {
+      TANGO_GL_CHECK(glDisable(capability));
+    }
+  }
+}
+
+void GlState::BlendFunc(GLenum source, GLenum destination) {
+  BlendFuncSeparate(source, destination, source, destination);
+}
+
+void GlState::BlendFuncSeparate(GLenum source_rgb, GLenum destination_rgb,
+                                GLenum source_alpha,
+                                GLenum destination_alpha) {
+  const GLenum functions[4] = {source_rgb, destination_rgb, source_alpha,
+                               destination_alpha};
+  bool changed = false;
+  for (int i = 0; i < 4; ++i) {
+    // No short cut: every shadow must take its new value.
+    changed = blend_func_[i].Set(functions[i]) || changed;
+  }
+  if (Count(kBlendFunc, changed)) {
+    TANGO_GL_CHECK(glBlendFuncSeparate(source_rgb, destination_rgb,
+                                       source_alpha, destination_alpha));
+  }
+}
+
+void GlState::DepthMask(bool write) {
+  if (Count(kDepth, depth_mask_.Set(write))) {
+    TANGO_GL_CHECK(glDepthMask(write ? GL_TRUE : GL_FALSE));
+  }
+}
+
+void GlState::DepthFunc(GLenum function) {
+  if (Count(kDepth, depth_func_.Set(function))) {
+    TANGO_GL_CHECK(glDepthFunc(function));
+  }
+}
+
+void GlState::LineWidth(GLfloat width) {
+  if (Count(kLineWidth, line_width_.Set(width))) {
+    TANGO_GL_CHECK(glLineWidth(width));
+  }
+}
+
+void GlState::SetVertexAttribArray(GLuint index, bool enabled) {
+  if (Count(kAttribute,
+            index >= kAttributes || attributes_[index].Set(enabled))) {
+    if (enabled) {
+      TANGO_GL_CHECK(glEnableVertexAttribArray(index));
+    } else {
+      TANGO_GL_CHECK(glDisableVertexAttribArray(index));
+    }
+  }
+}
+
+void GlState::DeleteBuffers(GLsizei count, const GLuint* buffers) {
+  for (GLsizei i = 0; i < count; ++i) {
+    if (array_buffer_.known && array_buffer_.value == buffers[i]) {
+      array_buffer_.value = 0;
+    }
+    if (element_buffer_.known && element_buffer_.value == buffers[i]) {
+      element_buffer_.value = 0;
+    }
+  }
+  TANGO_GL_CHECK(glDeleteBuffers(count, buffers));
+}
+
+void GlState::DeleteVertexArrays(GLsizei count, const GLuint* vertex_arrays) {
+  for (GLsizei i = 0; i < count; ++i) {
+    if (vertex_array_.known && vertex_array_.value == vertex_arrays[i]) {
+      // Falls back to the default vertex array, whose state we do not know.
+      BindVertexArray(0);
+    }
+  }
+  TANGO_GL_CHECK(glDeleteVertexArrays(count, vertex_arrays));
+}
+
+void GlState::DeleteTextures(GLsizei count, const GLuint* textures) {
+  for (GLsizei i = 0; i < count; ++i) {
+    for (Shadow<GLuint>& texture : textures_) {
+      if (texture.known && texture.value == textures[i]) {
+        texture.value = 0;
+      }
+    }
+  }
+  TANGO_GL_CHECK(glDeleteTextures(count, textures));
+}
+
+GLuint GlState::GetProgram() {
+  if (!program_.known) {
+    program_.Set(Query(GL_CURRENT_PROGRAM));
+  }
+  return program_.value;
+}
+
+GLuint GlState::GetBuffer(GLenum target) {
+  if (target == GL_ELEMENT_ARRAY_BUFFER) {
+    if (!element_buffer_.known) {
+      element_buffer_.Set(Query(GL_ELEMENT_ARRAY_BUFFER_BINDING));
+    }
+    return element_buffer_.value;
+  }
+  if (!array_buffer_.known) {
+    array_buffer_.Set(Query(GL_ARRAY_BUFFER_BINDING));
+  }
+  return array_buffer_.value;
+}
+
+GLuint GlState::GetVertexArray() {
+  if (!vertex_array_.known) {
+    vertex_array_.Set(Query(GL_VERTEX_ARRAY_BINDING));
+  }
+  return vertex_array_.value;
+}
+
+GLuint GlState::GetTexture(GLenum target) {
+  if (!active_texture_.known) {
+    active_texture_.Set(Query(GL_ACTIVE_TEXTURE));
+  }
+  const GLuint unit = active_texture_.value - GL_TEXTURE0;
+  if (target != GL_TEXTURE_2D || unit >= kTextureUnits) {
+    return Query(GL_TEXTURE_BINDING_2D);
+  }
+  if (!textures_[unit].known) {
+    textures_[unit].Set(Query(GL_TEXTURE_BINDING_2D));
+  }
+  return textures_[unit].value;
+}
+
+bool GlState::IsEnabled(GLenum capability) {
+  const int index = GetCapabilityIndex(capability);
+  if (index < 0) {
+    ++stats_.queries;
+    return glIsEnabled(capability) == GL_TRUE;
+  }
+  if (!capabilities_[index].known) {
+    ++stats_.queries;
+    capabilities_[index].Set(glIsEnabled(capability) == GL_TRUE);
+  }
+  return capabilities_[index].value;
+}
+
+void GlState::GetBlendFunc(GLenum functions[4]) {
+  for (int i = 0; i < 4; ++i) {
+    if (!blend_func_[i].known) {
+      blend_func_[i].Set(Query(kBlendFuncNames[i]));
+    }
+    functions[i] = blend_func_[i].value;
+  }
+}
+
+void GlState::SaveBinding(Shadow<GLuint>* shadow, GLenum query,
+                          Shadow<GLuint>* saved) {
+  if (!in_frame_ || saved->known) {
+    return;
+  }
+  if (!shadow->known) {
+    // Also lets the caller skip the bind if nothing changes.
+    shadow->Set(Query(query));
+  }
+  saved->Set(shadow->value);
+}
+
+bool GlState::Count(Kind kind, bool changed) {
+  if (changed) {
+    ++stats_.changes[kind];
+  } else {
+    ++stats_.skipped[kind];
+  }
+  return changed;
+}
+
+GLint GlState::Query(GLenum name) {
+  ++stats_.queries;
+  GLint value = 0;
+  glGetIntegerv(name, &value);
+  return value;
+}
+
+int GlState::GetCapabilityIndex(GLenum capability) {
+  for (int i = 0; i < kCapabilities; ++i) {
+    if (kShadowedCapabilities[i] == capability) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+}  // namespace tango_gl
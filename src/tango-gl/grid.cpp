@@ -0,0 +1,175 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tango-gl/grid.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "tango-gl/gl_debug.h"
+#include "tango-gl/gl_state.h"
+#include "tango-gl/program_cache.h"
+#include "tango-gl/shaders.h"
+
+namespace tango_gl {
+
+Grid::Grid(float density, int qx, int qy)
+    : Line(1.0f, GL_LINES),
+      density_(density),
+      qx_(qx),
+      qy_(qy),
+      procedural_(false),
+      major_interval_(10),
+      uniform_mv_mat_(-1),
+      uniform_grid_origin_(-1),
+      uniform_grid_size_(-1),
+      uniform_cell_size_(-1),
+      uniform_line_width_(-1),
+      uniform_major_interval_(-1),
+      uniform_fade_range_(-1) {
+  fade_end_ = density * std::max(qx, qy);
+  fade_start_ = 0.5f * fade_end_;
+  SetProcedural(true);
+}
+
+void Grid::SetProcedural(bool procedural) {
+  if (procedural) {
+    ProgramCache& programs = ProgramCache::GetInstance();
+    const GLuint program =
+        programs.GetProgram(shaders::GetProceduralGridVertexShader(),
+                            shaders::GetProceduralGridFragmentShader());
+    if (!program) {
+      LOGE("Procedural grid shader unavailable, drawing lines instead.");
+      procedural = false;
+    } else {
+      shader_program_ = program;
+      uniform_mvp_mat_ = programs.GetUniformLocation(program, "mvp");
+      uniform_mv_mat_ = programs.GetUniformLocation(program, "mv");
+      uniform_color_ = programs.GetUniformLocation(program, "color");
+      uniform_grid_origin_ =
+          programs.GetUniformLocation(program, "grid_origin");
+      uniform_grid_size_ = programs.GetUniformLocation(program, "grid_size");
+      uniform_cell_size_ = programs.GetUniformLocation(program, "cell_size");
+      uniform_line_width_ = programs.GetUniformLocation(program, "line_width");
+      uniform_major_interval_ =
+          programs.GetUniformLocation(program, "major_interval");
+      uniform_fade_range_ = programs.GetUniformLocation(program, "fade_range");
+      attrib_vertices_ = programs.GetAttribLocation(program, "vertex");
+      attrib_normals_ = -1;
+    }
+  }
+  if (!procedural) {
+    SetShader();
+  }
+  procedural_ = procedural;
+  if (procedural_) {
+    BuildQuad();
+  } else {
+    BuildLines();
+  }
+}
+
+void Grid::SetMajorLineInterval(int cells) {
+  major_interval_ = std::max(cells, 1);
+}
+
+void Grid::SetFadeDistance(float start, float end) {
+  fade_start_ = start;
+  fade_end_ = std::max(end, start);
+}
+
+bool Grid::GetBatchInfo(BatchInfo* info) const {
+  // The procedural grid needs its own shader and blending.
+  return !procedural_ && Line::GetBatchInfo(info);
+}
+
+void Grid::BuildLines() {
+  render_mode_ = GL_LINES;
+  // 3 float in 1 vertex, 2 vertices form a line.
+  // Horizontal line and vertical line forms the grid.
+  const float width = density_ * qx_ / 2;
+  const float height = density_ * qy_ / 2;
+  GLfloat* vertices = MapVertices(6 * (qx_ + qy_ + 2));
+  // Horizontal line.
+  for (int i = 0; i < qy_ + 1; i++) {
+    const GLfloat z = -height + i * density_;
+    const GLfloat line[6] = {-width, 0.0f, z, width, 0.0f, z};
+    vertices = std::copy(line, line + 6, vertices);
+  }
+  // Vertical line.
+  for (int i = 0; i < qx_ + 1; i++) {
+    const GLfloat x = -width + i * density_;
+    const GLfloat line[6] = {x, 0.0f, -height, x, 0.0f, height};
+    vertices = std::copy(line, line + 6, vertices);
+  }
+  UnmapVertices();
+}
+
+void Grid::BuildQuad() {
+  render_mode_ = GL_TRIANGLE_STRIP;
+  // Half a cell past the outer lines, so the shader can draw them whole.
+  const float width = density_ * (qx_ + 1) / 2;
+  const float height = density_ * (qy_ + 1) / 2;
+  const GLfloat quad[12] = {-width, 0.0f, -height, width, 0.0f, -height,
+                            -width, 0.0f, height,  width, 0.0f, height};
+  SetVertices(quad, 12);
+}
+
+void Grid::Render(const glm::mat4& projection_mat,
+                  const glm::mat4& view_mat) const {
+  if (!procedural_) {
+    Line::Render(projection_mat, view_mat);
+    return;
+  }
+  TANGO_GL_LABEL("Grid::Render");
+  GlState& state = GlState::GetInstance();
+  state.UseProgram(shader_program_);
+  glm::mat4 model_mat = GetTransformationMatrix();
+  glm::mat4 mv_mat = view_mat * model_mat;
+  glm::mat4 mvp_mat = projection_mat * mv_mat;
+  glUniformMatrix4fv(uniform_mvp_mat_, 1, GL_FALSE, glm::value_ptr(mvp_mat));
+  glUniformMatrix4fv(uniform_mv_mat_, 1, GL_FALSE, glm::value_ptr(mv_mat));
+  glUniform4f(uniform_color_, red_, green_, blue_, alpha_);
+  glUniform2f(uniform_grid_origin_, -density_ * qx_ / 2,
+              -density_ * qy_ / 2);
+  glUniform2f(uniform_grid_size_, static_cast<GLfloat>(qx_),
+              static_cast<GLfloat>(qy_));
+  glUniform1f(uniform_cell_size_, density_);
+  glUniform1f(uniform_line_width_, line_width_);
+  glUniform1f(uniform_major_interval_, static_cast<GLfloat>(major_interval_));
+  glUniform2f(uniform_fade_range_, fade_start_, fade_end_);
+
+  // The lines are blended over whatever is behind the grid. Put the blend
+  // state back afterwards; Cinder caches it.
+  const bool blend_enabled = state.IsEnabled(GL_BLEND);
+  GLenum blend_func[4];
+  state.GetBlendFunc(blend_func);
+  state.SetEnabled(GL_BLEND, true);
+  state.BlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE,
+                          GL_ONE_MINUS_SRC_ALPHA);
+
+  if (BindGeometry()) {
+    TANGO_GL_CHECK(glDrawArrays(render_mode_, 0, GetVertexCount()));
+    UnbindGeometry();
+  }
+
+  state.BlendFuncSeparate(blend_func[0], blend_func[1], blend_func[2],
+                          blend_func[3]);
+  state.SetEnabled(GL_BLEND, blend_enabled);
+}
+
+}  // namespace tango_gl
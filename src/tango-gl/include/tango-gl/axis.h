@@ -24,6 +24,10 @@ class Axis : public Line {
  public:
   Axis();
   void Render(const glm::mat4& projection_mat, const glm::mat4& view_mat) const;
+ protected:
+  // The per-vertex colors need Axis's own shader.
+  bool GetBatchInfo(BatchInfo*) const { return false; }
+
  private:
   GLuint attrib_colors_;
   std::vector<glm::vec4> vec_colors_;
@@ -21,8 +21,11 @@
 #include <vector>
 
 #include "tango-gl/drawable_object.h"
+#include "tango-gl/vertex_ring.h"
 
 namespace tango_gl {
+// Flat ribbon along a path, drawn as a triangle strip. Like Trace, it keeps
+// at most max_length vertices in a ring and uploads only what was appended.
 class Band : public DrawableObject {
  public:
   Band(const unsigned int max_legnth);
@@ -34,9 +37,14 @@ class Band : public DrawableObject {
   void Render(const glm::mat4& projection_mat, const glm::mat4& view_mat) const;
 
  private:
+  // Writes the left and right vertex of a slot, and their copy past the end
+  // for slot 0.
+  void WriteSlot(size_t slot, const glm::vec3& left, const glm::vec3& right);
+
   float band_width_;
   unsigned int max_length_;
-  std::vector<glm::vec3> vertices_v_;
+  // One slot per left and right vertex pair.
+  VertexRing ring_;
 };
 }  // namespace tango_gl
 #endif  // TANGO_GL_BAND_H_
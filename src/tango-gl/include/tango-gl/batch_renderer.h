@@ -0,0 +1,145 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TANGO_GL_BATCH_RENDERER_H_
+#define TANGO_GL_BATCH_RENDERER_H_
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "tango-gl/drawable_object.h"
+#include "tango-gl/frustum_culler.h"
+
+namespace tango_gl {
+// Draws many DrawableObjects with few draw calls. Objects queued with Add
+// are grouped by geometry and drawing mode; each group is one instanced draw
+// with the model matrix and color of every object in an instance buffer.
+// Without instancing (OpenGL ES 2) a group still shares one program and one
+// geometry binding and only the per-instance attributes change between
+// draws. Objects that cannot be batched are drawn with their own Render.
+// Objects whose world bounds are outside the view frustum are dropped
+// before any of that.
+//
+// Typical use, once per frame on the GL thread:
+//   for (auto& marker : markers) batch.Add(marker.get());
+//   batch.Render(projection_mat, view_mat);
+class BatchRenderer {
+ public:
+  struct Stats {
+    int objects;
+    // Objects outside the view frustum, not drawn.
+    int culled;
+    int batches;
+    // Objects drawn through their own Render.
+    int unbatched;
+    int draw_calls;
+    // Wall time of the last Render, i.e. CPU cost of submitting the frame.
+    double submit_ms;
+  };
+
+  BatchRenderer();
+  BatchRenderer(const BatchRenderer& other) = delete;
+  BatchRenderer& operator=(const BatchRenderer&) = delete;
+  ~BatchRenderer();
+
+  // Queues object for the next Render. It must stay alive until then.
+  void Add(const DrawableObject* object);
+
+  // Draws and then clears the queue.
+  void Render(const glm::mat4& projection_mat, const glm::mat4& view_mat);
+
+  // Instancing is used when the context supports it; turning it off forces
+  // the per-instance fallback, for comparing the two.
+  void SetInstancingEnabled(bool enabled) { instancing_enabled_ = enabled; }
+
+  // On by default.
+  void SetFrustumCullingEnabled(bool enabled) { culling_enabled_ = enabled; }
+
+  const Stats& GetStats() const { return stats_; }
+  // Details of the last Render's culling pass.
+  const FrustumCuller::Stats& GetCullingStats() const {
+    return culler_.GetStats();
+  }
+
+ private:
+  // Per-instance attributes as laid out in the instance buffer.
+  struct Instance {
+    GLfloat model[16];
+    GLfloat color[4];
+  };
+
+  struct BatchKey {
+    uint64_t geometry;
+    GLenum mode;
+    float line_width;
+    bool lit;
+    glm::vec3 light_position;
+    bool operator<(const BatchKey& other) const;
+  };
+
+  struct Batch {
+    // The first object queued; all of them have the same geometry, so its
+    // buffers are drawn for every instance.
+    const DrawableObject* mesh;
+    BatchKey key;
+    std::vector<Instance> instances;
+    // Position of the instances in the instance buffer.
+    size_t first;
+  };
+
+  // One of the two instanced programs and its locations.
+  struct Program {
+    GLuint id;
+    GLint uniform_view;
+    GLint uniform_projection;
+    GLint uniform_light;
+    GLint attrib_vertices;
+    GLint attrib_normals;
+    GLint attrib_model;
+    GLint attrib_color;
+  };
+
+  static bool LoadProgram(const std::string& vertex_shader,
+                          Program* program);
+  void UploadInstances();
+  void DrawBatch(const Batch& batch, const Program& program,
+                 const glm::mat4& view_mat, bool instanced);
+
+  std::vector<const DrawableObject*> queue_;
+  std::vector<const DrawableObject*> visible_;
+  std::vector<const DrawableObject*> unbatched_;
+  // Batches are kept between frames so their instance vectors keep their
+  // capacity; batch_count_ of them are in use.
+  std::vector<Batch> batches_;
+  size_t batch_count_;
+  std::map<BatchKey, size_t> batch_index_;
+  std::vector<Instance> instance_data_;
+
+  bool programs_created_;
+  Program unlit_program_;
+  Program lit_program_;
+  GLuint instance_buffer_;
+  size_t instance_buffer_capacity_;
+  GLuint vertex_array_;
+  bool instancing_enabled_;
+  bool culling_enabled_;
+  FrustumCuller culler_;
+  Stats stats_;
+};
+}  // namespace tango_gl
+#endif  // TANGO_GL_BATCH_RENDERER_H_
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TANGO_GL_BOUNDING_BOX_H_
+#define TANGO_GL_BOUNDING_BOX_H_
+
+#include <stddef.h>
+
+#include "glm/glm.hpp"
+
+namespace tango_gl {
+// Axis-aligned box. A default constructed box is empty: min is above max,
+// so extending it with any point gives that point.
+struct BoundingBox {
+  BoundingBox();
+  BoundingBox(const glm::vec3& min, const glm::vec3& max);
+
+  // Box around count points stored as x, y, z triples.
+  static BoundingBox FromPoints(const float* points, size_t count);
+
+  bool IsEmpty() const;
+  glm::vec3 GetCenter() const;
+  // Half the size along each axis.
+  glm::vec3 GetExtent() const;
+
+  void Extend(const glm::vec3& point);
+  void Extend(const BoundingBox& box);
+  void Extend(const float* points, size_t count);
+
+  // Smallest axis-aligned box around this box transformed by matrix.
+  BoundingBox Transformed(const glm::mat4& matrix) const;
+
+  glm::vec3 min;
+  glm::vec3 max;
+};
+}  // namespace tango_gl
+#endif  // TANGO_GL_BOUNDING_BOX_H_
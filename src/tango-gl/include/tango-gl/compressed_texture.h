@@ -0,0 +1,72 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TANGO_GL_COMPRESSED_TEXTURE_H_
+#define TANGO_GL_COMPRESSED_TEXTURE_H_
+
+#include "tango-gl/texture.h"
+
+// Not every GL header knows these.
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES 0x8D64
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2 0x9274
+#define GL_COMPRESSED_SRGB8_ETC2 0x9275
+#define GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2 0x9276
+#define GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2 0x9277
+#define GL_COMPRESSED_RGBA8_ETC2_EAC 0x9278
+#define GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC 0x9279
+#endif
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+#define GL_COMPRESSED_RGBA_ASTC_4x4_KHR 0x93B0
+#define GL_COMPRESSED_RGBA_ASTC_12x12_KHR 0x93BD
+#define GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR 0x93D0
+#define GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR 0x93DD
+#endif
+
+namespace tango_gl {
+namespace compressed_texture {
+// Block compressed textures take 0.5 (ETC2 RGB) or 1 (ETC2 RGBA, ASTC 4x4)
+// bytes per pixel of GPU memory and bandwidth instead of 3 or 4, e.g.
+//
+//  tango_gl::Texture::Image image, etc2;
+//  tango_gl::Texture::DecodePNG("/sdcard/wall.png", &image);
+//  tango_gl::compressed_texture::EncodeETC2(image, &etc2);
+//  tango_gl::compressed_texture::WriteKTX("/sdcard/wall.ktx", etc2);
+//
+// Nothing here but IsFormatSupported touches GL, so assets can also be
+// converted offline with the same code. TextureLoader uses these to keep
+// a cache of transcoded textures.
+
+// Encodes an uncompressed image and its mipmaps to ETC2: RGB8 when every
+// pixel is opaque, RGBA8 with EAC alpha otherwise. Thread safe; takes ten
+// to twenty times as long as decoding the PNG, so do it once and cache the
+// result.
+bool EncodeETC2(const Texture::Image& image, Texture::Image* compressed);
+
+// KTX 1.1 files of one 2D compressed texture, in native byte order. Other
+// KTX files (array, cube map, uncompressed or foreign endian) are refused.
+bool ReadKTX(const char* path, Texture::Image* image);
+bool WriteKTX(const char* path, const Texture::Image& image);
+
+// Whether format is an ETC1, ETC2/EAC or ASTC LDR format the current
+// context can sample. GL thread only.
+bool IsFormatSupported(GLenum format);
+}  // namespace compressed_texture
+}  // namespace tango_gl
+#endif  // TANGO_GL_COMPRESSED_TEXTURE_H_
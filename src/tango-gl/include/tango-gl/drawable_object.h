@@ -17,16 +17,38 @@
 #ifndef TANGO_GL_DRAWABLE_OBJECT_H_
 #define TANGO_GL_DRAWABLE_OBJECT_H_
 
+#include <stdint.h>
 #include <vector>
 
+#include "tango-gl/bounding_box.h"
 #include "tango-gl/color.h"
 #include "tango-gl/transform.h"
 #include "tango-gl/util.h"
 
 namespace tango_gl {
+class BatchRenderer;
+
+// Geometry lives in GL buffer objects, drawn through a vertex array object
+// where the context has them. vertices_, normals_ and indices_ are the CPU
+// copies: the setters below stage changes there and the next draw uploads
+// only the bytes that changed. Static meshes can drop the CPU copies once
+// uploaded.
+//
+// Buffer uploads happen inside Render, so geometry can still be set before
+// the GL context exists.
 class DrawableObject : public Transform {
  public:
-  DrawableObject() : red_(0), green_(0), blue_(0), alpha_(1.0f) {};
+  // Usage hint for the buffer objects, see glBufferData.
+  enum BufferUsage {
+    // Set once and drawn many times.
+    kStaticDraw,
+    // Changed now and then.
+    kDynamicDraw,
+    // Replaced about every frame.
+    kStreamDraw
+  };
+
+  DrawableObject();
   DrawableObject(const DrawableObject& other) = delete;
   const DrawableObject& operator=(const DrawableObject&) = delete;
   ~DrawableObject();
@@ -35,20 +57,123 @@ class DrawableObject : public Transform {
   void SetColor(const Color& color);
   void SetColor(const float red, const float green, const float blue);
   void SetAlpha(const float alpha);
+
+  // Applies from the next upload on. Defaults to kStaticDraw.
+  void SetBufferUsage(BufferUsage usage);
+  BufferUsage GetBufferUsage() const { return usage_; }
+
   void SetVertices(const std::vector<GLfloat>& vertices);
   void SetVertices(const std::vector<GLfloat>& vertices,
                    const std::vector<GLushort>& indices);
   void SetVertices(const std::vector<GLfloat>& vertices,
                    const std::vector<GLfloat>& normals);
+  // Take the arrays over without copying them; the arguments are left
+  // empty.
+  void SetVertices(std::vector<GLfloat>&& vertices);
+  void SetVertices(std::vector<GLfloat>&& vertices,
+                   std::vector<GLushort>&& indices);
+  void SetVertices(std::vector<GLfloat>&& vertices,
+                   std::vector<GLfloat>&& normals);
+  // Copy from memory the caller keeps; counts are in elements. The CPU
+  // copies keep their capacity, so refilling them with no more data than
+  // before does not allocate.
+  void SetVertices(const GLfloat* vertices, size_t count);
+  void SetVertices(const GLfloat* vertices, size_t vertex_count,
+                   const GLushort* indices, size_t index_count);
+  void SetVertices(const GLfloat* vertices, size_t vertex_count,
+                   const GLfloat* normals, size_t normal_count);
+  // 32-bit indices, for meshes of more than 65536 vertices. OpenGL ES 2
+  // needs OES_element_index_uint to draw them.
+  void SetVertices(const std::vector<GLfloat>& vertices,
+                   const std::vector<GLuint>& indices);
+  void SetVertices(std::vector<GLfloat>&& vertices,
+                   std::vector<GLuint>&& indices);
+  void SetVertices(const GLfloat* vertices, size_t vertex_count,
+                   const GLuint* indices, size_t index_count);
+
+  // Sizes the vertices to count floats and returns them to be written in
+  // place, which saves the copy of SetVertices for geometry built every
+  // frame. Contents are kept up to the old size. After ReleaseCpuData they
+  // are read back from the buffer object, so call it on the GL thread; on
+  // OpenGL ES 2, which cannot read buffers back, they start as zeros and
+  // must all be rewritten. Call UnmapVertices once done; the pointer is
+  // valid until then.
+  GLfloat* MapVertices(size_t count);
+  void UnmapVertices();
+
+  // Overwrite count elements starting at element offset of the geometry set
+  // above; ranges past the end are ignored. While the CPU copy is held, the
+  // changes are merged and uploaded with the next draw. After
+  // ReleaseCpuData they go straight to the buffer object, so they must be
+  // made on the GL thread.
+  void UpdateVertices(size_t offset, const GLfloat* data, size_t count);
+  void UpdateNormals(size_t offset, const GLfloat* data, size_t count);
+  // Indices must be of the type they were set with.
+  void UpdateIndices(size_t offset, const GLushort* data, size_t count);
+  void UpdateIndices(size_t offset, const GLuint* data, size_t count);
+
+  // Uploads anything pending and frees the CPU copies. Meant for static
+  // meshes; must be called on the GL thread. SetVertices still works
+  // afterwards and brings the CPU copy back.
+  void ReleaseCpuData();
+  bool HasCpuData() const;
+
+  // Box around the vertices in object space. SetVertices computes it
+  // exactly; partial updates only grow it, so it stays conservative. Empty
+  // for objects that draw geometry of their own, which are never culled.
+  const BoundingBox& GetLocalBounds() const { return local_bounds_; }
+  // The local bounds around the object as placed in the world. Recomputed
+  // only when the bounds or the world matrix change.
+  const BoundingBox& GetWorldBounds() const;
+
   virtual void Render(const glm::mat4& projection_mat,
                       const glm::mat4& view_mat) const = 0;
 
  protected:
+  friend class BatchRenderer;
+
+  // How a BatchRenderer draws this object when it is one instance of many.
+  struct BatchInfo {
+    GLenum mode;
+    float line_width;
+    bool lit;
+    // Light direction in world space, for lit objects.
+    glm::vec3 light_position;
+  };
+
+  // Objects that draw their geometry with the stock color or shaded shader
+  // fill in info and return true. Anything with its own shader or vertex
+  // attributes returns false and a BatchRenderer draws it with Render.
+  virtual bool GetBatchInfo(BatchInfo* info) const {
+    (void)info;
+    return false;
+  }
+
+  // Uploads what changed since the last draw and sets up the vertex and
+  // normal attributes of the current shader. Render calls it after
+  // glUseProgram and calls UnbindGeometry after drawing. Returns false if
+  // there is nothing to draw.
+  bool BindGeometry() const;
+  void UnbindGeometry() const;
+
+  // Counts of the uploaded geometry, valid after BindGeometry.
+  GLsizei GetVertexCount() const;
+  GLsizei GetIndexCount() const;
+  // GL_UNSIGNED_SHORT, or GL_UNSIGNED_INT for geometry set with GLuint
+  // indices.
+  GLenum GetIndexType() const { return index_type_; }
+
+  // For subclasses that edit vertices_ in place. offset and count are in
+  // floats; vertices_ becomes the CPU copy again if it had been released.
+  void MarkVerticesDirty(size_t offset, size_t count);
+
   float red_;
   float green_;
   float blue_;
   float alpha_;
   std::vector<GLushort> indices_;
+  // Used instead of indices_ when the index type is GL_UNSIGNED_INT.
+  std::vector<GLuint> wide_indices_;
   std::vector<GLfloat> vertices_;
   std::vector<GLfloat> normals_;
 
@@ -57,6 +182,72 @@ class DrawableObject : public Transform {
   GLuint uniform_mvp_mat_;
   GLuint attrib_vertices_;
   GLuint attrib_normals_;
+
+ private:
+  // A buffer object and the byte range of its CPU copy not uploaded yet.
+  struct GpuBuffer {
+    GpuBuffer()
+        : id(0), capacity(0), size(0), dirty_begin(0), dirty_end(0),
+          reallocate(false), released(false) {}
+    GLuint id;
+    // Bytes allocated with glBufferData and bytes holding geometry.
+    size_t capacity;
+    size_t size;
+    size_t dirty_begin;
+    size_t dirty_end;
+    // Whether the next upload respecifies the whole buffer.
+    bool reallocate;
+    // Whether the CPU copy was freed by ReleaseCpuData.
+    bool released;
+  };
+
+  // Identifies the geometry by content, so objects built the same way, like
+  // every Cube, share one batch.
+  uint64_t GetGeometryKey() const;
+  // Bookkeeping after a CPU copy was replaced as a whole.
+  void VerticesReplaced();
+  void NormalsReplaced();
+  void IndicesReplaced(GLenum type);
+  // Uploads pending geometry outside of a draw.
+  void PrepareGeometry() const;
+  void MarkDirty(GpuBuffer* buffer, size_t begin, size_t end);
+  void SaveBindings() const;
+  void RestoreBindings() const;
+  void Upload(GLenum target, const void* data, size_t size,
+              GpuBuffer* buffer) const;
+  void UploadPending() const;
+  // Copies the first size bytes of a released buffer into data, where the
+  // GL can read buffers back; leaves data alone otherwise.
+  void ReadBack(GLenum target, const GpuBuffer& buffer, void* data,
+                size_t size) const;
+  bool UpdateRange(GLenum target, size_t offset, const void* data,
+                   size_t size, size_t cpu_size, void* cpu_data,
+                   GpuBuffer* buffer);
+  // Grows local_bounds_ to cover count floats starting at float offset.
+  void ExtendBounds(size_t offset, const GLfloat* data, size_t count);
+  void SetAttributes() const;
+
+  BufferUsage usage_;
+  GLenum index_type_;
+  mutable GpuBuffer vertex_buffer_;
+  mutable GpuBuffer normal_buffer_;
+  mutable GpuBuffer index_buffer_;
+  // The vertex array records the attribute layout of one shader program;
+  // it is rebuilt when the program or the buffers change.
+  mutable GLuint vertex_array_;
+  mutable GLuint vertex_array_program_;
+  mutable bool vertex_array_dirty_;
+  // Bindings to restore once we are done, so other GL users (Cinder caches
+  // its own) do not see ours.
+  mutable GLint previous_vertex_array_;
+  mutable GLint previous_array_buffer_;
+  mutable GLint previous_element_buffer_;
+  BoundingBox local_bounds_;
+  mutable BoundingBox world_bounds_;
+  mutable uint32_t world_bounds_version_;
+  mutable bool world_bounds_valid_;
+  mutable uint64_t geometry_key_;
+  mutable bool geometry_key_valid_;
 };
 }  // namespace tango_gl
 #endif  // TANGO_GL_DRAWABLE_OBJECT_H_
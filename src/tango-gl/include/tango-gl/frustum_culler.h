@@ -0,0 +1,89 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TANGO_GL_FRUSTUM_CULLER_H_
+#define TANGO_GL_FRUSTUM_CULLER_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "tango-gl/bounding_box.h"
+#include "tango-gl/drawable_object.h"
+
+namespace tango_gl {
+// Tests bounding boxes against the view frustum, so objects that are out of
+// view can be skipped before anything is submitted to GL.
+//
+// Boxes are tested four at a time with NEON or SSE against the six planes
+// of the frustum; a box is culled when it lies entirely behind one of them.
+// The test is conservative: a box near a corner of the frustum may be kept
+// although it is out of view, but a box in view is never culled. Empty
+// boxes mean "no bounds" and are always kept.
+//
+// Typical use, once per frame:
+//   culler.SetViewProjection(projection_mat_ar * view_mat);
+//   culler.Cull(objects, &visible);
+class FrustumCuller {
+ public:
+  // Counts since the last SetViewProjection, i.e. for the current frame.
+  struct Stats {
+    int tested;
+    int visible;
+    int culled;
+    double cull_ms;
+  };
+
+  FrustumCuller();
+  FrustumCuller(const FrustumCuller& other) = delete;
+  FrustumCuller& operator=(const FrustumCuller&) = delete;
+
+  // Takes the frustum planes from a projection times view matrix, in world
+  // space, and resets the stats.
+  void SetViewProjection(const glm::mat4& view_projection_mat);
+
+  bool IsVisible(const BoundingBox& box) const;
+
+  // Sets visible[i] to 1 if boxes[i] may be in view and to 0 otherwise.
+  void Cull(const BoundingBox* boxes, size_t count, uint8_t* visible);
+
+  // Appends the objects whose world bounds may be in view to visible.
+  void Cull(const std::vector<const DrawableObject*>& objects,
+            std::vector<const DrawableObject*>* visible);
+
+  const Stats& GetStats() const { return stats_; }
+
+ private:
+  // Tests the boxes packed in centers_ and extents_; count is a multiple of
+  // four.
+  void TestPacked(size_t count, uint8_t* visible) const;
+
+  // a, b, c, d of ax + by + cz + d >= 0 for points inside, and |a|, |b|,
+  // |c| for the extent test.
+  float planes_[6][4];
+  float abs_normals_[6][3];
+  // Structure of arrays: all x, then all y, then all z, each padded to a
+  // multiple of four boxes.
+  std::vector<float> centers_;
+  std::vector<float> extents_;
+  std::vector<uint8_t> results_;
+  // Scratch for culling objects.
+  std::vector<BoundingBox> boxes_;
+  std::vector<uint8_t> object_visible_;
+  Stats stats_;
+};
+}  // namespace tango_gl
+#endif  // TANGO_GL_FRUSTUM_CULLER_H_
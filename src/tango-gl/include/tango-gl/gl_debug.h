@@ -0,0 +1,90 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TANGO_GL_GL_DEBUG_H_
+#define TANGO_GL_GL_DEBUG_H_
+
+#include "tango-gl/util.h"
+
+// How much GL checking is compiled in. glGetError waits for the GPU to
+// catch up, so every level above off costs frame time:
+//   TANGO_GL_DEBUG_OFF    nothing; the macros below are the bare calls.
+//   TANGO_GL_DEBUG_FRAME  errors are collected once per frame by
+//                         TANGO_GL_CHECK_FRAME, and KHR_debug messages are
+//                         logged as the driver reports them.
+//   TANGO_GL_DEBUG_CALLS  every call wrapped in TANGO_GL_CHECK is checked,
+//                         and KHR_debug reports synchronously, so the log
+//                         names the failing call and the labels around it.
+// Debug builds set TANGO_GL_DEBUG_LEVEL in build.gradle; the default is off.
+#define TANGO_GL_DEBUG_OFF 0
+#define TANGO_GL_DEBUG_FRAME 1
+#define TANGO_GL_DEBUG_CALLS 2
+
+#ifndef TANGO_GL_DEBUG_LEVEL
+#define TANGO_GL_DEBUG_LEVEL TANGO_GL_DEBUG_OFF
+#endif
+
+#define TANGO_GL_CONCAT_INNER(a, b) a##b
+#define TANGO_GL_CONCAT(a, b) TANGO_GL_CONCAT_INNER(a, b)
+
+#if TANGO_GL_DEBUG_LEVEL >= TANGO_GL_DEBUG_CALLS
+#define TANGO_GL_CHECK(call)                                             \
+  do {                                                                   \
+    call;                                                                \
+    tango_gl::gl_debug::CheckErrors(#call, __FILE__, __LINE__);          \
+  } while (0)
+#else
+#define TANGO_GL_CHECK(call) call
+#endif
+
+#if TANGO_GL_DEBUG_LEVEL >= TANGO_GL_DEBUG_FRAME
+#define TANGO_GL_CHECK_FRAME(name) \
+  tango_gl::gl_debug::CheckErrors(name, __FILE__, __LINE__)
+// Names the enclosing scope in error logs and, through KHR_debug, in GPU
+// debuggers. name must outlive the scope; string literals do.
+#define TANGO_GL_LABEL(name) \
+  tango_gl::gl_debug::ScopedLabel TANGO_GL_CONCAT(gl_label_, __LINE__)(name)
+#else
+#define TANGO_GL_CHECK_FRAME(name) ((void)0)
+#define TANGO_GL_LABEL(name) ((void)0)
+#endif
+
+namespace tango_gl {
+namespace gl_debug {
+// Installs the KHR_debug message callback when the context has one (the
+// extension, or OpenGL ES 3.2). Call once on the GL thread with the context
+// current; does nothing when checking is compiled out. Returns whether the
+// callback is installed.
+bool Initialize();
+
+// Logs and clears every pending GL error, with operation, the place it was
+// checked from and the labels in scope. Returns whether there were any.
+bool CheckErrors(const char* operation, const char* file, int line);
+
+// Pushes name on the label stack, and as a KHR_debug group when the
+// callback is installed. GL thread only.
+class ScopedLabel {
+ public:
+  explicit ScopedLabel(const char* name);
+  ~ScopedLabel();
+
+  ScopedLabel(const ScopedLabel& other) = delete;
+  ScopedLabel& operator=(const ScopedLabel&) = delete;
+};
+}  // namespace gl_debug
+}  // namespace tango_gl
+#endif  // TANGO_GL_GL_DEBUG_H_
@@ -0,0 +1,188 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TANGO_GL_GL_STATE_H_
+#define TANGO_GL_GL_STATE_H_
+
+#include "tango-gl/util.h"
+
+namespace tango_gl {
+// Shadow of the GL state tango_gl drawing touches: program, array and
+// element buffers, vertex array, 2D textures, blend, depth, line width,
+// capabilities and vertex attribute arrays. Setters skip calls that would
+// not change anything, and getters answer from the shadow instead of
+// stalling on glGet, so objects drawn one after another stop re-binding the
+// same program and buffers.
+//
+// The shadow only knows what went through it. Everything starts unknown,
+// and the first call per state always reaches GL. Call Invalidate after any
+// other GL code (Cinder drawing, say) and before drawing with tango_gl
+// again. BeginFrame does so too, once per frame.
+//
+// Cinder caches its own bindings and trusts them, so tango_gl drawing goes
+// between BeginFrame and EndFrame, with no Cinder drawing in between:
+//
+//  tango_gl::GlState::GetInstance().BeginFrame();
+//  grid->Render(projection, view);
+//  tango_gl::GlState::GetInstance().EndFrame();
+//
+// EndFrame puts the program, vertex array and array buffer back as
+// BeginFrame found them; within the block, objects drawn one after another
+// still share bindings. A binding is only queried when the block first
+// changes it, so an empty block makes no GL calls. GL thread only. Line
+// width is left as the last draw set it, so GL code that does not use
+// GlState must set its own.
+class GlState {
+ public:
+  enum Kind {
+    kProgram,
+    kBuffer,
+    kVertexArray,
+    kTexture,
+    kCapability,
+    kBlendFunc,
+    kDepth,
+    kLineWidth,
+    kAttribute,
+    kKindCount
+  };
+
+  struct Stats {
+    // Calls passed on to GL, and calls skipped as redundant, by kind.
+    int changes[kKindCount];
+    int skipped[kKindCount];
+    // glGet calls made to learn unknown state.
+    int queries;
+
+    int GetTotalChanges() const;
+    int GetTotalSkipped() const;
+  };
+
+  static GlState& GetInstance() {
+    static GlState instance;
+    return instance;
+  }
+
+  GlState(const GlState& other) = delete;
+  GlState& operator=(const GlState&) = delete;
+
+  // Keeps the counters of the frame that ends as the last frame's, starts
+  // new ones, invalidates the shadow and opens the block.
+  void BeginFrame();
+  // Rebinds the program, vertex array and array buffer the block changed to
+  // what was bound before, and closes the block.
+  void EndFrame();
+  // Forgets all state, e.g. after other GL code ran or the context was
+  // lost.
+  void Invalidate();
+
+  void UseProgram(GLuint program);
+  // GL_ARRAY_BUFFER and GL_ELEMENT_ARRAY_BUFFER are shadowed; other targets
+  // are passed through.
+  void BindBuffer(GLenum target, GLuint buffer);
+  void BindVertexArray(GLuint vertex_array);
+  void ActiveTexture(GLenum unit);
+  // GL_TEXTURE_2D is shadowed per unit; other targets are passed through.
+  void BindTexture(GLenum target, GLuint texture);
+  // GL_BLEND, GL_CULL_FACE, GL_DEPTH_TEST, GL_SCISSOR_TEST and
+  // GL_STENCIL_TEST are shadowed; others are passed through.
+  void SetEnabled(GLenum capability, bool enabled);
+  void BlendFunc(GLenum source, GLenum destination);
+  void BlendFuncSeparate(GLenum source_rgb, GLenum destination_rgb,
+                         GLenum source_alpha, GLenum destination_alpha);
+  void DepthMask(bool write);
+  void DepthFunc(GLenum function);
+  void LineWidth(GLfloat width);
+  void SetVertexAttribArray(GLuint index, bool enabled);
+
+  // Deleting a bound object unbinds it, so deletions of anything that may
+  // be bound must go through these.
+  void DeleteBuffers(GLsizei count, const GLuint* buffers);
+  void DeleteVertexArrays(GLsizei count, const GLuint* vertex_arrays);
+  void DeleteTextures(GLsizei count, const GLuint* textures);
+
+  GLuint GetProgram();
+  GLuint GetBuffer(GLenum target);
+  GLuint GetVertexArray();
+  GLuint GetTexture(GLenum target);
+  bool IsEnabled(GLenum capability);
+  // GL_BLEND_SRC_RGB, GL_BLEND_DST_RGB, GL_BLEND_SRC_ALPHA and
+  // GL_BLEND_DST_ALPHA, in that order.
+  void GetBlendFunc(GLenum functions[4]);
+
+  // Counters of the frame in progress, and of the last whole frame.
+  const Stats& GetStats() const { return stats_; }
+  const Stats& GetLastFrameStats() const { return last_frame_stats_; }
+
+ private:
+  static const int kTextureUnits = 8;
+  static const int kAttributes = 16;
+  static const int kCapabilities = 5;
+
+  // One piece of state and whether it is known.
+  template <typename T>
+  struct Shadow {
+    Shadow() : value(), known(false) {}
+    // Records value and returns whether GL must be told.
+    bool Set(T new_value) {
+      if (known && value == new_value) {
+        return false;
+      }
+      value = new_value;
+      known = true;
+      return true;
+    }
+    T value;
+    bool known;
+  };
+
+  GlState();
+
+  // Within a block, remembers what shadow holds before its first change,
+  // querying it if unknown.
+  void SaveBinding(Shadow<GLuint>* shadow, GLenum query,
+                   Shadow<GLuint>* saved);
+  // Counts a call of kind and returns changed.
+  bool Count(Kind kind, bool changed);
+  GLint Query(GLenum name);
+  static int GetCapabilityIndex(GLenum capability);
+
+  Shadow<GLuint> program_;
+  Shadow<GLuint> array_buffer_;
+  // Element buffer and attribute arrays belong to the vertex array and are
+  // forgotten when it changes.
+  Shadow<GLuint> element_buffer_;
+  Shadow<GLuint> vertex_array_;
+  Shadow<GLenum> active_texture_;
+  Shadow<GLuint> textures_[kTextureUnits];
+  Shadow<bool> capabilities_[kCapabilities];
+  Shadow<GLenum> blend_func_[4];
+  Shadow<bool> depth_mask_;
+  Shadow<GLenum> depth_func_;
+  Shadow<GLfloat> line_width_;
+  Shadow<bool> attributes_[kAttributes];
+  // Between BeginFrame and EndFrame; the bindings found there, known once
+  // the block changed them.
+  bool in_frame_;
+  Shadow<GLuint> frame_program_;
+  Shadow<GLuint> frame_vertex_array_;
+  Shadow<GLuint> frame_array_buffer_;
+  Stats stats_;
+  Stats last_frame_stats_;
+};
+}  // namespace tango_gl
+#endif  // TANGO_GL_GL_STATE_H_
@@ -20,9 +20,49 @@
 #include "tango-gl/line.h"
 
 namespace tango_gl {
+// qx by qy cells of size density in the xz plane, centered on the origin.
+//
+// By default the grid is one quad and the fragment shader draws the lines,
+// anti-aliased and about line width pixels wide at any distance, with a
+// major line every few cells and a fade with distance from the camera.
+// Where that shader does not compile (no OES_standard_derivatives) or with
+// SetProcedural(false), the grid is 2 * (qx + qy + 2) vertices of GL_LINES
+// as before.
 class Grid : public Line {
  public:
   Grid(float density = 1.0f, int qx = 50, int qy = 50);
+
+  void SetProcedural(bool procedural);
+  bool IsProcedural() const { return procedural_; }
+  // Cells between major lines; 10 by default.
+  void SetMajorLineInterval(int cells);
+  // Distances from the camera over which the procedural grid fades out.
+  // Defaults to half the grid's larger side to the whole of it.
+  void SetFadeDistance(float start, float end);
+
+  void Render(const glm::mat4& projection_mat, const glm::mat4& view_mat) const;
+
+ protected:
+  bool GetBatchInfo(BatchInfo* info) const;
+
+ private:
+  void BuildLines();
+  void BuildQuad();
+
+  float density_;
+  int qx_;
+  int qy_;
+  bool procedural_;
+  int major_interval_;
+  float fade_start_;
+  float fade_end_;
+  GLuint uniform_mv_mat_;
+  GLuint uniform_grid_origin_;
+  GLuint uniform_grid_size_;
+  GLuint uniform_cell_size_;
+  GLuint uniform_line_width_;
+  GLuint uniform_major_interval_;
+  GLuint uniform_fade_range_;
 };
 }  // namespace tango_gl
 #endif  // TANGO_GL_GRID_H_
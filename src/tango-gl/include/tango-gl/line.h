@@ -26,14 +26,20 @@ class Line : public DrawableObject {
       : line_width_(line_width), render_mode_(render_mode) {};
   void SetLineWidth(const float pixels);
   void Render(const glm::mat4& projection_mat, const glm::mat4& view_mat) const;
-  void UpdateLineVertices(const std::vector<glm::vec3>& vec_vertices) {
-    vec_vertices_ = vec_vertices;
-  }
+  // Replaces the points, which are kept in vertices_ like any other
+  // geometry and uploaded with the next Render.
+  void UpdateLineVertices(const std::vector<glm::vec3>& vec_vertices);
+  // Same, from count points in memory the caller keeps.
+  void UpdateLineVertices(const glm::vec3* points, size_t count);
+  // Sizes the line to count points and returns them to be written in place;
+  // call UnmapVertices once done.
+  glm::vec3* MapLineVertices(size_t count);
 
  protected:
+  bool GetBatchInfo(BatchInfo* info) const;
+
   float line_width_;
   GLenum render_mode_;
-  std::vector<glm::vec3> vec_vertices_;
 };
 }  // namespace tango_gl
 #endif  // TANGO_GL_LINE_H_
\ No newline at end of file
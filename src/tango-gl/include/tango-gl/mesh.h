@@ -28,6 +28,8 @@ class Mesh : public DrawableObject {
   void Render(const glm::mat4& projection_mat, const glm::mat4& view_mat) const;
 
  protected:
+  bool GetBatchInfo(BatchInfo* info) const;
+
   bool is_lighting_on_;
   glm::vec3 light_position_;
   GLuint uniform_mv_mat_;
@@ -17,6 +17,8 @@
 #ifndef TANGO_GL_OBJ_LOADER_H
 #define TANGO_GL_OBJ_LOADER_H
 
+#include <stddef.h>
+#include <stdint.h>
 #include <vector>
 
 #include "tango-gl/util.h"
@@ -24,8 +26,8 @@
 namespace tango_gl {
 namespace obj_loader {
 //  Load standard .obj file into vertices, indices or normals vectors,
-//  OBJ file can be exported from 3D tools like 3ds Max, when exporting,
-//  faces must be triangulated.
+//  OBJ file can be exported from 3D tools like 3ds Max. Faces with more
+//  than three corners are split into triangle fans.
 //  A readable file with only vertices should look like
 //  "v 1.00 2.00 3.00
 //   ...
@@ -49,12 +51,93 @@ namespace obj_loader {
 //  or
 //  tango_gl::obj_loader::LoadOBJData("/sdcard/model.obj", vertices, normals);
 //  mesh->SetVertices(vertices, normals);
+//
+//  The file is memory mapped and parsed in parallel, one chunk of lines per
+//  core, into vectors that are then handed over. Models with more than 65536
+//  vertices need the GLuint overload.
 
 bool LoadOBJData(const char* path, std::vector<GLfloat>& vertices,
                  std::vector<GLushort>& indices);
 
+bool LoadOBJData(const char* path, std::vector<GLfloat>& vertices,
+                 std::vector<GLuint>& indices);
+
   bool LoadOBJData(const char* path, std::vector<GLfloat>& vertices,
                    std::vector<GLfloat>& normals);
+
+// Everything the loaders read from an OBJ file. Indices are 0-based; faces
+// without normals have kNoIndex in normal_indices.
+struct ObjData {
+  static const GLuint kNoIndex = 0xffffffffu;
+  std::vector<GLfloat> positions;
+  std::vector<GLfloat> normals;
+  std::vector<GLuint> position_indices;
+  std::vector<GLuint> normal_indices;
+};
+
+// Parses path on threads threads, 0 meaning one per online core.
+bool ParseOBJ(const char* path, int threads, ObjData* data);
+
+// A model loaded through a binary cache file, so only the first launch
+// parses text.
+//
+// Open maps cache_path when it was written by this version of the loader
+// for the current size and modification time of obj_path; nothing is
+// parsed then, the arrays point straight into the mapping. Handing them to
+// a mesh with the pointer SetVertices overloads is the one copy, into the
+// mesh's vectors.
+// Otherwise it parses obj_path and writes cache_path for next time. The
+// arrays stay valid until Close or destruction, e.g.
+//
+//  tango_gl::obj_loader::MappedMesh model;
+//  if (model.Open("/sdcard/model.obj", "/sdcard/model.tgm", false)) {
+//    mesh->SetVertices(model.GetVertices(), model.GetVertexCount(),
+//                      model.GetIndices(), model.GetIndexCount());
+//  }
+//
+// with_normals picks the layout of the normals overload of LoadOBJData
+// (one vertex per face corner, no indices) over indexed positions.
+class MappedMesh {
+ public:
+  MappedMesh();
+  MappedMesh(const MappedMesh& other) = delete;
+  MappedMesh& operator=(const MappedMesh&) = delete;
+  ~MappedMesh();
+
+  bool Open(const char* obj_path, const char* cache_path, bool with_normals);
+  void Close();
+
+  // Whether the last Open had to parse the OBJ file.
+  bool WasParsed() const { return parsed_; }
+
+  // Counts are in elements: three floats per vertex or normal.
+  const GLfloat* GetVertices() const { return vertices_; }
+  size_t GetVertexCount() const { return vertex_count_; }
+  const GLfloat* GetNormals() const { return normals_; }
+  size_t GetNormalCount() const { return normal_count_; }
+  const GLuint* GetIndices() const { return indices_; }
+  size_t GetIndexCount() const { return index_count_; }
+
+ private:
+  bool MapCache(const char* cache_path, uint32_t layout,
+                uint64_t source_size, int64_t source_mtime);
+  void WriteCache(const char* cache_path, uint32_t layout,
+                  uint64_t source_size, int64_t source_mtime);
+
+  void* map_;
+  size_t map_size_;
+  bool parsed_;
+  // Parsed data, when the cache could not be used.
+  std::vector<GLfloat> parsed_vertices_;
+  std::vector<GLfloat> parsed_normals_;
+  std::vector<GLuint> parsed_indices_;
+  const GLfloat* vertices_;
+  size_t vertex_count_;
+  const GLfloat* normals_;
+  size_t normal_count_;
+  const GLuint* indices_;
+  size_t index_count_;
+};
 }  // namespace obj_loader
 }  // namespace tango_gl
 #endif  // TANGO_GL_OBJ_LOADER
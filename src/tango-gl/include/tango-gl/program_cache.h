@@ -0,0 +1,114 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TANGO_GL_PROGRAM_CACHE_H_
+#define TANGO_GL_PROGRAM_CACHE_H_
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "tango-gl/util.h"
+
+namespace tango_gl {
+// Process-wide cache of linked shader programs, keyed by their sources, so
+// every object drawn with the same shaders shares one program.
+// Uniform and attribute locations are cached per program as well.
+//
+// With a binary cache directory set, linked programs are also saved with
+// glGetProgramBinary and later runs load them with glProgramBinary instead
+// of compiling (OpenGL ES 3 drivers that report binary formats only). Files
+// are keyed by the sources and the GL renderer and version, so a driver
+// update just misses the cache.
+//
+// Programs belong to the GL context: use the cache from the GL thread only.
+class ProgramCache {
+ public:
+  struct Stats {
+    int programs;
+    // Programs built from source and loaded from the binary cache.
+    int compiled;
+    int loaded;
+    int binaries_saved;
+    // Time spent compiling, linking and loading programs.
+    double build_ms;
+  };
+
+  static ProgramCache& GetInstance() {
+    static ProgramCache instance;
+    return instance;
+  }
+
+  ProgramCache(const ProgramCache& other) = delete;
+  ProgramCache& operator=(const ProgramCache&) = delete;
+
+  // Returns the program for these sources, building it on first use. Returns
+  // 0 if the sources do not compile or link; that result is cached too.
+  GLuint GetProgram(const std::string& vertex_source,
+                    const std::string& fragment_source);
+
+  // Like glGetUniformLocation and glGetAttribLocation, for programs from
+  // GetProgram.
+  GLint GetUniformLocation(GLuint program, const char* name);
+  GLint GetAttribLocation(GLuint program, const char* name);
+
+  // Directory for program binaries, which must exist; empty turns the disk
+  // cache off, which is the default.
+  void SetBinaryCacheDirectory(const std::string& directory);
+
+  // Deletes all programs. Call with the context current, before it goes.
+  void Clear();
+  // Forgets all programs without deleting them, after the context was lost.
+  void Invalidate();
+
+  const Stats& GetStats() const { return stats_; }
+
+ private:
+  // Vertex and fragment source.
+  typedef std::pair<std::string, std::string> Sources;
+
+  struct Entry {
+    GLuint program;
+    std::map<std::string, GLint> uniforms;
+    std::map<std::string, GLint> attributes;
+  };
+
+  ProgramCache();
+
+  GLuint Build(const std::string& vertex_source,
+               const std::string& fragment_source, uint64_t hash);
+  std::string GetBinaryPath(uint64_t hash);
+  GLuint LoadBinary(const std::string& path);
+  void SaveBinary(GLuint program, const std::string& path);
+  bool BinariesSupported();
+  Entry* FindEntry(GLuint program);
+
+  // Keyed on the full sources rather than their hash, so colliding hashes
+  // still get a cached program each. Map nodes stay put, so program_entries_
+  // can point into them.
+  std::map<Sources, Entry> entries_;
+  std::unordered_map<GLuint, Entry*> program_entries_;
+  std::string binary_directory_;
+  // Number of program binary formats, -1 until asked, and a hash of the GL
+  // renderer and version; both are looked up with the first binary.
+  GLint binary_formats_;
+  uint64_t driver_hash_;
+  Stats stats_;
+};
+}  // namespace tango_gl
+#endif  // TANGO_GL_PROGRAM_CACHE_H_
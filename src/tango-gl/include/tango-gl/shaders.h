@@ -21,12 +21,22 @@
 
 namespace tango_gl {
 namespace shaders {
-std::string GetBasicVertexShader();
-std::string GetBasicFragmentShader();
-std::string GetColorVertexShader();
-std::string GetVideoOverlayVertexShader();
-std::string GetVideoOverlayFragmentShader();
-std::string GetShadedVertexShader();
+// Sources are built once and live for the whole process.
+const std::string& GetBasicVertexShader();
+const std::string& GetBasicFragmentShader();
+const std::string& GetColorVertexShader();
+const std::string& GetVideoOverlayVertexShader();
+const std::string& GetVideoOverlayFragmentShader();
+const std::string& GetShadedVertexShader();
+// Variants of the basic and shaded vertex shaders that take the model
+// matrix and color per instance, for BatchRenderer.
+const std::string& GetInstancedVertexShader();
+const std::string& GetInstancedShadedVertexShader();
+// Grid drawn on a single quad in the xz plane: the fragment shader works
+// out the anti-aliased minor and major lines from the plane coordinates.
+// Needs OES_standard_derivatives on OpenGL ES 2.
+const std::string& GetProceduralGridVertexShader();
+const std::string& GetProceduralGridFragmentShader();
 }  // namespace shaders
 }  // namespace tango_gl
 #endif  // TANGO_GL_SHADERS_H_
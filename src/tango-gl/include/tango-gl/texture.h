@@ -17,14 +17,33 @@
 #ifndef TANGO_GL_TEXTURE_H_
 #define TANGO_GL_TEXTURE_H_
 
-#include <errno.h>
-#include <png.h>
+#include <stdint.h>
+#include <vector>
 
 #include "tango-gl/util.h"
 
 namespace tango_gl {
+// A 2D texture loaded from a PNG file. The constructor decodes and uploads
+// on the calling thread, which must be the GL thread; TextureLoader does the
+// same without stalling frames. Pixels are freed once uploaded.
 class Texture {
  public:
+  // 8-bit pixels, rows tightly packed from top to bottom, or compressed
+  // blocks.
+  struct Image {
+    Image() : width(0), height(0), format(GL_RGBA), compressed_format(0) {}
+    uint32_t width;
+    uint32_t height;
+    // GL_RGB or GL_RGBA.
+    GLenum format;
+    // The GL compressed format, or 0 for plain pixels. Compressed images
+    // hold their mipmap levels one after another in pixels, level_sizes
+    // bytes each, since GL cannot generate mipmaps for them.
+    GLenum compressed_format;
+    std::vector<uint32_t> level_sizes;
+    std::vector<uint8_t> pixels;
+  };
+
   Texture(const char* file_path);
   Texture(const Texture& other) = delete;
   Texture& operator=(const Texture&) = delete;
@@ -33,10 +52,17 @@ class Texture {
   bool LoadFromPNG(const char* file_path);
   GLuint GetTextureID() const;
 
+  // Decode any PNG, from a file or from memory, to 8-bit RGB or RGBA
+  // through Cinder's loadImage. Safe to call from any thread.
+  static bool DecodePNG(const char* file_path, Image* image);
+  static bool DecodePNG(const uint8_t* data, size_t size, Image* image);
+  // Creates a texture holding image, with mipmaps where the context can
+  // make them or the image brings them. GL thread only; the texture binding
+  // is left as found. Returns 0 on failure.
+  static GLuint CreateTexture(const Image& image);
+
  private:
-  png_uint_32 width_, height_;
-  int bit_depth_, color_type_;
-  char* byte_data_;
+  uint32_t width_, height_;
   GLuint texture_id_;
 };
 }  // namespace tango_gl
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TANGO_GL_TEXTURE_LOADER_H_
+#define TANGO_GL_TEXTURE_LOADER_H_
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "tango-gl/texture.h"
+
+namespace tango_gl {
+// Loads PNG textures without stalling the GL thread. A pool of threads
+// decodes the files; decoded images wait in a queue until Update, called on
+// the GL thread once per frame, uploads as many as fit in its time budget,
+// generates their mipmaps and frees the pixels. Decoding pauses while the
+// queue holds more than max_decoded_bytes, so a large content pack never
+// sits in memory all at once.
+//
+// With a compressed cache directory set, textures are kept in GPU memory as
+// ETC2 (or whatever compressed format the app ships): a KTX file next to the
+// PNG, say wall.ktx for wall.png, is used when the context can sample its
+// format. Otherwise the PNG is transcoded to ETC2 once and cached under a
+// hash of its contents, which later loads read instead of decoding.
+//
+// Loads of visible content are decoded and uploaded before the rest;
+// SetVisible moves a pending load between the two. Load, SetVisible, Cancel
+// and the getters may be called from any thread. Textures belong to the
+// loader until cancelled: create, update and destroy it on the GL thread.
+class TextureLoader {
+ public:
+  typedef uint32_t Handle;
+  static const Handle kInvalidHandle = 0;
+
+  enum State {
+    // Waiting for or being decoded.
+    kPending,
+    // Waiting for Update to upload it.
+    kDecoded,
+    kReady,
+    kFailed,
+    // Cancelled, or never returned by Load.
+    kUnknown
+  };
+
+  struct Stats {
+    int decoded;
+    int uploaded;
+    int failed;
+    // Loads served from KTX files, and PNGs transcoded into the cache.
+    int compressed;
+    int transcoded;
+    // Thread time spent decoding, and GL thread time spent uploading.
+    double decode_ms;
+    double upload_ms;
+    // Pixels decoded but not uploaded yet.
+    size_t queued_bytes;
+  };
+
+  // num_threads 0 means one per online core but one, and at least one.
+  explicit TextureLoader(int num_threads = 0,
+                         size_t max_decoded_bytes = 64 << 20);
+  TextureLoader(const TextureLoader& other) = delete;
+  TextureLoader& operator=(const TextureLoader&) = delete;
+  ~TextureLoader();
+
+  // Directory for transcoded textures, which must exist; empty turns
+  // compressed loading off, which is the default. Call on the GL thread, as
+  // it checks which formats the context supports.
+  void SetCompressedCacheDirectory(const std::string& directory);
+
+  Handle Load(const std::string& file_path, bool visible);
+  void SetVisible(Handle handle, bool visible);
+  // Stops a pending load, or deletes the texture during the next Update.
+  // The handle is invalid afterwards.
+  void Cancel(Handle handle);
+
+  State GetState(Handle handle) const;
+  // The texture once the state is kReady, 0 before.
+  GLuint GetTexture(Handle handle) const;
+
+  // Deletes cancelled textures and uploads decoded images until budget_ms
+  // have passed. At least one image is uploaded per call, so loading always
+  // progresses.
+  void Update(double budget_ms);
+
+  Stats GetStats() const;
+
+ private:
+  struct Entry {
+    std::string path;
+    bool visible;
+    State state;
+    bool decoding;
+    Texture::Image image;
+    GLuint texture;
+  };
+
+  enum Source { kFromPng, kFromKtx, kTranscoded };
+
+  // Loads the pixels of file_path in the best form the settings allow.
+  static bool LoadImage(const std::string& file_path,
+                        const std::string& cache_directory,
+                        const std::vector<GLenum>& formats,
+                        Texture::Image* image, Source* source);
+  static void* ThreadMain(void* arg);
+  void Run();
+  // Pops the next handle worth working on from a pair of queues, visible
+  // first, or returns kInvalidHandle. The queues may hold stale handles:
+  // cancelled ones, duplicates and ones since moved to the other queue.
+  Handle PopQueued(std::deque<Handle>* queues, State state);
+
+  std::vector<pthread_t> threads_;
+  std::unordered_map<Handle, Entry> entries_;
+  // Index 0 holds visible loads, index 1 the others.
+  std::deque<Handle> decode_queues_[2];
+  std::deque<Handle> upload_queues_[2];
+  std::vector<GLuint> cancelled_textures_;
+  std::string cache_directory_;
+  // Compressed formats the context supports.
+  std::vector<GLenum> compressed_formats_;
+  Handle next_handle_;
+  size_t max_decoded_bytes_;
+  Stats stats_;
+  mutable pthread_mutex_t mutex_;
+  pthread_cond_t work_cond_;
+  bool stopping_;
+};
+}  // namespace tango_gl
+#endif  // TANGO_GL_TEXTURE_LOADER_H_
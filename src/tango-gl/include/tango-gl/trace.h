@@ -18,13 +18,29 @@
 #define TANGO_GL_TRACE_H_
 
 #include "tango-gl/line.h"
+#include "tango-gl/vertex_ring.h"
 
 namespace tango_gl {
+// Line strip following a moving point, e.g. the device's path. Points live
+// in a fixed-size ring: once it is full each new point overwrites the
+// oldest, and only the new point is uploaded.
 class Trace : public Line {
  public:
   Trace();
+  // Appends v if it is far enough from the last point.
   void UpdateVertexArray(const glm::vec3& v);
   void ClearVertexArray();
+  void Render(const glm::mat4& projection_mat, const glm::mat4& view_mat) const;
+
+ protected:
+  // A wrapped ring is drawn in two ranges, which a batch cannot do.
+  bool GetBatchInfo(BatchInfo*) const { return false; }
+
+ private:
+  // Writes a point to a slot, and its copy past the end for slot 0.
+  void WriteSlot(size_t slot, const glm::vec3& v);
+
+  VertexRing ring_;
 };
 }  // namespace tango_gl
 #endif  // TANGO_GL_TRACE_H_
@@ -17,10 +17,25 @@
 #ifndef TANGO_GL_TRANSFORM_H_
 #define TANGO_GL_TRANSFORM_H_
 
+#include <stdint.h>
+#include <vector>
+
 #include "glm/glm.hpp"
 #include "glm/gtc/quaternion.hpp"
 
 namespace tango_gl {
+// Position, rotation and scale of an object, relative to an optional parent.
+//
+// Local and world matrices are cached. Changing a transform marks its world
+// matrix and those of its whole subtree dirty, and flags its ancestors as
+// having dirty descendants, so clean nodes are never recomputed.
+// GetTransformationMatrix refreshes just the path it needs on demand;
+// UpdateWorldMatrices refreshes a whole hierarchy top-down in one pass and
+// skips subtrees with nothing dirty, which is cheaper per frame than lazy
+// calls on a deep tree.
+//
+// Destroying a transform detaches it from its parent and turns its children
+// into roots.
 class Transform {
  public:
   Transform();
@@ -41,19 +56,43 @@ class Transform {
   void Translate(const glm::vec3& translation);
 
   void SetTransformationMatrix(const glm::mat4& transform_mat);
+  // World matrix: the parent's world matrix times the local matrix.
   glm::mat4 GetTransformationMatrix() const;
+  const glm::mat4& GetLocalMatrix() const;
 
   void SetParent(Transform* transform);
 
   const Transform* GetParent() const ;
   Transform* GetParent() ;
+  const std::vector<Transform*>& GetChildren() const { return children_; }
+
+  // Changes whenever the world matrix does, so objects can cache things
+  // derived from it.
+  uint32_t GetWorldVersion() const;
+
+  // Brings the world matrices of this transform and its descendants up to
+  // date, parents before children.
+  void UpdateWorldMatrices();
 
  private:
+  const glm::mat4& GetWorldMatrix() const;
+  void SetLocalDirty();
+  void SetWorldDirty();
+
   Transform* parent_;
+  std::vector<Transform*> children_;
 
   glm::vec3 position_;
   glm::quat rotation_;
   glm::vec3 scale_;
+
+  mutable glm::mat4 local_matrix_;
+  mutable glm::mat4 world_matrix_;
+  mutable uint32_t world_version_;
+  mutable bool local_dirty_;
+  mutable bool world_dirty_;
+  // Some descendant has a dirty world matrix.
+  mutable bool descendant_dirty_;
 };
 }  // namespace tango_gl
 #endif  // TANGO_GL_TRANSFORM_H_
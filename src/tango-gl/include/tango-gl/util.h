@@ -18,8 +18,12 @@
 #define TANGO_GL_GL_UTIL_H_
 #define GLM_FORCE_RADIANS
 
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <jni.h>
+#include <functional>
+#include <string>
 #include <android/log.h>
 
 #include "glm/glm.hpp"
@@ -42,8 +46,34 @@
 
 namespace tango_gl {
 namespace util {
+  // Logs and clears pending GL errors. Waits for the GPU, so keep it out of
+  // per-frame code; TANGO_GL_CHECK in gl_debug.h compiles away instead.
   void CheckGlError(const char* operation);
 
+  // Compiles and links a program, logging the info log on failure. Returns
+  // 0 if either stage fails. retrievable_binary asks the driver to keep the
+  // linked binary for glGetProgramBinary (OpenGL ES 3 only).
+  GLuint CreateProgram(const char* vertex_source, const char* fragment_source,
+                       bool retrievable_binary = false);
+
+  // 64-bit FNV-1a of size bytes, continuing from hash.
+  uint64_t HashBytes(const void* data, size_t size,
+                     uint64_t hash = 14695981039346656037ull);
+
+  // Creates path through write, which returns false on failure. The file
+  // is written as path + ".part" and renamed into place, so a crash never
+  // leaves a truncated file behind. Returns false, leaving path as it was,
+  // if the file cannot be created or written.
+  bool WriteFileAtomically(const std::string& path,
+                           const std::function<bool(FILE* file)>& write);
+
+  // True when the current context has vertex array objects (OpenGL ES 3).
+  bool HasVertexArrays();
+
+  // True when the current context lists the extension, e.g.
+  // "GL_KHR_debug".
+  bool HasExtension(const char* name);
+
   void DecomposeMatrix(const glm::mat4& transform_mat,
                        glm::vec3& translation,
                        glm::quat& rotation,
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TANGO_GL_VERTEX_RING_H_
+#define TANGO_GL_VERTEX_RING_H_
+
+#include <stddef.h>
+
+namespace tango_gl {
+// Slot bookkeeping for trails kept in a fixed number of vertex slots, the
+// oldest overwritten first, so appending is O(1) and memory is constant.
+//
+// A slot is one group of vertices appended together, e.g. the left and
+// right edge of a band. Owners allocate capacity + 1 slots: whatever is
+// written to slot 0 is also written to slot capacity, so once the ring
+// wraps, the oldest part of the trail can be drawn up to that copy and the
+// newest part from slot 0, and the two draws join without a gap.
+class VertexRing {
+ public:
+  struct Range {
+    size_t first;
+    size_t count;
+  };
+
+  explicit VertexRing(size_t capacity)
+      : capacity_(capacity > 0 ? capacity : 1), next_(0), size_(0) {}
+
+  size_t GetCapacity() const { return capacity_; }
+  size_t GetSize() const { return size_; }
+  bool IsEmpty() const { return size_ == 0; }
+
+  // Takes the slot for the next group, the oldest one once full.
+  size_t Push() {
+    const size_t slot = next_;
+    next_ = next_ + 1 == capacity_ ? 0 : next_ + 1;
+    if (size_ < capacity_) {
+      ++size_;
+    }
+    return slot;
+  }
+
+  // Slot of the i-th newest group, 0 being the newest; i < GetSize().
+  size_t GetNewest(size_t i) const {
+    return (next_ + 2 * capacity_ - 1 - i) % capacity_;
+  }
+
+  void Clear() {
+    next_ = 0;
+    size_ = 0;
+  }
+
+  // Fills ranges with the slots to draw, oldest first, and returns how many
+  // there are (0 to 2).
+  int GetDrawRanges(Range ranges[2]) const {
+    if (size_ < capacity_ || next_ == 0) {
+      ranges[0].first = 0;
+      ranges[0].count = size_;
+      return size_ > 0 ? 1 : 0;
+    }
+    // Oldest to the end, including the copy of slot 0, then the rest.
+    ranges[0].first = next_;
+    ranges[0].count = capacity_ + 1 - next_;
+    ranges[1].first = 0;
+    ranges[1].count = next_;
+    return 2;
+  }
+
+ private:
+  size_t capacity_;
+  size_t next_;
+  size_t size_;
+};
+}  // namespace tango_gl
+#endif  // TANGO_GL_VERTEX_RING_H_
@@ -0,0 +1,64 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tango-gl/line.h"
+
+#include "tango-gl/gl_debug.h"
+#include "tango-gl/gl_state.h"
+
+namespace tango_gl {
+
+void Line::SetLineWidth(const float pixels) { line_width_ = pixels; }
+
+void Line::UpdateLineVertices(const std::vector<glm::vec3>& vec_vertices) {
+  UpdateLineVertices(vec_vertices.data(), vec_vertices.size());
+}
+
+void Line::UpdateLineVertices(const glm::vec3* points, size_t count) {
+  // glm::vec3 is three packed floats, so the points copy over as they are.
+  SetVertices(count > 0 ? glm::value_ptr(points[0]) : NULL, 3 * count);
+}
+
+glm::vec3* Line::MapLineVertices(size_t count) {
+  return reinterpret_cast<glm::vec3*>(MapVertices(3 * count));
+}
+
+bool Line::GetBatchInfo(BatchInfo* info) const {
+  info->mode = render_mode_;
+  info->line_width = line_width_;
+  info->lit = false;
+  info->light_position = glm::vec3(0.0f, 0.0f, 0.0f);
+  return true;
+}
+
+void Line::Render(const glm::mat4& projection_mat,
+                  const glm::mat4& view_mat) const {
+  TANGO_GL_LABEL("Line::Render");
+  GlState& state = GlState::GetInstance();
+  state.UseProgram(shader_program_);
+  state.LineWidth(line_width_);
+  glm::mat4 model_mat = GetTransformationMatrix();
+  glm::mat4 mvp_mat = projection_mat * view_mat * model_mat;
+  glUniformMatrix4fv(uniform_mvp_mat_, 1, GL_FALSE, glm::value_ptr(mvp_mat));
+  glUniform4f(uniform_color_, red_, green_, blue_, alpha_);
+
+  if (BindGeometry()) {
+    TANGO_GL_CHECK(glDrawArrays(render_mode_, 0, GetVertexCount()));
+    UnbindGeometry();
+  }
+}
+
+}  // namespace tango_gl
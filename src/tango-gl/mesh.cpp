@@ -0,0 +1,96 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tango-gl/mesh.h"
+#include "tango-gl/gl_debug.h"
+#include "tango-gl/gl_state.h"
+#include "tango-gl/program_cache.h"
+#include "tango-gl/shaders.h"
+
+namespace tango_gl {
+
+void Mesh::SetShader() {
+  DrawableObject::SetShader();
+  // Default mode set to no lighting.
+  is_lighting_on_ = false;
+}
+
+void Mesh::SetShader(bool is_lighting_on) {
+  if (is_lighting_on) {
+    ProgramCache& programs = ProgramCache::GetInstance();
+    shader_program_ = programs.GetProgram(shaders::GetShadedVertexShader(),
+                                          shaders::GetBasicFragmentShader());
+    if (!shader_program_) {
+      LOGE("Could not create program.");
+    }
+    uniform_mvp_mat_ = programs.GetUniformLocation(shader_program_, "mvp");
+    uniform_mv_mat_ = programs.GetUniformLocation(shader_program_, "mv");
+    uniform_light_pos_ =
+        programs.GetUniformLocation(shader_program_, "lightVec");
+    uniform_color_ = programs.GetUniformLocation(shader_program_, "color");
+
+    attrib_vertices_ = programs.GetAttribLocation(shader_program_, "vertex");
+    attrib_normals_ = programs.GetAttribLocation(shader_program_, "normal");
+    is_lighting_on_ = true;
+    // Set a defualt direction for directional light.
+    light_position_ = glm::vec3(-1.0f, -3.0f, -1.0f);
+    light_position_ = glm::normalize(light_position_);
+  } else {
+    SetShader();
+  }
+}
+
+void Mesh::SetLightPosition(const glm::vec3& light_position) {
+  light_position_ = light_position;
+}
+
+bool Mesh::GetBatchInfo(BatchInfo* info) const {
+  info->mode = GL_TRIANGLES;
+  info->line_width = 1.0f;
+  info->lit = is_lighting_on_;
+  info->light_position =
+      is_lighting_on_ ? light_position_ : glm::vec3(0.0f, 0.0f, 0.0f);
+  return true;
+}
+
+void Mesh::Render(const glm::mat4& projection_mat,
+                  const glm::mat4& view_mat) const {
+  TANGO_GL_LABEL("Mesh::Render");
+  GlState& state = GlState::GetInstance();
+  state.UseProgram(shader_program_);
+  glm::mat4 model_mat = GetTransformationMatrix();
+  glm::mat4 mv_mat = view_mat * model_mat;
+  glm::mat4 mvp_mat = projection_mat * mv_mat;
+  glUniformMatrix4fv(uniform_mvp_mat_, 1, GL_FALSE, glm::value_ptr(mvp_mat));
+  glUniform4f(uniform_color_, red_, green_, blue_, alpha_);
+  if (is_lighting_on_) {
+    glUniformMatrix4fv(uniform_mv_mat_, 1, GL_FALSE, glm::value_ptr(mv_mat));
+    glm::vec3 light_position = glm::mat3(view_mat) * light_position_;
+    glUniform3fv(uniform_light_pos_, 1, glm::value_ptr(light_position));
+  }
+
+  if (BindGeometry()) {
+    if (GetIndexCount() > 0) {
+      TANGO_GL_CHECK(glDrawElements(GL_TRIANGLES, GetIndexCount(),
+                                    GetIndexType(), 0));
+    } else {
+      TANGO_GL_CHECK(glDrawArrays(GL_TRIANGLES, 0, GetVertexCount()));
+    }
+    UnbindGeometry();
+  }
+}
+
+}  // namespace tango_gl
@@ -0,0 +1,648 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tango-gl/obj_loader.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+
+namespace tango_gl {
+namespace obj_loader {
+
+const GLuint ObjData::kNoIndex;
+
+namespace {
+// Files smaller than this per thread are not worth splitting further.
+const size_t kMinChunkSize = 1 << 20;
+const int kMaxThreads = 16;
+
+const char kCacheMagic[4] = {'T', 'G', 'M', 'C'};
+// Bump whenever the cache layout or the parser output changes.
+const uint32_t kCacheVersion = 2;
+enum CacheLayout { kIndexedLayout = 0, kNormalsLayout = 1 };
+
+// Cache file: this header, then vertex_count floats, normal_count floats and
+// index_count uint32 indices, in native byte order.
+struct CacheHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t layout;
+  uint32_t reserved;
+  // Of the OBJ file the cache was written from.
+  uint64_t source_size;
+  int64_t source_mtime;
+  uint64_t vertex_count;
+  uint64_t normal_count;
+  uint64_t index_count;
+};
+
+// The powers of ten that are exact in float.
+const float kPowersOfTen[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f,
+                              1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+
+inline bool IsBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+inline bool IsDigit(char c) { return c >= '0' && c <= '9'; }
+
+inline const char* SkipBlanks(const char* p, const char* end) {
+  while (p < end && IsBlank(*p)) {
+    ++p;
+  }
+  return p;
+}
+
+inline const char* NextLine(const char* p, const char* end) {
+  const char* newline =
+      static_cast<const char*>(memchr(p, '\n', end - p));
+  return newline != NULL ? newline + 1 : end;
+}
+
+// Parses a decimal number to the same float strtof returns. Mantissas up to
+// 2^24 and powers of ten up to 10^10 are exact in float, so for those one
+// correctly rounded float multiply or divide is the answer (Clinger's fast
+// path). That covers the 6 or 7 digits exporters write; anything longer or
+// more extreme goes through strtof. Going through double instead would
+// round twice and can be one ulp off.
+bool ParseFloat(const char** cursor, const char* end, float* value) {
+  const char* p = SkipBlanks(*cursor, end);
+  const char* start = p;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    ++p;
+  }
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool any_digit = false;
+  bool truncated = false;
+  for (; p < end && IsDigit(*p); ++p) {
+    any_digit = true;
+    if (digits < 19) {
+      mantissa = mantissa * 10 + (*p - '0');
+      digits += mantissa != 0;
+    } else {
+      ++exponent;
+      truncated = true;
+    }
+  }
+  if (p < end && *p == '.') {
+    for (++p; p < end && IsDigit(*p); ++p) {
+      any_digit = true;
+      if (digits < 19) {
+        mantissa = mantissa * 10 + (*p - '0');
+        digits += mantissa != 0;
+        --exponent;
+      } else {
+        truncated = true;
+      }
+    }
+  }
+  if (!any_digit) {
+    return false;
+  }
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    const char* q = p + 1;
+    bool negative_exponent = false;
+    if (q < end && (*q == '-' || *q == '+')) {
+      negative_exponent = *q == '-';
+      ++q;
+    }
+    if (q < end && IsDigit(*q)) {
+      int written = 0;
+      for (; q < end && IsDigit(*q); ++q) {
+        written = std::min(written * 10 + (*q - '0'), 100000);
+      }
+      exponent += negative_exponent ? -written : written;
+      p = q;
+    }
+  }
+
+  float result;
+  if (!truncated && mantissa <= (1u << 24) && exponent >= -10 &&
+      exponent <= 10) {
+    result = static_cast<float>(mantissa);
+    result = exponent < 0 ? result / kPowersOfTen[-exponent]
+                          : result * kPowersOfTen[exponent];
+    if (negative) {
+      result = -result;
+    }
+  } else {
+    char buffer[128];
+    const size_t length =
+        std::min(static_cast<size_t>(p - start), sizeof(buffer) - 1);
+    memcpy(buffer, start, length);
+    buffer[length] = '\0';
+    result = strtof(buffer, NULL);
+  }
+  *value = result;
+  *cursor = p;
+  return true;
+}
+
+bool ParseIndex(const char** cursor, const char* end, int64_t* value) {
+  const char* p = *cursor;
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p == '-';
+    ++p;
+  }
+  if (p == end || !IsDigit(*p)) {
+    return false;
+  }
+  int64_t result = 0;
+  for (; p < end && IsDigit(*p); ++p) {
+    result = std::min(result * 10 + (*p - '0'), static_cast<int64_t>(1) << 40);
+  }
+  *value = negative ? -result : result;
+  *cursor = p;
+  return true;
+}
+
+// One range of whole lines and what was parsed from it. Indices are final
+// except for relative (negative) ones, which are stored relative to the
+// first vertex of the chunk and listed in the fixups, because the number of
+// vertices in earlier chunks is not known yet.
+struct Chunk {
+  const char* begin;
+  const char* end;
+  std::vector<GLfloat> positions;
+  std::vector<GLfloat> normals;
+  std::vector<GLuint> position_indices;
+  std::vector<GLuint> normal_indices;
+  std::vector<size_t> position_fixups;
+  std::vector<size_t> normal_fixups;
+  // Start of the first line that could not be parsed, or NULL.
+  const char* error;
+};
+
+struct Corner {
+  GLuint position;
+  GLuint normal;
+  bool relative_position;
+  bool relative_normal;
+};
+
+// Resolves a 1-based or negative OBJ index against count elements so far.
+bool ResolveIndex(int64_t index, size_t count, GLuint* resolved,
+                  bool* relative) {
+  if (index > 0) {
+    *resolved = static_cast<GLuint>(index - 1);
+    *relative = false;
+    return true;
+  }
+  if (index < 0) {
+    // Wraps below zero for references into earlier chunks; adding the
+    // chunk's base brings it back.
+    *resolved = static_cast<GLuint>(static_cast<int64_t>(count) + index);
+    *relative = true;
+    return true;
+  }
+  return false;
+}
+
+bool ParseFace(const char* p, const char* end, Chunk* chunk,
+               std::vector<Corner>* corners) {
+  corners->clear();
+  const size_t position_count = chunk->positions.size() / 3;
+  const size_t normal_count = chunk->normals.size() / 3;
+  while (true) {
+    p = SkipBlanks(p, end);
+    if (p == end || *p == '\n' || *p == '#') {
+      break;
+    }
+    // v, v/vt, v//vn or v/vt/vn.
+    Corner corner = {ObjData::kNoIndex, ObjData::kNoIndex, false, false};
+    int64_t index;
+    if (!ParseIndex(&p, end, &index) ||
+        !ResolveIndex(index, position_count, &corner.position,
+                      &corner.relative_position)) {
+      return false;
+    }
+    if (p < end && *p == '/') {
+      ++p;
+      int64_t texture_index;
+      if (p < end && *p != '/' && !ParseIndex(&p, end, &texture_index)) {
+        return false;
+      }
+      if (p < end && *p == '/') {
+        ++p;
+        if (!ParseIndex(&p, end, &index) ||
+            !ResolveIndex(index, normal_count, &corner.normal,
+                          &corner.relative_normal)) {
+          return false;
+        }
+      }
+    }
+    if (p < end && !IsBlank(*p) && *p != '\n') {
+      return false;
+    }
+    corners->push_back(corner);
+  }
+  if (corners->size() < 3) {
+    return false;
+  }
+  // Fan around the first corner.
+  for (size_t i = 1; i + 1 < corners->size(); ++i) {
+    const Corner* triangle[3] = {&(*corners)[0], &(*corners)[i],
+                                 &(*corners)[i + 1]};
+    for (const Corner* corner : triangle) {
+      if (corner->relative_position) {
+        chunk->position_fixups.push_back(chunk->position_indices.size());
+      }
+      if (corner->relative_normal) {
+        chunk->normal_fixups.push_back(chunk->normal_indices.size());
+      }
+      chunk->position_indices.push_back(corner->position);
+      chunk->normal_indices.push_back(corner->normal);
+    }
+  }
+  return true;
+}
+
+bool ParseVector(const char* p, const char* end, std::vector<GLfloat>* out) {
+  float xyz[3];
+  for (int i = 0; i < 3; ++i) {
+    if (!ParseFloat(&p, end, &xyz[i])) {
+      return false;
+    }
+  }
+  // Anything after the third value (w, vertex colors) is ignored.
+  out->insert(out->end(), xyz, xyz + 3);
+  return true;
+}
+
+void ParseChunk(Chunk* chunk) {
+  std::vector<Corner> corners;
+  const char* end = chunk->end;
+  for (const char* line = chunk->begin; line < end;
+       line = NextLine(line, end)) {
+    const char* p = SkipBlanks(line, end);
+    if (end - p < 2) {
+      continue;
+    }
+    bool ok = true;
+    if (p[0] == 'v' && IsBlank(p[1])) {
+      ok = ParseVector(p + 2, end, &chunk->positions);
+    } else if (p[0] == 'v' && p[1] == 'n' && end - p > 2 && IsBlank(p[2])) {
+      ok = ParseVector(p + 3, end, &chunk->normals);
+    } else if (p[0] == 'f' && IsBlank(p[1])) {
+      ok = ParseFace(p + 2, end, chunk, &corners);
+    }
+    if (!ok) {
+      chunk->error = line;
+      return;
+    }
+  }
+}
+
+void* ParseChunkThread(void* arg) {
+  ParseChunk(static_cast<Chunk*>(arg));
+  return NULL;
+}
+
+bool MapFile(const char* path, void** data, size_t* size) {
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    return false;
+  }
+  *size = static_cast<size_t>(info.st_size);
+  *data = NULL;
+  if (*size > 0) {
+    *data = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (*data == MAP_FAILED) {
+    *data = NULL;
+    return false;
+  }
+  return true;
+}
+}  // namespace
+
+bool ParseOBJ(const char* path, int threads, ObjData* data) {
+  data->positions.clear();
+  data->normals.clear();
+  data->position_indices.clear();
+  data->normal_indices.clear();
+  void* map;
+  size_t size;
+  if (!MapFile(path, &map, &size)) {
+    LOGE("Failed to open file: %s", path);
+    return false;
+  }
+  if (size == 0) {
+    return true;
+  }
+  const char* text = static_cast<const char*>(map);
+  // Every thread reads its own part of the file at once.
+  madvise(map, size, MADV_WILLNEED);
+
+  if (threads <= 0) {
+    threads = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+  }
+  threads = std::max(1, std::min(threads, kMaxThreads));
+  threads = static_cast<int>(
+      std::min<size_t>(threads, size / kMinChunkSize + 1));
+
+  // Split at line boundaries.
+  std::vector<Chunk> chunks(threads);
+  const char* begin = text;
+  for (int i = 0; i < threads; ++i) {
+    const char* end = text + size;
+    if (i + 1 < threads) {
+      end = std::max(begin, text + size / threads * (i + 1));
+      end = NextLine(end, text + size);
+    }
+    chunks[i].begin = begin;
+    chunks[i].end = end;
+    chunks[i].error = NULL;
+    begin = end;
+  }
+  std::vector<pthread_t> workers(threads);
+  std::vector<bool> started(threads, false);
+  for (int i = 1; i < threads; ++i) {
+    started[i] = pthread_create(&workers[i], NULL, ParseChunkThread,
+                                &chunks[i]) == 0;
+  }
+  ParseChunk(&chunks[0]);
+  for (int i = 1; i < threads; ++i) {
+    if (started[i]) {
+      pthread_join(workers[i], NULL);
+    } else {
+      ParseChunk(&chunks[i]);
+    }
+  }
+
+  bool ok = true;
+  size_t position_total = 0;
+  size_t normal_total = 0;
+  size_t index_total = 0;
+  for (const Chunk& chunk : chunks) {
+    if (chunk.error != NULL && ok) {
+      const char* line_end = NextLine(chunk.error, text + size);
+      LOGE("obj_loader: cannot parse \"%.*s\" in %s",
+           static_cast<int>(std::min<ptrdiff_t>(line_end - chunk.error, 80)),
+           chunk.error, path);
+      ok = false;
+    }
+    position_total += chunk.positions.size();
+    normal_total += chunk.normals.size();
+    index_total += chunk.position_indices.size();
+  }
+  if (ok) {
+    data->positions.reserve(position_total);
+    data->normals.reserve(normal_total);
+    data->position_indices.reserve(index_total);
+    data->normal_indices.reserve(index_total);
+    for (Chunk& chunk : chunks) {
+      const GLuint position_base =
+          static_cast<GLuint>(data->positions.size() / 3);
+      const GLuint normal_base = static_cast<GLuint>(data->normals.size() / 3);
+      for (size_t fixup : chunk.position_fixups) {
+        chunk.position_indices[fixup] += position_base;
+      }
+      for (size_t fixup : chunk.normal_fixups) {
+        chunk.normal_indices[fixup] += normal_base;
+      }
+      data->positions.insert(data->positions.end(), chunk.positions.begin(),
+                             chunk.positions.end());
+      data->normals.insert(data->normals.end(), chunk.normals.begin(),
+                           chunk.normals.end());
+      data->position_indices.insert(data->position_indices.end(),
+                                    chunk.position_indices.begin(),
+                                    chunk.position_indices.end());
+      data->normal_indices.insert(data->normal_indices.end(),
+                                  chunk.normal_indices.begin(),
+                                  chunk.normal_indices.end());
+    }
+    const GLuint position_count = data->positions.size() / 3;
+    const GLuint normal_count = data->normals.size() / 3;
+    for (size_t i = 0; i < index_total && ok; ++i) {
+      const GLuint normal = data->normal_indices[i];
+      ok = data->position_indices[i] < position_count &&
+           (normal == ObjData::kNoIndex || normal < normal_count);
+    }
+    if (!ok) {
+      LOGE("obj_loader: face index out of range in %s", path);
+    }
+  }
+  munmap(map, size);
+  return ok;
+}
+
+bool LoadOBJData(const char* path, std::vector<GLfloat>& vertices,
+                 std::vector<GLushort>& indices) {
+  ObjData data;
+  if (!ParseOBJ(path, 0, &data)) {
+    return false;
+  }
+  if (data.positions.size() / 3 > 65536) {
+    LOGE("%s has %zu vertices, more than 16-bit indices can address.", path,
+         data.positions.size() / 3);
+    return false;
+  }
+  vertices.swap(data.positions);
+  indices.assign(data.position_indices.begin(), data.position_indices.end());
+  return true;
+}
+
+bool LoadOBJData(const char* path, std::vector<GLfloat>& vertices,
+                 std::vector<GLuint>& indices) {
+  ObjData data;
+  if (!ParseOBJ(path, 0, &data)) {
+    return false;
+  }
+  vertices.swap(data.positions);
+  indices.swap(data.position_indices);
+  return true;
+}
+
+bool LoadOBJData(const char* path, std::vector<GLfloat>& vertices,
+                 std::vector<GLfloat>& normals) {
+  ObjData data;
+  if (!ParseOBJ(path, 0, &data)) {
+    return false;
+  }
+  const size_t corners = data.position_indices.size();
+  vertices.resize(3 * corners);
+  normals.resize(3 * corners);
+  for (size_t i = 0; i < corners; ++i) {
+    const GLuint normal = data.normal_indices[i];
+    if (normal == ObjData::kNoIndex) {
+      LOGE("Format of 'f int//int int//int int//int' required for each face "
+           "line");
+      return false;
+    }
+    memcpy(&vertices[3 * i], &data.positions[3 * data.position_indices[i]],
+           3 * sizeof(GLfloat));
+    memcpy(&normals[3 * i], &data.normals[3 * normal], 3 * sizeof(GLfloat));
+  }
+  return true;
+}
+
+MappedMesh::MappedMesh()
+    : map_(NULL),
+      map_size_(0),
+      parsed_(false),
+      vertices_(NULL),
+      vertex_count_(0),
+      normals_(NULL),
+      normal_count_(0),
+      indices_(NULL),
+      index_count_(0) {}
+
+MappedMesh::~MappedMesh() { Close(); }
+
+bool MappedMesh::Open(const char* obj_path, const char* cache_path,
+                      bool with_normals) {
+  Close();
+  struct stat info;
+  if (stat(obj_path, &info) != 0) {
+    LOGE("Failed to open file: %s", obj_path);
+    return false;
+  }
+  const uint64_t source_size = static_cast<uint64_t>(info.st_size);
+  const int64_t source_mtime = static_cast<int64_t>(info.st_mtime);
+  const uint32_t layout = with_normals ? kNormalsLayout : kIndexedLayout;
+  if (cache_path != NULL &&
+      MapCache(cache_path, layout, source_size, source_mtime)) {
+    return true;
+  }
+
+  const bool ok =
+      with_normals
+          ? LoadOBJData(obj_path, parsed_vertices_, parsed_normals_)
+          : LoadOBJData(obj_path, parsed_vertices_, parsed_indices_);
+  if (!ok) {
+    Close();
+    return false;
+  }
+  parsed_ = true;
+  vertices_ = parsed_vertices_.data();
+  vertex_count_ = parsed_vertices_.size();
+  normals_ = parsed_normals_.data();
+  normal_count_ = parsed_normals_.size();
+  indices_ = parsed_indices_.data();
+  index_count_ = parsed_indices_.size();
+  if (cache_path != NULL) {
+    WriteCache(cache_path, layout, source_size, source_mtime);
+  }
+  return true;
+}
+
+void MappedMesh::Close() {
+  if (map_ != NULL) {
+    munmap(map_, map_size_);
+    map_ = NULL;
+    map_size_ = 0;
+  }
+  std::vector<GLfloat>().swap(parsed_vertices_);
+  std::vector<GLfloat>().swap(parsed_normals_);
+  std::vector<GLuint>().swap(parsed_indices_);
+  parsed_ = false;
+  vertices_ = NULL;
+  vertex_count_ = 0;
+  normals_ = NULL;
+  normal_count_ = 0;
+  indices_ = NULL;
+  index_count_ = 0;
+}
+
+bool MappedMesh::MapCache(const char* cache_path, uint32_t layout,
+                          uint64_t source_size, int64_t source_mtime) {
+  void* map;
+  size_t size;
+  if (!MapFile(cache_path, &map, &size)) {
+    return false;
+  }
+  if (size < sizeof(CacheHeader)) {
+    if (map != NULL) {
+      munmap(map, size);
+    }
+    return false;
+  }
+  const CacheHeader* header = static_cast<const CacheHeader*>(map);
+  // Counts are checked one by one first so the size sum cannot overflow.
+  const uint64_t limit = size / sizeof(GLfloat);
+  const bool ok =
+      memcmp(header->magic, kCacheMagic, sizeof(kCacheMagic)) == 0 &&
+      header->version == kCacheVersion && header->layout == layout &&
+      header->source_size == source_size &&
+      header->source_mtime == source_mtime &&
+      header->vertex_count <= limit && header->normal_count <= limit &&
+      header->index_count <= limit &&
+      sizeof(CacheHeader) +
+              sizeof(GLfloat) * (header->vertex_count + header->normal_count) +
+              sizeof(GLuint) * header->index_count ==
+          size;
+  if (!ok) {
+    munmap(map, size);
+    return false;
+  }
+  map_ = map;
+  map_size_ = size;
+  const uint8_t* data = static_cast<const uint8_t*>(map) + sizeof(CacheHeader);
+  vertices_ = reinterpret_cast<const GLfloat*>(data);
+  vertex_count_ = header->vertex_count;
+  normals_ = vertices_ + vertex_count_;
+  normal_count_ = header->normal_count;
+  indices_ = reinterpret_cast<const GLuint*>(normals_ + normal_count_);
+  index_count_ = header->index_count;
+  return true;
+}
+
+void MappedMesh::WriteCache(const char* cache_path, uint32_t layout,
+                            uint64_t source_size, int64_t source_mtime) {
+  CacheHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+  header.version = kCacheVersion;
+  header.layout = layout;
+  header.source_size = source_size;
+  header.source_mtime = source_mtime;
+  header.vertex_count = vertex_count_;
+  header.normal_count = normal_count_;
+  header.index_count = index_count_;
+  if (!util::WriteFileAtomically(cache_path, [&](FILE* file) {
+        return fwrite(&header, sizeof(header), 1, file) == 1 &&
+               fwrite(vertices_, sizeof(GLfloat), vertex_count_, file) ==
+                   vertex_count_ &&
+               fwrite(normals_, sizeof(GLfloat), normal_count_, file) ==
+                   normal_count_ &&
+               fwrite(indices_, sizeof(GLuint), index_count_, file) ==
+                   index_count_;
+      })) {
+    LOGE("obj_loader: cannot write %s", cache_path);
+  }
+}
+
+}  // namespace obj_loader
+}  // namespace tango_gl
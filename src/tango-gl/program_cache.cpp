@@ -0,0 +1,244 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tango-gl/program_cache.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
+namespace tango_gl {
+
+namespace {
+const char kBinaryMagic[4] = {'T', 'G', 'P', 'B'};
+const uint32_t kBinaryVersion = 1;
+// Anything bigger is a corrupt file, not a program.
+const uint32_t kMaxBinaryLength = 16 << 20;
+
+struct BinaryHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t format;
+  uint32_t length;
+};
+
+double NowMs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000.0 + now.tv_nsec / 1.0e6;
+}
+
+uint64_t HashString(const char* value, uint64_t hash) {
+  return value == NULL ? hash : util::HashBytes(value, strlen(value) + 1, hash);
+}
+}  // namespace
+
+ProgramCache::ProgramCache() : binary_formats_(-1), driver_hash_(0) {
+  memset(&stats_, 0, sizeof(stats_));
+}
+
+GLuint ProgramCache::GetProgram(const std::string& vertex_source,
+                                const std::string& fragment_source) {
+  std::pair<std::map<Sources, Entry>::iterator, bool> inserted =
+      entries_.insert(
+          std::make_pair(Sources(vertex_source, fragment_source), Entry()));
+  Entry& entry = inserted.first->second;
+  if (!inserted.second) {
+    return entry.program;
+  }
+
+  // The hash only names the binary file. The separator keeps "ab" + "c" and
+  // "a" + "bc" apart.
+  uint64_t hash = util::HashBytes(vertex_source.data(), vertex_source.size());
+  hash = util::HashBytes("", 1, hash);
+  hash = util::HashBytes(fragment_source.data(), fragment_source.size(), hash);
+  entry.program = Build(vertex_source, fragment_source, hash);
+  if (entry.program) {
+    program_entries_[entry.program] = &entry;
+  }
+  stats_.programs = static_cast<int>(program_entries_.size());
+  return entry.program;
+}
+
+GLint ProgramCache::GetUniformLocation(GLuint program, const char* name) {
+  Entry* entry = FindEntry(program);
+  if (entry == NULL) {
+    return glGetUniformLocation(program, name);
+  }
+  std::pair<std::map<std::string, GLint>::iterator, bool> inserted =
+      entry->uniforms.insert(std::make_pair(std::string(name), -1));
+  if (inserted.second) {
+    inserted.first->second = glGetUniformLocation(program, name);
+  }
+  return inserted.first->second;
+}
+
+GLint ProgramCache::GetAttribLocation(GLuint program, const char* name) {
+  Entry* entry = FindEntry(program);
+  if (entry == NULL) {
+    return glGetAttribLocation(program, name);
+  }
+  std::pair<std::map<std::string, GLint>::iterator, bool> inserted =
+      entry->attributes.insert(std::make_pair(std::string(name), -1));
+  if (inserted.second) {
+    inserted.first->second = glGetAttribLocation(program, name);
+  }
+  return inserted.first->second;
+}
+
+void ProgramCache::SetBinaryCacheDirectory(const std::string& directory) {
+  binary_directory_ = directory;
+}
+
+void ProgramCache::Clear() {
+  for (const std::pair<const GLuint, Entry*>& program : program_entries_) {
+    glDeleteProgram(program.first);
+  }
+  Invalidate();
+}
+
+void ProgramCache::Invalidate() {
+  entries_.clear();
+  program_entries_.clear();
+  stats_.programs = 0;
+}
+
+GLuint ProgramCache::Build(const std::string& vertex_source,
+                           const std::string& fragment_source,
+                           uint64_t hash) {
+  const double start = NowMs();
+  const bool use_binaries = !binary_directory_.empty() && BinariesSupported();
+  std::string path;
+  GLuint program = 0;
+  if (use_binaries) {
+    path = GetBinaryPath(hash);
+    program = LoadBinary(path);
+    if (program) {
+      ++stats_.loaded;
+    }
+  }
+  if (!program) {
+    program = util::CreateProgram(vertex_source.c_str(),
+                                  fragment_source.c_str(), use_binaries);
+    if (program) {
+      ++stats_.compiled;
+      if (use_binaries) {
+        SaveBinary(program, path);
+      }
+    }
+  }
+  stats_.build_ms += NowMs() - start;
+  return program;
+}
+
+bool ProgramCache::BinariesSupported() {
+  if (binary_formats_ < 0) {
+    // Program binaries arrived in OpenGL ES 3 together with vertex arrays.
+    binary_formats_ = 0;
+    if (util::HasVertexArrays()) {
+      glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binary_formats_);
+    }
+    driver_hash_ = HashString(
+        reinterpret_cast<const char*>(glGetString(GL_RENDERER)),
+        util::HashBytes("", 0));
+    driver_hash_ = HashString(
+        reinterpret_cast<const char*>(glGetString(GL_VERSION)), driver_hash_);
+  }
+  return binary_formats_ > 0;
+}
+
+std::string ProgramCache::GetBinaryPath(uint64_t hash) {
+  char name[32];
+  snprintf(name, sizeof(name), "/%016llx.glbin",
+           static_cast<unsigned long long>(hash ^ driver_hash_));
+  return binary_directory_ + name;
+}
+
+GLuint ProgramCache::LoadBinary(const std::string& path) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (file == NULL) {
+    return 0;
+  }
+  BinaryHeader header;
+  std::vector<uint8_t> binary;
+  bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+            memcmp(header.magic, kBinaryMagic, sizeof(kBinaryMagic)) == 0 &&
+            header.version == kBinaryVersion && header.length > 0 &&
+            header.length <= kMaxBinaryLength;
+  if (ok) {
+    binary.resize(header.length);
+    ok = fread(binary.data(), 1, binary.size(), file) == binary.size();
+  }
+  fclose(file);
+  if (!ok) {
+    LOGE("ProgramCache: ignoring unreadable %s", path.c_str());
+    remove(path.c_str());
+    return 0;
+  }
+
+  GLuint program = glCreateProgram();
+  glProgramBinary(program, header.format, binary.data(), header.length);
+  GLint link_status = GL_FALSE;
+  glGetProgramiv(program, GL_LINK_STATUS, &link_status);
+  if (link_status != GL_TRUE) {
+    // Drivers may reject binaries at any time, e.g. after an update that
+    // kept the version string; compile and replace the file.
+    glDeleteProgram(program);
+    remove(path.c_str());
+    return 0;
+  }
+  return program;
+}
+
+void ProgramCache::SaveBinary(GLuint program, const std::string& path) {
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0 || static_cast<uint32_t>(length) > kMaxBinaryLength) {
+    return;
+  }
+  std::vector<uint8_t> binary(length);
+  GLsizei written = 0;
+  GLenum format = 0;
+  glGetProgramBinary(program, length, &written, &format, binary.data());
+  if (written <= 0) {
+    return;
+  }
+
+  BinaryHeader header;
+  memcpy(header.magic, kBinaryMagic, sizeof(kBinaryMagic));
+  header.version = kBinaryVersion;
+  header.format = format;
+  header.length = static_cast<uint32_t>(written);
+  const bool ok = util::WriteFileAtomically(path, [&](FILE* file) {
+    return fwrite(&header, sizeof(header), 1, file) == 1 &&
+           fwrite(binary.data(), 1, written, file) ==
+               static_cast<size_t>(written);
+  });
+  if (ok) {
+    ++stats_.binaries_saved;
+  } else {
+    LOGE("ProgramCache: cannot write %s", path.c_str());
+  }
+}
+
+ProgramCache::Entry* ProgramCache::FindEntry(GLuint program) {
+  std::unordered_map<GLuint, Entry*>::iterator it =
+      program_entries_.find(program);
+  return it == program_entries_.end() ? NULL : it->second;
+}
+
+}  // namespace tango_gl
@@ -0,0 +1,207 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tango-gl/shaders.h"
+
+namespace tango_gl {
+namespace shaders {
+const std::string& GetBasicVertexShader() {
+  static const std::string source =
+      "precision mediump float;\n"
+      "precision mediump int;\n"
+      "attribute vec4 vertex;\n"
+      "uniform mat4 mvp;\n"
+      "uniform vec4 color;\n"
+      "varying vec4 v_color;\n"
+      "void main() {\n"
+      "  gl_Position = mvp*vertex;\n"
+      "  v_color = color;\n"
+      "}\n";
+  return source;
+}
+
+const std::string& GetBasicFragmentShader() {
+  static const std::string source =
+      "precision mediump float;\n"
+      "varying vec4 v_color;\n"
+      "void main() {\n"
+      "  gl_FragColor = v_color;\n"
+      "}\n";
+  return source;
+}
+
+const std::string& GetColorVertexShader() {
+  static const std::string source =
+      "precision mediump float;\n"
+      "precision mediump int;\n"
+      "attribute vec4 vertex;\n"
+      "attribute vec4 color;\n"
+      "uniform mat4 mvp;\n"
+      "varying vec4 v_color;\n"
+      "void main() {\n"
+      "  gl_Position = mvp*vertex;\n"
+      "  v_color = color;\n"
+      "}\n";
+  return source;
+}
+
+const std::string& GetVideoOverlayVertexShader() {
+  static const std::string source =
+      "precision highp float;\n"
+      "precision highp int;\n"
+      "attribute vec4 vertex;\n"
+      "attribute vec2 textureCoords;\n"
+      "varying vec2 f_textureCoords;\n"
+      "uniform mat4 mvp;\n"
+      "void main() {\n"
+      "  f_textureCoords = textureCoords;\n"
+      "  gl_Position = mvp * vertex;\n"
+      "}\n";
+  return source;
+}
+
+const std::string& GetVideoOverlayFragmentShader() {
+  static const std::string source =
+      "#extension GL_OES_EGL_image_external : require\n"
+      "precision highp float;\n"
+      "precision highp int;\n"
+      "uniform samplerExternalOES texture;\n"
+      "varying vec2 f_textureCoords;\n"
+      "void main() {\n"
+      "  gl_FragColor = texture2D(texture, f_textureCoords);\n"
+      "}\n";
+  return source;
+}
+
+const std::string& GetShadedVertexShader() {
+  static const std::string source =
+      "attribute vec4 vertex;\n"
+      "attribute vec3 normal;\n"
+      "uniform mat4 mvp;\n"
+      "uniform mat4 mv;\n"
+      "uniform vec4 color;\n"
+      "uniform vec3 lightVec;\n"
+      "varying vec4 v_color;\n"
+      "void main() {\n"
+      "  vec3 mvNormal = vec3(mv * vec4(normal, 0.0));\n"
+      "  float diffuse = max(-dot(mvNormal, lightVec), 0.0);\n"
+      "  v_color.a = color.a;\n"
+      "  v_color.xyz = color.xyz * diffuse + color.xyz * 0.3;\n"
+      "  gl_Position = mvp*vertex;\n"
+      "}\n";
+  return source;
+}
+
+const std::string& GetInstancedVertexShader() {
+  static const std::string source =
+      "precision mediump float;\n"
+      "precision mediump int;\n"
+      "attribute vec4 vertex;\n"
+      "attribute mat4 instance_model;\n"
+      "attribute vec4 instance_color;\n"
+      "uniform mat4 view;\n"
+      "uniform mat4 projection;\n"
+      "varying vec4 v_color;\n"
+      "void main() {\n"
+      "  gl_Position = projection * view * instance_model * vertex;\n"
+      "  v_color = instance_color;\n"
+      "}\n";
+  return source;
+}
+
+const std::string& GetInstancedShadedVertexShader() {
+  static const std::string source =
+      "attribute vec4 vertex;\n"
+      "attribute vec3 normal;\n"
+      "attribute mat4 instance_model;\n"
+      "attribute vec4 instance_color;\n"
+      "uniform mat4 view;\n"
+      "uniform mat4 projection;\n"
+      "uniform vec3 lightVec;\n"
+      "varying vec4 v_color;\n"
+      "void main() {\n"
+      "  mat4 mv = view * instance_model;\n"
+      "  vec3 mvNormal = vec3(mv * vec4(normal, 0.0));\n"
+      "  float diffuse = max(-dot(mvNormal, lightVec), 0.0);\n"
+      "  v_color.a = instance_color.a;\n"
+      "  v_color.xyz = instance_color.xyz * (diffuse + 0.3);\n"
+      "  gl_Position = projection * mv * vertex;\n"
+      "}\n";
+  return source;
+}
+
+const std::string& GetProceduralGridVertexShader() {
+  static const std::string source =
+      "precision highp float;\n"
+      "attribute vec4 vertex;\n"
+      "uniform mat4 mvp;\n"
+      "uniform mat4 mv;\n"
+      "uniform vec2 grid_origin;\n"
+      "uniform float cell_size;\n"
+      "varying vec2 v_coord;\n"
+      "varying vec3 v_view_pos;\n"
+      "void main() {\n"
+      "  v_coord = (vertex.xz - grid_origin) / cell_size;\n"
+      // The distance is taken per fragment: it is not linear across the
+      // quad, while the view position is.
+      "  v_view_pos = vec3(mv * vertex);\n"
+      "  gl_Position = mvp * vertex;\n"
+      "}\n";
+  return source;
+}
+
+const std::string& GetProceduralGridFragmentShader() {
+  static const std::string source =
+      "#extension GL_OES_standard_derivatives : enable\n"
+      "#ifdef GL_FRAGMENT_PRECISION_HIGH\n"
+      "precision highp float;\n"
+      "#else\n"
+      "precision mediump float;\n"
+      "#endif\n"
+      "uniform vec4 color;\n"
+      "uniform vec2 grid_size;\n"
+      "uniform float line_width;\n"
+      "uniform float major_interval;\n"
+      "uniform vec2 fade_range;\n"
+      "varying vec2 v_coord;\n"
+      "varying vec3 v_view_pos;\n"
+      // Coverage of the nearest line through whole coordinates, line_width
+      // pixels wide at any distance. pixel is the size of a pixel in cells.
+      "float LineCoverage(vec2 coord, vec2 pixel) {\n"
+      "  vec2 d = abs(fract(coord + 0.5) - 0.5) / (pixel * line_width);\n"
+      "  return 1.0 - min(min(d.x, d.y), 1.0);\n"
+      "}\n"
+      "void main() {\n"
+      "  vec2 pixel = fwidth(v_coord);\n"
+      "  vec2 outside = max(-v_coord, v_coord - grid_size) / pixel;\n"
+      "  if (max(outside.x, outside.y) > line_width) discard;\n"
+      // Minor lines fade out as they get closer than four pixels apart,
+      // before they can alias into moire.
+      "  float spacing = 1.0 / max(pixel.x, pixel.y);\n"
+      "  float minor = LineCoverage(v_coord, pixel) *\n"
+      "      clamp(spacing * 0.5 - 1.0, 0.0, 1.0);\n"
+      "  float major = LineCoverage(v_coord / major_interval,\n"
+      "                             pixel / major_interval);\n"
+      "  float fade = 1.0 - smoothstep(fade_range.x, fade_range.y,\n"
+      "                                length(v_view_pos));\n"
+      "  float alpha = color.a * max(0.5 * minor, major) * fade;\n"
+      "  if (alpha < 0.004) discard;\n"
+      "  gl_FragColor = vec4(color.rgb, alpha);\n"
+      "}\n";
+  return source;
+}
+}  // namespace shaders
+}  // namespace tango_gl
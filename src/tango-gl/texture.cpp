@@ -0,0 +1,204 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tango-gl/texture.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <exception>
+
+#include "cinder/DataSource.h"
+#include "cinder/ImageIo.h"
+#include "cinder/Surface.h"
+
+#include "tango-gl/gl_debug.h"
+#include "tango-gl/gl_state.h"
+
+namespace tango_gl {
+
+namespace {
+const uint8_t kPngSignature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+bool IsPowerOfTwo(uint32_t value) {
+  return value != 0 && (value & (value - 1)) == 0;
+}
+}  // namespace
+
+Texture::Texture(const char* file_path)
+    : width_(0), height_(0), texture_id_(0) {
+  if (!LoadFromPNG(file_path)) {
+    LOGE("Texture initialing error");
+  }
+}
+
+Texture::~Texture() {
+  if (texture_id_ != 0) {
+    GlState::GetInstance().DeleteTextures(1, &texture_id_);
+  }
+}
+
+bool Texture::LoadFromPNG(const char* file_path) {
+  Image image;
+  if (!DecodePNG(file_path, &image)) {
+    return false;
+  }
+  const GLuint texture_id = CreateTexture(image);
+  if (texture_id == 0) {
+    return false;
+  }
+  if (texture_id_ != 0) {
+    GlState::GetInstance().DeleteTextures(1, &texture_id_);
+  }
+  texture_id_ = texture_id;
+  width_ = image.width;
+  height_ = image.height;
+  return true;
+}
+
+GLuint Texture::GetTextureID() const { return texture_id_; }
+
+bool Texture::DecodePNG(const char* file_path, Image* image) {
+  FILE* file = fopen(file_path, "rb");
+  if (file == NULL) {
+    LOGE("Failed to open file: %s", file_path);
+    return false;
+  }
+  std::vector<uint8_t> data;
+  uint8_t buffer[64 << 10];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    data.insert(data.end(), buffer, buffer + read);
+  }
+  fclose(file);
+  if (!DecodePNG(data.data(), data.size(), image)) {
+    LOGE("Failed to decode %s", file_path);
+    return false;
+  }
+  return true;
+}
+
+bool Texture::DecodePNG(const uint8_t* data, size_t size, Image* image) {
+  if (size < sizeof(kPngSignature) ||
+      memcmp(data, kPngSignature, sizeof(kPngSignature)) != 0) {
+    return false;
+  }
+  // Cinder decodes with the loader built into libcinder (stb_image on
+  // Android), so PNG support needs no library of our own. The buffer wraps
+  // data without copying it.
+  ci::Surface8u surface;
+  try {
+    ci::BufferRef buffer =
+        ci::Buffer::create(const_cast<uint8_t*>(data), size);
+    surface = ci::Surface8u(ci::loadImage(ci::DataSourceBuffer::create(buffer),
+                                          ci::ImageSource::Options(), "png"));
+  } catch (const std::exception& e) {
+    LOGE("Texture: cannot decode PNG: %s", e.what());
+    return false;
+  }
+  if (!surface.getData()) {
+    return false;
+  }
+
+  // Repack to tight 8-bit RGB or RGBA, whatever channel order and row
+  // padding the surface uses.
+  const bool alpha = surface.hasAlpha();
+  const int channels = alpha ? 4 : 3;
+  const int32_t width = surface.getWidth();
+  const int32_t height = surface.getHeight();
+  const uint8_t pixel_step = surface.getPixelInc();
+  const uint8_t offsets[4] = {surface.getRedOffset(),
+                              surface.getGreenOffset(),
+                              surface.getBlueOffset(),
+                              alpha ? surface.getAlphaOffset()
+                                    : static_cast<uint8_t>(0)};
+  image->width = width;
+  image->height = height;
+  image->format = alpha ? GL_RGBA : GL_RGB;
+  image->pixels.resize(static_cast<size_t>(width) * height * channels);
+  uint8_t* out = image->pixels.data();
+  for (int32_t y = 0; y < height; ++y) {
+    const uint8_t* in = surface.getData() + y * surface.getRowBytes();
+    for (int32_t x = 0; x < width; ++x, in += pixel_step) {
+      for (int c = 0; c < channels; ++c) {
+        *out++ = in[offsets[c]];
+      }
+    }
+  }
+  image->compressed_format = 0;
+  image->level_sizes.clear();
+  return true;
+}
+
+GLuint Texture::CreateTexture(const Image& image) {
+  if (image.pixels.empty()) {
+    LOGE("Texture: nothing to upload");
+    return 0;
+  }
+  GlState& state = GlState::GetInstance();
+  const GLuint previous_texture = state.GetTexture(GL_TEXTURE_2D);
+  GLint previous_alignment = 4;
+  glGetIntegerv(GL_UNPACK_ALIGNMENT, &previous_alignment);
+
+  GLuint texture_id = 0;
+  glGenTextures(1, &texture_id);
+  state.BindTexture(GL_TEXTURE_2D, texture_id);
+  bool mipmaps;
+  if (image.compressed_format != 0) {
+    size_t offset = 0;
+    uint32_t width = image.width;
+    uint32_t height = image.height;
+    for (size_t level = 0; level < image.level_sizes.size(); ++level) {
+      TANGO_GL_CHECK(glCompressedTexImage2D(GL_TEXTURE_2D, level,
+                                            image.compressed_format, width,
+                                            height, 0, image.level_sizes[level],
+                                            image.pixels.data() + offset));
+      offset += image.level_sizes[level];
+      width = width > 1 ? width / 2 : 1;
+      height = height > 1 ? height / 2 : 1;
+    }
+    mipmaps = image.level_sizes.size() > 1;
+    if (mipmaps) {
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,
+                      image.level_sizes.size() - 1);
+    }
+  } else {
+    // RGB rows are not 4-byte aligned in general.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    TANGO_GL_CHECK(glTexImage2D(GL_TEXTURE_2D, 0, image.format, image.width,
+                                image.height, 0, image.format, GL_UNSIGNED_BYTE,
+                                image.pixels.data()));
+    // OpenGL ES 2 has neither mipmaps nor repeat for non power of two
+    // sizes.
+    mipmaps = util::HasVertexArrays() ||
+              (IsPowerOfTwo(image.width) && IsPowerOfTwo(image.height));
+    if (mipmaps) {
+      TANGO_GL_CHECK(glGenerateMipmap(GL_TEXTURE_2D));
+    } else {
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+      glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+  }
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                  mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+  glPixelStorei(GL_UNPACK_ALIGNMENT, previous_alignment);
+  state.BindTexture(GL_TEXTURE_2D, previous_texture);
+  return texture_id;
+}
+
+}  // namespace tango_gl
@@ -0,0 +1,412 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tango-gl/texture_loader.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <utility>
+
+#include "tango-gl/compressed_texture.h"
+#include "tango-gl/gl_debug.h"
+#include "tango-gl/gl_state.h"
+
+namespace tango_gl {
+
+const TextureLoader::Handle TextureLoader::kInvalidHandle;
+
+namespace {
+// Bump when the encoder output changes, so old cache files are not used.
+const uint64_t kTranscodeVersion = 1;
+
+// Every format a KTX file may bring.
+const GLenum kCompressedFormats[] = {
+    GL_ETC1_RGB8_OES,
+    GL_COMPRESSED_RGB8_ETC2,
+    GL_COMPRESSED_SRGB8_ETC2,
+    GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2,
+    GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2,
+    GL_COMPRESSED_RGBA8_ETC2_EAC,
+    GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC};
+const GLenum kAstcFormatRanges[2][2] = {
+    {GL_COMPRESSED_RGBA_ASTC_4x4_KHR, GL_COMPRESSED_RGBA_ASTC_12x12_KHR},
+    {GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR,
+     GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR}};
+
+double NowMs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1000.0 + now.tv_nsec / 1.0e6;
+}
+
+int QueueIndex(bool visible) { return visible ? 0 : 1; }
+
+bool ReadFile(const std::string& path, std::vector<uint8_t>* data) {
+  FILE* file = fopen(path.c_str(), "rb");
+  if (file == NULL) {
+    return false;
+  }
+  uint8_t buffer[64 << 10];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    data->insert(data->end(), buffer, buffer + read);
+  }
+  fclose(file);
+  return true;
+}
+
+bool IsIn(const std::vector<GLenum>& formats, GLenum format) {
+  return std::find(formats.begin(), formats.end(), format) != formats.end();
+}
+}  // namespace
+
+TextureLoader::TextureLoader(int num_threads, size_t max_decoded_bytes)
+    : next_handle_(1), max_decoded_bytes_(max_decoded_bytes), stopping_(false) {
+  memset(&stats_, 0, sizeof(stats_));
+  pthread_mutex_init(&mutex_, NULL);
+  pthread_cond_init(&work_cond_, NULL);
+  if (num_threads <= 0) {
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    num_threads = cores > 2 ? static_cast<int>(cores) - 1 : 1;
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, &TextureLoader::ThreadMain, this) == 0) {
+      threads_.push_back(thread);
+    }
+  }
+}
+
+TextureLoader::~TextureLoader() {
+  pthread_mutex_lock(&mutex_);
+  stopping_ = true;
+  pthread_cond_broadcast(&work_cond_);
+  pthread_mutex_unlock(&mutex_);
+  for (size_t i = 0; i < threads_.size(); ++i) {
+    pthread_join(threads_[i], NULL);
+  }
+  for (const std::pair<const Handle, Entry>& entry : entries_) {
+    if (entry.second.texture != 0) {
+      cancelled_textures_.push_back(entry.second.texture);
+    }
+  }
+  if (!cancelled_textures_.empty()) {
+    GlState::GetInstance().DeleteTextures(cancelled_textures_.size(),
+                                          cancelled_textures_.data());
+  }
+  pthread_cond_destroy(&work_cond_);
+  pthread_mutex_destroy(&mutex_);
+}
+
+void TextureLoader::SetCompressedCacheDirectory(
+    const std::string& directory) {
+  std::vector<GLenum> formats;
+  if (!directory.empty()) {
+    for (GLenum format : kCompressedFormats) {
+      if (compressed_texture::IsFormatSupported(format)) {
+        formats.push_back(format);
+      }
+    }
+    for (const GLenum* range : kAstcFormatRanges) {
+      for (GLenum format = range[0]; format <= range[1]; ++format) {
+        if (compressed_texture::IsFormatSupported(format)) {
+          formats.push_back(format);
+        }
+      }
+    }
+  }
+  pthread_mutex_lock(&mutex_);
+  cache_directory_ = directory;
+  compressed_formats_.swap(formats);
+  pthread_mutex_unlock(&mutex_);
+}
+
+TextureLoader::Handle TextureLoader::Load(const std::string& file_path,
+                                          bool visible) {
+  pthread_mutex_lock(&mutex_);
+  const Handle handle = next_handle_++;
+  if (next_handle_ == kInvalidHandle) {
+    ++next_handle_;
+  }
+  Entry& entry = entries_[handle];
+  entry.path = file_path;
+  entry.visible = visible;
+  entry.state = kPending;
+  entry.decoding = false;
+  entry.texture = 0;
+  decode_queues_[QueueIndex(visible)].push_back(handle);
+  pthread_cond_signal(&work_cond_);
+  pthread_mutex_unlock(&mutex_);
+  return handle;
+}
+
+void TextureLoader::SetVisible(Handle handle, bool visible) {
+  pthread_mutex_lock(&mutex_);
+  std::unordered_map<Handle, Entry>::iterator it = entries_.find(handle);
+  if (it != entries_.end() && it->second.visible != visible) {
+    // The copy left in the other queue is skipped when popped.
+    it->second.visible = visible;
+    if (it->second.state == kPending && !it->second.decoding) {
+      decode_queues_[QueueIndex(visible)].push_back(handle);
+    } else if (it->second.state == kDecoded) {
+      upload_queues_[QueueIndex(visible)].push_back(handle);
+    }
+  }
+  pthread_mutex_unlock(&mutex_);
+}
+
+void TextureLoader::Cancel(Handle handle) {
+  pthread_mutex_lock(&mutex_);
+  std::unordered_map<Handle, Entry>::iterator it = entries_.find(handle);
+  if (it != entries_.end()) {
+    if (it->second.texture != 0) {
+      cancelled_textures_.push_back(it->second.texture);
+    }
+    if (!it->second.image.pixels.empty()) {
+      stats_.queued_bytes -= it->second.image.pixels.size();
+      pthread_cond_signal(&work_cond_);
+    }
+    // A thread still decoding it drops the result.
+    entries_.erase(it);
+  }
+  pthread_mutex_unlock(&mutex_);
+}
+
+TextureLoader::State TextureLoader::GetState(Handle handle) const {
+  pthread_mutex_lock(&mutex_);
+  std::unordered_map<Handle, Entry>::const_iterator it = entries_.find(handle);
+  const State state = it != entries_.end() ? it->second.state : kUnknown;
+  pthread_mutex_unlock(&mutex_);
+  return state;
+}
+
+GLuint TextureLoader::GetTexture(Handle handle) const {
+  pthread_mutex_lock(&mutex_);
+  std::unordered_map<Handle, Entry>::const_iterator it = entries_.find(handle);
+  const GLuint texture = it != entries_.end() ? it->second.texture : 0;
+  pthread_mutex_unlock(&mutex_);
+  return texture;
+}
+
+void TextureLoader::Update(double budget_ms) {
+  TANGO_GL_LABEL("TextureLoader::Update");
+  const double start = NowMs();
+  std::vector<GLuint> cancelled;
+  pthread_mutex_lock(&mutex_);
+  cancelled.swap(cancelled_textures_);
+  pthread_mutex_unlock(&mutex_);
+  if (!cancelled.empty()) {
+    GlState::GetInstance().DeleteTextures(cancelled.size(), cancelled.data());
+  }
+
+  while (true) {
+    Texture::Image image;
+    pthread_mutex_lock(&mutex_);
+    const Handle handle = PopQueued(upload_queues_, kDecoded);
+    if (handle != kInvalidHandle) {
+      image.width = entries_[handle].image.width;
+      image.height = entries_[handle].image.height;
+      image.format = entries_[handle].image.format;
+      image.compressed_format = entries_[handle].image.compressed_format;
+      image.level_sizes.swap(entries_[handle].image.level_sizes);
+      image.pixels.swap(entries_[handle].image.pixels);
+      stats_.queued_bytes -= image.pixels.size();
+      pthread_cond_signal(&work_cond_);
+    }
+    pthread_mutex_unlock(&mutex_);
+    if (handle == kInvalidHandle) {
+      break;
+    }
+
+    const double upload_start = NowMs();
+    GLuint texture = Texture::CreateTexture(image);
+    // Free the pixels before taking the lock again.
+    std::vector<uint8_t>().swap(image.pixels);
+
+    pthread_mutex_lock(&mutex_);
+    stats_.upload_ms += NowMs() - upload_start;
+    std::unordered_map<Handle, Entry>::iterator it = entries_.find(handle);
+    if (it != entries_.end()) {
+      it->second.texture = texture;
+      it->second.state = texture != 0 ? kReady : kFailed;
+      if (texture != 0) {
+        ++stats_.uploaded;
+      } else {
+        ++stats_.failed;
+      }
+      texture = 0;
+    }
+    pthread_mutex_unlock(&mutex_);
+    if (texture != 0) {
+      // Cancelled during the upload.
+      GlState::GetInstance().DeleteTextures(1, &texture);
+    }
+    if (NowMs() - start >= budget_ms) {
+      break;
+    }
+  }
+}
+
+TextureLoader::Stats TextureLoader::GetStats() const {
+  pthread_mutex_lock(&mutex_);
+  const Stats stats = stats_;
+  pthread_mutex_unlock(&mutex_);
+  return stats;
+}
+
+bool TextureLoader::LoadImage(const std::string& file_path,
+                              const std::string& cache_directory,
+                              const std::vector<GLenum>& formats,
+                              Texture::Image* image, Source* source) {
+  *source = kFromPng;
+  if (cache_directory.empty()) {
+    return Texture::DecodePNG(file_path.c_str(), image);
+  }
+  // A compressed version shipped with the app wins.
+  const size_t extension = file_path.rfind('.');
+  if (extension != std::string::npos &&
+      file_path.find('/', extension) == std::string::npos) {
+    const std::string ktx_path = file_path.substr(0, extension) + ".ktx";
+    if (access(ktx_path.c_str(), R_OK) == 0 &&
+        compressed_texture::ReadKTX(ktx_path.c_str(), image) &&
+        IsIn(formats, image->compressed_format)) {
+      *source = kFromKtx;
+      return true;
+    }
+  }
+
+  std::vector<uint8_t> png;
+  if (!ReadFile(file_path, &png)) {
+    LOGE("Failed to open file: %s", file_path.c_str());
+    return false;
+  }
+  const bool transcode = IsIn(formats, GL_COMPRESSED_RGB8_ETC2) &&
+                         IsIn(formats, GL_COMPRESSED_RGBA8_ETC2_EAC);
+  std::string cache_path;
+  if (transcode) {
+    uint64_t hash = util::HashBytes(&kTranscodeVersion,
+                                    sizeof(kTranscodeVersion));
+    hash = util::HashBytes(png.data(), png.size(), hash);
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.ktx",
+             static_cast<unsigned long long>(hash));
+    cache_path = cache_directory + name;
+    if (access(cache_path.c_str(), R_OK) == 0 &&
+        compressed_texture::ReadKTX(cache_path.c_str(), image)) {
+      *source = kFromKtx;
+      return true;
+    }
+  }
+
+  Texture::Image decoded;
+  if (!Texture::DecodePNG(png.data(), png.size(), &decoded)) {
+    LOGE("Failed to decode %s", file_path.c_str());
+    return false;
+  }
+  std::vector<uint8_t>().swap(png);
+  if (transcode && compressed_texture::EncodeETC2(decoded, image)) {
+    compressed_texture::WriteKTX(cache_path.c_str(), *image);
+    *source = kTranscoded;
+    return true;
+  }
+  *image = std::move(decoded);
+  return true;
+}
+
+void* TextureLoader::ThreadMain(void* arg) {
+  static_cast<TextureLoader*>(arg)->Run();
+  return NULL;
+}
+
+void TextureLoader::Run() {
+  pthread_mutex_lock(&mutex_);
+  while (true) {
+    Handle handle = kInvalidHandle;
+    while (!stopping_ &&
+           (stats_.queued_bytes >= max_decoded_bytes_ ||
+            (handle = PopQueued(decode_queues_, kPending)) == kInvalidHandle)) {
+      pthread_cond_wait(&work_cond_, &mutex_);
+    }
+    if (stopping_) {
+      break;
+    }
+    Entry& entry = entries_[handle];
+    entry.decoding = true;
+    const std::string path = entry.path;
+    const std::string cache_directory = cache_directory_;
+    const std::vector<GLenum> formats = compressed_formats_;
+    pthread_mutex_unlock(&mutex_);
+
+    const double decode_start = NowMs();
+    Texture::Image image;
+    Source source = kFromPng;
+    const bool decoded =
+        LoadImage(path, cache_directory, formats, &image, &source);
+    const double decode_ms = NowMs() - decode_start;
+
+    pthread_mutex_lock(&mutex_);
+    stats_.decode_ms += decode_ms;
+    if (decoded) {
+      stats_.compressed += source == kFromKtx;
+      stats_.transcoded += source == kTranscoded;
+    }
+    std::unordered_map<Handle, Entry>::iterator it = entries_.find(handle);
+    if (it == entries_.end()) {
+      // Cancelled while decoding.
+      continue;
+    }
+    it->second.decoding = false;
+    if (decoded) {
+      ++stats_.decoded;
+      stats_.queued_bytes += image.pixels.size();
+      it->second.image.width = image.width;
+      it->second.image.height = image.height;
+      it->second.image.format = image.format;
+      it->second.image.compressed_format = image.compressed_format;
+      it->second.image.level_sizes.swap(image.level_sizes);
+      it->second.image.pixels.swap(image.pixels);
+      it->second.state = kDecoded;
+      upload_queues_[QueueIndex(it->second.visible)].push_back(handle);
+    } else {
+      ++stats_.failed;
+      it->second.state = kFailed;
+    }
+  }
+  pthread_mutex_unlock(&mutex_);
+}
+
+TextureLoader::Handle TextureLoader::PopQueued(std::deque<Handle>* queues,
+                                               State state) {
+  for (int i = 0; i < 2; ++i) {
+    while (!queues[i].empty()) {
+      const Handle handle = queues[i].front();
+      queues[i].pop_front();
+      std::unordered_map<Handle, Entry>::const_iterator it =
+          entries_.find(handle);
+      if (it != entries_.end() && it->second.state == state &&
+          !it->second.decoding && QueueIndex(it->second.visible) == i) {
+        return handle;
+      }
+    }
+  }
+  return kInvalidHandle;
+}
+
+}  // namespace tango_gl
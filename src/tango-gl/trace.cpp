@@ -0,0 +1,86 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "tango-gl/trace.h"
+
+#include <string.h>
+
+#include "tango-gl/gl_debug.h"
+#include "tango-gl/gl_state.h"
+
+namespace tango_gl {
+
+static const int kMaxTraceLength = 5000;
+static const float kDistanceCheck = 0.05f;
+
+Trace::Trace() : Line(3.0f, GL_LINE_STRIP), ring_(kMaxTraceLength) {
+  SetShader();
+  SetBufferUsage(kDynamicDraw);
+  // Allocated once, including the copy of slot 0 past the end.
+  vertices_.assign(3 * (ring_.GetCapacity() + 1), 0.0f);
+}
+
+void Trace::UpdateVertexArray(const glm::vec3& v) {
+  if (!ring_.IsEmpty()) {
+    const GLfloat* last = &vertices_[3 * ring_.GetNewest(0)];
+    if (glm::distance(glm::vec3(last[0], last[1], last[2]), v) <
+        kDistanceCheck) {
+      return;
+    }
+  }
+  WriteSlot(ring_.Push(), v);
+}
+
+void Trace::ClearVertexArray() { ring_.Clear(); }
+
+void Trace::WriteSlot(size_t slot, const glm::vec3& v) {
+  memcpy(&vertices_[3 * slot], glm::value_ptr(v), 3 * sizeof(GLfloat));
+  MarkVerticesDirty(3 * slot, 3);
+  if (slot == 0) {
+    const size_t mirror = 3 * ring_.GetCapacity();
+    memcpy(&vertices_[mirror], glm::value_ptr(v), 3 * sizeof(GLfloat));
+    MarkVerticesDirty(mirror, 3);
+  }
+}
+
+void Trace::Render(const glm::mat4& projection_mat,
+                   const glm::mat4& view_mat) const {
+  VertexRing::Range ranges[2];
+  const int range_count = ring_.GetDrawRanges(ranges);
+  if (range_count == 0) {
+    return;
+  }
+  TANGO_GL_LABEL("Trace::Render");
+  GlState& state = GlState::GetInstance();
+  state.UseProgram(shader_program_);
+  state.LineWidth(line_width_);
+  glm::mat4 model_mat = GetTransformationMatrix();
+  glm::mat4 mvp_mat = projection_mat * view_mat * model_mat;
+  glUniformMatrix4fv(uniform_mvp_mat_, 1, GL_FALSE, glm::value_ptr(mvp_mat));
+  glUniform4f(uniform_color_, red_, green_, blue_, alpha_);
+
+  if (BindGeometry()) {
+    for (int i = 0; i < range_count; ++i) {
+      TANGO_GL_CHECK(glDrawArrays(render_mode_,
+                                  static_cast<GLint>(ranges[i].first),
+                                  static_cast<GLsizei>(ranges[i].count)));
+    }
+    UnbindGeometry();
+  }
+}
+
+}  // namespace tango_gl
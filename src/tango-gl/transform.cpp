@@ -0,0 +1,209 @@
+/*
+ * Copyright 2014 Google Inc. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "tango-gl/transform.h"
+
+#include <algorithm>
+
+#include "tango-gl/util.h"
+
+namespace tango_gl {
+Transform::Transform()
+    : parent_(NULL),
+      position_(0.0f, 0.0f, 0.0f),
+      rotation_(1.0f, 0.0f, 0.0f, 0.0f),
+      scale_(1.0f, 1.0f, 1.0f),
+      local_matrix_(1.0f),
+      world_matrix_(1.0f),
+      world_version_(0),
+      local_dirty_(false),
+      world_dirty_(false),
+      descendant_dirty_(false) {}
+
+Transform::~Transform() {
+  // Objects are not responsible for deleting their parents or children.
+  SetParent(NULL);
+  for (Transform* child : children_) {
+    child->parent_ = NULL;
+    child->SetWorldDirty();
+  }
+}
+
+void Transform::SetPosition(const glm::vec3& position) {
+  position_ = position;
+  SetLocalDirty();
+}
+
+glm::vec3 Transform::GetPosition() const { return position_; }
+
+void Transform::SetRotation(const glm::quat& rotation) {
+  rotation_ = rotation;
+  SetLocalDirty();
+}
+
+glm::quat Transform::GetRotation() const { return rotation_; }
+
+void Transform::SetScale(const glm::vec3& scale) {
+  scale_ = scale;
+  SetLocalDirty();
+}
+
+glm::vec3 Transform::GetScale() const { return scale_; }
+
+void Transform::Translate(const glm::vec3& translation) {
+  position_ += translation;
+  SetLocalDirty();
+}
+
+void Transform::SetTransformationMatrix(const glm::mat4& transform_mat) {
+  util::DecomposeMatrix(transform_mat, position_, rotation_, scale_);
+  SetLocalDirty();
+}
+
+glm::mat4 Transform::GetTransformationMatrix() const {
+  return GetWorldMatrix();
+}
+
+const glm::mat4& Transform::GetLocalMatrix() const {
+  if (local_dirty_) {
+    local_matrix_ = glm::scale(glm::mat4_cast(rotation_), scale_);
+    local_matrix_[3][0] = position_.x;
+    local_matrix_[3][1] = position_.y;
+    local_matrix_[3][2] = position_.z;
+    local_dirty_ = false;
+  }
+  return local_matrix_;
+}
+
+void Transform::SetParent(Transform* transform) {
+  if (transform == parent_) {
+    return;
+  }
+  for (Transform* ancestor = transform; ancestor != NULL;
+       ancestor = ancestor->parent_) {
+    if (ancestor == this) {
+      LOGE("Transform::SetParent would create a cycle, ignored.");
+      return;
+    }
+  }
+  if (parent_ != NULL) {
+    std::vector<Transform*>& siblings = parent_->children_;
+    siblings.erase(std::find(siblings.begin(), siblings.end(), this));
+  }
+  parent_ = transform;
+  if (parent_ != NULL) {
+    parent_->children_.push_back(this);
+  }
+  SetWorldDirty();
+}
+
+uint32_t Transform::GetWorldVersion() const {
+  GetWorldMatrix();
+  return world_version_;
+}
+
+const Transform* Transform::GetParent() const { return parent_; }
+
+Transform* Transform::GetParent() { return parent_; }
+
+void Transform::UpdateWorldMatrices() {
+  GetWorldMatrix();
+  if (!descendant_dirty_) {
+    return;
+  }
+  descendant_dirty_ = false;
+  // Depth first, so every parent is done before its children. Subtrees with
+  // nothing dirty are skipped whole.
+  std::vector<Transform*> stack(children_.begin(), children_.end());
+  while (!stack.empty()) {
+    Transform* node = stack.back();
+    stack.pop_back();
+    const bool was_dirty = node->world_dirty_;
+    if (was_dirty) {
+      node->world_matrix_ =
+          node->parent_->world_matrix_ * node->GetLocalMatrix();
+      node->world_dirty_ = false;
+      ++node->world_version_;
+    }
+    if (was_dirty || node->descendant_dirty_) {
+      node->descendant_dirty_ = false;
+      stack.insert(stack.end(), node->children_.begin(), node->children_.end());
+    }
+  }
+}
+
+const glm::mat4& Transform::GetWorldMatrix() const {
+  if (!world_dirty_) {
+    return world_matrix_;
+  }
+  // Walk up to the topmost dirty ancestor, then compute back down. A dirty
+  // transform's whole subtree is dirty, so the dirty ones form one chain.
+  const Transform* top = this;
+  while (top->parent_ != NULL && top->parent_->world_dirty_) {
+    top = top->parent_;
+  }
+  std::vector<const Transform*> chain;
+  for (const Transform* node = this; node != top; node = node->parent_) {
+    chain.push_back(node);
+  }
+  chain.push_back(top);
+  for (size_t i = chain.size(); i-- > 0;) {
+    const Transform* node = chain[i];
+    if (node->parent_ != NULL) {
+      node->world_matrix_ =
+          node->parent_->world_matrix_ * node->GetLocalMatrix();
+    } else {
+      node->world_matrix_ = node->GetLocalMatrix();
+    }
+    node->world_dirty_ = false;
+    ++node->world_version_;
+    // Its children are still dirty; keep them on the batch pass's path.
+    if (!node->children_.empty()) {
+      node->descendant_dirty_ = true;
+    }
+  }
+  return world_matrix_;
+}
+
+void Transform::SetLocalDirty() {
+  local_dirty_ = true;
+  SetWorldDirty();
+}
+
+void Transform::SetWorldDirty() {
+  if (!world_dirty_) {
+    world_dirty_ = true;
+    if (!children_.empty()) {
+      // Children already dirty have dirty subtrees too; stop there.
+      std::vector<Transform*> stack(children_.begin(), children_.end());
+      while (!stack.empty()) {
+        Transform* node = stack.back();
+        stack.pop_back();
+        if (!node->world_dirty_) {
+          node->world_dirty_ = true;
+          stack.insert(stack.end(), node->children_.begin(),
+                       node->children_.end());
+        }
+      }
+    }
+  }
+  for (Transform* ancestor = parent_;
+       ancestor != NULL && !ancestor->descendant_dirty_;
+       ancestor = ancestor->parent_) {
+    ancestor->descendant_dirty_ = true;
+  }
+}
+}  // namespace tango_gl
@@ -16,14 +16,148 @@
 
 #include "tango-gl/util.h"
 
+#include <string.h>
+
+#include "tango-gl/gl_debug.h"
+
 namespace tango_gl {
 
+namespace {
+GLuint LoadShader(GLenum shader_type, const char* shader_source) {
+  GLuint shader = glCreateShader(shader_type);
+  if (shader) {
+    glShaderSource(shader, 1, &shader_source, NULL);
+    glCompileShader(shader);
+    GLint compiled = 0;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled) {
+      GLint info_len = 0;
+      glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &info_len);
+      if (info_len) {
+        char* buf = (char*) malloc(info_len);
+        if (buf) {
+          glGetShaderInfoLog(shader, info_len, NULL, buf);
+          LOGE("Could not compile shader %d:\n%s\n", shader_type, buf);
+          free(buf);
+        }
+      }
+      glDeleteShader(shader);
+      shader = 0;
+    }
+  }
+  return shader;
+}
+}  // namespace
+
 void util::CheckGlError(const char* operation) {
   for (GLint error = glGetError(); error; error = glGetError()) {
     LOGI("after %s() glError (0x%x)\n", operation, error);
   }
 }
 
+GLuint util::CreateProgram(const char* vertex_source,
+                           const char* fragment_source,
+                           bool retrievable_binary) {
+  GLuint vertex_shader = LoadShader(GL_VERTEX_SHADER, vertex_source);
+  if (!vertex_shader) {
+    return 0;
+  }
+  GLuint fragment_shader = LoadShader(GL_FRAGMENT_SHADER, fragment_source);
+  if (!fragment_shader) {
+    glDeleteShader(vertex_shader);
+    return 0;
+  }
+
+  GLuint program = glCreateProgram();
+  if (program) {
+    TANGO_GL_CHECK(glAttachShader(program, vertex_shader));
+    TANGO_GL_CHECK(glAttachShader(program, fragment_shader));
+    if (retrievable_binary) {
+      glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                          GL_TRUE);
+    }
+    glLinkProgram(program);
+    GLint link_status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &link_status);
+    if (link_status != GL_TRUE) {
+      GLint buf_length = 0;
+      glGetProgramiv(program, GL_INFO_LOG_LENGTH, &buf_length);
+      if (buf_length) {
+        char* buf = (char*) malloc(buf_length);
+        if (buf) {
+          glGetProgramInfoLog(program, buf_length, NULL, buf);
+          LOGE("Could not link program:\n%s\n", buf);
+          free(buf);
+        }
+      }
+      glDeleteProgram(program);
+      program = 0;
+    }
+  }
+  // The program keeps the shaders alive for as long as it needs them.
+  glDeleteShader(vertex_shader);
+  glDeleteShader(fragment_shader);
+  return program;
+}
+
+uint64_t util::HashBytes(const void* data, size_t size, uint64_t hash) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+bool util::WriteFileAtomically(const std::string& path,
+                               const std::function<bool(FILE* file)>& write) {
+  const std::string part_path = path + ".part";
+  FILE* file = fopen(part_path.c_str(), "wb");
+  if (file == NULL) {
+    return false;
+  }
+  bool ok = write(file);
+  ok = fclose(file) == 0 && ok;
+  if (!ok || rename(part_path.c_str(), path.c_str()) != 0) {
+    remove(part_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool util::HasExtension(const char* name) {
+  const char* extensions =
+      reinterpret_cast<const char*>(glGetString(GL_EXTENSIONS));
+  if (extensions == NULL) {
+    return false;
+  }
+  const size_t length = strlen(name);
+  for (const char* found = strstr(extensions, name); found != NULL;
+       found = strstr(found + length, name)) {
+    // Whole names only; some extensions are prefixes of others.
+    if ((found == extensions || found[-1] == ' ') &&
+        (found[length] == ' ' || found[length] == '\0')) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool util::HasVertexArrays() {
+  // Version strings look like "OpenGL ES 3.1 ...". The answer cannot change
+  // for the lifetime of the process, so it is looked up once.
+  static const bool has_vertex_arrays = [] {
+    const char* version =
+        reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    const char kPrefix[] = "OpenGL ES ";
+    if (version == NULL ||
+        strncmp(version, kPrefix, sizeof(kPrefix) - 1) != 0) {
+      return false;
+    }
+    return atoi(version + sizeof(kPrefix) - 1) >= 3;
+  }();
+  return has_vertex_arrays;
+}
+
 void util::DecomposeMatrix (const glm::mat4& transform_mat,
                               glm::vec3& translation,
                               glm::quat& rotation,
@@ -0,0 +1,164 @@
+#ifndef CINDER_TANGO_THREAD_RINGS_H_
+#define CINDER_TANGO_THREAD_RINGS_H_
+
+#include <pthread.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "spsc_ring.h"
+
+// One SpscRing per producing thread, drained by a single consumer. Push
+// looks up the calling thread's ring and never locks or allocates after
+// that thread's first push; a full ring drops the item and counts it.
+// Drain pops every ring and frees the rings of threads that have ended
+// once they are empty. FastLog and Profiler keep their records in one.
+//
+//  ThreadRings<Record> rings(512);
+//  rings.Push(record);  // Any thread.
+//  rings.Drain([](int tid, const Record& record) { ... });  // One thread.
+template <typename T>
+class ThreadRings {
+ public:
+  // on_new_thread, if set, runs on each producing thread once its ring
+  // exists, before its first item is queued; it may Push.
+  explicit ThreadRings(size_t ring_size,
+                       void (*on_new_thread)(int tid) = nullptr)
+      : ring_size_(ring_size),
+        on_new_thread_(on_new_thread),
+        exited_dropped_(0) {
+    pthread_key_create(&thread_key_, OnThreadExit);
+    pthread_mutex_init(&mutex_, nullptr);
+  }
+  // Threads may still push while the process exits, so the rings, the key
+  // and the mutex are left alone.
+  ~ThreadRings() {}
+  ThreadRings(const ThreadRings& other) = delete;
+  ThreadRings& operator=(const ThreadRings&) = delete;
+
+  // Size of the rings of threads that push for the first time from now on.
+  void SetRingSize(size_t ring_size) {
+    ring_size_.store(ring_size, std::memory_order_relaxed);
+  }
+
+  bool Push(const T& item) {
+    Buffer* buffer = GetThreadBuffer();
+    if (!buffer->ring.TryPush(item)) {
+      buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+  // Calls consume(tid, item) for every queued item, a thread at a time, and
+  // returns how many items were dropped since the last Drain. One thread at
+  // a time.
+  template <typename Consume>
+  uint64_t Drain(Consume consume) {
+    return Drain(consume, [](int) {});
+  }
+
+  // Also calls thread_ended(tid) once an ended thread's ring is drained and
+  // freed. tid may belong to a newer thread by then.
+  template <typename Consume, typename ThreadEnded>
+  uint64_t Drain(Consume consume, ThreadEnded thread_ended) {
+    pthread_mutex_lock(&mutex_);
+    std::vector<Buffer*> buffers(buffers_);
+    pthread_mutex_unlock(&mutex_);
+
+    uint64_t dropped = 0;
+    T item;
+    for (Buffer* buffer : buffers) {
+      // Read before draining: a buffer that had exited then has nothing
+      // more coming once drained.
+      const bool exited = buffer->exited.load();
+      while (buffer->ring.TryPop(&item)) {
+        consume(buffer->tid, item);
+      }
+      const uint64_t total = buffer->dropped.load(std::memory_order_relaxed);
+      dropped += total - buffer->drained_dropped;
+      buffer->drained_dropped = total;
+      if (exited) {
+        pthread_mutex_lock(&mutex_);
+        buffers_.erase(std::find(buffers_.begin(), buffers_.end(), buffer));
+        exited_dropped_ += total;
+        pthread_mutex_unlock(&mutex_);
+        const int tid = buffer->tid;
+        delete buffer;
+        thread_ended(tid);
+      }
+    }
+    return dropped;
+  }
+
+  // Items dropped since the start, ended threads' included; any thread.
+  uint64_t GetDropped() const {
+    pthread_mutex_lock(&mutex_);
+    uint64_t dropped = exited_dropped_;
+    for (const Buffer* buffer : buffers_) {
+      dropped += buffer->dropped.load(std::memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&mutex_);
+    return dropped;
+  }
+
+  // Threads with a ring, ended ones not yet drained included; any thread.
+  int GetThreadCount() const {
+    pthread_mutex_lock(&mutex_);
+    const int count = static_cast<int>(buffers_.size());
+    pthread_mutex_unlock(&mutex_);
+    return count;
+  }
+
+  // The calling thread's kernel id, as Drain reports it.
+  int GetThreadId() { return GetThreadBuffer()->tid; }
+
+ private:
+  struct Buffer {
+    Buffer(size_t size, int tid)
+        : ring(size), tid(tid), dropped(0), drained_dropped(0),
+          exited(false) {}
+    SpscRing<T> ring;
+    const int tid;
+    std::atomic<uint64_t> dropped;
+    // Consumer only.
+    uint64_t drained_dropped;
+    // Set when the thread ends; Drain frees the buffer once drained.
+    std::atomic<bool> exited;
+  };
+
+  static void OnThreadExit(void* buffer) {
+    static_cast<Buffer*>(buffer)->exited.store(true);
+  }
+
+  Buffer* GetThreadBuffer() {
+    Buffer* buffer = static_cast<Buffer*>(pthread_getspecific(thread_key_));
+    if (buffer != nullptr) {
+      return buffer;
+    }
+    // Once per thread.
+    const int tid = static_cast<int>(syscall(__NR_gettid));
+    buffer = new Buffer(ring_size_.load(std::memory_order_relaxed), tid);
+    pthread_mutex_lock(&mutex_);
+    buffers_.push_back(buffer);
+    pthread_mutex_unlock(&mutex_);
+    pthread_setspecific(thread_key_, buffer);
+    if (on_new_thread_ != nullptr) {
+      on_new_thread_(tid);
+    }
+    return buffer;
+  }
+
+  std::atomic<size_t> ring_size_;
+  void (*const on_new_thread_)(int tid);
+  pthread_key_t thread_key_;
+  // Guards buffers_ and exited_dropped_.
+  mutable pthread_mutex_t mutex_;
+  std::vector<Buffer*> buffers_;
+  uint64_t exited_dropped_;
+};
+
+#endif  // CINDER_TANGO_THREAD_RINGS_H_
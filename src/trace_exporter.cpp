@@ -0,0 +1,247 @@
+#include "trace_exporter.h"
+
+#if CINDER_TANGO_PROFILE
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <cmath>
+
+#include "cinder/Log.h"
+
+namespace {
+std::string EscapeJson(const char* text) {
+  std::string escaped;
+  for (const char* c = text; *c != '\0'; ++c) {
+    if (*c == '"' || *c == '\\') {
+      escaped += '\\';
+      escaped += *c;
+    } else if (static_cast<unsigned char>(*c) < 0x20) {
+      escaped += ' ';
+    } else {
+      escaped += *c;
+    }
+  }
+  return escaped;
+}
+
+// Trace timestamps are in microseconds.
+double ToMicroseconds(int64_t ns) { return ns / 1000.0; }
+}  // namespace
+
+TraceExporter::Options::Options()
+    : queue_size(16384),
+      max_file_bytes(64 * 1024 * 1024),
+      flush_interval_ms(200) {}
+
+TraceExporter::TraceExporter()
+    : recording_(false),
+      trace_id_(0),
+      stopping_(false),
+      file_(nullptr),
+      pid_(0),
+      first_object_(true),
+      written_(0),
+      dropped_(0),
+      bytes_(0) {
+  pthread_mutex_init(&mutex_, nullptr);
+  pthread_cond_init(&wake_cond_, nullptr);
+}
+
+bool TraceExporter::Start(const Options& options) {
+  if (recording_.load()) {
+    return false;
+  }
+  options_ = options;
+  file_ = fopen(options_.path.c_str(), "w");
+  if (file_ == nullptr) {
+    CI_LOG_E("TraceExporter: cannot create " << options_.path << ": "
+                                             << strerror(errno));
+    return false;
+  }
+  if (!queue_ || queue_->GetCapacity() < options_.queue_size) {
+    queue_.reset(new SpscRing<Event>(options_.queue_size));
+  }
+  pid_ = getpid();
+  first_object_ = true;
+  written_.store(0);
+  dropped_.store(0);
+  bytes_.store(0);
+  fputs("[\n", file_);
+  WriteObject("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,"
+              "\"args\":{\"name\":\"CinderTango\"}}",
+              pid_);
+
+  stopping_ = false;
+  if (pthread_create(&thread_, nullptr, ThreadMain, this) != 0) {
+    CI_LOG_E("TraceExporter: cannot start writer thread");
+    fclose(file_);
+    file_ = nullptr;
+    return false;
+  }
+  ++trace_id_;
+  recording_.store(true, std::memory_order_release);
+  return true;
+}
+
+void TraceExporter::Stop() {
+  if (!recording_.exchange(false)) {
+    return;
+  }
+  pthread_mutex_lock(&mutex_);
+  stopping_ = true;
+  pthread_cond_signal(&wake_cond_);
+  pthread_mutex_unlock(&mutex_);
+  pthread_join(thread_, nullptr);
+  fputs("\n]\n", file_);
+  fclose(file_);
+  file_ = nullptr;
+  CI_LOG_I("TraceExporter: " << written_.load() << " events written to "
+                             << options_.path << ", " << dropped_.load()
+                             << " dropped");
+}
+
+TraceExporter::Stats TraceExporter::GetStats() const {
+  Stats stats;
+  stats.written = written_.load();
+  stats.dropped = dropped_.load();
+  stats.bytes = bytes_.load();
+  return stats;
+}
+
+void TraceExporter::AddThreadName(int tid, const char* name) {
+  Event event;
+  event.phase = 'M';
+  event.tid = tid;
+  event.name = strdup(name);
+  event.time_ns = 0;
+  event.duration_ns = 0;
+  event.value = 0.0;
+  if (!Push(event)) {
+    free(const_cast<char*>(event.name));
+  }
+}
+
+void TraceExporter::AddSpan(const char* name, int tid, int64_t begin_ns,
+                            int64_t end_ns) {
+  Event event;
+  event.phase = 'X';
+  event.tid = tid;
+  event.name = name;
+  event.time_ns = begin_ns;
+  event.duration_ns = end_ns - begin_ns;
+  event.value = 0.0;
+  Push(event);
+}
+
+void TraceExporter::AddCounter(const char* name, int tid, int64_t time_ns,
+                               double value) {
+  if (!std::isfinite(value)) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  Event event;
+  event.phase = 'C';
+  event.tid = tid;
+  event.name = name;
+  event.time_ns = time_ns;
+  event.duration_ns = 0;
+  event.value = value;
+  Push(event);
+}
+
+bool TraceExporter::Push(const Event& event) {
+  if (!IsRecording()) {
+    return false;
+  }
+  if (!queue_->TryPush(event)) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+void* TraceExporter::ThreadMain(void* arg) {
+  static_cast<TraceExporter*>(arg)->Run();
+  return nullptr;
+}
+
+void TraceExporter::Run() {
+  Event event;
+  pthread_mutex_lock(&mutex_);
+  while (true) {
+    const bool stopping = stopping_;
+    pthread_mutex_unlock(&mutex_);
+
+    while (queue_->TryPop(&event)) {
+      WriteEvent(event);
+    }
+    fflush(file_);
+
+    pthread_mutex_lock(&mutex_);
+    if (stopping) {
+      break;
+    }
+    if (!stopping_) {
+      timespec deadline;
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_nsec += options_.flush_interval_ms * 1000000L;
+      deadline.tv_sec += deadline.tv_nsec / 1000000000L;
+      deadline.tv_nsec %= 1000000000L;
+      pthread_cond_timedwait(&wake_cond_, &mutex_, &deadline);
+    }
+  }
+  pthread_mutex_unlock(&mutex_);
+}
+
+void TraceExporter::WriteEvent(const Event& event) {
+  const std::string name = EscapeJson(event.name);
+  bool written;
+  if (event.phase == 'M') {
+    written = WriteObject(
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,"
+        "\"args\":{\"name\":\"%s\"}}",
+        pid_, event.tid, name.c_str());
+    free(const_cast<char*>(event.name));
+  } else if (event.phase == 'X') {
+    written = WriteObject(
+        "{\"name\":\"%s\",\"cat\":\"stage\",\"ph\":\"X\",\"pid\":%d,"
+        "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+        name.c_str(), pid_, event.tid, ToMicroseconds(event.time_ns),
+        ToMicroseconds(event.duration_ns));
+  } else {
+    written = WriteObject(
+        "{\"name\":\"%s\",\"ph\":\"C\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,"
+        "\"args\":{\"value\":%g}}",
+        name.c_str(), pid_, event.tid, ToMicroseconds(event.time_ns),
+        event.value);
+  }
+  if (written) {
+    written_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+bool TraceExporter::WriteObject(const char* format, ...) {
+  if (bytes_.load(std::memory_order_relaxed) >= options_.max_file_bytes) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  if (!first_object_) {
+    fputs(",\n", file_);
+    bytes_.fetch_add(2, std::memory_order_relaxed);
+  }
+  first_object_ = false;
+  va_list args;
+  va_start(args, format);
+  const int size = vfprintf(file_, format, args);
+  va_end(args);
+  if (size > 0) {
+    bytes_.fetch_add(size, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+#endif  // CINDER_TANGO_PROFILE
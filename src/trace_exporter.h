@@ -0,0 +1,128 @@
+#ifndef CINDER_TANGO_TRACE_EXPORTER_H_
+#define CINDER_TANGO_TRACE_EXPORTER_H_
+
+#include "profiler.h"
+
+#if CINDER_TANGO_PROFILE
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "spsc_ring.h"
+
+// Streams the profiler's spans and counters to a file in the Chrome
+// trace-event JSON format, which chrome://tracing and ui.perfetto.dev open.
+// Each span is a complete ("X") event on the thread that ran it, so the
+// Tango callbacks show up on their own tracks next to the render and
+// simulation threads, starting where the callback arrived. The profiler
+// names the tracks after the threads' kernel names.
+//
+// Profiler::EndFrame hands the events over through a bounded queue; a
+// background thread formats them and writes the file. A full queue drops
+// events and counts them, and the file stops growing at max_file_bytes, so
+// memory and disk use stay bounded however long a session runs.
+//
+// The file is a JSON array whose closing bracket is written by Stop. The
+// viewers accept it without one, so the trace of a session that crashed
+// still loads.
+//
+// Start and Stop must be called from the thread that calls
+// Profiler::EndFrame.
+class TraceExporter {
+ public:
+  struct Options {
+    Options();
+    std::string path;
+    // Events waiting for the writer.
+    size_t queue_size;
+    uint64_t max_file_bytes;
+    int flush_interval_ms;
+  };
+
+  struct Stats {
+    uint64_t written;
+    // Lost to a full queue or to max_file_bytes.
+    uint64_t dropped;
+    uint64_t bytes;
+  };
+
+  static TraceExporter& GetInstance() {
+    static TraceExporter instance;
+    return instance;
+  }
+
+  TraceExporter(const TraceExporter& other) = delete;
+  TraceExporter& operator=(const TraceExporter&) = delete;
+
+  // Truncates options.path and starts writing to it. Returns false if a
+  // trace is being recorded already or the file cannot be created.
+  bool Start(const Options& options);
+  // Writes what is queued and closes the file.
+  void Stop();
+  bool IsRecording() const {
+    return recording_.load(std::memory_order_acquire);
+  }
+  // Changes with every Start.
+  uint32_t GetTraceId() const { return trace_id_; }
+
+  Stats GetStats() const;
+
+  // The thread calling Profiler::EndFrame only. Names the track of thread
+  // tid; name is copied.
+  void AddThreadName(int tid, const char* name);
+  // The thread calling Profiler::EndFrame only. name must outlive the
+  // exporter. Counter values that are not finite are dropped, since JSON
+  // has no NaN or infinity.
+  void AddSpan(const char* name, int tid, int64_t begin_ns, int64_t end_ns);
+  void AddCounter(const char* name, int tid, int64_t time_ns, double value);
+
+ private:
+  struct Event {
+    char phase;
+    int tid;
+    // For thread names ('M'), a copy the writer frees.
+    const char* name;
+    int64_t time_ns;
+    // Span duration, or counter value.
+    int64_t duration_ns;
+    double value;
+  };
+
+  TraceExporter();
+  ~TraceExporter() {}
+
+  static void* ThreadMain(void* arg);
+  // Returns false if the event was not queued.
+  bool Push(const Event& event);
+  void Run();
+  void WriteEvent(const Event& event);
+  // Writes one JSON object, comma-separated from the previous one, unless
+  // the file is full.
+  bool WriteObject(const char* format, ...)
+      __attribute__((format(printf, 2, 3)));
+
+  Options options_;
+  std::unique_ptr<SpscRing<Event> > queue_;
+  std::atomic<bool> recording_;
+  uint32_t trace_id_;
+  pthread_t thread_;
+  // Guards stopping_.
+  mutable pthread_mutex_t mutex_;
+  pthread_cond_t wake_cond_;
+  bool stopping_;
+  // Writer thread only.
+  FILE* file_;
+  int pid_;
+  bool first_object_;
+  std::atomic<uint64_t> written_;
+  std::atomic<uint64_t> dropped_;
+  std::atomic<uint64_t> bytes_;
+};
+
+#endif  // CINDER_TANGO_PROFILE
+
+#endif  // CINDER_TANGO_TRACE_EXPORTER_H_
@@ -0,0 +1,52 @@
+#ifndef CINDER_TANGO_TRIPLE_BUFFER_H_
+#define CINDER_TANGO_TRIPLE_BUFFER_H_
+
+#include <stdint.h>
+#include <atomic>
+
+// Hands the latest value from one writer thread to one reader thread without
+// locks or waiting. The writer fills GetWriteBuffer and publishes it; the
+// reader picks up the newest published buffer with Acquire and reads it
+// until its next Acquire. Values published in between are skipped, so a
+// slow reader never holds the writer back and always sees the freshest one.
+//
+// Buffers are reused, never cleared: the write buffer holds whatever was
+// written to it two publishes ago, so writers must overwrite every field
+// (and get to keep the capacity of any containers).
+template <typename T>
+class TripleBuffer {
+ public:
+  TripleBuffer() : write_(0), middle_(1), read_(2) {}
+  TripleBuffer(const TripleBuffer& other) = delete;
+  TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+  // Writer thread only.
+  T& GetWriteBuffer() { return buffers_[write_]; }
+  void Publish() {
+    write_ = middle_.exchange(write_ | kFresh, std::memory_order_acq_rel) &
+             kIndexMask;
+  }
+
+  // Reader thread only. Returns false, keeping the current read buffer, if
+  // nothing was published since the last call.
+  bool Acquire() {
+    if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0) {
+      return false;
+    }
+    read_ = middle_.exchange(read_, std::memory_order_acq_rel) & kIndexMask;
+    return true;
+  }
+  const T& GetReadBuffer() const { return buffers_[read_]; }
+
+ private:
+  static const uint8_t kIndexMask = 3;
+  // Set in middle_ while it holds a buffer the reader has not taken.
+  static const uint8_t kFresh = 4;
+
+  T buffers_[3];
+  uint8_t write_;
+  std::atomic<uint8_t> middle_;
+  uint8_t read_;
+};
+
+#endif  // CINDER_TANGO_TRIPLE_BUFFER_H_
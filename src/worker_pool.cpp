@@ -0,0 +1,142 @@
+#include "worker_pool.h"
+
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+
+namespace {
+// Shared between RunBatch and the helpers it enqueues. Helpers that start
+// after the batch is done find nothing left to claim and never touch tasks.
+struct TaskBatch {
+  explicit TaskBatch(const std::vector<std::function<void()> >* tasks)
+      : tasks(tasks), size(tasks->size()), next(0), finished(0) {
+    pthread_mutex_init(&mutex, nullptr);
+    pthread_cond_init(&done_cond, nullptr);
+  }
+  ~TaskBatch() {
+    pthread_cond_destroy(&done_cond);
+    pthread_mutex_destroy(&mutex);
+  }
+
+  void Drain() {
+    size_t i;
+    while ((i = next.fetch_add(1)) < size) {
+      (*tasks)[i]();
+      pthread_mutex_lock(&mutex);
+      if (++finished == size) {
+        pthread_cond_broadcast(&done_cond);
+      }
+      pthread_mutex_unlock(&mutex);
+    }
+  }
+
+  const std::vector<std::function<void()> >* tasks;
+  const size_t size;
+  std::atomic<size_t> next;
+  pthread_mutex_t mutex;
+  pthread_cond_t done_cond;
+  size_t finished;
+};
+}  // namespace
+
+WorkerPool::WorkerPool(int num_threads) : active_tasks_(0), stopping_(false) {
+  pthread_mutex_init(&mutex_, nullptr);
+  pthread_cond_init(&task_cond_, nullptr);
+  pthread_cond_init(&idle_cond_, nullptr);
+  if (num_threads < 1) {
+    num_threads = 1;
+  }
+  for (int i = 0; i < num_threads; ++i) {
+    pthread_t thread;
+    if (pthread_create(&thread, nullptr, &WorkerPool::ThreadMain, this) == 0) {
+      threads_.push_back(thread);
+    }
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  pthread_mutex_lock(&mutex_);
+  stopping_ = true;
+  tasks_.clear();
+  pthread_cond_broadcast(&task_cond_);
+  pthread_mutex_unlock(&mutex_);
+  for (size_t i = 0; i < threads_.size(); ++i) {
+    pthread_join(threads_[i], nullptr);
+  }
+  pthread_cond_destroy(&idle_cond_);
+  pthread_cond_destroy(&task_cond_);
+  pthread_mutex_destroy(&mutex_);
+}
+
+int WorkerPool::DefaultThreadCount() {
+  long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  return cores > 2 ? static_cast<int>(cores) - 1 : 1;
+}
+
+bool WorkerPool::Enqueue(std::function<void()> task) {
+  pthread_mutex_lock(&mutex_);
+  const bool accepted = !stopping_ && !threads_.empty();
+  if (accepted) {
+    tasks_.push_back(std::move(task));
+    pthread_cond_signal(&task_cond_);
+  }
+  pthread_mutex_unlock(&mutex_);
+  return accepted;
+}
+
+void WorkerPool::WaitIdle() {
+  pthread_mutex_lock(&mutex_);
+  while (!tasks_.empty() || active_tasks_ > 0) {
+    pthread_cond_wait(&idle_cond_, &mutex_);
+  }
+  pthread_mutex_unlock(&mutex_);
+}
+
+void WorkerPool::RunBatch(const std::vector<std::function<void()> >& tasks) {
+  if (tasks.empty()) {
+    return;
+  }
+  std::shared_ptr<TaskBatch> batch(new TaskBatch(&tasks));
+  const size_t helpers = std::min(threads_.size(), tasks.size() - 1);
+  for (size_t i = 0; i < helpers; ++i) {
+    Enqueue([batch]() { batch->Drain(); });
+  }
+  batch->Drain();
+  pthread_mutex_lock(&batch->mutex);
+  while (batch->finished < batch->size) {
+    pthread_cond_wait(&batch->done_cond, &batch->mutex);
+  }
+  pthread_mutex_unlock(&batch->mutex);
+}
+
+void* WorkerPool::ThreadMain(void* arg) {
+  static_cast<WorkerPool*>(arg)->Run();
+  return nullptr;
+}
+
+void WorkerPool::Run() {
+  pthread_mutex_lock(&mutex_);
+  while (true) {
+    while (tasks_.empty() && !stopping_) {
+      pthread_cond_wait(&task_cond_, &mutex_);
+    }
+    if (stopping_) {
+      break;
+    }
+    std::function<void()> task = std::move(tasks_.front());
+    tasks_.pop_front();
+    ++active_tasks_;
+    pthread_mutex_unlock(&mutex_);
+
+    task();
+
+    pthread_mutex_lock(&mutex_);
+    --active_tasks_;
+    if (tasks_.empty() && active_tasks_ == 0) {
+      pthread_cond_broadcast(&idle_cond_);
+    }
+  }
+  // Wake anyone waiting on a queue that was cleared by the destructor.
+  pthread_cond_broadcast(&idle_cond_);
+  pthread_mutex_unlock(&mutex_);
+}
@@ -0,0 +1,54 @@
+#ifndef CINDER_TANGO_WORKER_POOL_H_
+#define CINDER_TANGO_WORKER_POOL_H_
+
+#include <pthread.h>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// A fixed set of pthreads draining a FIFO task queue. Used for work that must
+// stay off the render thread and off the Tango callback threads (mesh
+// simplification, exports and other long running jobs).
+//
+// Tasks may be enqueued from any thread. Destroying the pool discards tasks
+// that have not started yet and joins all threads once the running tasks
+// return.
+class WorkerPool {
+ public:
+  explicit WorkerPool(int num_threads);
+  WorkerPool(const WorkerPool& other) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+  ~WorkerPool();
+
+  // One thread per online core, keeping one core free for the render thread.
+  static int DefaultThreadCount();
+
+  // Returns false, dropping the task, once the pool is being destroyed or
+  // if it has no threads to run it.
+  bool Enqueue(std::function<void()> task);
+
+  // Blocks until the queue is empty and no task is running.
+  void WaitIdle();
+
+  // Runs tasks in parallel and returns when all of them have finished. The
+  // calling thread works on the batch too, so this is safe to call from a
+  // pool thread and does not wait on unrelated queued work.
+  void RunBatch(const std::vector<std::function<void()> >& tasks);
+
+  int GetThreadCount() const { return static_cast<int>(threads_.size()); }
+
+ private:
+  static void* ThreadMain(void* arg);
+  void Run();
+
+  std::vector<pthread_t> threads_;
+  std::deque<std::function<void()> > tasks_;
+  pthread_mutex_t mutex_;
+  pthread_cond_t task_cond_;
+  pthread_cond_t idle_cond_;
+  int active_tasks_;
+  bool stopping_;
+};
+
+#endif  // CINDER_TANGO_WORKER_POOL_H_
@@ -0,0 +1,534 @@
+#include "yuv_convert.h"
+
+#include <string.h>
+#include <vector>
+
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define YUV_CONVERT_NEON 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define YUV_CONVERT_SSE2 1
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define YUV_CONVERT_SSSE3 1
+#endif
+#endif
+
+namespace yuv_convert {
+namespace {
+
+// 6-bit fixed point BT.601 coefficients. Every intermediate fits a signed
+// 16-bit lane; only the blue sum can overflow, and then only for values that
+// clamp to 255 either way, so saturating SIMD adds match the scalar path.
+const int kLumaScale = 74;
+const int kVToR = 102;
+const int kUToG = 25;
+const int kVToG = 52;
+const int kUToB = 129;
+
+inline uint8_t Clamp255(int value) {
+  return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+// Scalar reference kernels. Each processes [begin, n) so it can finish the
+// tail left by the SIMD version.
+
+void Reduce2RowScalar(const uint8_t* r0, const uint8_t* r1, int begin, int n,
+                      uint8_t* dst) {
+  for (int x = begin; x < n; ++x) {
+    int sum = r0[2 * x] + r0[2 * x + 1] + r1[2 * x] + r1[2 * x + 1];
+    dst[x] = static_cast<uint8_t>((sum + 2) >> 2);
+  }
+}
+
+void Reduce4RowScalar(const uint8_t* const rows[4], int begin, int n,
+                      uint8_t* dst) {
+  for (int x = begin; x < n; ++x) {
+    int sum = 0;
+    for (int r = 0; r < 4; ++r) {
+      const uint8_t* p = rows[r] + 4 * x;
+      sum += p[0] + p[1] + p[2] + p[3];
+    }
+    dst[x] = static_cast<uint8_t>((sum + 8) >> 4);
+  }
+}
+
+void GatherChromaScalar(const ImagePlanes& src, int scale, int out_row,
+                        int begin, int n, uint8_t* u, uint8_t* v) {
+  const int step = src.chroma_step;
+  if (scale == 4) {
+    const size_t row0 = static_cast<size_t>(out_row * 2) * src.chroma_stride;
+    const size_t row1 = row0 + src.chroma_stride;
+    for (int x = begin; x < n; ++x) {
+      const size_t c0 = static_cast<size_t>(2 * x) * step;
+      const size_t c1 = c0 + step;
+      u[x] = static_cast<uint8_t>((src.u[row0 + c0] + src.u[row0 + c1] +
+                                   src.u[row1 + c0] + src.u[row1 + c1] + 2) >>
+                                  2);
+      v[x] = static_cast<uint8_t>((src.v[row0 + c0] + src.v[row0 + c1] +
+                                   src.v[row1 + c0] + src.v[row1 + c1] + 2) >>
+                                  2);
+    }
+    return;
+  }
+  // Scale 1 reads chroma at half resolution, scale 2 at full resolution.
+  const int shift = scale == 1 ? 1 : 0;
+  const size_t row =
+      static_cast<size_t>(out_row >> shift) * src.chroma_stride;
+  for (int x = begin; x < n; ++x) {
+    const size_t c = row + static_cast<size_t>(x >> shift) * step;
+    u[x] = src.u[c];
+    v[x] = src.v[c];
+  }
+}
+
+void ColorRowScalar(const uint8_t* y, const uint8_t* u, const uint8_t* v,
+                    int begin, int n, PixelLayout layout, uint8_t* dst) {
+  const int bpp = GetBytesPerPixel(layout);
+  for (int x = begin; x < n; ++x) {
+    const int yy = (y[x] - 16) * kLumaScale;
+    const int d = u[x] - 128;
+    const int e = v[x] - 128;
+    uint8_t* out = dst + x * bpp;
+    out[0] = Clamp255((yy + kVToR * e + 32) >> 6);
+    out[1] = Clamp255((yy - kUToG * d - kVToG * e + 32) >> 6);
+    out[2] = Clamp255((yy + kUToB * d + 32) >> 6);
+    if (bpp == 4) {
+      out[3] = 255;
+    }
+  }
+}
+
+// SIMD kernels. Each returns how many outputs it produced; the caller runs
+// the scalar kernel on the rest.
+
+#if defined(YUV_CONVERT_NEON)
+
+int Reduce2RowSimd(const uint8_t* r0, const uint8_t* r1, int n,
+                   uint8_t* dst) {
+  int x = 0;
+  for (; x + 16 <= n; x += 16) {
+    uint16x8_t s0 = vpaddlq_u8(vld1q_u8(r0 + 2 * x));
+    s0 = vpadalq_u8(s0, vld1q_u8(r1 + 2 * x));
+    uint16x8_t s1 = vpaddlq_u8(vld1q_u8(r0 + 2 * x + 16));
+    s1 = vpadalq_u8(s1, vld1q_u8(r1 + 2 * x + 16));
+    vst1q_u8(dst + x, vcombine_u8(vrshrn_n_u16(s0, 2), vrshrn_n_u16(s1, 2)));
+  }
+  return x;
+}
+
+int Reduce4RowSimd(const uint8_t* const rows[4], int n, uint8_t* dst) {
+  int x = 0;
+  for (; x + 16 <= n; x += 16) {
+    uint16x4_t sums[4];
+    for (int k = 0; k < 4; ++k) {
+      const int offset = 4 * x + 16 * k;
+      uint16x8_t acc = vpaddlq_u8(vld1q_u8(rows[0] + offset));
+      acc = vpadalq_u8(acc, vld1q_u8(rows[1] + offset));
+      acc = vpadalq_u8(acc, vld1q_u8(rows[2] + offset));
+      acc = vpadalq_u8(acc, vld1q_u8(rows[3] + offset));
+      sums[k] = vpadd_u16(vget_low_u16(acc), vget_high_u16(acc));
+    }
+    uint8x8_t lo = vrshrn_n_u16(vcombine_u16(sums[0], sums[1]), 4);
+    uint8x8_t hi = vrshrn_n_u16(vcombine_u16(sums[2], sums[3]), 4);
+    vst1q_u8(dst + x, vcombine_u8(lo, hi));
+  }
+  return x;
+}
+
+int GatherChromaSimd(const ImagePlanes& src, int scale, int out_row, int n,
+                     uint8_t* u, uint8_t* v) {
+  int x = 0;
+  if (scale == 1) {
+    const size_t row = static_cast<size_t>(out_row >> 1) * src.chroma_stride;
+    if (src.chroma_step == 2) {
+      const uint8_t* vu = src.v + row;
+      for (; x + 16 <= n; x += 16) {
+        uint8x8x2_t c = vld2_u8(vu + x);
+        uint8x8x2_t vv = vzip_u8(c.val[0], c.val[0]);
+        uint8x8x2_t uu = vzip_u8(c.val[1], c.val[1]);
+        vst1q_u8(v + x, vcombine_u8(vv.val[0], vv.val[1]));
+        vst1q_u8(u + x, vcombine_u8(uu.val[0], uu.val[1]));
+      }
+    } else {
+      for (; x + 16 <= n; x += 16) {
+        uint8x8_t cu = vld1_u8(src.u + row + x / 2);
+        uint8x8_t cv = vld1_u8(src.v + row + x / 2);
+        uint8x8x2_t uu = vzip_u8(cu, cu);
+        uint8x8x2_t vv = vzip_u8(cv, cv);
+        vst1q_u8(u + x, vcombine_u8(uu.val[0], uu.val[1]));
+        vst1q_u8(v + x, vcombine_u8(vv.val[0], vv.val[1]));
+      }
+    }
+  } else if (scale == 2 && src.chroma_step == 2) {
+    const uint8_t* vu = src.v + static_cast<size_t>(out_row) * src.chroma_stride;
+    for (; x + 16 <= n; x += 16) {
+      uint8x16x2_t c = vld2q_u8(vu + 2 * x);
+      vst1q_u8(v + x, c.val[0]);
+      vst1q_u8(u + x, c.val[1]);
+    }
+  }
+  return x;
+}
+
+inline uint8x8_t ToU8(int16x8_t value) { return vqmovun_s16(value); }
+
+inline void ColorNeon(uint8x8_t y8, uint8x8_t u8, uint8x8_t v8, uint8x8_t* r,
+                      uint8x8_t* g, uint8x8_t* b) {
+  const int16x8_t k16 = vdupq_n_s16(16);
+  const int16x8_t k128 = vdupq_n_s16(128);
+  const int16x8_t k32 = vdupq_n_s16(32);
+  int16x8_t yy = vmulq_n_s16(
+      vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(y8)), k16), kLumaScale);
+  int16x8_t d = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u8)), k128);
+  int16x8_t e = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v8)), k128);
+  *r = ToU8(vshrq_n_s16(
+      vqaddq_s16(vqaddq_s16(yy, vmulq_n_s16(e, kVToR)), k32), 6));
+  *g = ToU8(vshrq_n_s16(
+      vqaddq_s16(vqsubq_s16(vqsubq_s16(yy, vmulq_n_s16(d, kUToG)),
+                            vmulq_n_s16(e, kVToG)),
+                 k32),
+      6));
+  *b = ToU8(vshrq_n_s16(
+      vqaddq_s16(vqaddq_s16(yy, vmulq_n_s16(d, kUToB)), k32), 6));
+}
+
+int ColorRowSimd(const uint8_t* y, const uint8_t* u, const uint8_t* v, int n,
+                 PixelLayout layout, uint8_t* dst) {
+  int x = 0;
+  for (; x + 16 <= n; x += 16) {
+    uint8x16_t y8 = vld1q_u8(y + x);
+    uint8x16_t u8 = vld1q_u8(u + x);
+    uint8x16_t v8 = vld1q_u8(v + x);
+    uint8x8_t r_lo, g_lo, b_lo, r_hi, g_hi, b_hi;
+    ColorNeon(vget_low_u8(y8), vget_low_u8(u8), vget_low_u8(v8), &r_lo, &g_lo,
+              &b_lo);
+    ColorNeon(vget_high_u8(y8), vget_high_u8(u8), vget_high_u8(v8), &r_hi,
+              &g_hi, &b_hi);
+    if (layout == kPixelLayoutRgba) {
+      uint8x16x4_t px;
+      px.val[0] = vcombine_u8(r_lo, r_hi);
+      px.val[1] = vcombine_u8(g_lo, g_hi);
+      px.val[2] = vcombine_u8(b_lo, b_hi);
+      px.val[3] = vdupq_n_u8(255);
+      vst4q_u8(dst + 4 * x, px);
+    } else {
+      uint8x16x3_t px;
+      px.val[0] = vcombine_u8(r_lo, r_hi);
+      px.val[1] = vcombine_u8(g_lo, g_hi);
+      px.val[2] = vcombine_u8(b_lo, b_hi);
+      vst3q_u8(dst + 3 * x, px);
+    }
+  }
+  return x;
+}
+
+#elif defined(YUV_CONVERT_SSE2)
+
+// Sums adjacent byte pairs into 16-bit lanes.
+inline __m128i PairSums(__m128i bytes) {
+  const __m128i mask = _mm_set1_epi16(0x00ff);
+  return _mm_add_epi16(_mm_and_si128(bytes, mask), _mm_srli_epi16(bytes, 8));
+}
+
+inline __m128i Load(const uint8_t* p) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+inline void Store(uint8_t* p, __m128i value) {
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(p), value);
+}
+
+int Reduce2RowSimd(const uint8_t* r0, const uint8_t* r1, int n,
+                   uint8_t* dst) {
+  const __m128i two = _mm_set1_epi16(2);
+  int x = 0;
+  for (; x + 16 <= n; x += 16) {
+    __m128i s0 = _mm_add_epi16(PairSums(Load(r0 + 2 * x)),
+                               PairSums(Load(r1 + 2 * x)));
+    __m128i s1 = _mm_add_epi16(PairSums(Load(r0 + 2 * x + 16)),
+                               PairSums(Load(r1 + 2 * x + 16)));
+    s0 = _mm_srli_epi16(_mm_add_epi16(s0, two), 2);
+    s1 = _mm_srli_epi16(_mm_add_epi16(s1, two), 2);
+    Store(dst + x, _mm_packus_epi16(s0, s1));
+  }
+  return x;
+}
+
+int Reduce4RowSimd(const uint8_t* const rows[4], int n, uint8_t* dst) {
+  const __m128i ones = _mm_set1_epi16(1);
+  const __m128i eight = _mm_set1_epi16(8);
+  int x = 0;
+  for (; x + 16 <= n; x += 16) {
+    __m128i sums[4];
+    for (int k = 0; k < 4; ++k) {
+      const int offset = 4 * x + 16 * k;
+      __m128i acc = PairSums(Load(rows[0] + offset));
+      acc = _mm_add_epi16(acc, PairSums(Load(rows[1] + offset)));
+      acc = _mm_add_epi16(acc, PairSums(Load(rows[2] + offset)));
+      acc = _mm_add_epi16(acc, PairSums(Load(rows[3] + offset)));
+      sums[k] = _mm_madd_epi16(acc, ones);
+    }
+    __m128i lo = _mm_packs_epi32(sums[0], sums[1]);
+    __m128i hi = _mm_packs_epi32(sums[2], sums[3]);
+    lo = _mm_srli_epi16(_mm_add_epi16(lo, eight), 4);
+    hi = _mm_srli_epi16(_mm_add_epi16(hi, eight), 4);
+    Store(dst + x, _mm_packus_epi16(lo, hi));
+  }
+  return x;
+}
+
+int GatherChromaSimd(const ImagePlanes& src, int scale, int out_row, int n,
+                     uint8_t* u, uint8_t* v) {
+  const __m128i mask = _mm_set1_epi16(0x00ff);
+  int x = 0;
+  if (scale == 1) {
+    const size_t row = static_cast<size_t>(out_row >> 1) * src.chroma_stride;
+    if (src.chroma_step == 2) {
+      const uint8_t* vu = src.v + row;
+      for (; x + 16 <= n; x += 16) {
+        __m128i c = Load(vu + x);
+        __m128i cv = _mm_and_si128(c, mask);
+        __m128i cu = _mm_srli_epi16(c, 8);
+        Store(v + x, _mm_or_si128(cv, _mm_slli_epi16(cv, 8)));
+        Store(u + x, _mm_or_si128(cu, _mm_slli_epi16(cu, 8)));
+      }
+    } else {
+      for (; x + 16 <= n; x += 16) {
+        __m128i cu = _mm_loadl_epi64(
+            reinterpret_cast<const __m128i*>(src.u + row + x / 2));
+        __m128i cv = _mm_loadl_epi64(
+            reinterpret_cast<const __m128i*>(src.v + row + x / 2));
+        Store(u + x, _mm_unpacklo_epi8(cu, cu));
+        Store(v + x, _mm_unpacklo_epi8(cv, cv));
+      }
+    }
+  } else if (scale == 2 && src.chroma_step == 2) {
+    const uint8_t* vu = src.v + static_cast<size_t>(out_row) * src.chroma_stride;
+    for (; x + 16 <= n; x += 16) {
+      __m128i a = Load(vu + 2 * x);
+      __m128i b = Load(vu + 2 * x + 16);
+      Store(v + x, _mm_packus_epi16(_mm_and_si128(a, mask),
+                                    _mm_and_si128(b, mask)));
+      Store(u + x, _mm_packus_epi16(_mm_srli_epi16(a, 8),
+                                    _mm_srli_epi16(b, 8)));
+    }
+  }
+  return x;
+}
+
+inline void ColorSse2(__m128i y, __m128i u, __m128i v, __m128i* r, __m128i* g,
+                      __m128i* b) {
+  const __m128i k16 = _mm_set1_epi16(16);
+  const __m128i k128 = _mm_set1_epi16(128);
+  const __m128i k32 = _mm_set1_epi16(32);
+  __m128i yy = _mm_mullo_epi16(_mm_sub_epi16(y, k16),
+                               _mm_set1_epi16(kLumaScale));
+  __m128i d = _mm_sub_epi16(u, k128);
+  __m128i e = _mm_sub_epi16(v, k128);
+  *r = _mm_srai_epi16(
+      _mm_adds_epi16(
+          _mm_adds_epi16(yy, _mm_mullo_epi16(e, _mm_set1_epi16(kVToR))), k32),
+      6);
+  *g = _mm_srai_epi16(
+      _mm_adds_epi16(
+          _mm_subs_epi16(
+              _mm_subs_epi16(yy, _mm_mullo_epi16(d, _mm_set1_epi16(kUToG))),
+              _mm_mullo_epi16(e, _mm_set1_epi16(kVToG))),
+          k32),
+      6);
+  *b = _mm_srai_epi16(
+      _mm_adds_epi16(
+          _mm_adds_epi16(yy, _mm_mullo_epi16(d, _mm_set1_epi16(kUToB))), k32),
+      6);
+}
+
+int ColorRowSimd(const uint8_t* y, const uint8_t* u, const uint8_t* v, int n,
+                 PixelLayout layout, uint8_t* dst) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alpha = _mm_set1_epi8(static_cast<char>(0xff));
+  int x = 0;
+  for (; x + 16 <= n; x += 16) {
+    __m128i y8 = Load(y + x);
+    __m128i u8 = Load(u + x);
+    __m128i v8 = Load(v + x);
+    __m128i r_lo, g_lo, b_lo, r_hi, g_hi, b_hi;
+    ColorSse2(_mm_unpacklo_epi8(y8, zero), _mm_unpacklo_epi8(u8, zero),
+              _mm_unpacklo_epi8(v8, zero), &r_lo, &g_lo, &b_lo);
+    ColorSse2(_mm_unpackhi_epi8(y8, zero), _mm_unpackhi_epi8(u8, zero),
+              _mm_unpackhi_epi8(v8, zero), &r_hi, &g_hi, &b_hi);
+    __m128i r8 = _mm_packus_epi16(r_lo, r_hi);
+    __m128i g8 = _mm_packus_epi16(g_lo, g_hi);
+    __m128i b8 = _mm_packus_epi16(b_lo, b_hi);
+
+    __m128i rg_lo = _mm_unpacklo_epi8(r8, g8);
+    __m128i rg_hi = _mm_unpackhi_epi8(r8, g8);
+    __m128i ba_lo = _mm_unpacklo_epi8(b8, alpha);
+    __m128i ba_hi = _mm_unpackhi_epi8(b8, alpha);
+    __m128i px[4] = {_mm_unpacklo_epi16(rg_lo, ba_lo),
+                     _mm_unpackhi_epi16(rg_lo, ba_lo),
+                     _mm_unpacklo_epi16(rg_hi, ba_hi),
+                     _mm_unpackhi_epi16(rg_hi, ba_hi)};
+    if (layout == kPixelLayoutRgba) {
+      for (int k = 0; k < 4; ++k) {
+        Store(dst + 4 * x + 16 * k, px[k]);
+      }
+      continue;
+    }
+    uint8_t* out = dst + 3 * x;
+#if defined(YUV_CONVERT_SSSE3)
+    // Drop alpha from each block of four pixels. The overlapping 16-byte
+    // stores are overwritten by the next block; the last one is trimmed.
+    const __m128i pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14,
+                                       -1, -1, -1, -1);
+    for (int k = 0; k < 3; ++k) {
+      Store(out + 12 * k, _mm_shuffle_epi8(px[k], pack));
+    }
+    uint8_t last[16];
+    Store(last, _mm_shuffle_epi8(px[3], pack));
+    memcpy(out + 36, last, 12);
+#else
+    uint8_t rgba[64];
+    for (int k = 0; k < 4; ++k) {
+      Store(rgba + 16 * k, px[k]);
+    }
+    for (int i = 0; i < 16; ++i) {
+      out[3 * i] = rgba[4 * i];
+      out[3 * i + 1] = rgba[4 * i + 1];
+      out[3 * i + 2] = rgba[4 * i + 2];
+    }
+#endif
+  }
+  return x;
+}
+
+#else
+
+int Reduce2RowSimd(const uint8_t*, const uint8_t*, int, uint8_t*) {
+  return 0;
+}
+int Reduce4RowSimd(const uint8_t* const[4], int, uint8_t*) { return 0; }
+int GatherChromaSimd(const ImagePlanes&, int, int, int, uint8_t*, uint8_t*) {
+  return 0;
+}
+int ColorRowSimd(const uint8_t*, const uint8_t*, const uint8_t*, int,
+                 PixelLayout, uint8_t*) {
+  return 0;
+}
+
+#endif
+
+void ReduceRow(const uint8_t* plane, int stride, int scale, int out_row,
+               int n, uint8_t* dst, bool use_simd) {
+  const uint8_t* top = plane + static_cast<size_t>(out_row * scale) * stride;
+  int x = 0;
+  if (scale == 2) {
+    const uint8_t* bottom = top + stride;
+    if (use_simd) {
+      x = Reduce2RowSimd(top, bottom, n, dst);
+    }
+    Reduce2RowScalar(top, bottom, x, n, dst);
+  } else {
+    const uint8_t* rows[4] = {top, top + stride, top + 2 * stride,
+                              top + 3 * stride};
+    if (use_simd) {
+      x = Reduce4RowSimd(rows, n, dst);
+    }
+    Reduce4RowScalar(rows, x, n, dst);
+  }
+}
+
+}  // namespace
+
+int GetBytesPerPixel(PixelLayout layout) {
+  switch (layout) {
+    case kPixelLayoutRgb:
+      return 3;
+    case kPixelLayoutRgba:
+      return 4;
+    default:
+      return 1;
+  }
+}
+
+bool DownscalePlane(const uint8_t* src, int width, int height, int src_stride,
+                    int scale, uint8_t* dst, int dst_stride, bool use_simd) {
+  if (scale != 1 && scale != 2 && scale != 4) {
+    return false;
+  }
+  const int out_width = width / scale;
+  const int out_height = height / scale;
+  if (out_width <= 0 || out_height <= 0) {
+    return false;
+  }
+  for (int y = 0; y < out_height; ++y) {
+    uint8_t* out = dst + static_cast<size_t>(y) * dst_stride;
+    if (scale == 1) {
+      memcpy(out, src + static_cast<size_t>(y) * src_stride, out_width);
+    } else {
+      ReduceRow(src, src_stride, scale, y, out_width, out, use_simd);
+    }
+  }
+  return true;
+}
+
+bool ConvertImage(const ImagePlanes& src, int scale, PixelLayout layout,
+                  uint8_t* dst, int dst_stride, bool use_simd) {
+  if (layout == kPixelLayoutGray) {
+    return DownscalePlane(src.y, src.width, src.height, src.y_stride, scale,
+                          dst, dst_stride, use_simd);
+  }
+  if (scale != 1 && scale != 2 && scale != 4) {
+    return false;
+  }
+  const int out_width = src.width / scale;
+  const int out_height = src.height / scale;
+  if (out_width <= 0 || out_height <= 0) {
+    return false;
+  }
+
+  // One row of luma and expanded chroma stays in L1 between the gather and
+  // color passes.
+  std::vector<uint8_t> scratch(static_cast<size_t>(out_width) * 3);
+  uint8_t* y_row = &scratch[0];
+  uint8_t* u_row = y_row + out_width;
+  uint8_t* v_row = u_row + out_width;
+
+  for (int y = 0; y < out_height; ++y) {
+    const uint8_t* luma = y_row;
+    if (scale == 1) {
+      luma = src.y + static_cast<size_t>(y) * src.y_stride;
+    } else {
+      ReduceRow(src.y, src.y_stride, scale, y, out_width, y_row, use_simd);
+    }
+
+    int x = 0;
+    if (use_simd) {
+      x = GatherChromaSimd(src, scale, y, out_width, u_row, v_row);
+    }
+    GatherChromaScalar(src, scale, y, x, out_width, u_row, v_row);
+
+    uint8_t* out = dst + static_cast<size_t>(y) * dst_stride;
+    x = 0;
+    if (use_simd) {
+      x = ColorRowSimd(luma, u_row, v_row, out_width, layout, out);
+    }
+    ColorRowScalar(luma, u_row, v_row, x, out_width, layout, out);
+  }
+  return true;
+}
+
+const char* GetSimdName() {
+#if defined(YUV_CONVERT_NEON)
+  return "NEON";
+#elif defined(YUV_CONVERT_SSSE3)
+  return "SSSE3";
+#elif defined(YUV_CONVERT_SSE2)
+  return "SSE2";
+#else
+  return "none";
+#endif
+}
+
+}  // namespace yuv_convert
@@ -0,0 +1,50 @@
+#ifndef CINDER_TANGO_YUV_CONVERT_H_
+#define CINDER_TANGO_YUV_CONVERT_H_
+
+#include <stdint.h>
+
+#include "camera_frame.h"
+
+// Conversion of YUV 4:2:0 camera images (NV21 and YV12) to RGB, RGBA or
+// gray, optionally fused with a 2x or 4x box downscale.
+//
+// Each kernel has a scalar reference and a SIMD version (NEON on ARM, SSE2
+// with an SSSE3 RGB store on x86). Both use the same BT.601 arithmetic with
+// 6-bit fixed point coefficients and intermediates that fit 16-bit lanes,
+// so their output is bit-identical; use_simd = false selects the reference.
+//
+// Color math, with c = Y - 16, d = U - 128, e = V - 128:
+//   R = (74 c + 102 e + 32) >> 6
+//   G = (74 c - 25 d - 52 e + 32) >> 6
+//   B = (74 c + 129 d + 32) >> 6
+// clamped to [0, 255]. Gray is the luma value as stored. Downscaling averages
+// luma over scale x scale blocks and chroma over the matching chroma block,
+// rounding to nearest.
+namespace yuv_convert {
+
+enum PixelLayout {
+  kPixelLayoutGray,  // 1 byte per pixel.
+  kPixelLayoutRgb,   // 3 bytes per pixel.
+  kPixelLayoutRgba   // 4 bytes per pixel, alpha 255.
+};
+
+int GetBytesPerPixel(PixelLayout layout);
+
+// Converts src into dst, which must hold (src.height / scale) rows of
+// (src.width / scale) pixels, dst_stride bytes apart. scale is 1, 2 or 4.
+// Returns false for unsupported arguments.
+bool ConvertImage(const ImagePlanes& src, int scale, PixelLayout layout,
+                  uint8_t* dst, int dst_stride, bool use_simd = true);
+
+// Box-downscales a single 8-bit plane by 2 or 4, or copies it for scale 1.
+// Used for gray output and for building image pyramids.
+bool DownscalePlane(const uint8_t* src, int width, int height, int src_stride,
+                    int scale, uint8_t* dst, int dst_stride,
+                    bool use_simd = true);
+
+// Name of the instruction set behind use_simd = true, e.g. "NEON".
+const char* GetSimdName();
+
+}  // namespace yuv_convert
+
+#endif  // CINDER_TANGO_YUV_CONVERT_H_
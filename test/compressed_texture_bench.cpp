@@ -0,0 +1,90 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+
+#include "etc2_decoder.h"
+#include "test_util.h"
+
+// ETC2 against uncompressed RGBA8 textures with full mip chains: GPU
+// memory, encode time (the one-off transcode), load time from disk, and
+// quality by the software decoder. Loading the uncompressed form is timed
+// as reading raw RGBA8 levels, a lower bound for decoding a PNG.
+
+using tango_gl::Texture;
+namespace compressed_texture = tango_gl::compressed_texture;
+
+namespace {
+size_t Rgba8ChainBytes(uint32_t width, uint32_t height) {
+  size_t bytes = 0;
+  while (true) {
+    bytes += static_cast<size_t>(width) * height * 4;
+    if (width == 1 && height == 1) {
+      return bytes;
+    }
+    width = width > 1 ? width / 2 : 1;
+    height = height > 1 ? height / 2 : 1;
+  }
+}
+
+double ReadRawMs(const char* path, size_t bytes) {
+  FILE* file = fopen(path, "wb");
+  std::vector<uint8_t> data(bytes, 7);
+  fwrite(data.data(), 1, bytes, file);
+  fclose(file);
+  const double start = test_util::NowMs();
+  file = fopen(path, "rb");
+  std::vector<uint8_t> read(bytes);
+  const size_t got = fread(read.data(), 1, bytes, file);
+  fclose(file);
+  const double ms = test_util::NowMs() - start;
+  unlink(path);
+  return got == bytes ? ms : -1.0;
+}
+}  // namespace
+
+int main() {
+  srand(11);
+  const struct {
+    uint32_t width;
+    uint32_t height;
+    GLenum format;
+  } cases[] = {{1024, 1024, GL_RGB},
+               {1024, 1024, GL_RGBA},
+               {2048, 2048, GL_RGB}};
+  char path[64];
+  snprintf(path, sizeof(path), "/tmp/compressed_texture_bench_%d",
+           static_cast<int>(getpid()));
+  printf("%-14s %-9s %8s %8s %6s %9s %9s %9s %7s\n", "size", "format",
+         "RGBA8 KB", "ETC2 KB", "ratio", "encode ms", "KTX load", "raw load",
+         "PSNR");
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+    Texture::Image source, compressed, loaded;
+    etc2_decoder::MakeImage(cases[i].width, cases[i].height, cases[i].format,
+                            &source);
+    double start = test_util::NowMs();
+    compressed_texture::EncodeETC2(source, &compressed);
+    const double encode_ms = test_util::NowMs() - start;
+
+    compressed_texture::WriteKTX(path, compressed);
+    start = test_util::NowMs();
+    compressed_texture::ReadKTX(path, &loaded);
+    const double ktx_ms = test_util::NowMs() - start;
+    unlink(path);
+    const size_t raw_bytes = Rgba8ChainBytes(source.width, source.height);
+    const double raw_ms = ReadRawMs(path, raw_bytes);
+
+    const bool alpha =
+        compressed.compressed_format == GL_COMPRESSED_RGBA8_ETC2_EAC;
+    std::vector<uint8_t> rgba;
+    etc2_decoder::DecodeLevel(compressed.pixels.data(), source.width,
+                              source.height, alpha, &rgba);
+    char size[32];
+    snprintf(size, sizeof(size), "%ux%u", source.width, source.height);
+    printf("%-14s %-9s %8zu %8zu %5.1fx %9.1f %9.2f %9.2f %6.1fdB\n", size,
+           alpha ? "RGBA8 EAC" : "RGB8", raw_bytes / 1024,
+           compressed.pixels.size() / 1024,
+           static_cast<double>(raw_bytes) / compressed.pixels.size(),
+           encode_ms, ktx_ms, raw_ms, etc2_decoder::Psnr(source, rgba));
+  }
+  return 0;
+}
@@ -0,0 +1,86 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+
+#include "etc2_decoder.h"
+#include "test_util.h"
+
+// EncodeETC2 validated with the independent software decoder, and KTX
+// round trips.
+
+using tango_gl::Texture;
+namespace compressed_texture = tango_gl::compressed_texture;
+
+namespace {
+// Encodes source and checks the format, the mip chain and the quality of
+// every level against a downsampled source.
+void CheckEncode(uint32_t width, uint32_t height, GLenum format,
+                 GLenum expected_format, double min_psnr) {
+  Texture::Image source, compressed;
+  etc2_decoder::MakeImage(width, height, format, &source);
+  EXPECT(compressed_texture::EncodeETC2(source, &compressed));
+  EXPECT(compressed.compressed_format == expected_format);
+  EXPECT(compressed.width == width && compressed.height == height);
+  const bool alpha = expected_format == GL_COMPRESSED_RGBA8_ETC2_EAC;
+
+  size_t offset = 0;
+  uint32_t level_width = width, level_height = height;
+  for (size_t level = 0; level < compressed.level_sizes.size(); ++level) {
+    const size_t blocks = static_cast<size_t>((level_width + 3) / 4) *
+                          ((level_height + 3) / 4);
+    EXPECT(compressed.level_sizes[level] == blocks * (alpha ? 16 : 8));
+    std::vector<uint8_t> rgba;
+    EXPECT(etc2_decoder::DecodeLevel(compressed.pixels.data() + offset,
+                                     level_width, level_height, alpha,
+                                     &rgba) == 0);
+    if (level == 0) {
+      const double psnr = etc2_decoder::Psnr(source, rgba);
+      if (psnr < min_psnr) {
+        fprintf(stderr, "%ux%u: %.1f dB\n", width, height, psnr);
+      }
+      EXPECT(psnr >= min_psnr);
+    }
+    offset += compressed.level_sizes[level];
+    if (level + 1 == compressed.level_sizes.size()) {
+      EXPECT(level_width == 1 && level_height == 1);
+    }
+    level_width = level_width > 1 ? level_width / 2 : 1;
+    level_height = level_height > 1 ? level_height / 2 : 1;
+  }
+  EXPECT(offset == compressed.pixels.size());
+}
+}  // namespace
+
+int main() {
+  srand(11);
+  CheckEncode(256, 256, GL_RGB, GL_COMPRESSED_RGB8_ETC2, 32.0);
+  CheckEncode(128, 64, GL_RGBA, GL_COMPRESSED_RGBA8_ETC2_EAC, 32.0);
+  CheckEncode(37, 21, GL_RGBA, GL_COMPRESSED_RGBA8_ETC2_EAC, 30.0);
+  CheckEncode(1, 1, GL_RGB, GL_COMPRESSED_RGB8_ETC2, 30.0);
+
+  // Opaque RGBA drops the alpha blocks.
+  Texture::Image opaque, compressed;
+  etc2_decoder::MakeImage(16, 16, GL_RGBA, &opaque);
+  for (size_t i = 3; i < opaque.pixels.size(); i += 4) {
+    opaque.pixels[i] = 255;
+  }
+  EXPECT(compressed_texture::EncodeETC2(opaque, &compressed));
+  EXPECT(compressed.compressed_format == GL_COMPRESSED_RGB8_ETC2);
+  EXPECT(!compressed_texture::EncodeETC2(compressed, &opaque));
+
+  // KTX round trip, and a truncated file is refused.
+  char path[64];
+  snprintf(path, sizeof(path), "/tmp/compressed_texture_test_%d.ktx",
+           static_cast<int>(getpid()));
+  Texture::Image read;
+  EXPECT(compressed_texture::WriteKTX(path, compressed));
+  EXPECT(compressed_texture::ReadKTX(path, &read));
+  EXPECT(read.compressed_format == compressed.compressed_format);
+  EXPECT(read.width == compressed.width && read.height == compressed.height);
+  EXPECT(read.level_sizes == compressed.level_sizes);
+  EXPECT(read.pixels == compressed.pixels);
+  EXPECT(truncate(path, 80) == 0);
+  EXPECT(!compressed_texture::ReadKTX(path, &read));
+  unlink(path);
+  return test_util::Finish();
+}
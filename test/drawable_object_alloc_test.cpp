@@ -0,0 +1,127 @@
+#include <stdlib.h>
+#include <new>
+#include <utility>
+
+#include "fake_gl.h"
+#include "tango-gl/line.h"
+#include "test_util.h"
+
+// Per-frame geometry updates through Line and DrawableObject must not
+// allocate once the buffers have grown to size, and must upload each
+// update once. Mapping released geometry starts from what is on the GPU.
+
+namespace {
+long allocations = 0;
+}  // namespace
+
+void* operator new(size_t size) {
+  ++allocations;
+  void* memory = malloc(size == 0 ? 1 : size);
+  if (memory == NULL) {
+    throw std::bad_alloc();
+  }
+  return memory;
+}
+
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+
+using tango_gl::Line;
+
+int main() {
+  const int kFrames = 100;
+  const size_t kPoints = 1000;
+  const size_t kBytes = kPoints * 3 * sizeof(GLfloat);
+  const glm::mat4 identity(1.0f);
+  const fake_gl::Counters& counters = fake_gl::GetState().counters;
+
+  Line line(2.0f, GL_LINE_STRIP);
+  line.SetShader();
+  line.SetBufferUsage(tango_gl::DrawableObject::kStreamDraw);
+  std::vector<glm::vec3> points(kPoints);
+  line.UpdateLineVertices(points);
+  line.Render(identity, identity);
+  // The first update grows the buffers, and proves the counter works.
+  EXPECT(allocations > 0);
+
+  // Copy from a vector the caller keeps.
+  long start = allocations;
+  size_t uploaded = counters.buffer_bytes;
+  for (int frame = 0; frame < kFrames; ++frame) {
+    points[frame].x += 1.0f;
+    line.UpdateLineVertices(points);
+    line.Render(identity, identity);
+  }
+  EXPECT(allocations == start);
+  EXPECT(counters.buffer_bytes - uploaded == kFrames * kBytes);
+
+  // Copy from caller-owned memory, shrinking.
+  start = allocations;
+  for (int frame = 0; frame < kFrames; ++frame) {
+    line.UpdateLineVertices(points.data(), kPoints - frame);
+    line.Render(identity, identity);
+  }
+  EXPECT(allocations == start);
+
+  // Write in place.
+  start = allocations;
+  uploaded = counters.buffer_bytes;
+  for (int frame = 0; frame < kFrames; ++frame) {
+    glm::vec3* mapped = line.MapLineVertices(kPoints);
+    for (size_t i = 0; i < kPoints; ++i) {
+      mapped[i] = glm::vec3(frame, i, 0.0f);
+    }
+    line.UnmapVertices();
+    line.Render(identity, identity);
+  }
+  EXPECT(allocations == start);
+  EXPECT(counters.buffer_bytes - uploaded == kFrames * kBytes);
+
+  // Raw float arrays and partial updates.
+  std::vector<GLfloat> floats(kPoints * 3, 1.0f);
+  start = allocations;
+  for (int frame = 0; frame < kFrames; ++frame) {
+    line.SetVertices(floats.data(), floats.size());
+    line.UpdateVertices(frame * 3, floats.data(), 3);
+    line.Render(identity, identity);
+  }
+  EXPECT(allocations == start);
+
+  // Moving a vector in takes its storage: no allocation besides the
+  // caller's own.
+  std::vector<GLfloat> moved(kPoints * 3, 2.0f);
+  start = allocations;
+  line.SetVertices(std::move(moved));
+  line.Render(identity, identity);
+  EXPECT(allocations == start);
+  EXPECT(moved.empty());
+
+  // Once the CPU copy is released, a partial rewrite of the mapped vertices
+  // keeps the rest of the geometry instead of uploading zeros over it.
+  for (size_t i = 0; i < kPoints; ++i) {
+    points[i] = glm::vec3(i, 2.0f * i, 3.0f);
+  }
+  line.UpdateLineVertices(points);
+  line.Render(identity, identity);
+  line.ReleaseCpuData();
+  EXPECT(!line.HasCpuData());
+  glm::vec3* mapped = line.MapLineVertices(kPoints + 1);
+  bool kept = true;
+  for (size_t i = 0; i < kPoints; ++i) {
+    kept = kept && mapped[i] == points[i];
+  }
+  EXPECT(kept);
+  EXPECT(mapped[kPoints] == glm::vec3(0.0f));
+  mapped[0] = glm::vec3(-1.0f);
+  mapped[kPoints] = glm::vec3(-2.0f);
+  line.UnmapVertices();
+  line.Render(identity, identity);
+  line.ReleaseCpuData();
+  mapped = line.MapLineVertices(kPoints + 1);
+  EXPECT(mapped[0] == glm::vec3(-1.0f));
+  EXPECT(mapped[1] == points[1]);
+  EXPECT(mapped[kPoints] == glm::vec3(-2.0f));
+  line.UnmapVertices();
+  EXPECT(fake_gl::GetState().error == GL_NO_ERROR);
+  return test_util::Finish();
+}
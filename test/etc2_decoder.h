@@ -0,0 +1,177 @@
+#ifndef CINDER_TANGO_TEST_ETC2_DECODER_H_
+#define CINDER_TANGO_TEST_ETC2_DECODER_H_
+
+#include <math.h>
+#include <stdint.h>
+#include <vector>
+
+#include "tango-gl/compressed_texture.h"
+
+// A software ETC2 decoder written from the format specification rather
+// than from the encoder, to validate EncodeETC2 on the desktop. It handles
+// the individual and differential color modes and EAC alpha, which is all
+// the encoder emits; T, H and planar blocks are reported as unsupported.
+namespace etc2_decoder {
+
+inline int Clamp255(int value) {
+  return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+inline uint64_t ReadBigEndian(const uint8_t* block) {
+  uint64_t value = 0;
+  for (int i = 0; i < 8; ++i) {
+    value = value << 8 | block[i];
+  }
+  return value;
+}
+
+// Decodes the RGB of a 4x4 block into out, row-major RGBA. Returns false
+// for block modes this decoder does not know.
+inline bool DecodeColorBlock(const uint8_t* block, uint8_t out[16][4]) {
+  static const int kModifiers[8][2] = {{2, 8},   {5, 17},  {9, 29},
+                                       {13, 42}, {18, 60}, {24, 80},
+                                       {33, 106}, {47, 183}};
+  const uint64_t bits = ReadBigEndian(block);
+  const bool differential = (bits >> 33) & 1;
+  const bool flip = (bits >> 32) & 1;
+  int base[2][3];
+  for (int c = 0; c < 3; ++c) {
+    const int shift = 59 - 8 * c;
+    if (differential) {
+      const int first = (bits >> shift) & 31;
+      int delta = (bits >> (shift - 3)) & 7;
+      delta = delta >= 4 ? delta - 8 : delta;
+      const int second = first + delta;
+      if (second < 0 || second > 31) {
+        return false;
+      }
+      base[0][c] = first << 3 | first >> 2;
+      base[1][c] = second << 3 | second >> 2;
+    } else {
+      base[0][c] = ((bits >> (shift + 1)) & 15) * 17;
+      base[1][c] = ((bits >> (shift - 3)) & 15) * 17;
+    }
+  }
+  const int tables[2] = {static_cast<int>((bits >> 37) & 7),
+                         static_cast<int>((bits >> 34) & 7)};
+  // Pixel indices run down the columns.
+  for (int x = 0; x < 4; ++x) {
+    for (int y = 0; y < 4; ++y) {
+      const int i = x * 4 + y;
+      const int subblock = flip ? y >= 2 : x >= 2;
+      const int index =
+          static_cast<int>(((bits >> (16 + i)) & 1) << 1 | ((bits >> i) & 1));
+      const int* modifier = kModifiers[tables[subblock]];
+      const int offset = index < 2 ? modifier[index] : -modifier[index - 2];
+      for (int c = 0; c < 3; ++c) {
+        out[y * 4 + x][c] =
+            static_cast<uint8_t>(Clamp255(base[subblock][c] + offset));
+      }
+      out[y * 4 + x][3] = 255;
+    }
+  }
+  return true;
+}
+
+// Decodes an EAC alpha block into the alpha of out.
+inline void DecodeAlphaBlock(const uint8_t* block, uint8_t out[16][4]) {
+  static const int kTables[16][8] = {
+      {-3, -6, -9, -15, 2, 5, 8, 14}, {-3, -7, -10, -13, 2, 6, 9, 12},
+      {-2, -5, -8, -13, 1, 4, 7, 12}, {-2, -4, -6, -13, 1, 3, 5, 12},
+      {-3, -6, -8, -12, 2, 5, 7, 11}, {-3, -7, -9, -11, 2, 6, 8, 10},
+      {-4, -7, -8, -11, 3, 6, 7, 10}, {-3, -5, -8, -11, 2, 4, 7, 10},
+      {-2, -6, -8, -10, 1, 5, 7, 9},  {-2, -5, -8, -10, 1, 4, 7, 9},
+      {-2, -4, -8, -10, 1, 3, 7, 9},  {-2, -5, -7, -10, 1, 4, 6, 9},
+      {-3, -4, -7, -10, 2, 3, 6, 9},  {-1, -2, -3, -10, 0, 1, 2, 9},
+      {-4, -6, -8, -9, 3, 5, 7, 8},   {-3, -5, -7, -9, 2, 4, 6, 8}};
+  const uint64_t bits = ReadBigEndian(block);
+  const int base = static_cast<int>(bits >> 56);
+  const int multiplier = static_cast<int>((bits >> 52) & 15);
+  const int* table = kTables[(bits >> 48) & 15];
+  for (int x = 0; x < 4; ++x) {
+    for (int y = 0; y < 4; ++y) {
+      const int index = static_cast<int>((bits >> (45 - 3 * (x * 4 + y))) & 7);
+      out[y * 4 + x][3] =
+          static_cast<uint8_t>(Clamp255(base + table[index] * multiplier));
+    }
+  }
+}
+
+// Decodes one level of an RGB8_ETC2 or RGBA8_ETC2_EAC image to tight RGBA
+// rows. Returns the number of blocks in modes the decoder does not know.
+inline int DecodeLevel(const uint8_t* data, uint32_t width, uint32_t height,
+                       bool alpha, std::vector<uint8_t>* rgba) {
+  const uint32_t blocks_wide = (width + 3) / 4;
+  const uint32_t blocks_high = (height + 3) / 4;
+  const int block_size = alpha ? 16 : 8;
+  rgba->assign(static_cast<size_t>(width) * height * 4, 0);
+  int unsupported = 0;
+  for (uint32_t by = 0; by < blocks_high; ++by) {
+    for (uint32_t bx = 0; bx < blocks_wide; ++bx) {
+      const uint8_t* block = data + (by * blocks_wide + bx) * block_size;
+      uint8_t pixels[16][4];
+      unsupported += !DecodeColorBlock(alpha ? block + 8 : block, pixels);
+      if (alpha) {
+        DecodeAlphaBlock(block, pixels);
+      }
+      for (uint32_t y = 0; y < 4 && by * 4 + y < height; ++y) {
+        for (uint32_t x = 0; x < 4 && bx * 4 + x < width; ++x) {
+          uint8_t* out = &(*rgba)[((by * 4 + y) * width + bx * 4 + x) * 4];
+          for (int c = 0; c < 4; ++c) {
+            out[c] = pixels[y * 4 + x][c];
+          }
+        }
+      }
+    }
+  }
+  return unsupported;
+}
+
+// PSNR in dB of decoded RGBA against the source pixels, over the source's
+// channels.
+inline double Psnr(const tango_gl::Texture::Image& source,
+                   const std::vector<uint8_t>& rgba) {
+  const int channels = source.format == GL_RGBA ? 4 : 3;
+  const size_t pixels = static_cast<size_t>(source.width) * source.height;
+  double squared_error = 0.0;
+  for (size_t i = 0; i < pixels; ++i) {
+    for (int c = 0; c < channels; ++c) {
+      const double difference =
+          source.pixels[i * channels + c] - rgba[i * 4 + c];
+      squared_error += difference * difference;
+    }
+  }
+  const double mean = squared_error / (pixels * channels);
+  return mean == 0.0 ? 99.0 : 10.0 * log10(255.0 * 255.0 / mean);
+}
+
+// A smooth, photo-like test image with a little noise; alpha varies when
+// the format is GL_RGBA.
+inline void MakeImage(uint32_t width, uint32_t height, GLenum format,
+                      tango_gl::Texture::Image* image) {
+  const int channels = format == GL_RGBA ? 4 : 3;
+  image->width = width;
+  image->height = height;
+  image->format = format;
+  image->compressed_format = 0;
+  image->level_sizes.clear();
+  image->pixels.resize(static_cast<size_t>(width) * height * channels);
+  for (uint32_t y = 0; y < height; ++y) {
+    for (uint32_t x = 0; x < width; ++x) {
+      uint8_t* pixel = &image->pixels[(y * width + x) * channels];
+      pixel[0] = static_cast<uint8_t>(
+          Clamp255(128 + 100 * sin(x * 0.02) * cos(y * 0.03) + rand() % 9 - 4));
+      pixel[1] = static_cast<uint8_t>(
+          Clamp255(128 + 90 * sin((x + y) * 0.01) + rand() % 9 - 4));
+      pixel[2] = static_cast<uint8_t>(Clamp255(64 + (x + 2 * y) % 128));
+      if (channels == 4) {
+        pixel[3] = static_cast<uint8_t>(
+            Clamp255(255 * (0.5 + 0.5 * sin(x * 0.05))));
+      }
+    }
+  }
+}
+
+}  // namespace etc2_decoder
+
+#endif  // CINDER_TANGO_TEST_ETC2_DECODER_H_
@@ -0,0 +1,36 @@
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+#include "exposure_estimator.h"
+#include "test_util.h"
+
+// ExposureEstimator::Update on a 1280x720 NV21 frame for each sample step.
+// The per-frame budget is 0.5 ms.
+
+int main() {
+  const int width = 1280, height = 720;
+  const int kIterations = 200;
+  std::vector<uint8_t> data(width * height * 3 / 2);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<uint8_t>(rand());
+  }
+  ImagePlanes planes;
+  GetImagePlanes(TANGO_HAL_PIXEL_FORMAT_YCrCb_420_SP, data.data(), width,
+                 height, width, &planes);
+  printf("%dx%d NV21\n", width, height);
+  for (int step = 1; step <= 8; step *= 2) {
+    ExposureEstimator::Options options;
+    options.sample_step = step;
+    ExposureEstimator estimator(options);
+    double total_ms = 0.0, max_ms = 0.0;
+    for (int i = 0; i < kIterations; ++i) {
+      estimator.Update(planes, i / 30.0);
+      total_ms += estimator.GetLastUpdateMs();
+      max_ms = std::max(max_ms, estimator.GetLastUpdateMs());
+    }
+    printf("step %d: %.3f ms avg, %.3f ms max\n", step,
+           total_ms / kIterations, max_ms);
+  }
+  return 0;
+}
@@ -0,0 +1,61 @@
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "exposure_estimator.h"
+#include "test_util.h"
+
+// ComputeLumaHistogram against a brute-force count, and the estimate of a
+// flat image.
+
+namespace {
+ImagePlanes MakeNv21(int width, int height, std::vector<uint8_t>* data) {
+  ImagePlanes planes;
+  GetImagePlanes(TANGO_HAL_PIXEL_FORMAT_YCrCb_420_SP, data->data(), width,
+                 height, width, &planes);
+  return planes;
+}
+}  // namespace
+
+int main() {
+  srand(5);
+  // Odd width to exercise the scalar tail after the SIMD gather.
+  const int width = 333, height = 190;
+  std::vector<uint8_t> data(width * height * 3 / 2 + width);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<uint8_t>(rand());
+  }
+  const ImagePlanes planes = MakeNv21(width, height, &data);
+  for (int step = 1; step <= 8; step *= 2) {
+    uint32_t expected[256];
+    memset(expected, 0, sizeof(expected));
+    uint32_t count = 0;
+    for (int y = 0; y < height; y += step) {
+      for (int x = 0; x < width; x += step) {
+        ++expected[planes.y[y * planes.y_stride + x]];
+        ++count;
+      }
+    }
+    LumaHistogram histogram;
+    ComputeLumaHistogram(planes, step, &histogram);
+    EXPECT(histogram.sample_count == count);
+    EXPECT(memcmp(histogram.bins, expected, sizeof(expected)) == 0);
+    EXPECT(histogram.mean_u > 96.0f && histogram.mean_u < 160.0f);
+    EXPECT(histogram.mean_v > 96.0f && histogram.mean_v < 160.0f);
+  }
+
+  // A neutral gray image at the target luma leaves content unchanged.
+  ExposureEstimator::Options options;
+  std::vector<uint8_t> gray(data.size(), 128);
+  memset(gray.data(), static_cast<int>(options.target_luma), width * height);
+  ExposureEstimator estimator(options);
+  for (int i = 0; i < 30; ++i) {
+    estimator.Update(MakeNv21(width, height, &gray), i / 30.0);
+  }
+  const ToneEstimate estimate = estimator.GetEstimate();
+  EXPECT(estimate.gain > 0.95f && estimate.gain < 1.05f);
+  EXPECT(estimate.tint.x > 0.95f && estimate.tint.x < 1.05f);
+  EXPECT(estimate.tint.y > 0.95f && estimate.tint.y < 1.05f);
+  EXPECT(estimate.tint.z > 0.95f && estimate.tint.z < 1.05f);
+  return test_util::Finish();
+}
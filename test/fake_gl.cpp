@@ -0,0 +1,355 @@
+#include "fake_gl.h"
+
+#include <string.h>
+
+namespace fake_gl {
+
+State::State()
+    : version("OpenGL ES 3.0 fake"),
+      renderer("fake_gl"),
+      extensions("GL_OES_compressed_ETC1_RGB8_texture"),
+      program_binary_formats(1),
+      error(GL_NO_ERROR),
+      next_name(1),
+      program(0),
+      vertex_array(0),
+      array_buffer(0),
+      element_array_buffer(0),
+      texture_2d(0),
+      active_texture(GL_TEXTURE0) {
+  memset(&counters, 0, sizeof(counters));
+  enabled.insert(GL_DITHER);
+}
+
+State& GetState() {
+  static State state;
+  return state;
+}
+
+void Reset() { GetState() = State(); }
+
+}  // namespace fake_gl
+
+namespace {
+const char kBinary[] = "fake program binary";
+
+fake_gl::State& Call() {
+  fake_gl::State& state = fake_gl::GetState();
+  ++state.counters.calls;
+  return state;
+}
+
+void GenNames(GLsizei n, GLuint* names, std::set<GLuint>* live) {
+  fake_gl::State& state = Call();
+  for (GLsizei i = 0; i < n; ++i) {
+    names[i] = state.next_name++;
+    live->insert(names[i]);
+  }
+}
+
+void DeleteNames(GLsizei n, const GLuint* names, std::set<GLuint>* live,
+                 GLuint* bound) {
+  Call();
+  for (GLsizei i = 0; i < n; ++i) {
+    live->erase(names[i]);
+    if (*bound == names[i]) {
+      *bound = 0;
+    }
+  }
+}
+
+GLint Location(GLuint program, const GLchar* name) {
+  fake_gl::State& state = Call();
+  std::map<std::pair<GLuint, std::string>, GLint>::iterator it =
+      state.locations.insert(std::make_pair(std::make_pair(program, name),
+                                            GLint(0))).first;
+  if (it->second == 0) {
+    // Distinct small locations, so attribute arrays stay in range.
+    it->second = static_cast<GLint>(state.locations.size() % 8) + 1;
+  }
+  return it->second - 1;
+}
+
+// The contents of the buffer bound to target, or NULL if none is.
+std::string* BoundData(fake_gl::State& state, GLenum target) {
+  GLuint buffer = 0;
+  if (target == GL_ARRAY_BUFFER) {
+    buffer = state.array_buffer;
+  } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+    buffer = state.element_array_buffer;
+  }
+  return buffer == 0 ? NULL : &state.buffer_data[buffer];
+}
+
+void Draw(GLsizei count, GLsizei instances) {
+  fake_gl::State& state = Call();
+  ++state.counters.draw_calls;
+  state.counters.vertices += static_cast<size_t>(count) * instances;
+}
+}  // namespace
+
+extern "C" {
+
+GLenum glGetError() {
+  fake_gl::State& state = Call();
+  const GLenum error = state.error;
+  state.error = GL_NO_ERROR;
+  return error;
+}
+
+const GLubyte* glGetString(GLenum name) {
+  fake_gl::State& state = Call();
+  const std::string* value = NULL;
+  switch (name) {
+    case GL_VERSION:
+      value = &state.version;
+      break;
+    case GL_RENDERER:
+      value = &state.renderer;
+      break;
+    case GL_EXTENSIONS:
+      value = &state.extensions;
+      break;
+    default:
+      return NULL;
+  }
+  return reinterpret_cast<const GLubyte*>(value->c_str());
+}
+
+void glGetIntegerv(GLenum name, GLint* data) {
+  fake_gl::State& state = Call();
+  switch (name) {
+    case GL_CURRENT_PROGRAM:
+      *data = state.program;
+      break;
+    case GL_VERTEX_ARRAY_BINDING:
+      *data = state.vertex_array;
+      break;
+    case GL_ARRAY_BUFFER_BINDING:
+      *data = state.array_buffer;
+      break;
+    case GL_ELEMENT_ARRAY_BUFFER_BINDING:
+      *data = state.element_array_buffer;
+      break;
+    case GL_TEXTURE_BINDING_2D:
+      *data = state.texture_2d;
+      break;
+    case GL_ACTIVE_TEXTURE:
+      *data = state.active_texture;
+      break;
+    case GL_NUM_PROGRAM_BINARY_FORMATS:
+      *data = state.program_binary_formats;
+      break;
+    default:
+      *data = 0;
+      break;
+  }
+}
+
+void glEnable(GLenum cap) { Call().enabled.insert(cap); }
+void glDisable(GLenum cap) { Call().enabled.erase(cap); }
+GLboolean glIsEnabled(GLenum cap) {
+  return Call().enabled.count(cap) ? GL_TRUE : GL_FALSE;
+}
+void glDepthMask(GLboolean) { Call(); }
+void glDepthFunc(GLenum) { Call(); }
+void glBlendFuncSeparate(GLenum, GLenum, GLenum, GLenum) { Call(); }
+void glLineWidth(GLfloat) { Call(); }
+void glPixelStorei(GLenum, GLint) { Call(); }
+
+GLuint glCreateShader(GLenum) { return Call().next_name++; }
+void glShaderSource(GLuint, GLsizei, const GLchar* const*, const GLint*) {
+  Call();
+}
+void glCompileShader(GLuint) { ++Call().counters.shaders_compiled; }
+void glGetShaderiv(GLuint, GLenum name, GLint* params) {
+  Call();
+  *params = name == GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+void glGetShaderInfoLog(GLuint, GLsizei, GLsizei* length, GLchar* info_log) {
+  Call();
+  if (length != NULL) *length = 0;
+  if (info_log != NULL) *info_log = '\0';
+}
+void glDeleteShader(GLuint) { Call(); }
+
+GLuint glCreateProgram() {
+  fake_gl::State& state = Call();
+  ++state.counters.programs_created;
+  state.programs.insert(state.next_name);
+  return state.next_name++;
+}
+void glDeleteProgram(GLuint program) {
+  fake_gl::State& state = Call();
+  if (program != 0 && state.programs.erase(program)) {
+    ++state.counters.programs_deleted;
+  }
+}
+void glAttachShader(GLuint, GLuint) { Call(); }
+void glLinkProgram(GLuint) { Call(); }
+void glProgramParameteri(GLuint, GLenum, GLint) { Call(); }
+void glGetProgramiv(GLuint, GLenum name, GLint* params) {
+  Call();
+  switch (name) {
+    case GL_LINK_STATUS:
+      *params = GL_TRUE;
+      break;
+    case GL_PROGRAM_BINARY_LENGTH:
+      *params = sizeof(kBinary);
+      break;
+    default:
+      *params = 0;
+      break;
+  }
+}
+void glGetProgramInfoLog(GLuint, GLsizei, GLsizei* length, GLchar* info_log) {
+  Call();
+  if (length != NULL) *length = 0;
+  if (info_log != NULL) *info_log = '\0';
+}
+void glGetProgramBinary(GLuint, GLsizei buffer_size, GLsizei* length,
+                        GLenum* format, void* binary) {
+  Call();
+  *length = buffer_size < static_cast<GLsizei>(sizeof(kBinary))
+                ? 0
+                : static_cast<GLsizei>(sizeof(kBinary));
+  *format = 1;
+  memcpy(binary, kBinary, *length);
+}
+void glProgramBinary(GLuint, GLenum, const void*, GLsizei) { Call(); }
+void glUseProgram(GLuint program) { Call().program = program; }
+GLint glGetUniformLocation(GLuint program, const GLchar* name) {
+  return Location(program, name);
+}
+GLint glGetAttribLocation(GLuint program, const GLchar* name) {
+  return Location(program, name);
+}
+void glUniform1f(GLint, GLfloat) { Call(); }
+void glUniform2f(GLint, GLfloat, GLfloat) { Call(); }
+void glUniform4f(GLint, GLfloat, GLfloat, GLfloat, GLfloat) { Call(); }
+void glUniform3fv(GLint, GLsizei, const GLfloat*) { Call(); }
+void glUniformMatrix4fv(GLint, GLsizei, GLboolean, const GLfloat*) { Call(); }
+
+void glGenBuffers(GLsizei n, GLuint* buffers) {
+  GenNames(n, buffers, &fake_gl::GetState().buffers);
+}
+void glDeleteBuffers(GLsizei n, const GLuint* buffers) {
+  fake_gl::State& state = fake_gl::GetState();
+  DeleteNames(n, buffers, &state.buffers, &state.array_buffer);
+  for (GLsizei i = 0; i < n; ++i) {
+    state.buffer_data.erase(buffers[i]);
+    if (state.element_array_buffer == buffers[i]) {
+      state.element_array_buffer = 0;
+    }
+  }
+}
+void glBindBuffer(GLenum target, GLuint buffer) {
+  fake_gl::State& state = Call();
+  if (target == GL_ARRAY_BUFFER) {
+    state.array_buffer = buffer;
+  } else if (target == GL_ELEMENT_ARRAY_BUFFER) {
+    state.element_array_buffer = buffer;
+  }
+}
+void glBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum) {
+  fake_gl::State& state = Call();
+  ++state.counters.buffer_uploads;
+  state.counters.buffer_bytes += size;
+  std::string* contents = BoundData(state, target);
+  if (contents == NULL) {
+    return;
+  }
+  if (data == NULL) {
+    contents->assign(size, '\0');
+  } else {
+    contents->assign(static_cast<const char*>(data), size);
+  }
+}
+void glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size,
+                     const void* data) {
+  fake_gl::State& state = Call();
+  ++state.counters.buffer_uploads;
+  state.counters.buffer_bytes += size;
+  std::string* contents = BoundData(state, target);
+  if (contents == NULL ||
+      static_cast<size_t>(offset + size) > contents->size()) {
+    state.error = GL_INVALID_VALUE;
+    return;
+  }
+  contents->replace(offset, size, static_cast<const char*>(data), size);
+}
+void* glMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length,
+                       GLbitfield) {
+  fake_gl::State& state = Call();
+  std::string* contents = BoundData(state, target);
+  if (contents == NULL ||
+      static_cast<size_t>(offset + length) > contents->size()) {
+    state.error = GL_INVALID_VALUE;
+    return NULL;
+  }
+  return &(*contents)[offset];
+}
+GLboolean glUnmapBuffer(GLenum) {
+  Call();
+  return GL_TRUE;
+}
+
+void glGenVertexArrays(GLsizei n, GLuint* arrays) {
+  GenNames(n, arrays, &fake_gl::GetState().vertex_arrays);
+}
+void glDeleteVertexArrays(GLsizei n, const GLuint* arrays) {
+  fake_gl::State& state = fake_gl::GetState();
+  DeleteNames(n, arrays, &state.vertex_arrays, &state.vertex_array);
+}
+void glBindVertexArray(GLuint array) { Call().vertex_array = array; }
+void glEnableVertexAttribArray(GLuint) { Call(); }
+void glDisableVertexAttribArray(GLuint) { Call(); }
+void glVertexAttribPointer(GLuint, GLint, GLenum, GLboolean, GLsizei,
+                           const void*) {
+  Call();
+}
+void glVertexAttrib4fv(GLuint, const GLfloat*) { Call(); }
+void glVertexAttribDivisor(GLuint, GLuint) { Call(); }
+
+void glDrawArrays(GLenum, GLint, GLsizei count) { Draw(count, 1); }
+void glDrawElements(GLenum, GLsizei count, GLenum, const void*) {
+  Draw(count, 1);
+}
+void glDrawArraysInstanced(GLenum, GLint, GLsizei count, GLsizei instances) {
+  Draw(count, instances);
+}
+void glDrawElementsInstanced(GLenum, GLsizei count, GLenum, const void*,
+                             GLsizei instances) {
+  Draw(count, instances);
+}
+
+void glGenTextures(GLsizei n, GLuint* textures) {
+  GenNames(n, textures, &fake_gl::GetState().textures);
+}
+void glDeleteTextures(GLsizei n, const GLuint* textures) {
+  fake_gl::State& state = fake_gl::GetState();
+  DeleteNames(n, textures, &state.textures, &state.texture_2d);
+}
+void glActiveTexture(GLenum texture) { Call().active_texture = texture; }
+void glBindTexture(GLenum target, GLuint texture) {
+  fake_gl::State& state = Call();
+  if (target == GL_TEXTURE_2D) {
+    state.texture_2d = texture;
+  }
+}
+void glTexParameteri(GLenum, GLenum, GLint) { Call(); }
+void glTexImage2D(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint,
+                  GLenum, GLenum, const void*) {
+  fake_gl::State& state = Call();
+  ++state.counters.texture_uploads;
+  state.counters.texture_bytes += static_cast<size_t>(width) * height * 4;
+}
+void glCompressedTexImage2D(GLenum, GLint, GLenum, GLsizei, GLsizei, GLint,
+                            GLsizei size, const void*) {
+  fake_gl::State& state = Call();
+  ++state.counters.texture_uploads;
+  state.counters.texture_bytes += size;
+}
+void glGenerateMipmap(GLenum) { Call(); }
+
+}  // extern "C"
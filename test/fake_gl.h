@@ -0,0 +1,67 @@
+#ifndef CINDER_TANGO_TEST_FAKE_GL_H_
+#define CINDER_TANGO_TEST_FAKE_GL_H_
+
+#include <stddef.h>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "cinder/gl/gl.h"
+
+// An OpenGL ES 3 implementation without a GPU, for testing tango-gl on the
+// desktop. It hands out object names, tracks bindings and enabled
+// capabilities so glGet and the GlState shadow agree, and counts calls.
+// Shaders always compile and programs always link. Nothing is drawn.
+namespace fake_gl {
+
+struct Counters {
+  int calls;
+  int draw_calls;
+  // Vertices (or indices) submitted, times the instance count.
+  size_t vertices;
+  int programs_created;
+  int programs_deleted;
+  int shaders_compiled;
+  int buffer_uploads;
+  size_t buffer_bytes;
+  int texture_uploads;
+  size_t texture_bytes;
+};
+
+struct State {
+  State();
+
+  Counters counters;
+  std::string version;
+  std::string renderer;
+  std::string extensions;
+  GLint program_binary_formats;
+  // Returned once by the next glGetError.
+  GLenum error;
+
+  GLuint next_name;
+  GLuint program;
+  GLuint vertex_array;
+  GLuint array_buffer;
+  GLuint element_array_buffer;
+  GLuint texture_2d;
+  GLenum active_texture;
+  std::set<GLenum> enabled;
+  std::set<GLuint> programs;
+  std::set<GLuint> buffers;
+  // What glBufferData and glBufferSubData stored, by buffer name.
+  std::map<GLuint, std::string> buffer_data;
+  std::set<GLuint> vertex_arrays;
+  std::set<GLuint> textures;
+  std::map<std::pair<GLuint, std::string>, GLint> locations;
+};
+
+// The process-wide fake context.
+State& GetState();
+// Starts over with a fresh context.
+void Reset();
+
+}  // namespace fake_gl
+
+#endif  // CINDER_TANGO_TEST_FAKE_GL_H_
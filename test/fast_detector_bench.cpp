@@ -0,0 +1,56 @@
+#include <stdlib.h>
+#include <vector>
+
+#include "fast_detector.h"
+#include "test_util.h"
+
+// Pyramid build and FAST-9 detection time at the color camera resolution.
+// Defaults to the 1280x720 that cc_width/cc_height report on the tablet;
+// pass width and height to try another.
+
+int main(int argc, char** argv) {
+  const int width = argc > 2 ? atoi(argv[1]) : 1280;
+  const int height = argc > 2 ? atoi(argv[2]) : 720;
+  const int kIterations = 50;
+  std::vector<uint8_t> image(width * height);
+  srand(3);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      image[y * width + x] = static_cast<uint8_t>(
+          ((x / 40 + y / 40) % 2) * 120 + 60 + rand() % 20);
+    }
+  }
+
+  ImagePyramid pyramid;
+  WorkerPool pool(3);
+  FastDetector::Options options;
+  FastDetector serial(nullptr, options);
+  FastDetector threaded(&pool, options);
+  std::vector<Keypoint> keypoints;
+  double pyramid_ms = 0.0, serial_ms = 0.0, threaded_ms = 0.0;
+  FastDetector::Timing stages = {0.0, 0.0, 0.0};
+  for (int i = 0; i < kIterations; ++i) {
+    double start = test_util::NowMs();
+    pyramid.Build(image.data(), width, height, width, 4);
+    pyramid_ms += test_util::NowMs() - start;
+    start = test_util::NowMs();
+    serial.Detect(pyramid, &keypoints);
+    serial_ms += test_util::NowMs() - start;
+    start = test_util::NowMs();
+    threaded.Detect(pyramid, &keypoints);
+    threaded_ms += test_util::NowMs() - start;
+    stages.score_ms += threaded.GetLastTiming().score_ms;
+    stages.suppress_ms += threaded.GetLastTiming().suppress_ms;
+    stages.bucket_ms += threaded.GetLastTiming().bucket_ms;
+  }
+  printf("%dx%d, %d levels, %zu keypoints\n", width, height,
+         pyramid.GetLevelCount(), keypoints.size());
+  printf("pyramid   %7.3f ms\n", pyramid_ms / kIterations);
+  printf("serial    %7.3f ms\n", serial_ms / kIterations);
+  printf("3 workers %7.3f ms (score %.3f, suppress %.3f, bucket %.3f)\n",
+         threaded_ms / kIterations, stages.score_ms / kIterations,
+         stages.suppress_ms / kIterations, stages.bucket_ms / kIterations);
+  printf("%.1f frames/s detection throughput\n",
+         1000.0 * kIterations / (pyramid_ms + threaded_ms));
+  return 0;
+}
@@ -0,0 +1,105 @@
+#include <stdlib.h>
+#include <vector>
+
+#include "fast_detector.h"
+#include "test_util.h"
+
+// FastDetector against a brute-force FAST-9 segment test, and the threaded
+// detector against the single-threaded one.
+
+namespace {
+const int kCircle[16][2] = {{0, -3}, {1, -3},  {2, -2},  {3, -1},
+                            {3, 0},  {3, 1},   {2, 2},   {1, 3},
+                            {0, 3},  {-1, 3},  {-2, 2},  {-3, 1},
+                            {-3, 0}, {-3, -1}, {-2, -2}, {-1, -3}};
+
+void MakeImage(int width, int height, std::vector<uint8_t>* image) {
+  image->resize(width * height);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      (*image)[y * width + x] = static_cast<uint8_t>(
+          ((x / 40 + y / 40) % 2) * 120 + 60 + rand() % 20);
+    }
+  }
+  for (int i = 0; i < 2000; ++i) {
+    const int cx = rand() % width, cy = rand() % height, r = 2 + rand() % 4;
+    for (int y = cy - r; y <= cy + r; ++y) {
+      for (int x = cx - r; x <= cx + r; ++x) {
+        if (x >= 0 && y >= 0 && x < width && y < height) {
+          (*image)[y * width + x] = static_cast<uint8_t>(rand());
+        }
+      }
+    }
+  }
+}
+
+size_t CountCorners(const ImagePyramid& pyramid, int threshold) {
+  size_t corners = 0;
+  for (int l = 0; l < pyramid.GetLevelCount(); ++l) {
+    const ImagePyramid::Level& level = pyramid.GetLevel(l);
+    for (int y = 3; y < level.height - 3; ++y) {
+      for (int x = 3; x < level.width - 3; ++x) {
+        const int center = level.data[y * level.stride + x];
+        bool corner = false;
+        for (int start = 0; start < 16 && !corner; ++start) {
+          bool brighter = true, darker = true;
+          for (int j = 0; j < 9; ++j) {
+            const int* offset = kCircle[(start + j) % 16];
+            const int value =
+                level.data[(y + offset[1]) * level.stride + x + offset[0]];
+            brighter &= value > center + threshold;
+            darker &= value < center - threshold;
+          }
+          corner = brighter || darker;
+        }
+        corners += corner;
+      }
+    }
+  }
+  return corners;
+}
+
+bool SameKeypoints(const std::vector<Keypoint>& a,
+                   const std::vector<Keypoint>& b) {
+  if (a.size() != b.size()) return false;
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (a[i].x != b[i].x || a[i].y != b[i].y || a[i].level != b[i].level ||
+        a[i].score != b[i].score) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+int main() {
+  srand(3);
+  const int width = 640, height = 360;
+  std::vector<uint8_t> image;
+  MakeImage(width, height, &image);
+  ImagePyramid pyramid;
+  pyramid.Build(image.data(), width, height, width, 3);
+  EXPECT(pyramid.GetLevelCount() == 3);
+  EXPECT(pyramid.GetLevel(2).width == width / 4);
+
+  FastDetector::Options raw_options;
+  raw_options.nonmax_suppression = false;
+  raw_options.max_per_cell = 0;
+  FastDetector raw(nullptr, raw_options);
+  std::vector<Keypoint> keypoints;
+  raw.Detect(pyramid, &keypoints);
+  EXPECT(!keypoints.empty());
+  EXPECT(keypoints.size() == CountCorners(pyramid, raw_options.threshold));
+
+  WorkerPool pool(3);
+  FastDetector::Options options;
+  FastDetector serial(nullptr, options);
+  FastDetector threaded(&pool, options);
+  std::vector<Keypoint> serial_keypoints;
+  serial.Detect(pyramid, &serial_keypoints);
+  threaded.Detect(pyramid, &keypoints);
+  EXPECT(!keypoints.empty());
+  EXPECT(keypoints.size() < CountCorners(pyramid, options.threshold));
+  EXPECT(SameKeypoints(serial_keypoints, keypoints));
+  return test_util::Finish();
+}
@@ -0,0 +1,101 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "fast_log.h"
+#include "test_util.h"
+
+// What FastLog writes: printf formatting driven by the recorded types,
+// * widths and precisions, %%, strings cut at kTextSize and the count of
+// records a rate limit held back.
+
+// The mismatched length modifiers are the point of one case.
+#pragma GCC diagnostic ignored "-Wformat"
+
+namespace {
+// The messages of the lines in path, without time, level and call site.
+std::vector<std::string> ReadMessages(const std::string& path) {
+  std::vector<std::string> messages;
+  FILE* file = fopen(path.c_str(), "r");
+  if (file == nullptr) {
+    return messages;
+  }
+  char buffer[512];
+  while (fgets(buffer, sizeof(buffer), file) != nullptr) {
+    std::string line(buffer);
+    if (!line.empty() && line[line.size() - 1] == '\n') {
+      line.erase(line.size() - 1);
+    }
+    // "<seconds> <level> <file>:<line> <message>"
+    size_t space = 0;
+    for (int field = 0; field < 3 && space != std::string::npos; ++field) {
+      space = line.find(' ', space + (field > 0));
+    }
+    messages.push_back(space == std::string::npos ? line
+                                                  : line.substr(space + 1));
+  }
+  fclose(file);
+  return messages;
+}
+}  // namespace
+
+int main() {
+  char directory[] = "/tmp/fast_log_testXXXXXX";
+  EXPECT(mkdtemp(directory) != nullptr);
+  FastLog::Options options;
+  options.file_path = std::string(directory) + "/log.txt";
+  FastLog& log = FastLog::GetInstance();
+  EXPECT(log.Start(options));
+
+  const int64_t big = 12345678901234LL;
+  const short small = -3;
+  FAST_LOG_I("%d %ld %hhu %lf", big, small, 300u, 2.5f);
+  FAST_LOG_I("%x %5.1f %-4d| %p", 255u, 3.14159, 7,
+             static_cast<const void*>(nullptr));
+  FAST_LOG_I("100%% %s %d%%", "done", 5);
+  FAST_LOG_I("[%*d] [%-*d] [%.*f]", 5, 42, 4, 1, 2, 3.14159);
+  FAST_LOG_I("[%*.*f]", 8, 3, 2.71828);
+  FAST_LOG_I("[%.*s]", -1, "negative precision");
+  FAST_LOG_I("%s|%s", std::string(60, 'a'), "b");
+  FAST_LOG_I("%d %d", 1);
+  for (int i = 0; i < 6; ++i) {
+    if (i == 5) {
+      usleep(150 * 1000);
+    }
+    FAST_LOG(FastLog::kWarning, 100, "limited %d", i);
+  }
+  log.Flush();
+  log.Stop();
+
+  const std::vector<std::string> messages = ReadMessages(options.file_path);
+  const std::string expected[] = {
+      "12345678901234 -3 300 2.500000",
+      "ff   3.1 7   | (nil)",
+      "100% done 5%",
+      "[   42] [1   ] [3.14]",
+      "[   2.718]",
+      "[negative precision]",
+      // The text of a record holds kTextSize bytes with the terminators.
+      std::string(FastLog::kTextSize - 1, 'a') + "|",
+      "1 <missing>",
+      "limited 0",
+      "limited 5 (+4 suppressed)",
+  };
+  const size_t count = sizeof(expected) / sizeof(expected[0]);
+  EXPECT(messages.size() == count);
+  for (size_t i = 0; i < count && i < messages.size(); ++i) {
+    if (messages[i] != expected[i]) {
+      fprintf(stderr, "line %zu: \"%s\", expected \"%s\"\n", i,
+              messages[i].c_str(), expected[i].c_str());
+      ++test_util::failures;
+    }
+  }
+
+  unlink(options.file_path.c_str());
+  rmdir(directory);
+  return test_util::Finish();
+}
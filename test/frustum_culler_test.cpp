@@ -0,0 +1,123 @@
+#include <stdlib.h>
+#include <vector>
+
+#include "tango-gl/frustum_culler.h"
+#include "test_util.h"
+
+// The packed NEON or SSE2 plane test of FrustumCuller::Cull against the
+// scalar IsVisible, on random boxes and frusta, including empty boxes,
+// points and boxes straddling or touching a plane.
+
+using tango_gl::BoundingBox;
+using tango_gl::FrustumCuller;
+
+namespace {
+float Random(float min, float max) {
+  return min + (max - min) * (rand() / static_cast<float>(RAND_MAX));
+}
+
+glm::vec3 RandomVector(float range) {
+  return glm::vec3(Random(-range, range), Random(-range, range),
+                   Random(-range, range));
+}
+
+// A perspective frustum looking from a random place, or every other time
+// an arbitrary matrix, whose planes are arbitrary too.
+glm::mat4 RandomViewProjection(int frustum) {
+  glm::mat4 m;
+  if (frustum % 2 == 0) {
+    glm::mat4 view(1.0f);
+    view[3] = glm::vec4(RandomVector(5.0f), 1.0f);
+    m = glm::perspective(Random(0.3f, 2.0f), Random(0.5f, 2.0f),
+                         Random(0.05f, 1.0f), Random(5.0f, 100.0f)) *
+        view;
+  } else {
+    for (int column = 0; column < 4; ++column) {
+      for (int row = 0; row < 4; ++row) {
+        m[column][row] = Random(-1.0f, 1.0f);
+      }
+    }
+  }
+  return m;
+}
+
+// Plane of the frustum as FrustumCuller takes it: the last row of m plus or
+// minus another.
+glm::vec4 GetPlane(const glm::mat4& m, int plane) {
+  const float sign = plane % 2 == 0 ? 1.0f : -1.0f;
+  glm::vec4 result;
+  for (int column = 0; column < 4; ++column) {
+    result[column] = m[column][3] + sign * m[column][plane / 2];
+  }
+  return result;
+}
+
+BoundingBox RandomBox(const glm::mat4& m, int kind) {
+  glm::vec3 center = RandomVector(20.0f);
+  glm::vec3 extent(Random(0.0f, 3.0f), Random(0.0f, 3.0f),
+                   Random(0.0f, 3.0f));
+  switch (kind) {
+    case 0:
+      return BoundingBox();
+    case 1:
+      // A point.
+      extent = glm::vec3(0.0f);
+      break;
+    case 2:
+    case 3: {
+      // Centered on a plane, so it straddles it; or moved off along the
+      // normal by about its radius, so it just touches.
+      const glm::vec4 plane = GetPlane(m, rand() % 6);
+      const glm::vec3 normal(plane.x, plane.y, plane.z);
+      const float length_squared = glm::dot(normal, normal);
+      if (length_squared > 0.0f) {
+        center -= normal * ((glm::dot(normal, center) + plane.w) /
+                            length_squared);
+        if (kind == 3) {
+          const float radius = glm::dot(glm::abs(normal), extent);
+          center -= normal * (radius / length_squared);
+        }
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  return BoundingBox(center - extent, center + extent);
+}
+}  // namespace
+
+int main() {
+  srand(1);
+  const int kFrusta = 200;
+  // Not a multiple of four, so the padding lanes are exercised too.
+  const size_t kBoxes = 1001;
+  FrustumCuller culler;
+  std::vector<BoundingBox> boxes(kBoxes);
+  std::vector<uint8_t> visible(kBoxes);
+  int mismatches = 0;
+  int kept = 0;
+  int culled = 0;
+  for (int frustum = 0; frustum < kFrusta; ++frustum) {
+    const glm::mat4 m = RandomViewProjection(frustum);
+    culler.SetViewProjection(m);
+    for (size_t i = 0; i < kBoxes; ++i) {
+      boxes[i] = RandomBox(m, static_cast<int>(i % 6));
+    }
+    culler.Cull(boxes.data(), boxes.size(), visible.data());
+    for (size_t i = 0; i < kBoxes; ++i) {
+      const bool expected = culler.IsVisible(boxes[i]);
+      mismatches += (visible[i] != 0) != expected;
+      kept += expected;
+      culled += !expected;
+      if (i % 6 == 0) {
+        EXPECT(visible[i]);
+      }
+    }
+  }
+  EXPECT(mismatches == 0);
+  // Both outcomes were tried.
+  EXPECT(kept > 1000 && culled > 1000);
+  printf("%d kept, %d culled, %d mismatches\n", kept, culled, mismatches);
+  return test_util::Finish();
+}
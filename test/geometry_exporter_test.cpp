@@ -0,0 +1,235 @@
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "geometry_exporter.h"
+#include "test_util.h"
+
+// Writes synthetic meshes and clouds in both formats and reads them back.
+
+namespace {
+const char kPlyPath[] = "geometry_exporter_test.ply";
+const char kNativePath[] = "geometry_exporter_test.ctgm";
+
+std::shared_ptr<MeshData> MakeMesh(int columns, int rows, float z,
+                                   bool with_attributes) {
+  std::shared_ptr<MeshData> mesh(new MeshData());
+  for (int y = 0; y < rows; ++y) {
+    for (int x = 0; x < columns; ++x) {
+      const float p[3] = {x * 0.1f, y * 0.1f, z + 0.01f * x * y};
+      mesh->vertices.insert(mesh->vertices.end(), p, p + 3);
+      if (with_attributes) {
+        const float n[3] = {0.0f, 0.0f, 1.0f};
+        mesh->normals.insert(mesh->normals.end(), n, n + 3);
+        const uint8_t c[4] = {static_cast<uint8_t>(x), static_cast<uint8_t>(y),
+                              7, 255};
+        mesh->colors.insert(mesh->colors.end(), c, c + 4);
+      }
+    }
+  }
+  for (int y = 0; y + 1 < rows; ++y) {
+    for (int x = 0; x + 1 < columns; ++x) {
+      const uint32_t a = y * columns + x, b = a + 1, c = a + columns, d = c + 1;
+      const uint32_t f[6] = {a, b, d, a, d, c};
+      mesh->faces.insert(mesh->faces.end(), f, f + 6);
+    }
+  }
+  return mesh;
+}
+
+std::shared_ptr<PointCloudData> MakeCloud(int count) {
+  std::shared_ptr<PointCloudData> cloud(new PointCloudData());
+  for (int i = 0; i < count; ++i) {
+    cloud->points.push_back(i * 0.5f);
+    cloud->points.push_back(-i * 0.25f);
+    cloud->points.push_back(2.0f);
+  }
+  return cloud;
+}
+
+bool ReadFile(const char* path, std::vector<uint8_t>* data) {
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr) {
+    return false;
+  }
+  fseek(file, 0, SEEK_END);
+  data->resize(ftell(file));
+  fseek(file, 0, SEEK_SET);
+  const bool ok = fread(data->data(), 1, data->size(), file) == data->size();
+  fclose(file);
+  return ok;
+}
+
+// Everything the snapshot holds, merged the way the exporter merges it.
+struct Expected {
+  std::vector<float> positions;
+  std::vector<float> normals;
+  std::vector<uint8_t> colors;
+  std::vector<uint32_t> faces;
+};
+
+Expected Merge(const GeometrySnapshot& snapshot, bool attributes) {
+  Expected expected;
+  uint32_t base = 0;
+  for (size_t i = 0; i < snapshot.meshes.size(); ++i) {
+    const MeshData& mesh = *snapshot.meshes[i];
+    expected.positions.insert(expected.positions.end(), mesh.vertices.begin(),
+                              mesh.vertices.end());
+    if (attributes) {
+      expected.normals.insert(expected.normals.end(), mesh.normals.begin(),
+                              mesh.normals.end());
+      expected.colors.insert(expected.colors.end(), mesh.colors.begin(),
+                             mesh.colors.end());
+    }
+    for (size_t f = 0; f < mesh.faces.size(); ++f) {
+      expected.faces.push_back(mesh.faces[f] + base);
+    }
+    base += static_cast<uint32_t>(mesh.GetVertexCount());
+  }
+  for (size_t i = 0; i < snapshot.clouds.size(); ++i) {
+    expected.positions.insert(expected.positions.end(),
+                              snapshot.clouds[i]->points.begin(),
+                              snapshot.clouds[i]->points.end());
+  }
+  return expected;
+}
+
+void CheckPly(const GeometrySnapshot& snapshot, bool attributes) {
+  std::vector<uint8_t> data;
+  EXPECT(ReadFile(kPlyPath, &data));
+  const std::string text(data.begin(), data.end());
+  const size_t end = text.find("end_header\n");
+  EXPECT(end != std::string::npos);
+  if (end == std::string::npos) {
+    return;
+  }
+  const std::string header = text.substr(0, end);
+  const Expected expected = Merge(snapshot, attributes);
+  const size_t vertices = expected.positions.size() / 3;
+  const size_t faces = expected.faces.size() / 3;
+  char line[64];
+  snprintf(line, sizeof(line), "element vertex %zu\n", vertices);
+  EXPECT(header.find(line) != std::string::npos);
+  EXPECT((header.find("property float nx") != std::string::npos) ==
+         attributes);
+  EXPECT((header.find("property uchar red") != std::string::npos) ==
+         attributes);
+
+  const uint8_t* p = data.data() + end + strlen("end_header\n");
+  bool vertices_match = true;
+  for (size_t v = 0; v < vertices; ++v) {
+    vertices_match &= memcmp(p, &expected.positions[v * 3], 12) == 0;
+    p += 12;
+    if (attributes) {
+      vertices_match &= memcmp(p, &expected.normals[v * 3], 12) == 0;
+      vertices_match &= memcmp(p + 12, &expected.colors[v * 4], 4) == 0;
+      p += 16;
+    }
+  }
+  EXPECT(vertices_match);
+  bool faces_match = true;
+  for (size_t f = 0; f < faces; ++f) {
+    int32_t indices[3];
+    faces_match &= p[0] == 3;
+    memcpy(indices, p + 1, sizeof(indices));
+    for (int k = 0; k < 3; ++k) {
+      faces_match &= static_cast<uint32_t>(indices[k]) ==
+                     expected.faces[f * 3 + k];
+    }
+    p += 13;
+  }
+  EXPECT(faces_match);
+  EXPECT(p == data.data() + data.size());
+}
+
+void CheckNative(const GeometrySnapshot& snapshot, bool attributes) {
+  std::vector<uint8_t> data;
+  EXPECT(ReadFile(kNativePath, &data));
+  if (data.size() < 20) {
+    EXPECT(data.size() >= 20);
+    return;
+  }
+  EXPECT(memcmp(data.data(), "CTGM", 4) == 0);
+  uint32_t header[4];
+  memcpy(header, data.data() + 4, sizeof(header));
+  const Expected expected = Merge(snapshot, attributes);
+  const size_t vertices = expected.positions.size() / 3;
+  EXPECT(header[0] == 1);
+  EXPECT(header[2] == vertices);
+  EXPECT(header[3] == expected.faces.size() / 3);
+  const bool short_indices = (header[1] & 4) != 0;
+  EXPECT(short_indices == (vertices <= 0xffff));
+  EXPECT(((header[1] & 3) == 3) == attributes);
+
+  const uint8_t* p = data.data() + 20;
+  EXPECT(memcmp(p, expected.positions.data(), vertices * 12) == 0);
+  p += vertices * 12;
+  if (attributes) {
+    EXPECT(memcmp(p, expected.normals.data(), vertices * 12) == 0);
+    p += vertices * 12;
+    EXPECT(memcmp(p, expected.colors.data(), vertices * 4) == 0);
+    p += vertices * 4;
+  }
+  bool faces_match = true;
+  for (size_t i = 0; i < expected.faces.size(); ++i) {
+    uint32_t index;
+    if (short_indices) {
+      uint16_t short_index;
+      memcpy(&short_index, p, 2);
+      index = short_index;
+      p += 2;
+    } else {
+      memcpy(&index, p, 4);
+      p += 4;
+    }
+    faces_match &= index == expected.faces[i];
+  }
+  EXPECT(faces_match);
+  EXPECT(p == data.data() + data.size());
+}
+
+void RoundTrip(WorkerPool* pool, const GeometrySnapshot& snapshot,
+               bool attributes) {
+  // A small buffer, so the file goes out in many flushes.
+  GeometryExporter exporter(pool, 1024);
+  uint64_t last_progress = 0;
+  uint64_t progress_total = 0;
+  EXPECT(exporter.Start(kPlyPath, GeometryExporter::kFormatPly, snapshot,
+                        [&](uint64_t written, uint64_t total) {
+                          last_progress = written;
+                          progress_total = total;
+                        }));
+  exporter.Wait();
+  EXPECT(exporter.GetState() == GeometryExporter::kStateDone);
+  EXPECT(last_progress == progress_total);
+  EXPECT(progress_total == GeometryExporter::ComputeFileSize(
+                               GeometryExporter::kFormatPly, snapshot));
+  CheckPly(snapshot, attributes);
+
+  EXPECT(exporter.Start(kNativePath, GeometryExporter::kFormatNative,
+                        snapshot));
+  exporter.Wait();
+  EXPECT(exporter.GetState() == GeometryExporter::kStateDone);
+  CheckNative(snapshot, attributes);
+}
+}  // namespace
+
+int main() {
+  WorkerPool pool(2);
+
+  GeometrySnapshot meshes;
+  meshes.meshes.push_back(MakeMesh(30, 20, 0.0f, true));
+  meshes.meshes.push_back(MakeMesh(7, 9, 1.0f, true));
+  RoundTrip(&pool, meshes, true);
+
+  // Clouds drop the normals and colors; 80k points need 32-bit indices.
+  GeometrySnapshot mixed;
+  mixed.meshes.push_back(MakeMesh(30, 20, 0.0f, true));
+  mixed.clouds.push_back(MakeCloud(80000));
+  RoundTrip(&pool, mixed, false);
+
+  remove(kPlyPath);
+  remove(kNativePath);
+  return test_util::Finish();
+}
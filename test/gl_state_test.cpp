@@ -0,0 +1,64 @@
+#include <vector>
+
+#include "fake_gl.h"
+#include "tango-gl/gl_state.h"
+#include "tango-gl/line.h"
+#include "test_util.h"
+
+// A BeginFrame/EndFrame block must hand back the program, vertex array and
+// array buffer that Cinder had bound, since Cinder caches those bindings,
+// and must not query the ones it leaves alone.
+
+using tango_gl::GlState;
+using tango_gl::Line;
+
+int main() {
+  const glm::mat4 identity(1.0f);
+  const fake_gl::State& state = fake_gl::GetState();
+  GlState& gl_state = GlState::GetInstance();
+
+  Line line(2.0f, GL_LINE_STRIP);
+  line.SetShader();
+  line.UpdateLineVertices(std::vector<glm::vec3>(16));
+
+  // What Cinder leaves bound, set behind the shadow's back.
+  GLuint cinder_program = glCreateProgram();
+  GLuint cinder_vertex_array = 0;
+  GLuint cinder_buffer = 0;
+  glGenVertexArrays(1, &cinder_vertex_array);
+  glGenBuffers(1, &cinder_buffer);
+  for (int frame = 0; frame < 3; ++frame) {
+    glUseProgram(cinder_program);
+    glBindVertexArray(cinder_vertex_array);
+    glBindBuffer(GL_ARRAY_BUFFER, cinder_buffer);
+
+    gl_state.BeginFrame();
+    line.Render(identity, identity);
+    EXPECT(state.program != cinder_program);
+    const int draws = state.counters.draw_calls;
+    line.Render(identity, identity);
+    EXPECT(state.counters.draw_calls == draws + 1);
+    gl_state.EndFrame();
+
+    EXPECT(state.program == cinder_program);
+    EXPECT(state.vertex_array == cinder_vertex_array);
+    EXPECT(state.array_buffer == cinder_buffer);
+  }
+
+  // A block that draws nothing touches nothing, not even glGet.
+  const int calls = state.counters.calls;
+  gl_state.BeginFrame();
+  gl_state.EndFrame();
+  EXPECT(state.counters.calls == calls);
+  EXPECT(gl_state.GetStats().queries == 0);
+
+  // A block that only changes the program queries and restores only that.
+  gl_state.BeginFrame();
+  gl_state.UseProgram(glCreateProgram());
+  EXPECT(gl_state.GetStats().queries == 1);
+  gl_state.EndFrame();
+  EXPECT(gl_state.GetStats().queries == 1);
+  EXPECT(state.program == cinder_program);
+
+  return test_util::Finish();
+}
@@ -0,0 +1,326 @@
+#ifndef CINDER_TANGO_TEST_GLM_SUBSET_GLM_HPP_
+#define CINDER_TANGO_TEST_GLM_SUBSET_GLM_HPP_
+
+// The part of glm that src/ and tango-gl use, for building the desktop
+// tests without a Cinder checkout. Same names, layout (column major) and
+// results as glm for these functions; nothing else is provided.
+
+#include <math.h>
+
+namespace glm {
+
+struct vec4;
+
+struct vec2 {
+  float x, y;
+  vec2() : x(0), y(0) {}
+  explicit vec2(float s) : x(s), y(s) {}
+  vec2(float x, float y) : x(x), y(y) {}
+  float& operator[](int i) { return (&x)[i]; }
+  float operator[](int i) const { return (&x)[i]; }
+};
+
+struct vec3 {
+  float x, y, z;
+  vec3() : x(0), y(0), z(0) {}
+  explicit vec3(float s) : x(s), y(s), z(s) {}
+  vec3(float x, float y, float z) : x(x), y(y), z(z) {}
+  explicit vec3(const vec4& v);
+  float& operator[](int i) { return (&x)[i]; }
+  float operator[](int i) const { return (&x)[i]; }
+  vec3& operator+=(const vec3& o) { x += o.x; y += o.y; z += o.z; return *this; }
+  vec3& operator-=(const vec3& o) { x -= o.x; y -= o.y; z -= o.z; return *this; }
+  vec3& operator*=(float s) { x *= s; y *= s; z *= s; return *this; }
+  vec3& operator/=(float s) { x /= s; y /= s; z /= s; return *this; }
+};
+
+struct vec4 {
+  float x, y, z, w;
+  vec4() : x(0), y(0), z(0), w(0) {}
+  explicit vec4(float s) : x(s), y(s), z(s), w(s) {}
+  vec4(float x, float y, float z, float w) : x(x), y(y), z(z), w(w) {}
+  vec4(const vec3& v, float w) : x(v.x), y(v.y), z(v.z), w(w) {}
+  float& operator[](int i) { return (&x)[i]; }
+  float operator[](int i) const { return (&x)[i]; }
+  vec4& operator+=(const vec4& o) { x += o.x; y += o.y; z += o.z; w += o.w; return *this; }
+  vec4& operator*=(float s) { x *= s; y *= s; z *= s; w *= s; return *this; }
+};
+
+inline vec3::vec3(const vec4& v) : x(v.x), y(v.y), z(v.z) {}
+
+struct quat {
+  float x, y, z, w;
+  quat() : x(0), y(0), z(0), w(1) {}
+  quat(float w, float x, float y, float z) : x(x), y(y), z(z), w(w) {}
+  float& operator[](int i) { return (&x)[i]; }
+  float operator[](int i) const { return (&x)[i]; }
+};
+
+struct mat4 {
+  vec4 c[4];
+  mat4() { *this = mat4(1.0f); }
+  explicit mat4(float s) {
+    for (int i = 0; i < 4; ++i) {
+      c[i] = vec4(0.0f);
+      c[i][i] = s;
+    }
+  }
+  mat4(float a0, float a1, float a2, float a3, float b0, float b1, float b2,
+       float b3, float c0, float c1, float c2, float c3, float d0, float d1,
+       float d2, float d3) {
+    c[0] = vec4(a0, a1, a2, a3);
+    c[1] = vec4(b0, b1, b2, b3);
+    c[2] = vec4(c0, c1, c2, c3);
+    c[3] = vec4(d0, d1, d2, d3);
+  }
+  mat4(const vec4& a, const vec4& b, const vec4& cc, const vec4& d) {
+    c[0] = a;
+    c[1] = b;
+    c[2] = cc;
+    c[3] = d;
+  }
+  vec4& operator[](int i) { return c[i]; }
+  const vec4& operator[](int i) const { return c[i]; }
+};
+
+struct mat3 {
+  vec3 c[3];
+  mat3() {
+    for (int i = 0; i < 3; ++i) {
+      c[i] = vec3(0.0f);
+      c[i][i] = 1.0f;
+    }
+  }
+  explicit mat3(const mat4& m) {
+    for (int i = 0; i < 3; ++i) {
+      c[i] = vec3(m[i].x, m[i].y, m[i].z);
+    }
+  }
+  vec3& operator[](int i) { return c[i]; }
+  const vec3& operator[](int i) const { return c[i]; }
+};
+
+inline vec3 operator+(const vec3& a, const vec3& b) { return vec3(a.x + b.x, a.y + b.y, a.z + b.z); }
+inline vec3 operator-(const vec3& a, const vec3& b) { return vec3(a.x - b.x, a.y - b.y, a.z - b.z); }
+inline vec3 operator-(const vec3& a) { return vec3(-a.x, -a.y, -a.z); }
+inline vec3 operator*(const vec3& a, float s) { return vec3(a.x * s, a.y * s, a.z * s); }
+inline vec3 operator*(float s, const vec3& a) { return a * s; }
+inline vec3 operator*(const vec3& a, const vec3& b) { return vec3(a.x * b.x, a.y * b.y, a.z * b.z); }
+inline vec3 operator/(const vec3& a, float s) { return vec3(a.x / s, a.y / s, a.z / s); }
+inline bool operator==(const vec3& a, const vec3& b) { return a.x == b.x && a.y == b.y && a.z == b.z; }
+inline bool operator!=(const vec3& a, const vec3& b) { return !(a == b); }
+
+inline vec4 operator+(const vec4& a, const vec4& b) { return vec4(a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w); }
+inline vec4 operator-(const vec4& a, const vec4& b) { return vec4(a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w); }
+inline vec4 operator*(const vec4& a, float s) { return vec4(a.x * s, a.y * s, a.z * s, a.w * s); }
+inline vec4 operator*(float s, const vec4& a) { return a * s; }
+inline bool operator==(const vec4& a, const vec4& b) { return a.x == b.x && a.y == b.y && a.z == b.z && a.w == b.w; }
+
+inline vec4 operator*(const mat4& m, const vec4& v) { return m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3] * v.w; }
+inline mat4 operator*(const mat4& a, const mat4& b) {
+  mat4 r;
+  for (int i = 0; i < 4; ++i) {
+    r[i] = a * b[i];
+  }
+  return r;
+}
+inline vec3 operator*(const mat3& m, const vec3& v) { return m[0] * v.x + m[1] * v.y + m[2] * v.z; }
+inline bool operator==(const mat4& a, const mat4& b) {
+  for (int i = 0; i < 4; ++i) {
+    if (!(a[i] == b[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+inline bool operator!=(const mat4& a, const mat4& b) { return !(a == b); }
+
+inline float dot(const vec3& a, const vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline float dot(const vec4& a, const vec4& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+inline vec3 cross(const vec3& a, const vec3& b) {
+  return vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+}
+inline float length(const vec3& a) { return sqrtf(dot(a, a)); }
+inline float length(const vec4& a) { return sqrtf(dot(a, a)); }
+inline vec3 normalize(const vec3& a) { return a / length(a); }
+inline float distance(const vec3& a, const vec3& b) { return length(a - b); }
+inline vec3 min(const vec3& a, const vec3& b) { return vec3(fminf(a.x, b.x), fminf(a.y, b.y), fminf(a.z, b.z)); }
+inline vec3 max(const vec3& a, const vec3& b) { return vec3(fmaxf(a.x, b.x), fmaxf(a.y, b.y), fmaxf(a.z, b.z)); }
+inline vec3 abs(const vec3& a) { return vec3(fabsf(a.x), fabsf(a.y), fabsf(a.z)); }
+inline vec3 mix(const vec3& a, const vec3& b, float t) { return a + (b - a) * t; }
+inline float mix(float a, float b, float t) { return a + (b - a) * t; }
+inline float clamp(float v, float lo, float hi) { return fminf(fmaxf(v, lo), hi); }
+inline float radians(float degrees) { return degrees * 0.01745329251994329577f; }
+
+inline mat4 transpose(const mat4& m) {
+  mat4 r;
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      r[i][j] = m[j][i];
+    }
+  }
+  return r;
+}
+
+// Cofactor expansion, as glm does it.
+inline mat4 inverse(const mat4& m) {
+  const float* a = &m[0].x;
+  float inv[16];
+  inv[0] = a[5] * a[10] * a[15] - a[5] * a[11] * a[14] - a[9] * a[6] * a[15] + a[9] * a[7] * a[14] + a[13] * a[6] * a[11] - a[13] * a[7] * a[10];
+  inv[4] = -a[4] * a[10] * a[15] + a[4] * a[11] * a[14] + a[8] * a[6] * a[15] - a[8] * a[7] * a[14] - a[12] * a[6] * a[11] + a[12] * a[7] * a[10];
+  inv[8] = a[4] * a[9] * a[15] - a[4] * a[11] * a[13] - a[8] * a[5] * a[15] + a[8] * a[7] * a[13] + a[12] * a[5] * a[11] - a[12] * a[7] * a[9];
+  inv[12] = -a[4] * a[9] * a[14] + a[4] * a[10] * a[13] + a[8] * a[5] * a[14] - a[8] * a[6] * a[13] - a[12] * a[5] * a[10] + a[12] * a[6] * a[9];
+  inv[1] = -a[1] * a[10] * a[15] + a[1] * a[11] * a[14] + a[9] * a[2] * a[15] - a[9] * a[3] * a[14] - a[13] * a[2] * a[11] + a[13] * a[3] * a[10];
+  inv[5] = a[0] * a[10] * a[15] - a[0] * a[11] * a[14] - a[8] * a[2] * a[15] + a[8] * a[3] * a[14] + a[12] * a[2] * a[11] - a[12] * a[3] * a[10];
+  inv[9] = -a[0] * a[9] * a[15] + a[0] * a[11] * a[13] + a[8] * a[1] * a[15] - a[8] * a[3] * a[13] - a[12] * a[1] * a[11] + a[12] * a[3] * a[9];
+  inv[13] = a[0] * a[9] * a[14] - a[0] * a[10] * a[13] - a[8] * a[1] * a[14] + a[8] * a[2] * a[13] + a[12] * a[1] * a[10] - a[12] * a[2] * a[9];
+  inv[2] = a[1] * a[6] * a[15] - a[1] * a[7] * a[14] - a[5] * a[2] * a[15] + a[5] * a[3] * a[14] + a[13] * a[2] * a[7] - a[13] * a[3] * a[6];
+  inv[6] = -a[0] * a[6] * a[15] + a[0] * a[7] * a[14] + a[4] * a[2] * a[15] - a[4] * a[3] * a[14] - a[12] * a[2] * a[7] + a[12] * a[3] * a[6];
+  inv[10] = a[0] * a[5] * a[15] - a[0] * a[7] * a[13] - a[4] * a[1] * a[15] + a[4] * a[3] * a[13] + a[12] * a[1] * a[7] - a[12] * a[3] * a[5];
+  inv[14] = -a[0] * a[5] * a[14] + a[0] * a[6] * a[13] + a[4] * a[1] * a[14] - a[4] * a[2] * a[13] - a[12] * a[1] * a[6] + a[12] * a[2] * a[5];
+  inv[3] = -a[1] * a[6] * a[11] + a[1] * a[7] * a[10] + a[5] * a[2] * a[11] - a[5] * a[3] * a[10] - a[9] * a[2] * a[7] + a[9] * a[3] * a[6];
+  inv[7] = a[0] * a[6] * a[11] - a[0] * a[7] * a[10] - a[4] * a[2] * a[11] + a[4] * a[3] * a[10] + a[8] * a[2] * a[7] - a[8] * a[3] * a[6];
+  inv[11] = -a[0] * a[5] * a[11] + a[0] * a[7] * a[9] + a[4] * a[1] * a[11] - a[4] * a[3] * a[9] - a[8] * a[1] * a[7] + a[8] * a[3] * a[5];
+  inv[15] = a[0] * a[5] * a[10] - a[0] * a[6] * a[9] - a[4] * a[1] * a[10] + a[4] * a[2] * a[9] + a[8] * a[1] * a[6] - a[8] * a[2] * a[5];
+  const float det = a[0] * inv[0] + a[1] * inv[4] + a[2] * inv[8] + a[3] * inv[12];
+  mat4 r;
+  float* out = &r[0].x;
+  for (int i = 0; i < 16; ++i) {
+    out[i] = inv[i] / det;
+  }
+  return r;
+}
+
+inline float determinant(const mat4& m) {
+  const float* a = &m[0].x;
+  const float c0 = a[5] * a[10] * a[15] - a[5] * a[11] * a[14] - a[9] * a[6] * a[15] + a[9] * a[7] * a[14] + a[13] * a[6] * a[11] - a[13] * a[7] * a[10];
+  const float c4 = -a[4] * a[10] * a[15] + a[4] * a[11] * a[14] + a[8] * a[6] * a[15] - a[8] * a[7] * a[14] - a[12] * a[6] * a[11] + a[12] * a[7] * a[10];
+  const float c8 = a[4] * a[9] * a[15] - a[4] * a[11] * a[13] - a[8] * a[5] * a[15] + a[8] * a[7] * a[13] + a[12] * a[5] * a[11] - a[12] * a[7] * a[9];
+  const float c12 = -a[4] * a[9] * a[14] + a[4] * a[10] * a[13] + a[8] * a[5] * a[14] - a[8] * a[6] * a[13] - a[12] * a[5] * a[10] + a[12] * a[6] * a[9];
+  return a[0] * c0 + a[1] * c4 + a[2] * c8 + a[3] * c12;
+}
+
+inline float dot(const quat& a, const quat& b) { return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w; }
+
+inline quat operator*(const quat& p, const quat& q) {
+  return quat(p.w * q.w - p.x * q.x - p.y * q.y - p.z * q.z,
+              p.w * q.x + p.x * q.w + p.y * q.z - p.z * q.y,
+              p.w * q.y + p.y * q.w + p.z * q.x - p.x * q.z,
+              p.w * q.z + p.z * q.w + p.x * q.y - p.y * q.x);
+}
+
+inline vec3 operator*(const quat& q, const vec3& v) {
+  const vec3 u(q.x, q.y, q.z);
+  const vec3 uv = cross(u, v);
+  const vec3 uuv = cross(u, uv);
+  return v + ((uv * q.w) + uuv) * 2.0f;
+}
+
+inline mat4 mat4_cast(const quat& q) {
+  const float x = q.x, y = q.y, z = q.z, w = q.w;
+  mat4 m(1.0f);
+  m[0][0] = 1 - 2 * (y * y + z * z);
+  m[0][1] = 2 * (x * y + w * z);
+  m[0][2] = 2 * (x * z - w * y);
+  m[1][0] = 2 * (x * y - w * z);
+  m[1][1] = 1 - 2 * (x * x + z * z);
+  m[1][2] = 2 * (y * z + w * x);
+  m[2][0] = 2 * (x * z + w * y);
+  m[2][1] = 2 * (y * z - w * x);
+  m[2][2] = 1 - 2 * (x * x + y * y);
+  return m;
+}
+
+inline quat quat_cast(const mat4& m) {
+  const float trace = m[0][0] + m[1][1] + m[2][2];
+  if (trace > 0.0f) {
+    const float s = 0.5f / sqrtf(trace + 1.0f);
+    return quat(0.25f / s, (m[1][2] - m[2][1]) * s, (m[2][0] - m[0][2]) * s,
+                (m[0][1] - m[1][0]) * s);
+  }
+  if (m[0][0] > m[1][1] && m[0][0] > m[2][2]) {
+    const float s = 2.0f * sqrtf(1.0f + m[0][0] - m[1][1] - m[2][2]);
+    return quat((m[1][2] - m[2][1]) / s, 0.25f * s, (m[1][0] + m[0][1]) / s,
+                (m[2][0] + m[0][2]) / s);
+  }
+  if (m[1][1] > m[2][2]) {
+    const float s = 2.0f * sqrtf(1.0f + m[1][1] - m[0][0] - m[2][2]);
+    return quat((m[2][0] - m[0][2]) / s, (m[1][0] + m[0][1]) / s, 0.25f * s,
+                (m[2][1] + m[1][2]) / s);
+  }
+  const float s = 2.0f * sqrtf(1.0f + m[2][2] - m[0][0] - m[1][1]);
+  return quat((m[0][1] - m[1][0]) / s, (m[2][0] + m[0][2]) / s,
+              (m[2][1] + m[1][2]) / s, 0.25f * s);
+}
+
+inline quat normalize(const quat& q) {
+  const float n = sqrtf(dot(q, q));
+  return quat(q.w / n, q.x / n, q.y / n, q.z / n);
+}
+
+inline quat slerp(const quat& a, const quat& b, float t) {
+  quat end = b;
+  float cos_theta = dot(a, b);
+  if (cos_theta < 0.0f) {
+    end = quat(-b.w, -b.x, -b.y, -b.z);
+    cos_theta = -cos_theta;
+  }
+  float wa, wb;
+  if (cos_theta > 1.0f - 1e-6f) {
+    wa = 1.0f - t;
+    wb = t;
+  } else {
+    const float angle = acosf(cos_theta);
+    wa = sinf((1.0f - t) * angle) / sinf(angle);
+    wb = sinf(t * angle) / sinf(angle);
+  }
+  return quat(wa * a.w + wb * end.w, wa * a.x + wb * end.x,
+              wa * a.y + wb * end.y, wa * a.z + wb * end.z);
+}
+
+inline quat angleAxis(float angle, const vec3& axis) {
+  const float s = sinf(angle * 0.5f);
+  return quat(cosf(angle * 0.5f), axis.x * s, axis.y * s, axis.z * s);
+}
+
+inline mat4 translate(const mat4& m, const vec3& v) {
+  mat4 r = m;
+  r[3] = m[0] * v.x + m[1] * v.y + m[2] * v.z + m[3];
+  return r;
+}
+
+inline mat4 scale(const mat4& m, const vec3& v) {
+  mat4 r = m;
+  r[0] = m[0] * v.x;
+  r[1] = m[1] * v.y;
+  r[2] = m[2] * v.z;
+  return r;
+}
+
+inline mat4 frustum(float left, float right, float bottom, float top,
+                    float near, float far) {
+  mat4 r(0.0f);
+  r[0][0] = 2.0f * near / (right - left);
+  r[1][1] = 2.0f * near / (top - bottom);
+  r[2][0] = (right + left) / (right - left);
+  r[2][1] = (top + bottom) / (top - bottom);
+  r[2][2] = -(far + near) / (far - near);
+  r[2][3] = -1.0f;
+  r[3][2] = -(2.0f * far * near) / (far - near);
+  return r;
+}
+
+inline mat4 perspective(float fovy, float aspect, float near, float far) {
+  const float top = near * tanf(fovy * 0.5f);
+  return frustum(-top * aspect, top * aspect, -top, top, near, far);
+}
+
+inline const float* value_ptr(const mat4& m) { return &m[0].x; }
+inline float* value_ptr(mat4& m) { return &m[0].x; }
+inline const float* value_ptr(const vec3& v) { return &v.x; }
+inline float* value_ptr(vec3& v) { return &v.x; }
+inline const float* value_ptr(const vec4& v) { return &v.x; }
+
+}  // namespace glm
+
+#endif  // CINDER_TANGO_TEST_GLM_SUBSET_GLM_HPP_
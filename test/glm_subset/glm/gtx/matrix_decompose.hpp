@@ -0,0 +1,2 @@
+// Everything the subset has is in glm.hpp.
+#include "../glm.hpp"
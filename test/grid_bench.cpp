@@ -0,0 +1,51 @@
+#include <time.h>
+
+#include "fake_gl.h"
+#include "tango-gl/grid.h"
+#include "test_util.h"
+
+// Procedural quad grid against the GL_LINES grid: vertices submitted per
+// draw, bytes uploaded and CPU time to build and render, for growing grid
+// sizes. GPU cost is not measured; the fake GL context draws nothing.
+
+using tango_gl::Grid;
+
+namespace {
+double CpuMs() {
+  timespec now;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return now.tv_sec * 1.0e3 + now.tv_nsec / 1.0e6;
+}
+}  // namespace
+
+int main() {
+  const int kFrames = 100;
+  const int sizes[] = {50, 500, 2000};
+  const glm::mat4 identity(1.0f);
+  const fake_gl::Counters& counters = fake_gl::GetState().counters;
+  printf("%-5s %-10s %9s %9s %9s %14s %9s\n", "cells", "mode", "vertices",
+         "bytes", "build ms", "first draw ms", "draw ms");
+  for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+    for (int procedural = 0; procedural < 2; ++procedural) {
+      double start = CpuMs();
+      Grid grid(0.1f, sizes[s], sizes[s]);
+      grid.SetProcedural(procedural != 0);
+      const double build_ms = CpuMs() - start;
+      const size_t bytes = counters.buffer_bytes;
+      start = CpuMs();
+      grid.Render(identity, identity);
+      const double first_ms = CpuMs() - start;
+      const size_t vertices = counters.vertices;
+      start = CpuMs();
+      for (int frame = 0; frame < kFrames; ++frame) {
+        grid.Render(identity, identity);
+      }
+      const double draw_ms = (CpuMs() - start) / kFrames;
+      printf("%-5d %-10s %9zu %9zu %9.3f %14.3f %9.4f\n", sizes[s],
+             procedural ? "procedural" : "lines",
+             (counters.vertices - vertices) / kFrames,
+             counters.buffer_bytes - bytes, build_ms, first_ms, draw_ms);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,196 @@
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+#include "tango-gl/obj_loader.h"
+#include "test_util.h"
+
+// OBJ parsing: numbers bit-identical to strtof, threaded parsing equal to
+// single-threaded, face forms, 32-bit indices and the binary cache.
+
+using namespace tango_gl::obj_loader;
+
+namespace {
+std::string TempPath(const char* name) {
+  char path[256];
+  snprintf(path, sizeof(path), "/tmp/obj_loader_test_%d_%s",
+           static_cast<int>(getpid()), name);
+  return path;
+}
+
+bool WriteFile(const std::string& path, const std::string& contents) {
+  FILE* file = fopen(path.c_str(), "wb");
+  if (file == NULL) {
+    return false;
+  }
+  const bool ok =
+      fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+  return fclose(file) == 0 && ok;
+}
+
+std::string Format(const char* format, double value) {
+  char text[64];
+  snprintf(text, sizeof(text), format, value);
+  return text;
+}
+
+// Numbers on both sides of the parser's fast path, and decimals that land
+// on or next to the midpoint between two floats, where rounding through
+// double first goes wrong.
+void MakeNumbers(std::vector<std::string>* numbers) {
+  const char* fixed[] = {
+      "0", "-0", "0.0", ".5", "5.", "+1.5", "-2.5e+3", "1E5", "1e-10",
+      "1e10", "1e11", "0.1", "0.2", "0.3", "16777215", "16777216",
+      "16777217", "16777218", "16777219", "3.4028235e38", "3.4028236e38",
+      "1e39", "1.17549435e-38", "1.4e-45", "1e-45", "7e-46", "1e-50",
+      "1.000000059604644776", "1.000000059604644775",
+      "123456789012345678901234", "0.000000000000000000000000123",
+      "9007199254740993", "1.00000005960464477539062500001"};
+  numbers->assign(fixed, fixed + sizeof(fixed) / sizeof(fixed[0]));
+  for (int i = 0; i < 60000; ++i) {
+    // A short decimal, as exporters write them.
+    const double mantissa = rand() % 10000000;
+    const int exponent = rand() % 21 - 10;
+    numbers->push_back(Format("%.0f", mantissa) + "e" +
+                       Format("%.0f", exponent));
+    numbers->push_back(Format(rand() % 2 ? "%.6f" : "%.4f",
+                              (rand() - RAND_MAX / 2) / 1000.0));
+
+    // A random float, printed to round trip, and its upper midpoint.
+    uint32_t bits = static_cast<uint32_t>(rand()) ^
+                    (static_cast<uint32_t>(rand()) << 16);
+    bits &= 0x7f7fffffu;
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    const double midpoint =
+        (static_cast<double>(value) + nextafterf(value, INFINITY)) / 2.0;
+    numbers->push_back(Format("%.9g", value));
+    numbers->push_back(Format("%.15e", midpoint));
+    numbers->push_back(Format("%.18e", midpoint));
+  }
+  while (numbers->size() % 3 != 0) {
+    numbers->push_back("1");
+  }
+}
+
+bool SameBits(float a, float b) { return memcmp(&a, &b, sizeof(a)) == 0; }
+
+void CheckNumbers() {
+  std::vector<std::string> numbers;
+  MakeNumbers(&numbers);
+  std::string obj;
+  for (size_t i = 0; i < numbers.size(); i += 3) {
+    obj += "v " + numbers[i] + " " + numbers[i + 1] + "\t" + numbers[i + 2] +
+           "\r\n";
+  }
+  const std::string path = TempPath("numbers.obj");
+  EXPECT(WriteFile(path, obj));
+
+  ObjData serial, threaded;
+  EXPECT(ParseOBJ(path.c_str(), 1, &serial));
+  // The file is a few MB, so four threads really get several chunks.
+  EXPECT(ParseOBJ(path.c_str(), 4, &threaded));
+  EXPECT(serial.positions.size() == numbers.size());
+  EXPECT(serial.positions == threaded.positions);
+  int mismatches = 0;
+  for (size_t i = 0; i < numbers.size() && i < serial.positions.size(); ++i) {
+    const float expected = strtof(numbers[i].c_str(), NULL);
+    if (!SameBits(serial.positions[i], expected) ||
+        !SameBits(threaded.positions[i], expected)) {
+      if (++mismatches <= 10) {
+        fprintf(stderr, "%s: got %.9g, strtof %.9g\n", numbers[i].c_str(),
+                serial.positions[i], expected);
+      }
+    }
+  }
+  EXPECT(mismatches == 0);
+  unlink(path.c_str());
+}
+
+void CheckFaces() {
+  const std::string path = TempPath("faces.obj");
+  EXPECT(WriteFile(path,
+                   "# comment\n"
+                   "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\n"
+                   "vt 0 0\nvn 0 0 1\n"
+                   "f 1 2 3\n"
+                   "f 1/1 3/1 4/1\n"
+                   "f -4//1 -3//1 -2//1 -1//1\n"
+                   "f 1/1/1 2/1/1 3/1/1\n"));
+  ObjData data;
+  EXPECT(ParseOBJ(path.c_str(), 0, &data));
+  EXPECT(data.positions.size() == 12);
+  EXPECT(data.normals.size() == 3);
+  // The quad is a fan of two triangles.
+  const GLuint expected[] = {0, 1, 2, 0, 2, 3, 0, 1, 2, 0, 2, 3, 0, 1, 2};
+  EXPECT(data.position_indices ==
+         std::vector<GLuint>(expected, expected + 15));
+  EXPECT(data.normal_indices.size() == 15);
+  EXPECT(data.normal_indices[0] == ObjData::kNoIndex);
+  EXPECT(data.normal_indices[6] == 0);
+  unlink(path.c_str());
+
+  EXPECT(WriteFile(path, "v 0 0 0\nf 1 2 3\n"));
+  EXPECT(!ParseOBJ(path.c_str(), 0, &data));
+  unlink(path.c_str());
+}
+
+void CheckWideIndices() {
+  const int kVertices = 70000;
+  std::string obj;
+  for (int i = 0; i < kVertices; ++i) {
+    obj += "v " + Format("%.0f", i) + " 0 0\n";
+  }
+  obj += "f 1 69999 70000\n";
+  const std::string path = TempPath("wide.obj");
+  EXPECT(WriteFile(path, obj));
+  std::vector<GLfloat> vertices;
+  std::vector<GLushort> short_indices;
+  std::vector<GLuint> indices;
+  EXPECT(!LoadOBJData(path.c_str(), vertices, short_indices));
+  EXPECT(LoadOBJData(path.c_str(), vertices, indices));
+  EXPECT(vertices.size() == 3 * kVertices);
+  EXPECT(indices.size() == 3 && indices[2] == kVertices - 1);
+  unlink(path.c_str());
+}
+
+void CheckCache() {
+  const std::string path = TempPath("cached.obj");
+  const std::string cache_path = TempPath("cached.tgm");
+  EXPECT(WriteFile(path, "v 0 0 0\nv 1 0 0\nv 1 1 0\nvn 0 0 1\n"
+                         "f 1//1 2//1 3//1\n"));
+  for (int with_normals = 0; with_normals < 2; ++with_normals) {
+    unlink(cache_path.c_str());
+    MappedMesh parsed, mapped;
+    EXPECT(parsed.Open(path.c_str(), cache_path.c_str(), with_normals != 0));
+    EXPECT(parsed.WasParsed());
+    EXPECT(mapped.Open(path.c_str(), cache_path.c_str(), with_normals != 0));
+    EXPECT(!mapped.WasParsed());
+    EXPECT(mapped.GetVertexCount() == parsed.GetVertexCount());
+    EXPECT(mapped.GetNormalCount() == parsed.GetNormalCount());
+    EXPECT(mapped.GetIndexCount() == parsed.GetIndexCount());
+    EXPECT(memcmp(mapped.GetVertices(), parsed.GetVertices(),
+                  parsed.GetVertexCount() * sizeof(GLfloat)) == 0);
+  }
+  // A changed source invalidates the cache.
+  EXPECT(WriteFile(path, "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 2 2 2\nf 1 2 4\n"));
+  MappedMesh reparsed;
+  EXPECT(reparsed.Open(path.c_str(), cache_path.c_str(), false));
+  EXPECT(reparsed.WasParsed());
+  EXPECT(reparsed.GetVertexCount() == 12);
+  unlink(path.c_str());
+  unlink(cache_path.c_str());
+}
+}  // namespace
+
+int main() {
+  srand(7);
+  CheckNumbers();
+  CheckFaces();
+  CheckWideIndices();
+  CheckCache();
+  return test_util::Finish();
+}
@@ -0,0 +1,57 @@
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+
+#include "fake_gl.h"
+#include "tango-gl/program_cache.h"
+#include "test_util.h"
+
+// ProgramCache sharing, location caching and the binary disk cache, on the
+// fake GL context.
+
+using tango_gl::ProgramCache;
+
+int main() {
+  ProgramCache& cache = ProgramCache::GetInstance();
+  const fake_gl::Counters& counters = fake_gl::GetState().counters;
+  const std::string vertex = "void main() { gl_Position = vec4(0.0); }";
+  const std::string fragment = "void main() { gl_FragColor = vec4(1.0); }";
+
+  const GLuint program = cache.GetProgram(vertex, fragment);
+  EXPECT(program != 0);
+  EXPECT(cache.GetProgram(vertex, fragment) == program);
+  EXPECT(counters.programs_created == 1);
+  // Concatenations that match must not share a program.
+  const GLuint other = cache.GetProgram(vertex + "\n", fragment);
+  const GLuint shifted = cache.GetProgram(vertex + fragment.substr(0, 4),
+                                          fragment.substr(4));
+  EXPECT(other != 0 && other != program);
+  EXPECT(shifted != 0 && shifted != program && shifted != other);
+  EXPECT(cache.GetStats().programs == 3);
+  EXPECT(cache.GetStats().compiled == 3);
+
+  const GLint location = cache.GetUniformLocation(program, "mvp");
+  const int calls = counters.calls;
+  EXPECT(cache.GetUniformLocation(program, "mvp") == location);
+  EXPECT(counters.calls == calls);
+
+  cache.Clear();
+  EXPECT(counters.programs_deleted == 3);
+  EXPECT(fake_gl::GetState().programs.empty());
+  EXPECT(cache.GetStats().programs == 0);
+
+  // A second run loads the saved binary instead of compiling.
+  char directory[] = "/tmp/program_cache_testXXXXXX";
+  EXPECT(mkdtemp(directory) != NULL);
+  cache.SetBinaryCacheDirectory(directory);
+  EXPECT(cache.GetProgram(vertex, fragment) != 0);
+  EXPECT(cache.GetStats().binaries_saved == 1);
+  cache.Invalidate();
+  const int compiled = cache.GetStats().compiled;
+  EXPECT(cache.GetProgram(vertex, fragment) != 0);
+  EXPECT(cache.GetStats().loaded == 1);
+  EXPECT(cache.GetStats().compiled == compiled);
+  cache.Clear();
+  EXPECT(system((std::string("rm -rf ") + directory).c_str()) == 0);
+  return test_util::Finish();
+}
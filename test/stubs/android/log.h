@@ -0,0 +1,20 @@
+#ifndef CINDER_TANGO_TEST_STUBS_ANDROID_LOG_H_
+#define CINDER_TANGO_TEST_STUBS_ANDROID_LOG_H_
+
+// The NDK logging calls used by src/ and tango-gl; android_log.cpp prints
+// them to stderr.
+enum {
+  ANDROID_LOG_VERBOSE = 2,
+  ANDROID_LOG_DEBUG = 3,
+  ANDROID_LOG_INFO = 4,
+  ANDROID_LOG_WARN = 5,
+  ANDROID_LOG_ERROR = 6
+};
+
+extern "C" int __android_log_print(int priority, const char* tag,
+                                   const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+extern "C" int __android_log_write(int priority, const char* tag,
+                                   const char* text);
+
+#endif  // CINDER_TANGO_TEST_STUBS_ANDROID_LOG_H_
@@ -0,0 +1,20 @@
+#include <android/log.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+extern "C" int __android_log_print(int priority, const char* tag,
+                                   const char* format, ...) {
+  fprintf(stderr, "%d %s: ", priority, tag);
+  va_list args;
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+  return 0;
+}
+
+extern "C" int __android_log_write(int priority, const char* tag,
+                                   const char* text) {
+  fprintf(stderr, "%d %s: %s\n", priority, tag, text);
+  return 0;
+}
@@ -0,0 +1,12 @@
+#ifndef CINDER_TANGO_TEST_STUBS_CINDER_LOG_H_
+#define CINDER_TANGO_TEST_STUBS_CINDER_LOG_H_
+
+#include <iostream>
+
+// Cinder's streaming log macros, printed to stderr.
+#define CI_LOG_V(stream) (std::cerr << "V " << stream << std::endl)
+#define CI_LOG_I(stream) (std::cerr << "I " << stream << std::endl)
+#define CI_LOG_W(stream) (std::cerr << "W " << stream << std::endl)
+#define CI_LOG_E(stream) (std::cerr << "E " << stream << std::endl)
+
+#endif  // CINDER_TANGO_TEST_STUBS_CINDER_LOG_H_
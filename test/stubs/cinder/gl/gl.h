@@ -0,0 +1,14 @@
+#ifndef CINDER_TANGO_TEST_STUBS_CINDER_GL_GL_H_
+#define CINDER_TANGO_TEST_STUBS_CINDER_GL_GL_H_
+
+// What tango-gl needs from Cinder's GL header on Android: the OpenGL ES 3
+// API, plus the standard headers the real one pulls in. The functions are
+// implemented by fake_gl.cpp.
+#include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#endif  // CINDER_TANGO_TEST_STUBS_CINDER_GL_GL_H_
@@ -0,0 +1,8 @@
+#ifndef CINDER_TANGO_TEST_STUBS_JNI_H_
+#define CINDER_TANGO_TEST_STUBS_JNI_H_
+
+// Just enough of the NDK's jni.h for tango_client_api.h to parse.
+typedef struct _JNIEnv JNIEnv;
+typedef void* jobject;
+
+#endif  // CINDER_TANGO_TEST_STUBS_JNI_H_
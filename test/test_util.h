@@ -0,0 +1,39 @@
+#ifndef CINDER_TANGO_TEST_TEST_UTIL_H_
+#define CINDER_TANGO_TEST_TEST_UTIL_H_
+
+#include <stdio.h>
+#include <time.h>
+
+// Minimal checking for the desktop tests: EXPECT reports and counts a
+// failure and carries on; main returns test_util::Finish().
+#define EXPECT(condition)                                            \
+  do {                                                               \
+    if (!(condition)) {                                              \
+      fprintf(stderr, "%s:%d: expected %s\n", __FILE__, __LINE__,   \
+              #condition);                                           \
+      ++test_util::failures;                                         \
+    }                                                                \
+  } while (0)
+
+namespace test_util {
+
+extern int failures;
+
+inline int Finish() {
+  if (failures > 0) {
+    fprintf(stderr, "%d failure(s)\n", failures);
+    return 1;
+  }
+  printf("ok\n");
+  return 0;
+}
+
+inline double NowMs() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec * 1.0e3 + now.tv_nsec / 1.0e6;
+}
+
+}  // namespace test_util
+
+#endif  // CINDER_TANGO_TEST_TEST_UTIL_H_
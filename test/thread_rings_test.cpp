@@ -0,0 +1,126 @@
+#include <pthread.h>
+#include <atomic>
+#include <map>
+#include <vector>
+
+#include "fast_log.h"
+#include "test_util.h"
+#include "thread_rings.h"
+
+// ThreadRings: per-thread order, drop counting and freeing the rings of
+// ended threads; then FastLog on top of it.
+
+namespace {
+const size_t kRingSize = 128;
+
+std::atomic<int> new_threads(0);
+void OnNewThread(int) { ++new_threads; }
+
+struct Item {
+  int producer;
+  int sequence;
+};
+
+struct Producer {
+  ThreadRings<Item>* rings;
+  int index;
+  int count;
+};
+
+void* Produce(void* arg) {
+  const Producer* producer = static_cast<Producer*>(arg);
+  for (int i = 0; i < producer->count; ++i) {
+    Item item;
+    item.producer = producer->index;
+    item.sequence = i;
+    producer->rings->Push(item);
+  }
+  return nullptr;
+}
+
+// Runs count-item producers on their own threads and waits for them.
+void RunProducers(ThreadRings<Item>* rings, const std::vector<int>& counts) {
+  std::vector<Producer> producers(counts.size());
+  std::vector<pthread_t> threads(counts.size());
+  for (size_t i = 0; i < counts.size(); ++i) {
+    producers[i].rings = rings;
+    producers[i].index = static_cast<int>(i);
+    producers[i].count = counts[i];
+    pthread_create(&threads[i], nullptr, Produce, &producers[i]);
+  }
+  for (pthread_t thread : threads) {
+    pthread_join(thread, nullptr);
+  }
+}
+
+void* Log(void*) {
+  for (int i = 0; i < 10; ++i) {
+    FAST_LOG_I("line %d of %s", i, "worker");
+  }
+  return nullptr;
+}
+}  // namespace
+
+int main() {
+  ThreadRings<Item> rings(kRingSize, OnNewThread);
+
+  // Four threads that fit their rings.
+  RunProducers(&rings, std::vector<int>(4, 100));
+  EXPECT(new_threads == 4);
+  EXPECT(rings.GetThreadCount() == 4);
+  std::map<int, int> next;
+  std::map<int, int> producer_tid;
+  int drained = 0;
+  bool in_order = true;
+  bool one_tid = true;
+  EXPECT(rings.Drain([&](int tid, const Item& item) {
+    in_order = in_order && next[item.producer]++ == item.sequence;
+    if (producer_tid.count(item.producer) == 0) {
+      producer_tid[item.producer] = tid;
+    }
+    one_tid = one_tid && producer_tid[item.producer] == tid;
+    ++drained;
+  }) == 0);
+  EXPECT(drained == 400);
+  EXPECT(in_order);
+  EXPECT(one_tid);
+  // Every producer ended, so its ring went with the drain.
+  EXPECT(rings.GetThreadCount() == 0);
+
+  // One that overflows; what it dropped outlives its ring.
+  RunProducers(&rings, std::vector<int>(1, 200));
+  drained = 0;
+  EXPECT(rings.Drain([&](int, const Item&) { ++drained; }) == 72);
+  EXPECT(drained == 128);
+  EXPECT(rings.GetThreadCount() == 0);
+  EXPECT(rings.GetDropped() == 72);
+  EXPECT(rings.Drain([&](int, const Item&) { ++drained; }) == 0);
+
+  // A live thread keeps its ring and its tid.
+  Item item = {0, 0};
+  rings.Push(item);
+  rings.Push(item);
+  int tid = 0;
+  EXPECT(rings.Drain([&](int from, const Item&) { tid = from; }) == 0);
+  EXPECT(rings.GetThreadCount() == 1);
+  EXPECT(tid == rings.GetThreadId());
+
+  // FastLog keeps its records in ThreadRings.
+  FastLog& log = FastLog::GetInstance();
+  EXPECT(log.Start(FastLog::Options()));
+  pthread_t threads[2];
+  for (pthread_t& thread : threads) {
+    pthread_create(&thread, nullptr, Log, nullptr);
+  }
+  for (pthread_t thread : threads) {
+    pthread_join(thread, nullptr);
+  }
+  log.Flush();
+  const FastLog::Stats stats = log.GetStats();
+  EXPECT(stats.written == 20);
+  EXPECT(stats.dropped == 0);
+  EXPECT(stats.threads == 0);
+  log.Stop();
+
+  return test_util::Finish();
+}
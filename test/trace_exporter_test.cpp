@@ -0,0 +1,85 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <limits>
+#include <string>
+
+#include "profiler.h"
+#include "test_util.h"
+#include "trace_exporter.h"
+
+// Traces written through the profiler: counters that are not finite stay
+// out of the JSON, threads are named on their tracks, and the names of
+// ended threads are forgotten.
+
+namespace {
+std::string ReadFile(const std::string& path) {
+  std::string contents;
+  FILE* file = fopen(path.c_str(), "r");
+  if (file == nullptr) {
+    return contents;
+  }
+  char buffer[4096];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    contents.append(buffer, size);
+  }
+  fclose(file);
+  return contents;
+}
+
+bool Contains(const std::string& text, const char* part) {
+  return text.find(part) != std::string::npos;
+}
+
+void* Worker(void*) {
+  pthread_setname_np(pthread_self(), "trace_worker");
+  PROFILE_SCOPE("work");
+  return nullptr;
+}
+}  // namespace
+
+int main() {
+  char directory[] = "/tmp/trace_exporter_testXXXXXX";
+  EXPECT(mkdtemp(directory) != nullptr);
+  TraceExporter::Options options;
+  options.path = std::string(directory) + "/trace.json";
+  TraceExporter& trace = TraceExporter::GetInstance();
+  Profiler& profiler = Profiler::GetInstance();
+  pthread_setname_np(pthread_self(), "trace_main");
+
+  EXPECT(trace.Start(options));
+  pthread_t thread;
+  pthread_create(&thread, nullptr, Worker, nullptr);
+  pthread_join(thread, nullptr);
+  {
+    PROFILE_SCOPE("frame");
+  }
+  PROFILE_COUNTER("finite", 1.5);
+  PROFILE_COUNTER("nan", std::numeric_limits<double>::quiet_NaN());
+  PROFILE_COUNTER("inf", std::numeric_limits<double>::infinity());
+  profiler.EndFrame();
+  trace.Stop();
+  std::string json = ReadFile(options.path);
+  EXPECT(Contains(json, "\"finite\""));
+  EXPECT(!Contains(json, "nan"));
+  EXPECT(!Contains(json, "inf\"") && !Contains(json, ":inf"));
+  EXPECT(Contains(json, "\"name\":\"trace_worker\""));
+  EXPECT(Contains(json, "\"name\":\"trace_main\""));
+  EXPECT(Contains(json, "\"work\""));
+  EXPECT(json.compare(json.size() - 3, 3, "\n]\n") == 0);
+  EXPECT(trace.GetStats().dropped == 2);
+
+  // A new trace names the threads still running, not the one that ended.
+  EXPECT(trace.Start(options));
+  profiler.EndFrame();
+  trace.Stop();
+  json = ReadFile(options.path);
+  EXPECT(Contains(json, "\"name\":\"trace_main\""));
+  EXPECT(!Contains(json, "trace_worker"));
+
+  unlink(options.path.c_str());
+  rmdir(directory);
+  return test_util::Finish();
+}
@@ -0,0 +1,58 @@
+#ifndef CINDER_TANGO_TEST_TRANSFORM_HIERARCHY_H_
+#define CINDER_TANGO_TEST_TRANSFORM_HIERARCHY_H_
+
+#include <stdlib.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "tango-gl/transform.h"
+
+// Helpers shared by transform_test and transform_bench.
+namespace transform_hierarchy {
+
+// The world matrix composed from scratch up the parent chain, as
+// GetTransformationMatrix did before matrices were cached.
+inline glm::mat4 ComposeUncached(const tango_gl::Transform* transform) {
+  glm::mat4 matrix = glm::scale(glm::mat4_cast(transform->GetRotation()),
+                                transform->GetScale());
+  const glm::vec3 position = transform->GetPosition();
+  matrix[3] = glm::vec4(position, 1.0f);
+  if (transform->GetParent() != NULL) {
+    matrix = ComposeUncached(transform->GetParent()) * matrix;
+  }
+  return matrix;
+}
+
+inline float MaxDifference(const glm::mat4& a, const glm::mat4& b) {
+  float difference = 0.0f;
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      difference = std::max(difference, std::fabs(a[i][j] - b[i][j]));
+    }
+  }
+  return difference;
+}
+
+// A chain of chain_length nodes from the root, then nodes under random
+// earlier ones, each with a small random offset and rotation.
+inline void BuildHierarchy(
+    int count, int chain_length,
+    std::vector<std::unique_ptr<tango_gl::Transform> >* nodes) {
+  nodes->clear();
+  for (int i = 0; i < count; ++i) {
+    nodes->emplace_back(new tango_gl::Transform());
+    tango_gl::Transform* node = nodes->back().get();
+    if (i > 0) {
+      node->SetParent((*nodes)[i < chain_length ? i - 1 : rand() % i].get());
+    }
+    node->SetPosition(glm::vec3(0.01f * (rand() % 100), 0.01f, 0.0f));
+    node->SetRotation(glm::angleAxis(0.001f * (rand() % 100),
+                                     glm::vec3(0.0f, 0.0f, 1.0f)));
+  }
+}
+
+}  // namespace transform_hierarchy
+
+#endif  // CINDER_TANGO_TEST_TRANSFORM_HIERARCHY_H_
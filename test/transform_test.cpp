@@ -0,0 +1,66 @@
+#include "test_util.h"
+#include "transform_hierarchy.h"
+
+// Cached world matrices against composing the parent chain from scratch,
+// through edits, reparenting and destruction.
+
+using tango_gl::Transform;
+using transform_hierarchy::ComposeUncached;
+using transform_hierarchy::MaxDifference;
+
+namespace {
+float WorstDifference(
+    const std::vector<std::unique_ptr<Transform> >& nodes) {
+  float worst = 0.0f;
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    if (nodes[i]) {
+      worst = std::max(worst, MaxDifference(nodes[i]->GetTransformationMatrix(),
+                                            ComposeUncached(nodes[i].get())));
+    }
+  }
+  return worst;
+}
+}  // namespace
+
+int main() {
+  srand(1);
+  const int kCount = 2000;
+  const float kTolerance = 1e-3f;
+  std::vector<std::unique_ptr<Transform> > nodes;
+  transform_hierarchy::BuildHierarchy(kCount, 50, &nodes);
+  EXPECT(WorstDifference(nodes) < kTolerance);
+
+  for (int frame = 0; frame < 20; ++frame) {
+    for (int k = 0; k < 20; ++k) {
+      nodes[rand() % kCount]->Translate(glm::vec3(0.01f, 0.0f, 0.0f));
+    }
+    const int child = 1 + rand() % (kCount - 1);
+    nodes[child]->SetParent(nodes[rand() % child].get());
+    // Lazy reads before the batch pass leave parts of the tree clean.
+    for (int k = 0; k < 5; ++k) {
+      nodes[rand() % kCount]->GetTransformationMatrix();
+    }
+    nodes[0]->UpdateWorldMatrices();
+  }
+  EXPECT(WorstDifference(nodes) < kTolerance);
+
+  // Versions change with the world matrix, including through a parent, and
+  // only then.
+  const uint32_t version = nodes[1]->GetWorldVersion();
+  nodes[0]->UpdateWorldMatrices();
+  EXPECT(nodes[1]->GetWorldVersion() == version);
+  nodes[0]->Translate(glm::vec3(0.0f, 1.0f, 0.0f));
+  nodes[0]->UpdateWorldMatrices();
+  EXPECT(nodes[1]->GetWorldVersion() != version);
+
+  // Children of a destroyed transform become roots.
+  Transform* middle = nodes[10].get();
+  const std::vector<Transform*> children = middle->GetChildren();
+  EXPECT(!children.empty());
+  nodes[10].reset();
+  for (size_t i = 0; i < children.size(); ++i) {
+    EXPECT(children[i]->GetParent() == NULL);
+  }
+  EXPECT(WorstDifference(nodes) < kTolerance);
+  return test_util::Finish();
+}
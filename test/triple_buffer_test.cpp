@@ -0,0 +1,127 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <atomic>
+
+#include "test_util.h"
+#include "triple_buffer.h"
+
+// TripleBuffer between a writer and a reader thread: snapshots are never
+// torn or older than the last one read, Acquire reports each publish once,
+// and the latest value always comes out.
+
+namespace {
+const int kFields = 16;
+const uint64_t kPublishes = 1000000;
+const uint64_t kLockstepPublishes = 20000;
+
+struct Snapshot {
+  uint64_t sequence;
+  uint64_t fields[kFields];
+};
+
+TripleBuffer<Snapshot> buffer;
+std::atomic<bool> writer_done(false);
+// Lockstep: the last sequence published, and the last one the reader took.
+std::atomic<uint64_t> published(0);
+std::atomic<uint64_t> taken(0);
+
+void Write(uint64_t sequence) {
+  Snapshot& snapshot = buffer.GetWriteBuffer();
+  snapshot.sequence = sequence;
+  for (int i = 0; i < kFields; ++i) {
+    snapshot.fields[i] = sequence * kFields + i;
+  }
+  buffer.Publish();
+}
+
+bool IsWhole(const Snapshot& snapshot) {
+  for (int i = 0; i < kFields; ++i) {
+    if (snapshot.fields[i] != snapshot.sequence * kFields + i) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void* FreeRunningWriter(void*) {
+  for (uint64_t sequence = 1; sequence <= kPublishes; ++sequence) {
+    Write(sequence);
+  }
+  writer_done.store(true);
+  return nullptr;
+}
+
+void* LockstepWriter(void*) {
+  for (uint64_t sequence = 1; sequence <= kLockstepPublishes; ++sequence) {
+    Write(sequence);
+    published.store(sequence);
+    while (taken.load() != sequence) {
+      sched_yield();
+    }
+  }
+  return nullptr;
+}
+}  // namespace
+
+int main() {
+  EXPECT(!buffer.Acquire());
+
+  // Free running: the reader skips values but never goes back or tears.
+  pthread_t writer;
+  pthread_create(&writer, nullptr, FreeRunningWriter, nullptr);
+  uint64_t last = 0;
+  uint64_t acquired = 0;
+  bool whole = true;
+  bool newer = true;
+  bool unchanged = true;
+  while (!writer_done.load()) {
+    if (buffer.Acquire()) {
+      const Snapshot& snapshot = buffer.GetReadBuffer();
+      whole = whole && IsWhole(snapshot);
+      newer = newer && snapshot.sequence > last;
+      last = snapshot.sequence;
+      ++acquired;
+    } else if (acquired > 0) {
+      unchanged = unchanged && buffer.GetReadBuffer().sequence == last;
+    }
+  }
+  pthread_join(writer, nullptr);
+  // The latest value comes out once the writer has stopped, and only once.
+  if (last != kPublishes) {
+    EXPECT(buffer.Acquire());
+  }
+  EXPECT(buffer.GetReadBuffer().sequence == kPublishes);
+  EXPECT(IsWhole(buffer.GetReadBuffer()));
+  EXPECT(!buffer.Acquire());
+  EXPECT(whole);
+  EXPECT(newer);
+  EXPECT(unchanged);
+  EXPECT(acquired > 0 && acquired <= kPublishes);
+
+  // Lockstep: every publish is acquired exactly once.
+  published.store(0);
+  taken.store(0);
+  pthread_create(&writer, nullptr, LockstepWriter, nullptr);
+  bool once = true;
+  for (uint64_t sequence = 1; sequence <= kLockstepPublishes; ++sequence) {
+    while (published.load() != sequence) {
+      sched_yield();
+    }
+    once = once && buffer.Acquire() &&
+           buffer.GetReadBuffer().sequence == sequence &&
+           IsWhole(buffer.GetReadBuffer()) && !buffer.Acquire();
+    taken.store(sequence);
+  }
+  pthread_join(writer, nullptr);
+  EXPECT(once);
+
+  // Two publishes between reads come out as one, the second.
+  Write(7);
+  Write(8);
+  EXPECT(buffer.Acquire());
+  EXPECT(buffer.GetReadBuffer().sequence == 8);
+  EXPECT(!buffer.Acquire());
+
+  return test_util::Finish();
+}
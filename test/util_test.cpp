@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+
+#include "tango-gl/util.h"
+#include "test_util.h"
+
+// util::WriteFileAtomically: a failed write leaves the old file and no
+// ".part" file behind.
+
+namespace {
+std::string ReadFile(const std::string& path) {
+  std::string contents;
+  FILE* file = fopen(path.c_str(), "rb");
+  if (file == NULL) {
+    return contents;
+  }
+  char buffer[256];
+  size_t size;
+  while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    contents.append(buffer, size);
+  }
+  fclose(file);
+  return contents;
+}
+
+bool Exists(const std::string& path) { return access(path.c_str(), F_OK) == 0; }
+}  // namespace
+
+using tango_gl::util::WriteFileAtomically;
+
+int main() {
+  char directory[] = "/tmp/util_testXXXXXX";
+  EXPECT(mkdtemp(directory) != NULL);
+  const std::string path = std::string(directory) + "/file";
+
+  EXPECT(WriteFileAtomically(path, [](FILE* file) {
+    return fputs("first", file) >= 0;
+  }));
+  EXPECT(ReadFile(path) == "first");
+  EXPECT(!Exists(path + ".part"));
+
+  // A writer that fails halfway leaves the old contents.
+  EXPECT(!WriteFileAtomically(path, [](FILE* file) {
+    fputs("sec", file);
+    return false;
+  }));
+  EXPECT(ReadFile(path) == "first");
+  EXPECT(!Exists(path + ".part"));
+
+  EXPECT(WriteFileAtomically(path, [](FILE* file) {
+    return fputs("second", file) >= 0;
+  }));
+  EXPECT(ReadFile(path) == "second");
+
+  // An uncreatable file fails without calling the writer.
+  bool called = false;
+  EXPECT(!WriteFileAtomically(std::string(directory) + "/missing/file",
+                              [&](FILE*) { return called = true; }));
+  EXPECT(!called);
+
+  unlink(path.c_str());
+  rmdir(directory);
+  return test_util::Finish();
+}
@@ -0,0 +1,48 @@
+#include <stdlib.h>
+#include <vector>
+
+#include "test_util.h"
+#include "yuv_convert.h"
+
+// Conversion throughput in ms per megapixel of source image, SIMD and
+// scalar, for a 1280x720 NV21 frame.
+
+using namespace yuv_convert;
+
+int main() {
+  const int width = 1280, height = 720, stride = 1280;
+  const int kIterations = 50;
+  std::vector<uint8_t> data(
+      ImageByteSize(TANGO_HAL_PIXEL_FORMAT_YCrCb_420_SP, stride, height));
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<uint8_t>(rand());
+  }
+  ImagePlanes planes;
+  GetImagePlanes(TANGO_HAL_PIXEL_FORMAT_YCrCb_420_SP, data.data(), width,
+                 height, stride, &planes);
+  std::vector<uint8_t> out(width * height * 4);
+  const double megapixels = width * height / 1.0e6;
+
+  const char* layout_names[] = {"gray", "rgb", "rgba"};
+  printf("%s, %dx%d\n", GetSimdName(), width, height);
+  printf("%-6s %-5s %12s %12s %8s\n", "layout", "scale", "simd ms/MP",
+         "scalar ms/MP", "speedup");
+  for (int l = 0; l < 3; ++l) {
+    const PixelLayout layout = static_cast<PixelLayout>(l);
+    for (int scale = 1; scale <= 4; scale *= 2) {
+      const int dst_stride = width / scale * GetBytesPerPixel(layout);
+      double ms[2];
+      for (int simd = 0; simd < 2; ++simd) {
+        const double start = test_util::NowMs();
+        for (int i = 0; i < kIterations; ++i) {
+          ConvertImage(planes, scale, layout, out.data(), dst_stride,
+                       simd == 0);
+        }
+        ms[simd] = (test_util::NowMs() - start) / kIterations / megapixels;
+      }
+      printf("%-6s %-5d %12.3f %12.3f %7.1fx\n", layout_names[l], scale,
+             ms[0], ms[1], ms[1] / ms[0]);
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,141 @@
+#include <stdlib.h>
+#include <vector>
+
+#include "test_util.h"
+#include "yuv_convert.h"
+
+// The SIMD kernels against the scalar reference, and the reference against
+// the documented formula.
+
+using namespace yuv_convert;
+
+namespace {
+const TangoImageFormatType kFormats[] = {TANGO_HAL_PIXEL_FORMAT_YCrCb_420_SP,
+                                         TANGO_HAL_PIXEL_FORMAT_YV12};
+
+uint8_t Clamp(int value) {
+  return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+void Fill(std::vector<uint8_t>* data, int pattern) {
+  for (size_t i = 0; i < data->size(); ++i) {
+    switch (pattern) {
+      case 0:
+        (*data)[i] = static_cast<uint8_t>(rand());
+        break;
+      case 1:
+        // Extremes, where the 16-bit sums saturate.
+        (*data)[i] = i % 3 == 0 ? 255 : (i % 3 == 1 ? 0 : 128);
+        break;
+      default:
+        (*data)[i] = static_cast<uint8_t>(i % 2 == 0 ? 255 : 0);
+        break;
+    }
+  }
+}
+
+void CheckSimdMatchesScalar() {
+  // Odd sizes and strides exercise the scalar tails of the SIMD loops.
+  const int sizes[][2] = {{1280, 720}, {640, 480}, {37, 23}, {101, 67},
+                          {64, 8}, {16, 4}, {4, 4}};
+  const int layouts[] = {kPixelLayoutGray, kPixelLayoutRgb, kPixelLayoutRgba};
+  for (int pattern = 0; pattern < 3; ++pattern) {
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+      for (int f = 0; f < 2; ++f) {
+        const int width = sizes[s][0], height = sizes[s][1];
+        const int stride = width + (f == 0 ? 6 : 14);
+        std::vector<uint8_t> data(ImageByteSize(kFormats[f], stride, height));
+        Fill(&data, pattern);
+        ImagePlanes planes;
+        EXPECT(GetImagePlanes(kFormats[f], data.data(), width, height, stride,
+                              &planes));
+        for (int scale = 1; scale <= 4; scale *= 2) {
+          for (int l = 0; l < 3; ++l) {
+            const PixelLayout layout = static_cast<PixelLayout>(layouts[l]);
+            const int out_width = width / scale, out_height = height / scale;
+            const int dst_stride = out_width * GetBytesPerPixel(layout) + 3;
+            std::vector<uint8_t> simd(dst_stride * out_height, 0);
+            std::vector<uint8_t> scalar(dst_stride * out_height, 0);
+            EXPECT(ConvertImage(planes, scale, layout, simd.data(),
+                                dst_stride, true));
+            EXPECT(ConvertImage(planes, scale, layout, scalar.data(),
+                                dst_stride, false));
+            if (simd != scalar) {
+              fprintf(stderr, "%dx%d format %d scale %d layout %d pattern %d\n",
+                      width, height, f, scale, l, pattern);
+            }
+            EXPECT(simd == scalar);
+          }
+        }
+      }
+    }
+  }
+}
+
+void CheckScalarMatchesFormula() {
+  const int width = 34, height = 18, stride = 40;
+  for (int f = 0; f < 2; ++f) {
+    std::vector<uint8_t> data(ImageByteSize(kFormats[f], stride, height));
+    Fill(&data, 0);
+    ImagePlanes planes;
+    GetImagePlanes(kFormats[f], data.data(), width, height, stride, &planes);
+    std::vector<uint8_t> rgb(width * 3 * height);
+    ConvertImage(planes, 1, kPixelLayoutRgb, rgb.data(), width * 3, false);
+    bool match = true;
+    for (int y = 0; y < height; ++y) {
+      for (int x = 0; x < width; ++x) {
+        const int chroma = (y / 2) * planes.chroma_stride +
+                           (x / 2) * planes.chroma_step;
+        const int c = planes.y[y * planes.y_stride + x] - 16;
+        const int d = planes.u[chroma] - 128;
+        const int e = planes.v[chroma] - 128;
+        const uint8_t* out = &rgb[(y * width + x) * 3];
+        match &= out[0] == Clamp((74 * c + 102 * e + 32) >> 6);
+        match &= out[1] == Clamp((74 * c - 25 * d - 52 * e + 32) >> 6);
+        match &= out[2] == Clamp((74 * c + 129 * d + 32) >> 6);
+      }
+    }
+    EXPECT(match);
+  }
+}
+
+void CheckDownscalePlane() {
+  const int width = 67, height = 41, stride = 72;
+  std::vector<uint8_t> plane(stride * height);
+  Fill(&plane, 0);
+  for (int scale = 2; scale <= 4; scale *= 2) {
+    const int out_width = width / scale, out_height = height / scale;
+    std::vector<uint8_t> simd(out_width * out_height);
+    std::vector<uint8_t> scalar(out_width * out_height);
+    EXPECT(DownscalePlane(plane.data(), width, height, stride, scale,
+                          simd.data(), out_width, true));
+    EXPECT(DownscalePlane(plane.data(), width, height, stride, scale,
+                          scalar.data(), out_width, false));
+    EXPECT(simd == scalar);
+    // Round-to-nearest box average.
+    bool match = true;
+    for (int y = 0; y < out_height; ++y) {
+      for (int x = 0; x < out_width; ++x) {
+        int sum = 0;
+        for (int j = 0; j < scale; ++j) {
+          for (int i = 0; i < scale; ++i) {
+            sum += plane[(y * scale + j) * stride + x * scale + i];
+          }
+        }
+        const int count = scale * scale;
+        match &= scalar[y * out_width + x] == (sum + count / 2) / count;
+      }
+    }
+    EXPECT(match);
+  }
+}
+}  // namespace
+
+int main() {
+  srand(1);
+  printf("SIMD: %s\n", GetSimdName());
+  CheckSimdMatchesScalar();
+  CheckScalarMatchesFormula();
+  CheckDownscalePlane();
+  return test_util::Finish();
+}